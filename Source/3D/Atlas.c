@@ -355,6 +355,8 @@ void DisposeAllSpriteAtlases(void)
 
 Atlas* Atlas_Load(const char* fontName, int flags)
 {
+	int prevTag = SetMemoryTag(MEMORY_TAG_UI);
+
 	Atlas* atlas = AllocPtrClear(sizeof(Atlas));
 
 	if (flags & kAtlasLoadFont)
@@ -462,6 +464,7 @@ Atlas* Atlas_Load(const char* fontName, int flags)
 		}
 	}
 
+	SetMemoryTag(prevTag);
 	return atlas;
 }
 
@@ -20,6 +20,7 @@
 static void ResetCameraSettings(void);
 static void MoveCamera_DustDevil(ObjNode *player);
 static void UpdateCamera_FirstPerson(short i);
+static float UpdateSunVisibility(float fx, float fy, float fz, float sx, float sy);
 
 
 /****************************/
@@ -29,6 +30,9 @@ static void UpdateCamera_FirstPerson(short i);
 
 #define	NUM_FLARES			6
 
+#define	SUN_PROBE_SIZE		.012f				// half-size of the sun's occlusion probe, as a fraction of the pane height
+#define	SUN_PROBE_DIST		.9f					// how far out the probe sits, as a fraction of yon: in front of the cyc, behind the faded-out items
+
 #define	CAMERA_DEFAULT_DIST_FROM_ME		280.0f
 #define	CAMERA_WORMHOLE_DIST_FROM_ME	(CAMERA_DEFAULT_DIST_FROM_ME * 6.0f)
 
@@ -46,6 +50,8 @@ static void UpdateCamera_FirstPerson(short i);
 /*********************/
 
 static OGLCameraPlacement	gAnaglyphCameraBackup[MAX_PLAYERS];		// backup of original camera info before offsets applied
+static OGLCameraPlacement	gTickCameraPlacement[MAX_PLAYERS];		// cameras at the start of the current simulation tick
+static OGLCameraPlacement	gInterpolationCameraBackup[MAX_PLAYERS];	// real cameras while we draw interpolated ones
 
 Boolean				gCameraInExitMode = false;
 Boolean				gDrawLensFlare = true;
@@ -56,6 +62,20 @@ Boolean				gCameraInDeathDiveMode[MAX_PLAYERS] = {false, false};
 
 static OGLPoint3D	gSunCoord;
 
+		/* SUN OCCLUSION */
+		//
+		// Each pane draws a small probe where the sun is, once with the depth test
+		// and once without.  The probe sits just inside the cyclorama so that only
+		// terrain and objects can hide it.  The ratio of the two sample counts is how much of the sun
+		// is showing.  Results are read back a frame or two later so that we never
+		// wait on the GPU; until then the flare keeps the last known visibility.
+		//
+
+static GLuint		gSunQuery[MAX_SPLITSCREENS][2][2];				// [pane][buffer][depth tested, all]
+static Boolean		gSunQueryPending[MAX_SPLITSCREENS][2];
+static Byte			gSunQueryBuffer[MAX_SPLITSCREENS];
+static float		gSunVisibility[MAX_SPLITSCREENS] = {1, 1};
+
 Byte				gCameraMode[MAX_PLAYERS] = {CAMERA_MODE_NORMAL, CAMERA_MODE_NORMAL};
 
 static const float	gFlareOffsetTable[NUM_FLARES]=
@@ -119,6 +139,7 @@ float			dx,dy,length;
 OGLVector3D		axis,lookAtVector,sunVector;
 static OGLColorRGBA	transColor = {1,1,1,1};
 int				px,py,pw,ph;
+float			sunVisibility;
 
 	if (!gDrawLensFlare)
 		return;
@@ -187,10 +208,6 @@ int				px,py,pw,ph;
 	FastNormalizeVector(dx, dy, 0, &axis);
 
 
-			/***************/
-			/* DRAW FLARES */
-			/***************/
-
 			/* INIT MATRICES */
 
 	glMatrixMode(GL_MODELVIEW);
@@ -199,27 +216,45 @@ int				px,py,pw,ph;
 	glMatrixMode(GL_PROJECTION);
 	glLoadIdentity();
 
-	for (i = 0; i < NUM_FLARES; i++)
+
+			/* SEE HOW MUCH OF THE SUN IS SHOWING */
+
 	{
-		float	sx,sy,o,fx,fy;
+		OGLPoint3D	probeCoord;
+		float	sy = SUN_PROBE_SIZE * 2.0f;
+		float	sx = sy * ph / pw;
+		float	fx = sunScreenCoord.x / (pw/2) - 1.0f;					// (same math as flare #0 below)
+		float	fy = (ph - sunScreenCoord.y) / (ph/2) - 1.0f;
+
+		probeCoord.x = from.x + (gSunCoord.x - from.x) * SUN_PROBE_DIST;	// get the probe's depth
+		probeCoord.y = from.y + (gSunCoord.y - from.y) * SUN_PROBE_DIST;
+		probeCoord.z = from.z + (gSunCoord.z - from.z) * SUN_PROBE_DIST;
+		OGLPoint3D_Transform(&probeCoord, &gWorldToFrustumMatrix, &probeCoord);
+
+		sunVisibility = UpdateSunVisibility(fx, fy, probeCoord.z, sx, sy);
+	}
 
-		if (i == 0)
-			gGlobalTransparency = .99;		// sun is always full brightness (leave @ < 1 to ensure GL_BLEND)
-		else
-			gGlobalTransparency = transColor.a;
 
-		MO_DrawMaterial(gSpriteGroupList[SPRITE_GROUP_PARTICLES][gFlareImageTable[i]].materialObject);		// activate material
+			/***************/
+			/* DRAW FLARES */
+			/***************/
 
+	BeginSparkleBatch();
 
+	for (i = 0; i < NUM_FLARES; i++)
+	{
+		float		sx,sy,o,fx,fy,alpha;
+		OGLPoint3D	corners[4];
 
-		if (i == 1)												// always draw sun, but fade flares based on dot
+		if (i == 0)
+			alpha = .99f;										// sun is always full brightness (leave @ < 1 to ensure GL_BLEND)
+		else
 		{
-			if (transColor.a <= 0.0f)							// see if faded all out
+			alpha = transColor.a * sunVisibility;				// always draw sun, but fade flares based on dot & how much of the sun shows
+			if (alpha <= 0.0f)
 				break;
-			OGL_SetColor4fv(&transColor);
 		}
 
-
 		o = gFlareOffsetTable[i];
 
 		sy = gFlareScaleTable[i];
@@ -231,14 +266,16 @@ int				px,py,pw,ph;
 		fx = x / (pw/2) - 1.0f;
 		fy = (ph-y) / (ph/2) - 1.0f;
 
-		glBegin(GL_QUADS);
-		glTexCoord2f(0,0);	glVertex2f(fx - sx, fy - sy);
-		glTexCoord2f(1,0);	glVertex2f(fx + sx, fy - sy);
-		glTexCoord2f(1,1);	glVertex2f(fx + sx, fy + sy);
-		glTexCoord2f(0,1);	glVertex2f(fx - sx, fy + sy);
-		glEnd();
+		corners[0] = (OGLPoint3D) {fx - sx, fy - sy, 0};
+		corners[1] = (OGLPoint3D) {fx + sx, fy - sy, 0};
+		corners[2] = (OGLPoint3D) {fx + sx, fy + sy, 0};
+		corners[3] = (OGLPoint3D) {fx - sx, fy + sy, 0};
+
+		AddSparkleBatchQuad(gFlareImageTable[i], corners, alpha);
 	}
 
+	DrawSparkleBatch();
+
 			/* RESTORE MODES */
 
 bye:
@@ -248,6 +285,126 @@ bye:
 }
 
 
+/*********************** UPDATE SUN VISIBILITY ***************************/
+//
+// Picks up the sun probe results from an earlier frame, then issues this frame's probe
+// centered on fx,fy at depth fz (with half-size sx,sy, all in clip coords).  Must be called with
+// identity matrices and the scene's depth buffer still intact.
+//
+// Returns 0..1.  Without occlusion queries, the sun is always fully visible.
+//
+
+static float UpdateSunVisibility(float fx, float fy, float fz, float sx, float sy)
+{
+short		pane = gCurrentSplitScreenPane;
+Byte		buffer;
+GLuint		passed, total;
+GLboolean	alphaTest;
+
+	if (pane >= MAX_SPLITSCREENS)
+		return 1.0f;
+
+	if (gAnaglyphPass > 0)										// the 2nd eye uses what the 1st one found
+		return gSunVisibility[pane];
+
+
+			/* CREATE THE QUERIES THE FIRST TIME */
+
+	if (!gSunQuery[pane][0][0])
+	{
+		for (int b = 0; b < 2; b++)
+		{
+			gSunQuery[pane][b][0] = OGL_NewOcclusionQuery();
+			gSunQuery[pane][b][1] = OGL_NewOcclusionQuery();
+		}
+
+		if (!gSunQuery[pane][0][0])								// no driver support
+			return 1.0f;
+	}
+
+
+			/* READ BACK WHATEVER IS IN */
+
+	for (int b = 0; b < 2; b++)
+	{
+		if (gSunQueryPending[pane][b]
+			&& OGL_GetOcclusionQueryResult(gSunQuery[pane][b][0], &passed)
+			&& OGL_GetOcclusionQueryResult(gSunQuery[pane][b][1], &total))
+		{
+			gSunQueryPending[pane][b] = false;
+			if (total > 0)
+				gSunVisibility[pane] = SDL_min((float) passed / (float) total, 1.0f);
+		}
+	}
+
+
+			/* ISSUE THIS FRAME'S PROBE */
+			//
+			// If the sun is completely off the pane, there's nothing to test against,
+			// so we keep the last visibility.
+			//
+
+	if (fx + sx < -1.0f || fx - sx > 1.0f || fy + sy < -1.0f || fy - sy > 1.0f)
+		return gSunVisibility[pane];
+
+	buffer = gSunQueryBuffer[pane];
+	gSunQueryBuffer[pane] ^= 1;
+
+	alphaTest = glIsEnabled(GL_ALPHA_TEST);
+
+	OGL_PushState();
+	OGL_DisableTexture2D();
+	OGL_DisableBlend();
+	glDisable(GL_ALPHA_TEST);
+	glDepthMask(GL_FALSE);
+
+	for (int q = 0; q < 2; q++)
+	{
+		if (q == 0)
+			glEnable(GL_DEPTH_TEST);							// only the samples that terrain & objects don't cover pass
+		else
+			glDisable(GL_DEPTH_TEST);							// every sample on the pane
+
+		OGL_BeginOcclusionQuery(gSunQuery[pane][buffer][q]);
+		glBegin(GL_QUADS);
+		glVertex3f(fx - sx, fy - sy, fz);
+		glVertex3f(fx + sx, fy - sy, fz);
+		glVertex3f(fx + sx, fy + sy, fz);
+		glVertex3f(fx - sx, fy + sy, fz);
+		glEnd();
+		OGL_EndOcclusionQuery();
+	}
+
+	if (alphaTest)
+		glEnable(GL_ALPHA_TEST);
+	OGL_PopState();									// (also restores the depth test & mask)
+
+	gSunQueryPending[pane][buffer] = true;
+
+	return gSunVisibility[pane];
+}
+
+
+/*********************** DISPOSE SUN QUERIES ***************************/
+//
+// Called when a level is cleaned up, while the GL context is still around.
+// UpdateSunVisibility makes new ones the next time it's needed.
+//
+
+void DisposeSunQueries(void)
+{
+	for (int pane = 0; pane < MAX_SPLITSCREENS; pane++)
+	{
+		for (int b = 0; b < 2; b++)
+		{
+			OGL_DisposeOcclusionQuery(&gSunQuery[pane][b][0]);
+			OGL_DisposeOcclusionQuery(&gSunQuery[pane][b][1]);
+			gSunQueryPending[pane][b] = false;
+		}
+	}
+}
+
+
 //===============================================================================================================================================================
 
 #pragma mark -
@@ -266,6 +423,13 @@ ObjNode	*playerObj = gPlayerInfo[playerNum].objNode;
 
 	gCameraInDeathDiveMode[playerNum] = false;
 
+	if (playerNum < MAX_SPLITSCREENS)
+	{
+		gSunVisibility[playerNum] = 1.0f;							// don't use the last level's sun
+		gSunQueryPending[playerNum][0] = false;
+		gSunQueryPending[playerNum][1] = false;
+	}
+
 			/******************************/
 			/* SET CAMERA STARTING COORDS */
 			/******************************/
@@ -635,6 +799,60 @@ const OGLVector3D	forward = {0,0,-1};
 }
 
 
+#pragma mark -
+
+/********************** REMEMBER CAMERA PLACEMENTS ***************************/
+//
+// Called at the start of each fixed simulation tick so that the frame drawn
+// afterwards can be placed between this tick's cameras and the next.
+//
+
+void RememberCameraPlacements(void)
+{
+	for (int i = 0; i < gNumPlayers; i++)
+	{
+		gTickCameraPlacement[i] = gGameViewInfoPtr->cameraPlacement[i];
+	}
+}
+
+
+/********************** BEGIN CAMERA INTERPOLATION ***************************/
+//
+// Temporarily moves the cameras "frac" of the way from where they were at the start
+// of the last simulation tick to where they are now.  Undo with EndCameraInterpolation.
+//
+
+void BeginCameraInterpolation(float frac)
+{
+	for (int i = 0; i < gNumPlayers; i++)
+	{
+		OGLCameraPlacement	*cam = &gGameViewInfoPtr->cameraPlacement[i];
+		OGLCameraPlacement	*prev = &gTickCameraPlacement[i];
+
+		gInterpolationCameraBackup[i] = *cam;
+
+		cam->cameraLocation.x	= prev->cameraLocation.x + (cam->cameraLocation.x - prev->cameraLocation.x) * frac;
+		cam->cameraLocation.y	= prev->cameraLocation.y + (cam->cameraLocation.y - prev->cameraLocation.y) * frac;
+		cam->cameraLocation.z	= prev->cameraLocation.z + (cam->cameraLocation.z - prev->cameraLocation.z) * frac;
+
+		cam->pointOfInterest.x	= prev->pointOfInterest.x + (cam->pointOfInterest.x - prev->pointOfInterest.x) * frac;
+		cam->pointOfInterest.y	= prev->pointOfInterest.y + (cam->pointOfInterest.y - prev->pointOfInterest.y) * frac;
+		cam->pointOfInterest.z	= prev->pointOfInterest.z + (cam->pointOfInterest.z - prev->pointOfInterest.z) * frac;
+	}
+}
+
+
+/********************** END CAMERA INTERPOLATION ***************************/
+
+void EndCameraInterpolation(void)
+{
+	for (int i = 0; i < gNumPlayers; i++)
+	{
+		gGameViewInfoPtr->cameraPlacement[i] = gInterpolationCameraBackup[i];
+	}
+}
+
+
 #pragma mark -
 
 /********************** PREP ANAGLYPH CAMERAS ***************************/
@@ -0,0 +1,270 @@
+/****************************/
+/*   	ETC1.C				*/
+/****************************/
+
+//
+// A small ETC1 encoder, so that GLES drivers -- which can't compress a texture
+// on upload the way desktop GL does with S3TC -- still get a compressed tier.
+// ETC1 has no alpha, so it's only used for opaque textures.
+//
+// Each 4x4 block is tried split both ways (two 2x4 or two 4x2 halves), with each half's
+// color stored either as two RGB444 colors or as RGB555 + a 3-bit delta, and keeps
+// whichever fits best.  Every half picks its own modifier table by brute force.
+// That's well short of what an offline encoder does, but it's fast enough to run at load.
+//
+
+/****************************/
+/*    EXTERNALS             */
+/****************************/
+
+#include "game.h"
+
+
+/****************************/
+/*    PROTOTYPES            */
+/****************************/
+
+static uint64_t EncodeETC1Block(const uint8_t block[16][4]);
+static uint32_t FitETC1Half(const uint8_t block[16][4], const int pixels[8], const int base[3], int *outTable, uint32_t *outIndices);
+
+
+/****************************/
+/*    CONSTANTS             */
+/****************************/
+
+static const int kETC1Modifiers[8][2] =
+{
+	{  2,   8},
+	{  5,  17},
+	{  9,  29},
+	{ 13,  42},
+	{ 18,  60},
+	{ 24,  80},
+	{ 33, 106},
+	{ 47, 183},
+};
+
+static const int kETC1ModifierSigns[4][2] =		// pixel index -> which modifier & its sign
+{
+	{0, +1},
+	{1, +1},
+	{0, -1},
+	{1, -1},
+};
+
+
+/******************** ETC1 GET IMAGE SIZE ************************/
+
+long ETC1_GetImageSize(int width, int height)
+{
+	return (long) ((width + 3) / 4) * ((height + 3) / 4) * 8;
+}
+
+
+/******************** ETC1 ENCODE IMAGE ************************/
+//
+// rgba is width x height x 4 bytes; alpha is ignored.
+// out must hold ETC1_GetImageSize(width, height) bytes.
+//
+
+void ETC1_EncodeImage(const uint8_t *rgba, int width, int height, uint8_t *out)
+{
+uint8_t		block[16][4];
+
+	for (int by = 0; by < height; by += 4)
+	{
+		for (int bx = 0; bx < width; bx += 4)
+		{
+				/* GATHER THE BLOCK, COLUMN BY COLUMN LIKE ETC1 NUMBERS ITS PIXELS */
+				//
+				// Edge blocks repeat the last row/column.
+				//
+
+			for (int x = 0; x < 4; x++)
+			{
+				for (int y = 0; y < 4; y++)
+				{
+					int sx = SDL_min(bx + x, width - 1);
+					int sy = SDL_min(by + y, height - 1);
+
+					SDL_memcpy(block[x*4 + y], rgba + ((long) sy * width + sx) * 4, 4);
+				}
+			}
+
+			uint64_t bits = EncodeETC1Block(block);
+
+			for (int i = 0; i < 8; i++)						// stored big-endian
+				*out++ = (uint8_t) (bits >> (56 - i*8));
+		}
+	}
+}
+
+
+/******************** ENCODE ETC1 BLOCK ************************/
+
+static uint64_t EncodeETC1Block(const uint8_t block[16][4])
+{
+uint64_t	bestBits = 0;
+uint32_t	bestError = 0xffffffff;
+
+	for (int flip = 0; flip < 2; flip++)
+	{
+		int		halves[2][8];
+		int		avg[2][3];
+
+				/* WHICH PIXELS ARE IN EACH HALF */
+
+		for (int x = 0, n0 = 0, n1 = 0; x < 4; x++)
+		{
+			for (int y = 0; y < 4; y++)
+			{
+				Boolean second = flip ? (y >= 2) : (x >= 2);
+				if (second)
+					halves[1][n1++] = x*4 + y;
+				else
+					halves[0][n0++] = x*4 + y;
+			}
+		}
+
+		for (int h = 0; h < 2; h++)
+		{
+			for (int c = 0; c < 3; c++)
+			{
+				int sum = 0;
+				for (int i = 0; i < 8; i++)
+					sum += block[halves[h][i]][c];
+				avg[h][c] = sum;								// x8
+			}
+		}
+
+
+				/* TRY BOTH COLOR MODES */
+
+		for (int diff = 0; diff < 2; diff++)
+		{
+			int			q[2][3];
+			int			base[2][3];
+			int			table[2];
+			uint32_t	indices[2];
+			uint32_t	error = 0;
+			uint64_t	bits;
+
+			for (int h = 0; h < 2; h++)
+			{
+				for (int c = 0; c < 3; c++)
+				{
+					if (diff)
+					{
+						q[h][c] = (avg[h][c] * 31 + 255*4) / (255*8);		// round to 5 bits
+						base[h][c] = (q[h][c] << 3) | (q[h][c] >> 2);
+					}
+					else
+					{
+						q[h][c] = (avg[h][c] * 15 + 255*4) / (255*8);		// round to 4 bits
+						base[h][c] = (q[h][c] << 4) | q[h][c];
+					}
+				}
+			}
+
+			if (diff)
+			{
+				Boolean fits = true;
+				for (int c = 0; c < 3; c++)
+				{
+					int d = q[1][c] - q[0][c];
+					if (d < -4 || d > 3)
+						fits = false;
+				}
+				if (!fits)
+					continue;
+			}
+
+			for (int h = 0; h < 2; h++)
+				error += FitETC1Half(block, halves[h], base[h], &table[h], &indices[h]);
+
+			if (error >= bestError)
+				continue;
+
+
+				/* PACK IT */
+
+			if (diff)
+			{
+				bits =	((uint64_t) q[0][0] << 59) | ((uint64_t) ((q[1][0] - q[0][0]) & 7) << 56)
+					|	((uint64_t) q[0][1] << 51) | ((uint64_t) ((q[1][1] - q[0][1]) & 7) << 48)
+					|	((uint64_t) q[0][2] << 43) | ((uint64_t) ((q[1][2] - q[0][2]) & 7) << 40);
+			}
+			else
+			{
+				bits =	((uint64_t) q[0][0] << 60) | ((uint64_t) q[1][0] << 56)
+					|	((uint64_t) q[0][1] << 52) | ((uint64_t) q[1][1] << 48)
+					|	((uint64_t) q[0][2] << 44) | ((uint64_t) q[1][2] << 40);
+			}
+
+			bits |= ((uint64_t) table[0] << 37) | ((uint64_t) table[1] << 34);
+			bits |= ((uint64_t) diff << 33) | ((uint64_t) flip << 32);
+			bits |= indices[0] | indices[1];
+
+			bestBits = bits;
+			bestError = error;
+		}
+	}
+
+	return bestBits;
+}
+
+
+/******************** FIT ETC1 HALF ************************/
+//
+// Picks the modifier table & per-pixel modifiers for one half of a block.
+// Returns the squared error; *outIndices has the half's bits of the block's low word.
+//
+
+static uint32_t FitETC1Half(const uint8_t block[16][4], const int pixels[8], const int base[3], int *outTable, uint32_t *outIndices)
+{
+uint32_t	bestError = 0xffffffff;
+
+	for (int t = 0; t < 8; t++)
+	{
+		uint32_t	error = 0;
+		uint32_t	indices = 0;
+
+		for (int i = 0; i < 8; i++)
+		{
+			const uint8_t	*pixel = block[pixels[i]];
+			uint32_t		bestPixelError = 0xffffffff;
+			int				bestIndex = 0;
+
+			for (int m = 0; m < 4; m++)
+			{
+				int			mod = kETC1Modifiers[t][kETC1ModifierSigns[m][0]] * kETC1ModifierSigns[m][1];
+				uint32_t	e = 0;
+
+				for (int c = 0; c < 3; c++)
+				{
+					int d = SDL_clamp(base[c] + mod, 0, 255) - pixel[c];
+					e += d * d;
+				}
+
+				if (e < bestPixelError)
+				{
+					bestPixelError = e;
+					bestIndex = m;
+				}
+			}
+
+			error += bestPixelError;
+			indices |= ((uint32_t) (bestIndex >> 1) << (16 + pixels[i]))		// msb
+					|  ((uint32_t) (bestIndex & 1) << pixels[i]);				// lsb
+		}
+
+		if (error < bestError)
+		{
+			bestError = error;
+			*outTable = t;
+			*outIndices = indices;
+		}
+	}
+
+	return bestError;
+}
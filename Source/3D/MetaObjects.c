@@ -31,14 +31,63 @@ static void MO_DeleteObjectInfo_Picture(MOPictureObject *obj);
 static void SetMetaObjectToSprite(MOSpriteObject *spriteObj, MOSpriteSetupData *inData);
 static void MO_DisposeObject_Sprite(MOSpriteObject *obj);
 static void MO_CalcBoundingSphere_Recurse(MetaObjectPtr object, float *bSphere);
+static int GetMetaObjectPool(uint32_t type, intptr_t subType);
+static void *MO_PoolAlloc(int poolNum);
+static void MO_PoolFree(int poolNum, void *obj);
 
 
 /****************************/
 /*    CONSTANTS             */
 /****************************/
 
+		/* META OBJECT POOLS */
+		//
+		// Every MetaObject type gets a free list of fixed-size headers, so that
+		// spawning & deleting display-group objects doesn't hit the heap.
+		// Slabs are never given back; the pools only grow to the peak object count.
+		//
+
+enum
+{
+	MO_POOL_GROUP,
+	MO_POOL_VERTEXARRAY,
+	MO_POOL_MATERIAL,
+	MO_POOL_MATRIX,
+	MO_POOL_PICTURE,
+	MO_POOL_SPRITE,
+	NUM_MO_POOLS
+};
+
+#define	MO_POOL_OBJECTS_PER_SLAB	64
+
+typedef struct MOPoolFreeNode
+{
+	struct MOPoolFreeNode	*next;
+}MOPoolFreeNode;
+
+typedef struct
+{
+	long				objectSize;
+	MOPoolFreeNode		*freeList;
+	int					numLive;
+	int					numAllocated;			// live + on the free list
+}MOPoolType;
 
 
+		/* VERTEX ARRAY PAYLOAD SIZE CLASSES */
+		//
+		// Non-VAR vertex arrays (points, uvs, triangles...) and per-object world-space
+		// copies come from power-of-2 size classes, 64 bytes to 64K.  Bigger arrays
+		// go straight to AllocPtr.  Each block keeps a 16-byte header like AllocPtr's
+		// so MO_FreeVertexArrayPtr can tell them apart.
+		//
+
+#define	MO_VA_MIN_CLASS_SHIFT		6
+#define	MO_VA_NUM_CLASSES			11			// 64 .. 65536
+#define	MO_VA_HEADER_SIZE			16
+#define	MO_VA_SLAB_SIZE				(128*1024)
+#define	MO_VA_COOKIE				'MOVA'
+
 
 
 /*********************/
@@ -55,6 +104,18 @@ uint32_t				gGlobalMaterialFlags = 0;
 
 MOMaterialObject	*gMostRecentMaterial;
 
+static MOPoolType	gMOPools[NUM_MO_POOLS] =
+{
+	[MO_POOL_GROUP]			= { .objectSize = sizeof(MOGroupObject) },
+	[MO_POOL_VERTEXARRAY]	= { .objectSize = sizeof(MOVertexArrayObject) },
+	[MO_POOL_MATERIAL]		= { .objectSize = sizeof(MOMaterialObject) },
+	[MO_POOL_MATRIX]		= { .objectSize = sizeof(MOMatrixObject) },
+	[MO_POOL_PICTURE]		= { .objectSize = sizeof(MOPictureObject) },
+	[MO_POOL_SPRITE]		= { .objectSize = sizeof(MOSpriteObject) },
+};
+
+static MOPoolFreeNode	*gVertexArrayFreeLists[MO_VA_NUM_CLASSES];
+
 
 /***************** INIT META OBJECT HANDLER ******************/
 
@@ -134,56 +195,17 @@ MetaObjectPtr	mo;
 static MetaObjectPtr AllocateEmptyMetaObject(uint32_t type, intptr_t subType)
 {
 MetaObjectHeader	*mo;
-int					size;
-
-			/* DETERMINE SIZE OF DATA TO ALLOC */
-
-	switch(type)
-	{
-		case	MO_TYPE_GROUP:
-				size = sizeof(MOGroupObject);
-				break;
-
-		case	MO_TYPE_GEOMETRY:
-				switch(subType)
-				{
-					case	MO_GEOMETRY_SUBTYPE_VERTEXARRAY:
-							size = sizeof(MOVertexArrayObject);
-							break;
-
-					default:
-							DoFatalAlert("AllocateEmptyMetaObject: object subtype not recognized");
-							return(nil);
-				}
-				break;
-
-		case	MO_TYPE_MATERIAL:
-				size = sizeof(MOMaterialObject);
-				break;
-
-		case	MO_TYPE_MATRIX:
-				size = sizeof(MOMatrixObject);
-				break;
-
-		case	MO_TYPE_PICTURE:
-				size = sizeof(MOPictureObject);
-				break;
+int					poolNum;
 
-		case	MO_TYPE_SPRITE:
-				size = sizeof(MOSpriteObject);
-				break;
+			/* DETERMINE WHICH POOL TO GET IT FROM */
 
-		default:
-				DoFatalAlert("AllocateEmptyMetaObject: object type not recognized");
-				return(nil);
-	}
+	poolNum = GetMetaObjectPool(type, subType);
 
 
 			/* ALLOC MEMORY FOR META OBJECT */
 
-	mo = AllocPtrClear(size);
-	if (mo == nil)
-		DoFatalAlert("AllocateEmptyMetaObject: AllocPtr failed!");
+	mo = MO_PoolAlloc(poolNum);
+	SDL_memset(mo, 0, gMOPools[poolNum].objectSize);
 
 
 			/* INIT STRUCTURE */
@@ -591,8 +613,10 @@ Boolean		needNormals;
 			/* SETUP VERTEX ARRAY */
 			/**********************/
 
+	OGL_BeginVertexArrayBuffer(data->VARtype);			// if it lives in VAR memory, draw from the VAR's buffer object
+
 	glEnableClientState(GL_VERTEX_ARRAY);				// enable vertex arrays
-	glVertexPointer(3, GL_FLOAT, 0, data->points);		// point to points array
+	glVertexPointer(3, GL_FLOAT, 0, OGL_VertexArrayOffset(data->points));		// point to points array
 
 
 
@@ -602,7 +626,7 @@ Boolean		needNormals;
 
 	if (data->colorsFloat)									// do we have float colors?
 	{
-		glColorPointer(4, GL_FLOAT, 0, data->colorsFloat);
+		glColorPointer(4, GL_FLOAT, 0, OGL_VertexArrayOffset(data->colorsFloat));
 		glEnableClientState(GL_COLOR_ARRAY);				// enable color arrays
 	}
 	else
@@ -645,7 +669,7 @@ Boolean		needNormals;
 				OGL_ActiveTextureUnit(GL_TEXTURE0+i);								// activate texture layer #i
 				OGL_EnableTexture2D();
 
-				glTexCoordPointer(2, GL_FLOAT, 0,data->uvs[i]);						// enable uv arrays
+				glTexCoordPointer(2, GL_FLOAT, 0, OGL_VertexArrayOffset(data->uvs[i]));	// enable uv arrays
 				glEnableClientState(GL_TEXTURE_COORD_ARRAY);
 
 
@@ -734,7 +758,7 @@ use_current:
 
 									if (i == 0)
 									{
-										glTexCoordPointer(2, GL_FLOAT, 0,data->uvs[0]);					// enable uv arrays
+										glTexCoordPointer(2, GL_FLOAT, 0, OGL_VertexArrayOffset(data->uvs[0]));	// enable uv arrays
 										glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
 										glEnableClientState(GL_TEXTURE_COORD_ARRAY);
 									}
@@ -778,7 +802,7 @@ use_current:
 							/* JUST 1 TEXTURE LAYER */
 				else
 				{
-					glTexCoordPointer(2, GL_FLOAT, 0,data->uvs[0]);
+					glTexCoordPointer(2, GL_FLOAT, 0, OGL_VertexArrayOffset(data->uvs[0]));
 					glEnableClientState(GL_TEXTURE_COORD_ARRAY);	// enable uv arrays
 				}
 
@@ -824,7 +848,7 @@ go_here:
 
 	if (needNormals)
 	{
-		glNormalPointer(GL_FLOAT, 0, data->normals);
+		glNormalPointer(GL_FLOAT, 0, OGL_VertexArrayOffset(data->normals));
 		glEnableClientState(GL_NORMAL_ARRAY);			// enable normal arrays
 
 #if 0
@@ -864,10 +888,12 @@ go_here:
 	if (data->numTriangles)
 	{
 		GAME_ASSERT(data->triangles);
-		glDrawElements(GL_TRIANGLES,data->numTriangles*3,GL_UNSIGNED_INT,&data->triangles[0]);
+		glDrawElements(GL_TRIANGLES,data->numTriangles*3,GL_UNSIGNED_INT, OGL_ElementArrayOffset(&data->triangles[0]));
 		OGL_CheckError();
 	}
 
+	OGL_EndVertexArrayBuffer();								// leave client-side arrays usable for everyone else
+
 	gPolysThisFrame += data->numTriangles;					// inc poly counter
 
 
@@ -1251,7 +1277,7 @@ MOVertexArrayObject	*vObj;
 		MO_DetachFromLinkedList(obj);					// detach from linked list
 
 		header->cookie = 0xdeadbeef;					// devalidate cookie
-		SafeDisposePtr(obj);								// free memory used by object
+		MO_PoolFree(GetMetaObjectPool(header->type, header->subType), obj);	// give it back to its pool
 		return;
 	}
 }
@@ -1378,7 +1404,7 @@ Boolean	usingVAR = (varType != -1);					// were these arrays stored in VAR memor
 		if (usingVAR)
 			OGL_FreeVertexArrayMemory(data->points, varType);
 		else
-			SafeDisposePtr(data->points);
+			MO_FreeVertexArrayPtr(data->points);
 		data->points = nil;
 	}
 
@@ -1387,7 +1413,7 @@ Boolean	usingVAR = (varType != -1);					// were these arrays stored in VAR memor
 		if (usingVAR)
 			OGL_FreeVertexArrayMemory(data->normals, varType);
 		else
-			SafeDisposePtr(data->normals);
+			MO_FreeVertexArrayPtr(data->normals);
 		data->normals = nil;
 	}
 
@@ -1396,7 +1422,7 @@ Boolean	usingVAR = (varType != -1);					// were these arrays stored in VAR memor
 		if (usingVAR)
 			OGL_FreeVertexArrayMemory(data->uvs[0], varType);
 		else
-			SafeDisposePtr(data->uvs[0]);
+			MO_FreeVertexArrayPtr(data->uvs[0]);
 		data->uvs[0] = nil;
 
 		if (data->numMaterials == 2)					// see if also nuke secondary uv list
@@ -1406,7 +1432,7 @@ Boolean	usingVAR = (varType != -1);					// were these arrays stored in VAR memor
 				if (usingVAR)
 					OGL_FreeVertexArrayMemory(data->uvs[1], varType);
 				else
-					SafeDisposePtr(data->uvs[1]);
+					MO_FreeVertexArrayPtr(data->uvs[1]);
 
 				data->uvs[1] = nil;
 			}
@@ -1418,7 +1444,7 @@ Boolean	usingVAR = (varType != -1);					// were these arrays stored in VAR memor
 		if (usingVAR)
 			OGL_FreeVertexArrayMemory(data->colorsFloat, varType);
 		else
-			SafeDisposePtr(data->colorsFloat);
+			MO_FreeVertexArrayPtr(data->colorsFloat);
 		data->colorsFloat = nil;
 	}
 
@@ -1427,7 +1453,7 @@ Boolean	usingVAR = (varType != -1);					// were these arrays stored in VAR memor
 		if (usingVAR)
 			OGL_FreeVertexArrayMemory(data->triangles, varType);
 		else
-			SafeDisposePtr(data->triangles);
+			MO_FreeVertexArrayPtr(data->triangles);
 		data->triangles = nil;
 	}
 }
@@ -1443,7 +1469,7 @@ MOMaterialData		*data = &obj->objectData;
 		/* DISPOSE OF TEXTURE NAMES */
 
 	if (data->numMipmaps > 0)
-		glDeleteTextures(data->numMipmaps, &data->textureName[0]);
+		OGL_TextureMap_Dispose(data->numMipmaps, &data->textureName[0]);
 }
 
 
@@ -1460,6 +1486,170 @@ MOPictureData		*data = &obj->objectData;
 }
 
 
+#pragma mark -
+
+/******************** GET META OBJECT POOL *********************/
+
+static int GetMetaObjectPool(uint32_t type, intptr_t subType)
+{
+	switch(type)
+	{
+		case	MO_TYPE_GROUP:
+				return(MO_POOL_GROUP);
+
+		case	MO_TYPE_GEOMETRY:
+				switch(subType)
+				{
+					case	MO_GEOMETRY_SUBTYPE_VERTEXARRAY:
+							return(MO_POOL_VERTEXARRAY);
+
+					default:
+							DoFatalAlert("GetMetaObjectPool: object subtype not recognized");
+				}
+
+		case	MO_TYPE_MATERIAL:
+				return(MO_POOL_MATERIAL);
+
+		case	MO_TYPE_MATRIX:
+				return(MO_POOL_MATRIX);
+
+		case	MO_TYPE_PICTURE:
+				return(MO_POOL_PICTURE);
+
+		case	MO_TYPE_SPRITE:
+				return(MO_POOL_SPRITE);
+
+		default:
+				DoFatalAlert("GetMetaObjectPool: object type not recognized");
+	}
+}
+
+
+/******************** MO POOL ALLOC *********************/
+//
+// Pops a header off the pool's free list, carving a new slab if it's empty.
+//
+
+static void *MO_PoolAlloc(int poolNum)
+{
+MOPoolType	*pool = &gMOPools[poolNum];
+
+	if (pool->freeList == nil)
+	{
+		long	objectSize = (pool->objectSize + 15) & ~15L;				// keep every header 16-byte aligned
+		int		prevTag = SetMemoryTag(MEMORY_TAG_POOLS);
+		Ptr		slab = AllocPtr(objectSize * MO_POOL_OBJECTS_PER_SLAB);
+		SetMemoryTag(prevTag);
+
+		for (int i = MO_POOL_OBJECTS_PER_SLAB-1; i >= 0; i--)				// push them backwards so they get handed out in address order
+		{
+			MOPoolFreeNode *node = (MOPoolFreeNode *) (slab + i * objectSize);
+			node->next = pool->freeList;
+			pool->freeList = node;
+		}
+
+		pool->numAllocated += MO_POOL_OBJECTS_PER_SLAB;
+	}
+
+	MOPoolFreeNode *node = pool->freeList;
+	pool->freeList = node->next;
+	pool->numLive++;
+
+	return(node);
+}
+
+
+/******************** MO POOL FREE *********************/
+
+static void MO_PoolFree(int poolNum, void *obj)
+{
+MOPoolType		*pool = &gMOPools[poolNum];
+MOPoolFreeNode	*node = obj;
+
+	GAME_ASSERT(pool->numLive > 0);
+
+	node->next = pool->freeList;
+	pool->freeList = node;
+	pool->numLive--;
+}
+
+
+/******************** MO ALLOC VERTEX ARRAY PTR *********************/
+//
+// Use instead of AllocPtr for vertex array payloads that aren't in VAR memory.
+// Free with MO_FreeVertexArrayPtr (which also accepts plain AllocPtr blocks).
+//
+
+void *MO_AllocVertexArrayPtr(long size)
+{
+int		sizeClass = 0;
+
+	GAME_ASSERT(size >= 0);
+
+	while (sizeClass < MO_VA_NUM_CLASSES && (1L << (sizeClass + MO_VA_MIN_CLASS_SHIFT)) < size)
+		sizeClass++;
+
+	if (sizeClass == MO_VA_NUM_CLASSES)									// too big for the pools
+		return AllocPtr(size);
+
+
+			/* CARVE A NEW SLAB IF THIS CLASS HAS NOTHING FREE */
+
+	if (gVertexArrayFreeLists[sizeClass] == nil)
+	{
+		long	blockSize = MO_VA_HEADER_SIZE + (1L << (sizeClass + MO_VA_MIN_CLASS_SHIFT));
+		int		numBlocks = SDL_max(4, MO_VA_SLAB_SIZE / blockSize);
+		int		prevTag = SetMemoryTag(MEMORY_TAG_POOLS);
+		Ptr		slab = AllocPtr(blockSize * numBlocks);
+		SetMemoryTag(prevTag);
+
+		for (int i = numBlocks-1; i >= 0; i--)
+		{
+			MOPoolFreeNode *node = (MOPoolFreeNode *) (slab + i * blockSize);
+			node->next = gVertexArrayFreeLists[sizeClass];
+			gVertexArrayFreeLists[sizeClass] = node;
+		}
+	}
+
+
+			/* POP A BLOCK */
+
+	uint32_t *header = (uint32_t *) gVertexArrayFreeLists[sizeClass];
+	gVertexArrayFreeLists[sizeClass] = gVertexArrayFreeLists[sizeClass]->next;
+
+	header[0] = MO_VA_COOKIE;
+	header[1] = sizeClass;
+
+	return ((Ptr) header) + MO_VA_HEADER_SIZE;
+}
+
+
+/******************** MO FREE VERTEX ARRAY PTR *********************/
+
+void MO_FreeVertexArrayPtr(void *ptr)
+{
+	if (ptr == nil)
+		return;
+
+	uint32_t *header = (uint32_t *) (((Ptr) ptr) - MO_VA_HEADER_SIZE);
+
+	if (header[0] != MO_VA_COOKIE)										// it's a regular AllocPtr block
+	{
+		SafeDisposePtr(ptr);
+		return;
+	}
+
+	uint32_t sizeClass = header[1];
+	GAME_ASSERT(sizeClass < MO_VA_NUM_CLASSES);
+
+	header[0] = 'DEAD';
+
+	MOPoolFreeNode *node = (MOPoolFreeNode *) header;
+	node->next = gVertexArrayFreeLists[sizeClass];
+	gVertexArrayFreeLists[sizeClass] = node;
+}
+
+
 #pragma mark -
 
 /******************** MO_DUPLICATE VERTEX ARRAY DATA *********************/
@@ -1502,7 +1692,7 @@ Boolean		usingVAR = (varType != -1);
 		if (usingVAR)
 			outData->points = OGL_AllocVertexArrayMemory(s, varType);
 		else
-			outData->points = AllocPtr(s);
+			outData->points = MO_AllocVertexArrayPtr(s);
 
 		BlockMove(inData->points, outData->points, s);
 	}
@@ -1519,7 +1709,7 @@ Boolean		usingVAR = (varType != -1);
 		if (usingVAR)
 			outData->normals = OGL_AllocVertexArrayMemory(s, varType);
 		else
-			outData->normals = AllocPtr(s);
+			outData->normals = MO_AllocVertexArrayPtr(s);
 
 		BlockMove(inData->normals, outData->normals, s);
 	}
@@ -1536,7 +1726,7 @@ Boolean		usingVAR = (varType != -1);
 		if (usingVAR)
 			outData->uvs[0] = OGL_AllocVertexArrayMemory(s, varType);
 		else
-			outData->uvs[0] = AllocPtr(s);
+			outData->uvs[0] = MO_AllocVertexArrayPtr(s);
 
 		BlockMove(inData->uvs[0], outData->uvs[0], s);
 	}
@@ -1554,7 +1744,7 @@ Boolean		usingVAR = (varType != -1);
 		if (usingVAR)
 			outData->colorsFloat = OGL_AllocVertexArrayMemory(s, varType);
 		else
-			outData->colorsFloat = AllocPtr(s);
+			outData->colorsFloat = MO_AllocVertexArrayPtr(s);
 
 		BlockMove(inData->colorsFloat, outData->colorsFloat, s);
 	}
@@ -1572,7 +1762,7 @@ Boolean		usingVAR = (varType != -1);
 		if (usingVAR)
 			outData->triangles = OGL_AllocVertexArrayMemory(s, varType);
 		else
-			outData->triangles = AllocPtr(s);
+			outData->triangles = MO_AllocVertexArrayPtr(s);
 
 		BlockMove(inData->triangles, outData->triangles, s);
 	}
@@ -1896,6 +2086,6 @@ MOVertexArrayObject	*vObj;
 
 			/* THIS UPDATE WILL CAUSE US TO UPDATE THE VAR IF IT'S USED */
 
-	OGL_SetVertexArrayRangeDirty(data->VARtype);
+	OGL_SetVertexArrayMemoryDirty(data->uvs[0], numPoints * sizeof(OGLTextureCoord), data->VARtype);
 }
 
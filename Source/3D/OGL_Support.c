@@ -40,8 +40,24 @@ static void OGL_InitVertexArrayMemory(void);
 static void OGL_UpdateVertexArrayRange(void);
 static void OGL_DisableVertexArrayRanges(void);
 static long OGL_MaxMemForVARType(Byte varType);
+static void OGL_FlushVertexBuffer(Byte type);
 static void	ConvertTextureToGrey(void *imageMemory, short width, short height, GLint srcFormat, GLint dataType);
 static void	ConvertTextureToColorAnaglyph(void *imageMemory, short width, short height, GLint srcFormat, GLint dataType);
+static int OGL_GetTextureGroup(void);
+static long OGL_TextureMap_LoadCompressed(void *imageMemory, int width, int height, GLint srcFormat, GLint dataType, Boolean mipmaps, int cacheIndex);
+static Boolean IsUsableCompressedFormat(uint32_t internalFormat);
+static long OGL_UploadCompressedMipChain(const void *chain, long chainSize);
+#ifndef __EMSCRIPTEN__
+static long OGL_EncodeS3TCMipChain(void *imageMemory, int width, int height, GLint srcFormat, GLint dataType,
+								int bytesPerPixel, Ptr *outChain, long *outChainSize);
+#endif
+static Ptr OGL_EncodeETC1MipChain(void *imageMemory, int width, int height, GLint srcFormat, GLint dataType,
+								Boolean mipmaps, long *outChainSize);
+static void OGL_RecordTextureBytes(GLuint textureName, long bytes, long plainBytes);
+static void OGL_InitAnaglyphShader(void);
+static void OGL_DisposeAnaglyphShader(void);
+static void OGL_CaptureAnaglyphEye(int eye);
+static void OGL_DrawAnaglyphComposite(void);
 
 static void DrawBlueLine(GLint window_width, GLint window_height);
 static void ClearAllBuffersToBlack(void);
@@ -53,6 +69,9 @@ static void ClearAllBuffersToBlack(void);
 #define	STATE_STACK_SIZE	20
 
 
+#define	MAX_VERTEX_BUFFER_DIRTY_RANGES	64
+#define	VERTEX_BUFFER_GROW_SIZE			(256 * 1024)
+
 struct VertexArrayMemoryNode
 {
 	struct	VertexArrayMemoryNode	*prevNode;
@@ -81,6 +100,110 @@ Byte					gAnaglyphGreyTable[255];
 SDL_GLContext			gAGLContext = nil;
 
 
+		/* TEXTURE COMPRESSION */
+
+#ifndef __EMSCRIPTEN__
+static	PFNGLCOMPRESSEDTEXIMAGE2DPROC	gGlCompressedTexImage2DProc = nil;
+static	PFNGLGETCOMPRESSEDTEXIMAGEPROC	gGlGetCompressedTexImageProc = nil;
+#endif
+static	Boolean			gCanCompressTextures = false;		// GL_EXT_texture_compression_s3tc
+static	Boolean			gCanUseETC1Textures = false;		// GL_OES_compressed_ETC1_RGB8_texture (we encode these ourselves)
+
+#ifdef __EMSCRIPTEN__
+#define	CompressedTexImage2D	glCompressedTexImage2D
+#else
+#define	CompressedTexImage2D	gGlCompressedTexImage2DProc
+#endif
+
+#ifndef GL_ETC1_RGB8_OES
+#define	GL_ETC1_RGB8_OES		0x8D64
+#endif
+
+#define	TEXTURE_CACHE_MAGIC		'TXC4'
+#define	TEXTURE_CACHE_FOLDER	"TextureCache"
+
+typedef struct
+{
+	uint32_t	magic;
+	uint32_t	internalFormat;
+	uint64_t	sourceKey;							// the loader's key for the file the texture came from, so edited files don't use stale caches
+	int32_t		width;
+	int32_t		height;
+	int32_t		numLevels;							// followed by numLevels x (int32_t size, then the level's bytes padded to 4)
+	int32_t		pad;
+}TextureCacheHeader;
+
+		//
+		// Compressed textures are only cached for textures loaded from a file the loader told us about
+		// (see OGL_SetTextureCacheSource).  Each one is named after the file and its order in it,
+		// so there's one cache file per texture and a changed texture overwrites its old one.
+		// It's only used if the file's key (which the loader already had to work out) still matches.
+		//
+
+static	char			gTextureCacheSource[64] = "";
+static	uint64_t		gTextureCacheSourceKey = 0;
+static	int				gTextureCacheSourceIndex = 0;
+static	Boolean			gTextureCacheFolderMade = false;
+
+
+		/* TEXTURE & FRAME STATS */
+		//
+		// VRAM use is estimated from what we uploaded.  "Plain" is what the same textures
+		// would take as RGBA8 without mipmaps, i.e. what they cost before the quality prefs.
+		//
+
+static	uint32_t		*gTextureBytes = nil;				// indexed by texture name
+static	uint32_t		*gTexturePlainBytes = nil;
+static	GLuint			gTextureBytesTableSize = 0;
+static	int				gNumTexturesLoaded = 0;
+static	long			gTextureVRAM = 0;
+static	long			gTexturePlainVRAM = 0;
+static	long			gPeakTextureVRAM = 0;
+static	long			gPeakTexturePlainVRAM = 0;
+static	int				gRenderStatsFrames = 0;
+static	Uint64			gRenderStatsFrameTicks = 0;			// between successive OGL_DrawScene calls
+static	Uint64			gRenderStatsDrawTicks = 0;			// inside OGL_DrawScene, not counting the swap
+static	Uint64			gRenderStatsPrevFrameTick = 0;
+static	Uint64			gRenderStatsVertexBytes = 0;		// uploaded to vertex buffers
+
+
+		/* ANAGLYPH COMPOSITE */
+		//
+		// If the driver can run GLSL, each eye is rendered in full color and the two are
+		// mixed by a shader at the end of the frame.  Otherwise gAnaglyphProgram stays 0
+		// and we fall back to converting the textures as they're loaded.
+		//
+
+#ifndef __EMSCRIPTEN__
+static struct
+{
+	PFNGLCREATESHADERPROC		CreateShader;
+	PFNGLSHADERSOURCEPROC		ShaderSource;
+	PFNGLCOMPILESHADERPROC		CompileShader;
+	PFNGLGETSHADERIVPROC		GetShaderiv;
+	PFNGLDELETESHADERPROC		DeleteShader;
+	PFNGLCREATEPROGRAMPROC		CreateProgram;
+	PFNGLATTACHSHADERPROC		AttachShader;
+	PFNGLLINKPROGRAMPROC		LinkProgram;
+	PFNGLGETPROGRAMIVPROC		GetProgramiv;
+	PFNGLDELETEPROGRAMPROC		DeleteProgram;
+	PFNGLUSEPROGRAMPROC			UseProgram;
+	PFNGLGETUNIFORMLOCATIONPROC	GetUniformLocation;
+	PFNGLUNIFORM1IPROC			Uniform1i;
+	PFNGLUNIFORM1FPROC			Uniform1f;
+	PFNGLUNIFORM3FPROC			Uniform3f;
+}gAnaglyphGL;
+#endif
+
+static	GLuint			gAnaglyphProgram = 0;
+static	GLint			gAnaglyphUniform_Calibration;
+static	GLint			gAnaglyphUniform_ChannelBalancing;
+static	GLint			gAnaglyphUniform_Mono;
+static	GLuint			gAnaglyphEyeTexture[2] = {0,0};
+static	int				gAnaglyphEyeTextureWidth = 0;
+static	int				gAnaglyphEyeTextureHeight = 0;
+
+
 OGLMatrix4x4	gViewToFrustumMatrix,gWorldToViewMatrix,gWorldToFrustumMatrix, gLocalToViewMatrix, gLocalToFrustumMatrix;
 OGLMatrix4x4	gWorldToWindowMatrix[MAX_VIEWPORTS],gFrustumToWindowMatrix[MAX_VIEWPORTS];
 
@@ -135,6 +258,64 @@ Boolean							gUsingVertexArrayRange = false;
 #endif
 
 
+		/* VERTEX BUFFERS */
+		//
+		// Each non-"User" VAR type's master block is mirrored in a GL buffer object.
+		// The master block stays the CPU-side copy that the game writes into;
+		// we only send the parts that changed before the first draw that needs them.
+		// BG3D models and terrain are static.  Everything else is rewritten every frame,
+		// so it's streamed: the whole buffer is re-specified on each update, which lets
+		// the driver hand us fresh storage while the GPU still reads last frame's.
+		//
+
+typedef struct
+{
+	size_t		start, end;
+}VertexBufferRange;
+
+typedef struct
+{
+	GLuint				name;
+	Boolean				isDynamic;
+	size_t				usedSize;						// end of the last allocation in the master block
+	size_t				storageSize;					// size of the GL buffer's storage
+	Boolean				allDirty;
+	int					numDirtyRanges;
+	VertexBufferRange	dirtyRanges[MAX_VERTEX_BUFFER_DIRTY_RANGES];
+}VertexBufferType;
+
+#ifndef __EMSCRIPTEN__
+static struct
+{
+	PFNGLGENBUFFERSPROC			GenBuffers;
+	PFNGLDELETEBUFFERSPROC		DeleteBuffers;
+	PFNGLBINDBUFFERPROC			BindBuffer;
+	PFNGLBUFFERDATAPROC			BufferData;
+	PFNGLBUFFERSUBDATAPROC		BufferSubData;
+}gVertexBufferGL;
+#endif
+
+#ifndef __EMSCRIPTEN__
+static struct
+{
+	PFNGLGENQUERIESPROC			GenQueries;
+	PFNGLDELETEQUERIESPROC		DeleteQueries;
+	PFNGLBEGINQUERYPROC			BeginQuery;
+	PFNGLENDQUERYPROC			EndQuery;
+	PFNGLGETQUERYOBJECTUIVPROC	GetQueryObjectuiv;
+}gOcclusionQueryGL;
+#endif
+
+static	Boolean					gOcclusionQueriesSupported = false;
+static	GLboolean				gOcclusionQuerySavedColorMask[4];
+
+static	Boolean					gVertexBuffersSupported = false;
+static	VertexBufferType		gVertexBuffers[VERTEX_ARRAY_RANGE_TYPE_USER1];
+static	short					gCurrentVertexBufferType = -1;		// set by OGL_BeginVertexArrayBuffer
+static	GLuint					gBoundArrayBuffer = 0;
+static	GLuint					gBoundElementArrayBuffer = 0;
+
+
 /******************** OGL BOOT *****************/
 //
 // Initialize my OpenGL stuff.
@@ -397,12 +578,79 @@ GLint			maxTexSize;
 #ifndef __EMSCRIPTEN__
 	gGlClientActiveTextureProc = (PFNGLCLIENTACTIVETEXTUREARBPROC) SDL_GL_GetProcAddress("glClientActiveTexture");
 	GAME_ASSERT(gGlClientActiveTextureProc);
+
+			/* SEE IF WE CAN COMPRESS TEXTURES */
+			//
+			// The driver does the encoding the first time, then we keep its output in a cache
+			// file so later runs can upload the compressed mip chain directly.
+			//
+
+	gGlCompressedTexImage2DProc = (PFNGLCOMPRESSEDTEXIMAGE2DPROC) SDL_GL_GetProcAddress("glCompressedTexImage2D");
+	gGlGetCompressedTexImageProc = (PFNGLGETCOMPRESSEDTEXIMAGEPROC) SDL_GL_GetProcAddress("glGetCompressedTexImage");
+	gCanCompressTextures = SDL_GL_ExtensionSupported("GL_EXT_texture_compression_s3tc")
+							&& gGlCompressedTexImage2DProc
+							&& gGlGetCompressedTexImageProc;
+#endif
+
+			/* GLES CAN'T COMPRESS ON UPLOAD, BUT CAN TAKE ETC1 WE ENCODE OURSELVES */
+
+	gCanUseETC1Textures = (SDL_GL_ExtensionSupported("GL_OES_compressed_ETC1_RGB8_texture")
+							|| SDL_GL_ExtensionSupported("GL_WEBGL_compressed_texture_etc1"))
+#ifndef __EMSCRIPTEN__
+							&& gGlCompressedTexImage2DProc
+#endif
+							;
+
+#ifndef __EMSCRIPTEN__
+
+			/* GET VERTEX BUFFER PROCEDURES */
+			//
+			// Buffer objects are core since GL 1.5.  If any are missing,
+			// the VAR master blocks are drawn as plain client-side arrays.
+			//
+
+	gVertexBufferGL.GenBuffers		= (PFNGLGENBUFFERSPROC)		SDL_GL_GetProcAddress("glGenBuffers");
+	gVertexBufferGL.DeleteBuffers	= (PFNGLDELETEBUFFERSPROC)	SDL_GL_GetProcAddress("glDeleteBuffers");
+	gVertexBufferGL.BindBuffer		= (PFNGLBINDBUFFERPROC)		SDL_GL_GetProcAddress("glBindBuffer");
+	gVertexBufferGL.BufferData		= (PFNGLBUFFERDATAPROC)		SDL_GL_GetProcAddress("glBufferData");
+	gVertexBufferGL.BufferSubData	= (PFNGLBUFFERSUBDATAPROC)	SDL_GL_GetProcAddress("glBufferSubData");
+
+	gVertexBuffersSupported = true;
+	for (size_t i = 0; i < sizeof(gVertexBufferGL) / sizeof(void*); i++)
+	{
+		if (((void**) &gVertexBufferGL)[i] == nil)
+			gVertexBuffersSupported = false;
+	}
+
+	if (!gVertexBuffersSupported)
+		SDL_Log("No vertex buffer objects; drawing from client-side arrays");
+
+			/* GET OCCLUSION QUERY PROCEDURES */
+			//
+			// Core since GL 1.5.  Without them, whatever asks for a
+			// query result just assumes everything is visible.
+			//
+
+	gOcclusionQueryGL.GenQueries		= (PFNGLGENQUERIESPROC)			SDL_GL_GetProcAddress("glGenQueries");
+	gOcclusionQueryGL.DeleteQueries		= (PFNGLDELETEQUERIESPROC)		SDL_GL_GetProcAddress("glDeleteQueries");
+	gOcclusionQueryGL.BeginQuery		= (PFNGLBEGINQUERYPROC)			SDL_GL_GetProcAddress("glBeginQuery");
+	gOcclusionQueryGL.EndQuery			= (PFNGLENDQUERYPROC)			SDL_GL_GetProcAddress("glEndQuery");
+	gOcclusionQueryGL.GetQueryObjectuiv	= (PFNGLGETQUERYOBJECTUIVPROC)	SDL_GL_GetProcAddress("glGetQueryObjectuiv");
+
+	gOcclusionQueriesSupported = true;
+	for (size_t i = 0; i < sizeof(gOcclusionQueryGL) / sizeof(void*); i++)
+	{
+		if (((void**) &gOcclusionQueryGL)[i] == nil)
+			gOcclusionQueriesSupported = false;
+	}
 #endif
 
 #ifdef __EMSCRIPTEN__
 	// Initialise the GLES2 fixed-function compatibility layer (shaders, VBOs, etc.)
 	COMPAT_GL_Init();
 #endif
+
+	OGL_InitAnaglyphShader();
 }
 
 /**************** OGL: NUKE DRAW CONTEXT *********************/
@@ -418,6 +666,8 @@ static void OGL_DisposeDrawContext(void)
 		return;
 	}
 
+	OGL_DisposeAnaglyphShader();
+
 	SDL_GL_MakeCurrent(gSDLWindow, NULL);		// make context not current
 	SDL_GL_DestroyContext(gAGLContext);			// nuke context
 	gAGLContext = nil;
@@ -436,9 +686,10 @@ OGLViewDefType *viewDefPtr = &def->view;
 		/* FIX FOG FOR FOR B&W ANAGLYPH */
 		//
 		// The NTSC luminance standard where grayscale = .299r + .587g + .114b
+		// (The anaglyph shader converts the whole frame, clear color included.)
 		//
 
-	if (IsStereoAnaglyphColor())
+	if (IsStereoAnaglyphColor() && !OGL_IsAnaglyphShaderActive())
 	{
 		uint32_t r = (uint32_t) (viewDefPtr->clearColor.r * 255.0f);
 		uint32_t g = (uint32_t) (viewDefPtr->clearColor.g * 255.0f);
@@ -448,7 +699,7 @@ OGLViewDefType *viewDefPtr = &def->view;
 
 		viewDefPtr->clearColor = (OGLColorRGBA) { (float)r / 255.0f, (float)g / 255.0f, (float)b / 255.0f, 1.0f };
 	}
-	else if (IsStereoAnaglyphMono())
+	else if (IsStereoAnaglyphMono() && !OGL_IsAnaglyphShaderActive())
 	{
 		float	f;
 		f = viewDefPtr->clearColor.r * .299f;
@@ -675,6 +926,8 @@ GLfloat	ambient[4];
 
 void OGL_DrawScene(void (*drawRoutine)(void))
 {
+Uint64	drawStartTick = SDL_GetPerformanceCounter();
+
 	SDL_GetWindowSizeInPixels(gSDLWindow, &gGameWindowWidth, &gGameWindowHeight);
 
 
@@ -717,6 +970,10 @@ void OGL_DrawScene(void (*drawRoutine)(void))
 	OGL_UpdateVertexArrayRange();
 #endif
 
+			/* DO THE VIEW-INDEPENDENT OBJECT WORK ONCE FOR ALL PANES & PASSES */
+
+	PrepareObjectsForDrawing();
+
 
 do_shutter:
 
@@ -744,7 +1001,7 @@ do_shutter:
 				// Bringing up dialogs can write into green channel, so always be sure it's clear
 				//
 
-		if (IsStereoAnaglyphColor())
+		if (IsStereoAnaglyphColor() || OGL_IsAnaglyphShaderActive())
 			glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);		// make sure clearing Red/Green/Blue channels
 		else if (IsStereoAnaglyphMono())
 			glColorMask(GL_TRUE, GL_FALSE, GL_TRUE, GL_TRUE);		// make sure clearing Red/Blue channels
@@ -761,6 +1018,12 @@ do_shutter:
 
 do_anaglyph:
 
+	if (OGL_IsAnaglyphShaderActive())
+	{
+		if (gAnaglyphPass > 0)										// each eye is a full image of its own
+			glClear(GL_COLOR_BUFFER_BIT|GL_DEPTH_BUFFER_BIT);
+	}
+	else
 	if (IsStereoAnaglyph())
 	{
 				/* SET COLOR MASK */
@@ -822,6 +1085,9 @@ do_anaglyph:
 
 	if (IsStereo())
 	{
+		if (OGL_IsAnaglyphShaderActive())
+			OGL_CaptureAnaglyphEye(gAnaglyphPass);
+
 		gAnaglyphPass++;
 		if (gAnaglyphPass == 1)
 		{
@@ -830,6 +1096,9 @@ do_anaglyph:
 			else						// but shutters have separate buffers so they do need to clear the buffers
 				goto do_shutter;
 		}
+
+		if (OGL_IsAnaglyphShaderActive())
+			OGL_DrawAnaglyphComposite();
 	}
 
 
@@ -850,6 +1119,9 @@ do_anaglyph:
 			glPolygonMode(GL_FRONT_AND_BACK ,GL_FILL);
 	}
 
+	if (IsKeyDown(SDL_SCANCODE_F7))							// log memory use per subsystem
+		ReportMemoryTags();
+
 
 	if (gTimeDemo)
 	{
@@ -865,7 +1137,7 @@ do_anaglyph:
 		int		x2 = 60;
 
 		OGL_DrawString("fps:", 10,y);
-		OGL_DrawInt(gFramesPerSecond+.5f, x2,y);
+		OGL_DrawInt(gDrawFramesPerSecond+.5f, x2,y);
 		y += 15;
 
 		OGL_DrawString("tri:", 10,y);
@@ -885,6 +1157,21 @@ do_anaglyph:
 		OGL_DrawInt(gNumObjectNodes, x2,y);
 		y += 15;
 
+		OGL_DrawString("PRT:", 10,y);
+		OGL_DrawInt(gNumParticlesThisFrame, x2,y);
+		y += 15;
+
+		if (gDebugMode >= 2)								// KB per memory tag
+		{
+			for (int tag = 0; tag < NUM_MEMORY_TAGS; tag++)
+			{
+				long liveBytes;
+				OGL_DrawString(GetMemoryTagStats(tag, &liveBytes, nil, nil), 10,y);
+				OGL_DrawInt((int) (liveBytes/1024), x2+30,y);
+				y += 15;
+			}
+		}
+
 #if 0
 
 		OGL_DrawString("#scratchF:", 20,y);
@@ -951,11 +1238,19 @@ do_anaglyph:
 
 
 
+	gRenderStatsDrawTicks += SDL_GetPerformanceCounter() - drawStartTick;
+	if (gRenderStatsPrevFrameTick != 0)
+		gRenderStatsFrameTicks += drawStartTick - gRenderStatsPrevFrameTick;
+	gRenderStatsPrevFrameTick = drawStartTick;
+	gRenderStatsFrames++;
+
+
            /* SWAP THE BUFFS */
 
 	SDL_GL_SwapWindow(gSDLWindow);							// end render loop
 
-	if (!gGamePaused)										// freeze frame count if paused (otherwise double-buffered skeletons will flicker)
+	if (!gGamePaused										// freeze frame count if paused (otherwise double-buffered skeletons will flicker)
+		&& !gFixedTimestepActive)							// with a fixed timestep, each simulation tick advances it instead
 	{
 		gGameViewInfoPtr->frameCount++;						// inc frame count AFTER drawing (so that the previous Move calls were in sync with this draw frame count)
 	}
@@ -1117,17 +1412,35 @@ int	t,b,l,r;
 //			textureInRAM = true if OpenGL is to use the texture directly from imageMemory.
 //							In this case we are in control of the texture, and must remember to delete it later
 //
+// The texture group's quality pref decides whether we build mipmaps and/or compress it.
+//
 
 GLuint OGL_TextureMap_Load(void *imageMemory, int width, int height, GLint destFormat,
 							GLint srcFormat, GLint dataType)
 {
 GLuint	textureName;
+Byte	quality = gGamePrefs.textureQuality[OGL_GetTextureGroup()];
+Boolean	mipmaps = (quality >= TEXTURE_QUALITY_MIPMAPPED);
+long	plainBytes = (long) width * height * 4;
+long	bytes = 0;
+int		cacheIndex = -1;
 
+	if (gTextureCacheSource[0])								// every texture from the source counts, so the index is stable
+		cacheIndex = gTextureCacheSourceIndex++;
 
-	if (IsStereoAnaglyphColor())
-		ConvertTextureToColorAnaglyph(imageMemory, width, height, srcFormat, dataType);
-	else if (IsStereoAnaglyphMono())
-		ConvertTextureToGrey(imageMemory, width, height, srcFormat, dataType);
+	if (!OGL_IsAnaglyphShaderActive())						// otherwise the shader does it at the end of each frame
+	{
+		if (IsStereoAnaglyphColor())
+		{
+			ConvertTextureToColorAnaglyph(imageMemory, width, height, srcFormat, dataType);
+			cacheIndex = -1;								// pixels no longer match the file
+		}
+		else if (IsStereoAnaglyphMono())
+		{
+			ConvertTextureToGrey(imageMemory, width, height, srcFormat, dataType);
+			cacheIndex = -1;
+		}
+	}
 
 			/* GET A UNIQUE TEXTURE NAME & INITIALIZE IT */
 
@@ -1140,7 +1453,12 @@ GLuint	textureName;
 
 				/* LOAD TEXTURE AND/OR MIPMAPS */
 
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+#ifdef __EMSCRIPTEN__
+	if (mipmaps && ((width & (width-1)) || (height & (height-1))))		// WebGL 1 can only mipmap power-of-2 textures
+		mipmaps = false;
+#endif
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mipmaps ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
 #if 0
@@ -1148,20 +1466,39 @@ GLuint	textureName;
 		glPixelStorei(GL_UNPACK_CLIENT_STORAGE_APPLE, 1);
 #endif
 
-	glTexImage2D(GL_TEXTURE_2D,
-				0,										// mipmap level
-				destFormat,								// format in OpenGL
-				width,									// width in pixels
-				height,									// height in pixels
-				0,										// border
-				srcFormat,								// what my format is
-				dataType,								// size of each r,g,b
-				imageMemory);							// pointer to the actual texture pixels
+	if (quality >= TEXTURE_QUALITY_COMPRESSED && (gCanCompressTextures || gCanUseETC1Textures))
+		bytes = OGL_TextureMap_LoadCompressed(imageMemory, width, height, srcFormat, dataType, mipmaps, cacheIndex);
+
+	if (bytes == 0)											// not compressed, or the driver wouldn't do it
+	{
+#ifndef __EMSCRIPTEN__
+		glTexParameteri(GL_TEXTURE_2D, GL_GENERATE_MIPMAP, mipmaps ? GL_TRUE : GL_FALSE);
+#endif
+
+		glTexImage2D(GL_TEXTURE_2D,
+					0,										// mipmap level
+					destFormat,								// format in OpenGL
+					width,									// width in pixels
+					height,									// height in pixels
+					0,										// border
+					srcFormat,								// what my format is
+					dataType,								// size of each r,g,b
+					imageMemory);							// pointer to the actual texture pixels
+
+#ifdef __EMSCRIPTEN__
+		if (mipmaps)
+			glGenerateMipmap(GL_TEXTURE_2D);
+#endif
+
+		bytes = mipmaps ? plainBytes * 4 / 3 : plainBytes;	// a full mip chain adds a third
+	}
 
 			/* SEE IF RAN OUT OF MEMORY WHILE COPYING TO OPENGL */
 
 	OGL_CheckError();
 
+	OGL_RecordTextureBytes(textureName, bytes, plainBytes);
+
 
 				/* SET THIS TEXTURE AS CURRENTLY ACTIVE FOR DRAWING */
 
@@ -1171,160 +1508,773 @@ GLuint	textureName;
 }
 
 
-/***************** OGL TEXTUREMAP LOAD FROM PNG/JPG **********************/
+/***************** OGL SET TEXTURE CACHE SOURCE **************************/
+//
+// Loaders call this with the name of the file they're about to load textures from,
+// and a key that changes whenever the file does (a hash of it, or whatever they
+// already check their own caches with), then with nil when they're done.
+// Textures loaded in between can have their compressed versions cached
+// (see OGL_TextureMap_LoadCompressed).
+//
 
-GLuint OGL_TextureMap_LoadImageFile(const char* partialPath, int* outWidth, int* outHeight, int* outHasAlpha)
+void OGL_SetTextureCacheSource(const char* sourceName, uint64_t sourceKey)
 {
-	FSSpec dummySpec;
-	char path[64];
-	bool jpgExists = false;
-	bool pngExists = false;
-	uint8_t* colorPixels = NULL;
-	int width = 0;
-	int height = 0;
-	GLuint textureName = 0;
+	if (sourceName)
+		SDL_strlcpy(gTextureCacheSource, sourceName, sizeof(gTextureCacheSource));
+	else
+		gTextureCacheSource[0] = '\0';
 
-	// Try to load a JPEG file first.
-	SDL_snprintf(path, sizeof(path), "%s.jpg", partialPath);
-	jpgExists = noErr == FSMakeFSSpec(gDataSpec.vRefNum, gDataSpec.parID, path, &dummySpec);
-	if (jpgExists)
-	{
-		long jpgLength;
-		Ptr jpgData = LoadDataFile(path, &jpgLength);
-		GAME_ASSERT(jpgData);
+	gTextureCacheSourceKey		= sourceKey;
+	gTextureCacheSourceIndex	= 0;
+}
 
-		colorPixels = (uint8_t*) stbi_load_from_memory((const stbi_uc*) jpgData, (int) jpgLength, &width, &height, NULL, 4);
-		GAME_ASSERT(colorPixels);
 
-		SafeDisposePtr(jpgData);
-	}
+/***************** OGL TEXTUREMAP DISPOSE **************************/
 
-	// Now try to load the PNG version of the same image.
-	// If we've already loaded a JPEG, the PNG is used as an alpha mask.
-	// Otherwise, load the PNG as an RGBA image.
-	SDL_snprintf(path, sizeof(path), "%s.png", partialPath);
-	pngExists = noErr == FSMakeFSSpec(gDataSpec.vRefNum, gDataSpec.parID, path, &dummySpec);
-	if (pngExists)
-	{
-		long pngLength;
-		Ptr pngData = LoadDataFile(path, &pngLength);
-		GAME_ASSERT(pngData);
+void OGL_TextureMap_Dispose(int numTextures, const GLuint *textureNames)
+{
+	for (int i = 0; i < numTextures; i++)
+		OGL_RecordTextureBytes(textureNames[i], 0, 0);
 
-		if (!colorPixels)
-		{
-			// We haven't loaded a JPEG, so the PNG will serve as an RGBA image.
-			colorPixels = (uint8_t*) stbi_load_from_memory((const stbi_uc*) pngData, (int) pngLength, &width, &height, NULL, 4);
-			GAME_ASSERT(colorPixels);
-		}
-		else
-		{
-			int alphaWidth = 0;
-			int alphaHeight = 0;
+	glDeleteTextures(numTextures, textureNames);
+}
 
-			// Load PNG as alpha
-			uint8_t* alphaPixels = (uint8_t*) stbi_load_from_memory((const stbi_uc*) pngData, (int) pngLength, &alphaWidth, &alphaHeight, NULL, 1);
 
-			GAME_ASSERT(alphaPixels);
+/***************** GET TEXTURE GROUP **************************/
+//
+// The loaders already scope themselves with memory tags, so that's what tells us
+// whether a texture belongs to the terrain, a model, or the UI.
+//
 
-			// Apply alpha channel to existing colorPixels
-			GAME_ASSERT(colorPixels);			// we must have read colors from the JPEG file prior
+static int OGL_GetTextureGroup(void)
+{
+	switch (GetMemoryTag())
+	{
+		case	MEMORY_TAG_TERRAIN:
+				return TEXTURE_GROUP_TERRAIN;
 
-			if (alphaWidth != width || alphaHeight != height)
-			{
-				DoFatalAlert("%s: PNG mask dimensions must match JPEG file: %s", __func__, path);
-			}
+		case	MEMORY_TAG_UI:
+				return TEXTURE_GROUP_SPRITES;
 
-			// Merge alpha into color pixels
-			for (int a = 0, c = 3; a < width * height; a++, c += 4)
-			{
-				colorPixels[c] = alphaPixels[a];
-			}
+		default:
+				return TEXTURE_GROUP_MODELS;
+	}
+}
 
-			SafeDisposePtr(alphaPixels);
-		}
 
-		SafeDisposePtr(pngData);
-	}
+/***************** RECORD TEXTURE BYTES **************************/
+//
+// Pass 0 bytes when the texture goes away.
+//
 
-	// See if texture file was missing
-	if (!colorPixels)
+static void OGL_RecordTextureBytes(GLuint textureName, long bytes, long plainBytes)
+{
+	if (textureName >= gTextureBytesTableSize)
 	{
-		DoFatalAlert("%s: Texture file missing: %s\n", __func__, partialPath);
-	}
-
-	// Load colorPixels as OpenGL texture
-	textureName = OGL_TextureMap_Load(
-			colorPixels,
-			width,
-			height,
-			GL_RGBA,
-			GL_RGBA,
-			GL_UNSIGNED_BYTE);
+		if (bytes == 0)										// never recorded
+			return;
 
-	OGL_CheckError();
-	GAME_ASSERT(textureName);
+		GLuint newSize = textureName + 256;
+		gTextureBytes = ReallocPtr(gTextureBytes, sizeof(uint32_t) * newSize);
+		gTexturePlainBytes = ReallocPtr(gTexturePlainBytes, sizeof(uint32_t) * newSize);
+		SDL_memset(gTextureBytes + gTextureBytesTableSize, 0, sizeof(uint32_t) * (newSize - gTextureBytesTableSize));
+		SDL_memset(gTexturePlainBytes + gTextureBytesTableSize, 0, sizeof(uint32_t) * (newSize - gTextureBytesTableSize));
+		gTextureBytesTableSize = newSize;
+	}
 
-	SafeDisposePtr(colorPixels);
+	if (gTextureBytes[textureName])
+		gNumTexturesLoaded--;
+	if (bytes)
+		gNumTexturesLoaded++;
 
-	if (outWidth) *outWidth = width;
-	if (outHeight) *outHeight = height;
-	if (outHasAlpha) *outHasAlpha = pngExists;
+	gTextureVRAM		+= bytes - (long) gTextureBytes[textureName];
+	gTexturePlainVRAM	+= plainBytes - (long) gTexturePlainBytes[textureName];
+	gTextureBytes[textureName]		= (uint32_t) bytes;
+	gTexturePlainBytes[textureName]	= (uint32_t) plainBytes;
 
-	return textureName;
+	if (gTextureVRAM > gPeakTextureVRAM)
+	{
+		gPeakTextureVRAM = gTextureVRAM;
+		gPeakTexturePlainVRAM = gTexturePlainVRAM;
+	}
 }
 
 
-/******************** CONVERT TEXTURE TO GREY **********************/
+/***************** OGL TEXTUREMAP LOAD COMPRESSED **************************/
 //
-// The NTSC luminance standard where grayscale = .299r + .587g + .114b
+// Uploads the currently bound texture compressed, with a full mip chain if mipmaps is set.
+// Desktop GL encodes it as S3TC in the driver.  GLES drivers can't do that, so there
+// opaque textures are encoded as ETC1 on the CPU instead (see ETC1.c).
+//
+// If cacheIndex isn't -1, the compressed mip chain is cached in the prefs folder under the
+// texture's source file & index, so each texture only has to be encoded once.
+// ETC1 encoding is too slow to do on every load, so without a cache it isn't done at all.
+//
+// Returns the number of bytes uploaded, or 0 if the texture wasn't compressed
+// (the caller then uploads it the normal way).
 //
 
-static void	ConvertTextureToGrey(void *imageMemory, short width, short height, GLint srcFormat, GLint dataType)
+static long OGL_TextureMap_LoadCompressed(void *imageMemory, int width, int height, GLint srcFormat, GLint dataType, Boolean mipmaps, int cacheIndex)
 {
-long	x,y;
-float	r,g,b;
-uint32_t	a,q,rq,bq;
-uint32_t   redCal = gGamePrefs.anaglyphCalibrationRed;
-uint32_t   blueCal =  gGamePrefs.anaglyphCalibrationBlue;
+int			bytesPerPixel;
+char		cacheName[96];
+Ptr			cache;
+long		cacheSize = 0;
+long		bytes = 0;
 
+#ifdef __EMSCRIPTEN__
+	cacheIndex = -1;											// no persistent prefs folder to keep a cache in
+#endif
 
-	if (dataType == GL_UNSIGNED_INT_8_8_8_8_REV)
-	{
-		uint32_t	*pix32 = (uint32_t *)imageMemory;
-		for (y = 0; y < height; y++)
-		{
-			for (x = 0; x < width; x++)
-			{
-				uint32_t	pix = pix32[x];
 
-				r = (float)((pix >> 16) & 0xff) / 255.0f * .299f;
-				g = (float)((pix >> 8) & 0xff) / 255.0f * .586f;
-				b = (float)(pix & 0xff) / 255.0f * .114f;
-				a = (pix >> 24) & 0xff;
+			/* SEE HOW BIG THE SOURCE PIXELS ARE */
 
+	switch (dataType)
+	{
+		case	GL_UNSIGNED_BYTE:
+				if (srcFormat == GL_RGBA || srcFormat == GL_BGRA)
+					bytesPerPixel = 4;
+				else if (srcFormat == GL_RGB || srcFormat == GL_BGR)
+					bytesPerPixel = 3;
+				else
+					return 0;
+				break;
 
-				q = (r + g + b) * 255.0f;									// pass thru the brightness curve
-				if (q > 0xff)
-					q = 0xff;
-				q = gAnaglyphGreyTable[q];
+		case	GL_UNSIGNED_INT_8_8_8_8_REV:
+				bytesPerPixel = 4;
+				break;
 
-				rq = (q * redCal) / 0xff;									// balance the red & blue
-				bq = (q * blueCal) / 0xff;
+		case	GL_UNSIGNED_SHORT_1_5_5_5_REV:
+				bytesPerPixel = 2;
+				break;
 
-				pix = (a << 24) | (rq << 16) | (q << 8) | bq;
-				pix32[x] = pix;
-			}
-			pix32 += width;
-		}
+		default:
+				return 0;
 	}
 
-	else
-	if ((dataType == GL_UNSIGNED_BYTE) && (srcFormat == GL_RGBA))
+
+			/*************************************/
+			/* TRY TO UPLOAD THE CACHED VERSION */
+			/*************************************/
+
+	if (cacheIndex >= 0)
 	{
-		uint32_t	*pix32 = (uint32_t *)imageMemory;
-		for (y = 0; y < height; y++)
+		uint64_t	nameHash = HashBytes(HASH_BYTES_SEED, gTextureCacheSource, SDL_strlen(gTextureCacheSource));
+
+		SDL_snprintf(cacheName, sizeof(cacheName), "%s:%016llx-%d",		// name the cache file after the source file
+					TEXTURE_CACHE_FOLDER, (unsigned long long) nameHash, cacheIndex);
+
+		cache = LoadUserDataBlob(cacheName, &cacheSize);
+		if (cache)
 		{
-			for (x = 0; x < width; x++)
+			const TextureCacheHeader	*header = (const TextureCacheHeader *) cache;
+
+			if (cacheSize >= (long) sizeof(*header)
+				&& header->magic == TEXTURE_CACHE_MAGIC
+				&& header->sourceKey == gTextureCacheSourceKey
+				&& IsUsableCompressedFormat(header->internalFormat)
+				&& header->width == width
+				&& header->height == height
+				&& (mipmaps || header->numLevels == 1))
+			{
+				bytes = OGL_UploadCompressedMipChain(cache, cacheSize);
+			}
+
+			SafeDisposePtr(cache);
+
+			if (bytes > 0)
+				return bytes;
+			SDL_Log("%s: ignoring stale cache for %s #%d", __func__, gTextureCacheSource, cacheIndex);
+		}
+	}
+
+
+			/**********************/
+			/* COMPRESS IT FRESH */
+			/**********************/
+
+	cache = nil;
+	cacheSize = 0;
+
+#ifndef __EMSCRIPTEN__
+	if (gCanCompressTextures)
+		bytes = OGL_EncodeS3TCMipChain(imageMemory, width, height, srcFormat, dataType, bytesPerPixel, &cache, &cacheSize);
+	else
+#endif
+	if (cacheIndex >= 0)											// otherwise just upload it uncompressed
+	{
+		cache = OGL_EncodeETC1MipChain(imageMemory, width, height, srcFormat, dataType, mipmaps, &cacheSize);
+		if (cache)
+			bytes = OGL_UploadCompressedMipChain(cache, cacheSize);
+	}
+
+	if (!cache)
+		return bytes;
+
+	((TextureCacheHeader *) cache)->sourceKey = gTextureCacheSourceKey;
+
+	if (cacheIndex >= 0 && bytes > 0)
+	{
+		if (!gTextureCacheFolderMade)
+		{
+			MakeUserDataFolder(TEXTURE_CACHE_FOLDER);
+			gTextureCacheFolderMade = true;
+		}
+		SaveUserDataBlob(cacheName, cache, cacheSize);				// replaces this texture's previous cache, if any
+	}
+
+	SafeDisposePtr(cache);
+
+	return bytes;
+}
+
+
+/***************** IS USABLE COMPRESSED FORMAT **************************/
+
+static Boolean IsUsableCompressedFormat(uint32_t internalFormat)
+{
+	switch (internalFormat)
+	{
+#ifndef __EMSCRIPTEN__
+		case	GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+		case	GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+				return gCanCompressTextures;
+#endif
+
+		case	GL_ETC1_RGB8_OES:
+				return gCanUseETC1Textures;
+
+		default:
+				return false;
+	}
+}
+
+
+/***************** OGL UPLOAD COMPRESSED MIP CHAIN **************************/
+//
+// Uploads a mip chain laid out like the texture cache files.
+// Returns the number of bytes uploaded, or 0 if it's truncated or GL rejected it.
+//
+
+static long OGL_UploadCompressedMipChain(const void *chain, long chainSize)
+{
+const TextureCacheHeader	*header = (const TextureCacheHeader *) chain;
+const uint8_t				*cursor = (const uint8_t *) (header + 1);
+const uint8_t				*end = (const uint8_t *) chain + chainSize;
+int							w = header->width;
+int							h = header->height;
+long						bytes = 0;
+int							level;
+
+	for (level = 0; level < header->numLevels; level++)
+	{
+		int32_t	size;
+
+		if (cursor + sizeof(size) > end)
+			break;
+		SDL_memcpy(&size, cursor, sizeof(size));
+		cursor += sizeof(size);
+		if (size <= 0 || cursor + size > end)
+			break;
+
+		CompressedTexImage2D(GL_TEXTURE_2D, level, header->internalFormat, w, h, 0, size, cursor);
+		cursor += (size + 3) & ~3;
+		bytes += size;
+
+		w = w > 1 ? w/2 : 1;
+		h = h > 1 ? h/2 : 1;
+	}
+
+	if (OGL_CheckError() || level != header->numLevels)		// truncated file: mip chain would be incomplete
+		return 0;
+
+	return bytes;
+}
+
+
+/***************** OGL ENCODE S3TC MIP CHAIN **************************/
+//
+// Has the driver encode the bound texture as S3TC and build its mips, then reads them back
+// into *outChain in the cache layout (nil if that failed; the texture's still fine).
+// Returns the number of bytes uploaded, or 0 if the driver wouldn't compress it.
+//
+
+#ifndef __EMSCRIPTEN__
+static long OGL_EncodeS3TCMipChain(void *imageMemory, int width, int height, GLint srcFormat, GLint dataType,
+								int bytesPerPixel, Ptr *outChain, long *outChainSize)
+{
+long		numPixels = (long) width * height;
+Boolean		opaque = false;
+GLenum		internalFormat;
+GLint		isCompressed = GL_FALSE;
+int			numLevels;
+long		chainSize;
+long		bytes = 0;
+Ptr			chain;
+
+
+			/* USE DXT1 IF THERE'S NO ALPHA TO KEEP, DXT5 OTHERWISE */
+
+	if (bytesPerPixel == 3)
+		opaque = true;
+	else if (bytesPerPixel == 4)
+	{
+		const uint8_t *alpha = (const uint8_t *) imageMemory + 3;
+		if (dataType == GL_UNSIGNED_INT_8_8_8_8_REV && SDL_BYTEORDER == SDL_BIG_ENDIAN)
+			alpha = (const uint8_t *) imageMemory;					// packed ARGB word: alpha is the high byte
+
+		opaque = true;
+		for (long i = 0; i < numPixels; i++)
+		{
+			if (alpha[i*4] != 0xff)
+			{
+				opaque = false;
+				break;
+			}
+		}
+	}
+
+	internalFormat = opaque ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+
+
+			/* HAVE THE DRIVER ENCODE IT */
+
+	glTexParameteri(GL_TEXTURE_2D, GL_GENERATE_MIPMAP, GL_TRUE);
+	glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, srcFormat, dataType, imageMemory);
+	if (OGL_CheckError())
+		return 0;
+
+	glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_COMPRESSED, &isCompressed);
+	if (!isCompressed)
+		return 0;
+
+	numLevels = 1;
+	for (int size = SDL_max(width, height); size > 1; size /= 2)
+		numLevels++;
+
+
+			/* READ BACK WHAT IT MADE */
+
+	chainSize = sizeof(TextureCacheHeader);
+	for (int level = 0; level < numLevels; level++)
+	{
+		GLint	size = 0;
+		glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &size);
+		chainSize += sizeof(int32_t) + ((size + 3) & ~3);
+		bytes += size;
+	}
+
+	chain = AllocPtrClear(chainSize);
+	{
+		TextureCacheHeader	*header = (TextureCacheHeader *) chain;
+		uint8_t				*cursor = (uint8_t *) (header + 1);
+
+		header->magic			= TEXTURE_CACHE_MAGIC;
+		header->internalFormat	= internalFormat;
+		header->width			= width;
+		header->height			= height;
+		header->numLevels		= numLevels;
+
+		for (int level = 0; level < numLevels; level++)
+		{
+			GLint	size = 0;
+			int32_t	size32;
+
+			glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &size);
+			size32 = size;
+			SDL_memcpy(cursor, &size32, sizeof(size32));
+			cursor += sizeof(size32);
+
+			gGlGetCompressedTexImageProc(GL_TEXTURE_2D, level, cursor);
+			cursor += (size + 3) & ~3;
+		}
+	}
+
+	if (OGL_CheckError())										// don't cache a bad read-back
+	{
+		SafeDisposePtr(chain);
+		chain = nil;
+		chainSize = 0;
+	}
+
+	*outChain = chain;
+	*outChainSize = chainSize;
+	return bytes;
+}
+#endif
+
+
+/***************** OGL ENCODE ETC1 MIP CHAIN **************************/
+//
+// Encodes an opaque RGB(A) texture and, if asked, its box-filtered mips as ETC1,
+// in the texture cache layout.  Returns nil if the texture has alpha
+// or isn't in a format we can read.
+//
+
+static Ptr OGL_EncodeETC1MipChain(void *imageMemory, int width, int height, GLint srcFormat, GLint dataType,
+								Boolean mipmaps, long *outChainSize)
+{
+long		numPixels = (long) width * height;
+int			srcBytesPerPixel;
+uint8_t		*rgba;
+int			numLevels;
+long		chainSize;
+Ptr			chain;
+uint8_t		*cursor;
+int			w, h;
+
+	if (dataType != GL_UNSIGNED_BYTE)
+		return nil;
+
+	if (srcFormat == GL_RGBA)
+		srcBytesPerPixel = 4;
+	else if (srcFormat == GL_RGB)
+		srcBytesPerPixel = 3;
+	else
+		return nil;
+
+
+			/* COPY TO RGBA, MAKING SURE IT'S OPAQUE */
+
+	rgba = (uint8_t *) AllocPtr(numPixels * 4);
+
+	for (long i = 0; i < numPixels; i++)
+	{
+		const uint8_t *src = (const uint8_t *) imageMemory + i * srcBytesPerPixel;
+
+		if (srcBytesPerPixel == 4 && src[3] != 0xff)			// ETC1 can't keep alpha
+		{
+			SafeDisposePtr(rgba);
+			return nil;
+		}
+
+		rgba[i*4+0] = src[0];
+		rgba[i*4+1] = src[1];
+		rgba[i*4+2] = src[2];
+		rgba[i*4+3] = 0xff;
+	}
+
+
+			/* SIZE THE CHAIN */
+
+	numLevels = 1;
+	if (mipmaps)
+	{
+		for (int size = SDL_max(width, height); size > 1; size /= 2)
+			numLevels++;
+	}
+
+	chainSize = sizeof(TextureCacheHeader);
+	w = width;
+	h = height;
+	for (int level = 0; level < numLevels; level++)
+	{
+		chainSize += sizeof(int32_t) + ETC1_GetImageSize(w, h);			// always a multiple of 8, no padding needed
+		w = w > 1 ? w/2 : 1;
+		h = h > 1 ? h/2 : 1;
+	}
+
+	chain = AllocPtrClear(chainSize);
+
+	TextureCacheHeader	*header = (TextureCacheHeader *) chain;
+	header->magic			= TEXTURE_CACHE_MAGIC;
+	header->internalFormat	= GL_ETC1_RGB8_OES;
+	header->width			= width;
+	header->height			= height;
+	header->numLevels		= numLevels;
+
+
+			/* ENCODE EACH LEVEL, THEN HALVE THE PIXELS FOR THE NEXT */
+
+	cursor = (uint8_t *) (header + 1);
+	w = width;
+	h = height;
+
+	for (int level = 0; level < numLevels; level++)
+	{
+		int32_t	size = (int32_t) ETC1_GetImageSize(w, h);
+
+		SDL_memcpy(cursor, &size, sizeof(size));
+		cursor += sizeof(size);
+
+		ETC1_EncodeImage(rgba, w, h, cursor);
+		cursor += size;
+
+		int nw = w > 1 ? w/2 : 1;
+		int nh = h > 1 ? h/2 : 1;
+
+		for (int y = 0; y < nh; y++)									// box filter in place: reads are ahead of writes
+		{
+			for (int x = 0; x < nw; x++)
+			{
+				int x0 = SDL_min(x*2, w-1), x1 = SDL_min(x*2+1, w-1);
+				int y0 = SDL_min(y*2, h-1), y1 = SDL_min(y*2+1, h-1);
+
+				for (int c = 0; c < 3; c++)
+				{
+					rgba[(y*nw + x)*4 + c] = (uint8_t) ((rgba[(y0*w + x0)*4 + c] + rgba[(y0*w + x1)*4 + c]
+														+ rgba[(y1*w + x0)*4 + c] + rgba[(y1*w + x1)*4 + c] + 2) / 4);
+				}
+			}
+		}
+
+		w = nw;
+		h = nh;
+	}
+
+	SafeDisposePtr(rgba);
+
+	*outChainSize = chainSize;
+	return chain;
+}
+
+
+/***************** MARK RENDER STATS **************************/
+//
+// Starts a new window for OGL_ReportRenderStats.
+//
+
+void OGL_MarkRenderStats(void)
+{
+	gPeakTextureVRAM		= gTextureVRAM;
+	gPeakTexturePlainVRAM	= gTexturePlainVRAM;
+	gRenderStatsFrames		= 0;
+	gRenderStatsFrameTicks	= 0;
+	gRenderStatsDrawTicks	= 0;
+	gRenderStatsPrevFrameTick = 0;
+	gRenderStatsVertexBytes	= 0;
+}
+
+
+/***************** REPORT RENDER STATS **************************/
+//
+// Logs peak texture VRAM since OGL_MarkRenderStats (and what it would have been as
+// plain RGBA8 without mipmaps), plus average frame & draw times.
+//
+
+void OGL_ReportRenderStats(const char* label)
+{
+double	msPerTick = 1000.0 / (double) SDL_GetPerformanceFrequency();
+double	frameMS = 0;
+double	drawMS = 0;
+
+	if (gRenderStatsFrames > 1)
+		frameMS = gRenderStatsFrameTicks * msPerTick / (gRenderStatsFrames - 1);
+	if (gRenderStatsFrames > 0)
+		drawMS = gRenderStatsDrawTicks * msPerTick / gRenderStatsFrames;
+
+	SDL_Log("%s: textures peaked at %ld KB (%ld KB as plain RGBA8), %d still loaded",
+			label, gPeakTextureVRAM / 1024, gPeakTexturePlainVRAM / 1024, gNumTexturesLoaded);
+
+	SDL_Log("%s: %d frames, %.2f ms/frame avg, %.2f ms/frame in OGL_DrawScene",
+			label, gRenderStatsFrames, frameMS, drawMS);
+
+	if (gVertexBuffersSupported)
+	{
+		SDL_Log("%s: %.1f KB/frame uploaded to vertex buffers",
+				label, gRenderStatsFrames > 0 ? gRenderStatsVertexBytes / 1024.0 / gRenderStatsFrames : 0.0);
+	}
+}
+
+
+/***************** OGL TEXTUREMAP LOAD FROM PNG/JPG **********************/
+
+GLuint OGL_TextureMap_LoadImageFile(const char* partialPath, int* outWidth, int* outHeight, int* outHasAlpha)
+{
+	FSSpec jpgSpec;
+	FSSpec pngSpec;
+	char path[64];
+	bool jpgExists = false;
+	bool pngExists = false;
+	Ptr prefetched = NULL;
+	long prefetchedSize = 0;
+	uint8_t* colorPixels = NULL;
+	int width = 0;
+	int height = 0;
+	uint64_t sourceKey = HASH_BYTES_SEED;
+	GLuint textureName = 0;
+
+	SDL_snprintf(path, sizeof(path), "%s.jpg", partialPath);
+	jpgExists = noErr == FSMakeFSSpec(gDataSpec.vRefNum, gDataSpec.parID, path, &jpgSpec);
+
+	SDL_snprintf(path, sizeof(path), "%s.png", partialPath);
+	pngExists = noErr == FSMakeFSSpec(gDataSpec.vRefNum, gDataSpec.parID, path, &pngSpec);
+
+	// The prefetch thread may have decoded it already (see PrefetchImage).
+	if (jpgExists || pngExists)
+	{
+		prefetched = TakePrefetchedFile(jpgExists ? &jpgSpec : &pngSpec, &prefetchedSize);
+	}
+
+	if (prefetched)
+	{
+		const PrefetchedImageHeader* header = (const PrefetchedImageHeader*) prefetched;
+
+		if (prefetchedSize != (long) sizeof(*header) + header->width * header->height * 4
+			|| header->hasAlpha != (pngExists ? 1 : 0))
+		{
+			// It didn't see the same files as we do, so load them here.
+			SafeDisposePtr(prefetched);
+			prefetched = NULL;
+		}
+	}
+
+	if (prefetched)
+	{
+		const PrefetchedImageHeader* header = (const PrefetchedImageHeader*) prefetched;
+
+		width = header->width;
+		height = header->height;
+		sourceKey = header->sourceKey;
+		colorPixels = (uint8_t*) (prefetched + sizeof(*header));
+	}
+
+	// Try to load a JPEG file first.
+	if (jpgExists && !prefetched)
+	{
+		long jpgLength;
+		SDL_snprintf(path, sizeof(path), "%s.jpg", partialPath);
+		Ptr jpgData = LoadDataFile(path, &jpgLength);
+		GAME_ASSERT(jpgData);
+		sourceKey = HashBytes(sourceKey, jpgData, jpgLength);
+
+		colorPixels = (uint8_t*) stbi_load_from_memory((const stbi_uc*) jpgData, (int) jpgLength, &width, &height, NULL, 4);
+		GAME_ASSERT(colorPixels);
+
+		SafeDisposePtr(jpgData);
+	}
+
+	// Now try to load the PNG version of the same image.
+	// If we've already loaded a JPEG, the PNG is used as an alpha mask.
+	// Otherwise, load the PNG as an RGBA image.
+	if (pngExists && !prefetched)
+	{
+		long pngLength;
+		SDL_snprintf(path, sizeof(path), "%s.png", partialPath);
+		Ptr pngData = LoadDataFile(path, &pngLength);
+		GAME_ASSERT(pngData);
+		sourceKey = HashBytes(sourceKey, pngData, pngLength);
+
+		if (!colorPixels)
+		{
+			// We haven't loaded a JPEG, so the PNG will serve as an RGBA image.
+			colorPixels = (uint8_t*) stbi_load_from_memory((const stbi_uc*) pngData, (int) pngLength, &width, &height, NULL, 4);
+			GAME_ASSERT(colorPixels);
+		}
+		else
+		{
+			int alphaWidth = 0;
+			int alphaHeight = 0;
+
+			// Load PNG as alpha
+			uint8_t* alphaPixels = (uint8_t*) stbi_load_from_memory((const stbi_uc*) pngData, (int) pngLength, &alphaWidth, &alphaHeight, NULL, 1);
+
+			GAME_ASSERT(alphaPixels);
+
+			// Apply alpha channel to existing colorPixels
+			GAME_ASSERT(colorPixels);			// we must have read colors from the JPEG file prior
+
+			if (alphaWidth != width || alphaHeight != height)
+			{
+				DoFatalAlert("%s: PNG mask dimensions must match JPEG file: %s", __func__, path);
+			}
+
+			// Merge alpha into color pixels
+			for (int a = 0, c = 3; a < width * height; a++, c += 4)
+			{
+				colorPixels[c] = alphaPixels[a];
+			}
+
+			SafeDisposePtr(alphaPixels);
+		}
+
+		SafeDisposePtr(pngData);
+	}
+
+	// See if texture file was missing
+	if (!colorPixels)
+	{
+		DoFatalAlert("%s: Texture file missing: %s\n", __func__, partialPath);
+	}
+
+	// Load colorPixels as OpenGL texture
+	OGL_SetTextureCacheSource(partialPath, sourceKey);
+	textureName = OGL_TextureMap_Load(
+			colorPixels,
+			width,
+			height,
+			GL_RGBA,
+			GL_RGBA,
+			GL_UNSIGNED_BYTE);
+	OGL_SetTextureCacheSource(nil, 0);
+
+	OGL_CheckError();
+	GAME_ASSERT(textureName);
+
+	if (prefetched)
+		SafeDisposePtr(prefetched);				// the pixels are in there
+	else
+		SafeDisposePtr(colorPixels);
+
+	if (outWidth) *outWidth = width;
+	if (outHeight) *outHeight = height;
+	if (outHasAlpha) *outHasAlpha = pngExists;
+
+	return textureName;
+}
+
+
+/******************** CONVERT TEXTURE TO GREY **********************/
+//
+// The NTSC luminance standard where grayscale = .299r + .587g + .114b
+//
+
+static void	ConvertTextureToGrey(void *imageMemory, short width, short height, GLint srcFormat, GLint dataType)
+{
+long	x,y;
+float	r,g,b;
+uint32_t	a,q,rq,bq;
+uint32_t   redCal = gGamePrefs.anaglyphCalibrationRed;
+uint32_t   blueCal =  gGamePrefs.anaglyphCalibrationBlue;
+
+
+	if (dataType == GL_UNSIGNED_INT_8_8_8_8_REV)
+	{
+		uint32_t	*pix32 = (uint32_t *)imageMemory;
+		for (y = 0; y < height; y++)
+		{
+			for (x = 0; x < width; x++)
+			{
+				uint32_t	pix = pix32[x];
+
+				r = (float)((pix >> 16) & 0xff) / 255.0f * .299f;
+				g = (float)((pix >> 8) & 0xff) / 255.0f * .586f;
+				b = (float)(pix & 0xff) / 255.0f * .114f;
+				a = (pix >> 24) & 0xff;
+
+
+				q = (r + g + b) * 255.0f;									// pass thru the brightness curve
+				if (q > 0xff)
+					q = 0xff;
+				q = gAnaglyphGreyTable[q];
+
+				rq = (q * redCal) / 0xff;									// balance the red & blue
+				bq = (q * blueCal) / 0xff;
+
+				pix = (a << 24) | (rq << 16) | (q << 8) | bq;
+				pix32[x] = pix;
+			}
+			pix32 += width;
+		}
+	}
+
+	else
+	if ((dataType == GL_UNSIGNED_BYTE) && (srcFormat == GL_RGBA))
+	{
+		uint32_t	*pix32 = (uint32_t *)imageMemory;
+		for (y = 0; y < height; y++)
+		{
+			for (x = 0; x < width; x++)
 			{
 				uint32_t	pix = SwizzleULong(&pix32[x]);
 
@@ -1542,25 +2492,299 @@ uint32_t	a;
 			{
 				uint16_t	pix = pix16[x]; //SwizzleUShort(&pix16[x]);
 
-				r = ((pix >> 10) & 0x1f) << 3;			// load 5 bits per channel & convert to 8 bits
-				g = ((pix >> 5) & 0x1f) << 3;
-				b = (pix & 0x1f) << 3;
-				a = pix & 0x8000;
+				r = ((pix >> 10) & 0x1f) << 3;			// load 5 bits per channel & convert to 8 bits
+				g = ((pix >> 5) & 0x1f) << 3;
+				b = (pix & 0x1f) << 3;
+				a = pix & 0x8000;
+
+				ColorBalanceRGBForAnaglyph(&r, &g, &b, true);
+
+				r >>= 3;
+				g >>= 3;
+				b >>= 3;
+
+				pix = a | (r << 10) | (g << 5) | b;
+				pix16[x] = pix; //SwizzleUShort(&pix);
+
+			}
+			pix16 += width;
+		}
+	}
+
+}
+
+
+#pragma mark -
+
+
+/******************* IS ANAGLYPH SHADER ACTIVE *********************/
+//
+// True if anaglyph colors are being done by the full-screen shader pass,
+// in which case the textures are left untouched and mode/calibration changes
+// don't require anything to be reloaded.
+//
+
+Boolean OGL_IsAnaglyphShaderActive(void)
+{
+	return IsStereoAnaglyph() && gAnaglyphProgram != 0;
+}
+
+
+/******************* INIT ANAGLYPH SHADER *********************/
+//
+// Same math as ColorBalanceRGBForAnaglyph & ConvertTextureToGrey, but done per pixel
+// on the finished frame of each eye.
+//
+
+static void OGL_InitAnaglyphShader(void)
+{
+#ifdef __EMSCRIPTEN__
+	// gl_compat owns the only GLSL program on this platform, so keep converting the textures.
+	SDL_Log("%s: anaglyph textures will be converted at load", __func__);
+#else
+static const char* vertexSource =
+	"void main()\n"
+	"{\n"
+	"	gl_TexCoord[0] = gl_MultiTexCoord0;\n"
+	"	gl_Position = ftransform();\n"
+	"}\n";
+
+static const char* fragmentSource =
+	"uniform sampler2D leftEye;\n"
+	"uniform sampler2D rightEye;\n"
+	"uniform vec3 calibration;\n"
+	"uniform float channelBalancing;\n"
+	"uniform float mono;\n"
+	"\n"
+	"vec3 BalanceColor(vec3 c)\n"
+	"{\n"
+	"	vec3 f = c * calibration * 255.0;\n"
+	"	if (channelBalancing > 0.5)\n"
+	"	{\n"
+	"		float lumR = f.r * .299 + 1.0;\n"
+	"		float lumGB = f.g * .587 + f.b * .114 + 1.0;\n"
+	"		float ratio = lumR / lumGB * 1.5;\n"
+	"		float redRatio = lumGB / lumR * .4;\n"
+	"		f.b = max(f.b, min(f.b * ratio, 255.0));\n"
+	"		f.g = max(f.g, min(f.g * ratio * .8, 255.0));\n"
+	"		f.r = max(f.r, min(f.r * redRatio, 255.0));\n"
+	"	}\n"
+	"	return f / 255.0;\n"
+	"}\n"
+	"\n"
+	"vec3 GreyColor(vec3 c)\n"
+	"{\n"
+	"	float q = sin(min(dot(c, vec3(.299, .586, .114)), 1.0) * 1.5707963);\n"
+	"	return vec3(q * calibration.r, q, q * calibration.b);\n"
+	"}\n"
+	"\n"
+	"void main()\n"
+	"{\n"
+	"	vec3 l = texture2D(leftEye, gl_TexCoord[0].st).rgb;\n"
+	"	vec3 r = texture2D(rightEye, gl_TexCoord[0].st).rgb;\n"
+	"	if (mono > 0.5)\n"
+	"		gl_FragColor = vec4(GreyColor(l).r, 0.0, GreyColor(r).b, 1.0);\n"
+	"	else\n"
+	"		gl_FragColor = vec4(BalanceColor(l).r, BalanceColor(r).gb, 1.0);\n"
+	"}\n";
+
+GLuint	vs, fs, program;
+GLint	ok;
+
+			/* GET GL PROCEDURES */
+
+	gAnaglyphGL.CreateShader		= (PFNGLCREATESHADERPROC)		SDL_GL_GetProcAddress("glCreateShader");
+	gAnaglyphGL.ShaderSource		= (PFNGLSHADERSOURCEPROC)		SDL_GL_GetProcAddress("glShaderSource");
+	gAnaglyphGL.CompileShader		= (PFNGLCOMPILESHADERPROC)		SDL_GL_GetProcAddress("glCompileShader");
+	gAnaglyphGL.GetShaderiv			= (PFNGLGETSHADERIVPROC)		SDL_GL_GetProcAddress("glGetShaderiv");
+	gAnaglyphGL.DeleteShader		= (PFNGLDELETESHADERPROC)		SDL_GL_GetProcAddress("glDeleteShader");
+	gAnaglyphGL.CreateProgram		= (PFNGLCREATEPROGRAMPROC)		SDL_GL_GetProcAddress("glCreateProgram");
+	gAnaglyphGL.AttachShader		= (PFNGLATTACHSHADERPROC)		SDL_GL_GetProcAddress("glAttachShader");
+	gAnaglyphGL.LinkProgram			= (PFNGLLINKPROGRAMPROC)		SDL_GL_GetProcAddress("glLinkProgram");
+	gAnaglyphGL.GetProgramiv		= (PFNGLGETPROGRAMIVPROC)		SDL_GL_GetProcAddress("glGetProgramiv");
+	gAnaglyphGL.DeleteProgram		= (PFNGLDELETEPROGRAMPROC)		SDL_GL_GetProcAddress("glDeleteProgram");
+	gAnaglyphGL.UseProgram			= (PFNGLUSEPROGRAMPROC)			SDL_GL_GetProcAddress("glUseProgram");
+	gAnaglyphGL.GetUniformLocation	= (PFNGLGETUNIFORMLOCATIONPROC)	SDL_GL_GetProcAddress("glGetUniformLocation");
+	gAnaglyphGL.Uniform1i			= (PFNGLUNIFORM1IPROC)			SDL_GL_GetProcAddress("glUniform1i");
+	gAnaglyphGL.Uniform1f			= (PFNGLUNIFORM1FPROC)			SDL_GL_GetProcAddress("glUniform1f");
+	gAnaglyphGL.Uniform3f			= (PFNGLUNIFORM3FPROC)			SDL_GL_GetProcAddress("glUniform3f");
+
+	for (size_t i = 0; i < sizeof(gAnaglyphGL) / sizeof(void*); i++)
+	{
+		if (((void**) &gAnaglyphGL)[i] == nil)
+		{
+			SDL_Log("%s: no GLSL support, anaglyph textures will be converted at load", __func__);
+			return;
+		}
+	}
+
+
+			/* COMPILE & LINK */
+
+	vs = gAnaglyphGL.CreateShader(GL_VERTEX_SHADER);
+	gAnaglyphGL.ShaderSource(vs, 1, &vertexSource, nil);
+	gAnaglyphGL.CompileShader(vs);
+
+	fs = gAnaglyphGL.CreateShader(GL_FRAGMENT_SHADER);
+	gAnaglyphGL.ShaderSource(fs, 1, &fragmentSource, nil);
+	gAnaglyphGL.CompileShader(fs);
+
+	program = gAnaglyphGL.CreateProgram();
+	gAnaglyphGL.AttachShader(program, vs);
+	gAnaglyphGL.AttachShader(program, fs);
+	gAnaglyphGL.LinkProgram(program);
+
+	gAnaglyphGL.DeleteShader(vs);							// the program keeps them alive
+	gAnaglyphGL.DeleteShader(fs);
+
+	gAnaglyphGL.GetProgramiv(program, GL_LINK_STATUS, &ok);
+	if (!ok || OGL_CheckError())
+	{
+		SDL_Log("%s: couldn't build the anaglyph shader, textures will be converted at load", __func__);
+		gAnaglyphGL.DeleteProgram(program);
+		return;
+	}
+
+
+			/* BIND THE EYES TO TEXTURE UNITS 0 & 1 */
+
+	gAnaglyphGL.UseProgram(program);
+	gAnaglyphGL.Uniform1i(gAnaglyphGL.GetUniformLocation(program, "leftEye"), 0);
+	gAnaglyphGL.Uniform1i(gAnaglyphGL.GetUniformLocation(program, "rightEye"), 1);
+	gAnaglyphGL.UseProgram(0);
+
+	gAnaglyphUniform_Calibration		= gAnaglyphGL.GetUniformLocation(program, "calibration");
+	gAnaglyphUniform_ChannelBalancing	= gAnaglyphGL.GetUniformLocation(program, "channelBalancing");
+	gAnaglyphUniform_Mono				= gAnaglyphGL.GetUniformLocation(program, "mono");
+
+	gAnaglyphProgram = program;
+#endif
+}
+
+
+/******************* DISPOSE ANAGLYPH SHADER *********************/
+
+static void OGL_DisposeAnaglyphShader(void)
+{
+	if (gAnaglyphEyeTexture[0])
+	{
+		glDeleteTextures(2, gAnaglyphEyeTexture);
+		gAnaglyphEyeTexture[0] = gAnaglyphEyeTexture[1] = 0;
+		gAnaglyphEyeTextureWidth = gAnaglyphEyeTextureHeight = 0;
+	}
+
+#ifndef __EMSCRIPTEN__
+	if (gAnaglyphProgram)
+	{
+		gAnaglyphGL.DeleteProgram(gAnaglyphProgram);
+		gAnaglyphProgram = 0;
+	}
+#endif
+}
+
+
+/******************* CAPTURE ANAGLYPH EYE *********************/
+//
+// Copies the frame that was just drawn for one eye into that eye's texture.
+//
+
+static void OGL_CaptureAnaglyphEye(int eye)
+{
+int	w = gGameWindowWidth;
+int	h = gGameWindowHeight;
+
+	glPushAttrib(GL_TEXTURE_BIT);							// don't disturb the texture the materials think is bound
+
+			/* (RE)ALLOCATE EYE TEXTURES IF WINDOW WAS RESIZED */
+
+	if (w != gAnaglyphEyeTextureWidth || h != gAnaglyphEyeTextureHeight)
+	{
+		if (!gAnaglyphEyeTexture[0])
+			glGenTextures(2, gAnaglyphEyeTexture);
+
+		for (int i = 0; i < 2; i++)
+		{
+			glBindTexture(GL_TEXTURE_2D, gAnaglyphEyeTexture[i]);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, w, h, 0, GL_RGB, GL_UNSIGNED_BYTE, nil);
+		}
+
+		if (OGL_CheckError())
+			DoFatalAlert("OGL_CaptureAnaglyphEye: couldn't allocate eye textures");
+
+		gAnaglyphEyeTextureWidth = w;
+		gAnaglyphEyeTextureHeight = h;
+	}
+
+			/* COPY BACK BUFFER */
+
+	glBindTexture(GL_TEXTURE_2D, gAnaglyphEyeTexture[eye]);
+	glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, w, h);
+
+	glPopAttrib();
+}
+
+
+/******************* DRAW ANAGLYPH COMPOSITE *********************/
+//
+// Covers the whole window with the red/cyan (or red/blue) mix of both eyes,
+// using the current calibration prefs.
+//
+
+static void OGL_DrawAnaglyphComposite(void)
+{
+#ifndef __EMSCRIPTEN__
+	glPushAttrib(GL_ALL_ATTRIB_BITS);
+
+	glDisable(GL_ALPHA_TEST);
+	glDisable(GL_BLEND);
+	glDisable(GL_CULL_FACE);
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_FOG);
+	glDisable(GL_LIGHTING);
+	glDisable(GL_SCISSOR_TEST);
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	glViewport(0, 0, gGameWindowWidth, gGameWindowHeight);
+
+	glMatrixMode(GL_PROJECTION);
+	glPushMatrix();
+	glLoadIdentity();
+	glMatrixMode(GL_MODELVIEW);
+	glPushMatrix();
+	glLoadIdentity();
+
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_2D, gAnaglyphEyeTexture[1]);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, gAnaglyphEyeTexture[0]);
 
-				ColorBalanceRGBForAnaglyph(&r, &g, &b, true);
+	gAnaglyphGL.UseProgram(gAnaglyphProgram);
+	gAnaglyphGL.Uniform3f(gAnaglyphUniform_Calibration,
+						gGamePrefs.anaglyphCalibrationRed / 255.0f,
+						gGamePrefs.anaglyphCalibrationGreen / 255.0f,
+						gGamePrefs.anaglyphCalibrationBlue / 255.0f);
+	gAnaglyphGL.Uniform1f(gAnaglyphUniform_ChannelBalancing, gGamePrefs.doAnaglyphChannelBalancing ? 1.0f : 0.0f);
+	gAnaglyphGL.Uniform1f(gAnaglyphUniform_Mono, IsStereoAnaglyphMono() ? 1.0f : 0.0f);
 
-				r >>= 3;
-				g >>= 3;
-				b >>= 3;
+	glBegin(GL_QUADS);
+	glTexCoord2f(0, 0);		glVertex2f(-1, -1);
+	glTexCoord2f(1, 0);		glVertex2f( 1, -1);
+	glTexCoord2f(1, 1);		glVertex2f( 1,  1);
+	glTexCoord2f(0, 1);		glVertex2f(-1,  1);
+	glEnd();
 
-				pix = a | (r << 10) | (g << 5) | b;
-				pix16[x] = pix; //SwizzleUShort(&pix);
+	gAnaglyphGL.UseProgram(0);
 
-			}
-			pix16 += width;
-		}
-	}
+	glMatrixMode(GL_PROJECTION);
+	glPopMatrix();
+	glMatrixMode(GL_MODELVIEW);
+	glPopMatrix();
 
+	glPopAttrib();
+#endif
 }
 
 
@@ -1769,6 +2993,100 @@ OGLLightDefType	*lights;
 
 
 
+#pragma mark - Occlusion queries
+
+
+/******************** OGL: NEW OCCLUSION QUERY ********************/
+//
+// Returns 0 if the driver can't do occlusion queries.
+//
+
+GLuint OGL_NewOcclusionQuery(void)
+{
+GLuint	query = 0;
+
+#ifndef __EMSCRIPTEN__
+	if (gOcclusionQueriesSupported)
+		gOcclusionQueryGL.GenQueries(1, &query);
+#endif
+
+	return query;
+}
+
+
+/******************** OGL: DISPOSE OCCLUSION QUERY ********************/
+
+void OGL_DisposeOcclusionQuery(GLuint *query)
+{
+#ifndef __EMSCRIPTEN__
+	if (*query)
+		gOcclusionQueryGL.DeleteQueries(1, query);
+#endif
+
+	*query = 0;
+}
+
+
+/******************** OGL: BEGIN OCCLUSION QUERY ********************/
+//
+// Counts the samples that pass the depth test until OGL_EndOcclusionQuery.
+// Color writes are off in between: whatever is drawn is only a probe.
+//
+
+void OGL_BeginOcclusionQuery(GLuint query)
+{
+	GAME_ASSERT(query);
+
+#ifndef __EMSCRIPTEN__
+	glGetBooleanv(GL_COLOR_WRITEMASK, gOcclusionQuerySavedColorMask);		// the anaglyph passes mask some channels
+	glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+
+	gOcclusionQueryGL.BeginQuery(GL_SAMPLES_PASSED, query);
+#endif
+}
+
+
+/******************** OGL: END OCCLUSION QUERY ********************/
+
+void OGL_EndOcclusionQuery(void)
+{
+#ifndef __EMSCRIPTEN__
+	gOcclusionQueryGL.EndQuery(GL_SAMPLES_PASSED);
+
+	glColorMask(gOcclusionQuerySavedColorMask[0], gOcclusionQuerySavedColorMask[1],
+				gOcclusionQuerySavedColorMask[2], gOcclusionQuerySavedColorMask[3]);
+#endif
+}
+
+
+/******************** OGL: GET OCCLUSION QUERY RESULT ********************/
+//
+// Never waits for the GPU: returns false if the result isn't in yet,
+// so callers should issue a query and read it back a frame or so later.
+//
+
+Boolean OGL_GetOcclusionQueryResult(GLuint query, GLuint *samplesPassed)
+{
+#ifndef __EMSCRIPTEN__
+GLuint	available = 0;
+
+	if (!query)
+		return false;
+
+	gOcclusionQueryGL.GetQueryObjectuiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+	if (!available)
+		return false;
+
+	gOcclusionQueryGL.GetQueryObjectuiv(query, GL_QUERY_RESULT, samplesPassed);
+	return true;
+#else
+	(void) query;
+	(void) samplesPassed;
+	return false;
+#endif
+}
+
+
 #pragma mark -
 
 
@@ -2210,11 +3528,46 @@ static void OGL_InitVertexArrayMemory(void)
 
 		/* ALLOCATE MASTER BLOCK FOR NON-"USER" V.A.R. TYPES */
 
+	int prevTag = SetMemoryTag(MEMORY_TAG_VAR);
+
 	for (int i = 0; i < VERTEX_ARRAY_RANGE_TYPE_USER1; i++)
 	{
 		gVertexArrayMemoryBlock[i] = AllocPtrClear(OGL_MaxMemForVARType(i));
 	}
 
+	SetMemoryTag(prevTag);
+
+
+		/* CREATE A BUFFER OBJECT FOR EACH MASTER BLOCK */
+
+	SDL_zeroa(gVertexBuffers);
+
+#ifndef __EMSCRIPTEN__
+	if (gVertexBuffersSupported)
+	{
+		for (int i = 0; i < VERTEX_ARRAY_RANGE_TYPE_USER1; i++)
+		{
+			gVertexBufferGL.GenBuffers(1, &gVertexBuffers[i].name);
+
+			switch(i)
+			{
+				case	VERTEX_ARRAY_RANGE_TYPE_TERRAIN:
+				case	VERTEX_ARRAY_RANGE_TYPE_BG3DMODELS:
+				case	VERTEX_ARRAY_RANGE_TYPE_FOLIAGE:
+						gVertexBuffers[i].isDynamic = false;
+						break;
+
+				default:
+						gVertexBuffers[i].isDynamic = true;
+			}
+		}
+	}
+#endif
+
+	gCurrentVertexBufferType	= -1;
+	gBoundArrayBuffer			= 0;
+	gBoundElementArrayBuffer	= 0;
+
 #if VERTEXARRAYRANGES
 			/* GENERATE VERTEX ARRAY OBJECTS */
 
@@ -2266,6 +3619,23 @@ static void OGL_DisableVertexArrayRanges(void)
 	glDeleteVertexArraysAPPLE(NUM_VERTEX_ARRAY_RANGES, gVertexArrayRangeObjects);
 #endif
 
+				/* DELETE THE BUFFER OBJECTS */
+
+#ifndef __EMSCRIPTEN__
+	if (gVertexBuffersSupported)
+	{
+		OGL_EndVertexArrayBuffer();
+
+		for (int i = 0; i < VERTEX_ARRAY_RANGE_TYPE_USER1; i++)
+		{
+			if (gVertexBuffers[i].name)
+				gVertexBufferGL.DeleteBuffers(1, &gVertexBuffers[i].name);
+		}
+	}
+#endif
+
+	SDL_zeroa(gVertexBuffers);
+
 
 				/* FREE UP THE MEMORY */
 				// Only for non-"User" types. "User" types don't have allocated memory.
@@ -2294,6 +3664,23 @@ static void OGL_DisableVertexArrayRanges(void)
 
 void *OGL_AllocVertexArrayMemory(long size, Byte type)
 {
+void	*pointer = OGL_TryAllocVertexArrayMemory(size, type);
+
+	if (!pointer)
+		DoFatalAlert("OGL_AllocVertexArrayMemory:  Master Block is full! Type %d", type);
+
+	return(pointer);
+}
+
+
+/********************* OGL TRY ALLOC VERTEX ARRAY MEMORY *********************/
+//
+// Same as above, but returns nil if the master block is full so that the caller
+// can fall back on regular memory.
+//
+
+void *OGL_TryAllocVertexArrayMemory(long size, Byte type)
+{
 VertexArrayMemoryNode	*scanNode, *newNode;
 Ptr			prevEndPtr;
 
@@ -2309,7 +3696,9 @@ Ptr			prevEndPtr;
 	size = (size + 15) & 0xfffffff0;
 
 
+	int prevTag		= SetMemoryTag(MEMORY_TAG_VAR);
 	newNode 		= AllocPtrClear(sizeof(VertexArrayMemoryNode));	// allocate the node (assume we'll find room for it below)
+	SetMemoryTag(prevTag);
 	newNode->size 	= size;											// remember how big a chunk we're allocating
 
 	scanNode = 	gVertexArrayMemory_Head[type];						// start scanning @ front
@@ -2377,9 +3766,6 @@ Ptr			prevEndPtr;
 	if (((uintptr_t) prevEndPtr + size) >= ((uintptr_t) (gVertexArrayMemoryBlock[type]) + OGL_MaxMemForVARType(type)))		// would this allocation go over our master block's range?
 	{
 		SafeDisposePtr(newNode);
-
-		DoFatalAlert("OGL_AllocVertexArrayMemory:  Master Block is full! Type %d", type);
-
 		return(nil);
 	}
 
@@ -2396,6 +3782,9 @@ Ptr			prevEndPtr;
 
 
 got_it:
+	gVertexBuffers[type].usedSize = gVertexArrayMemory_Tail[type]->pointer + gVertexArrayMemory_Tail[type]->size - gVertexArrayMemoryBlock[type];
+	OGL_SetVertexArrayMemoryDirty(newNode->pointer, size, type);						// caller is about to fill it in
+
 #if VERTEXARRAYRANGES
 	gVertexArrayRangeUsed[type] = true;																					// memory has been allocated, so mark this type as used
 	gVertexArrayRangeSize[type] = (uintptr_t)gVertexArrayMemory_Tail[type]->pointer + gVertexArrayMemory_Tail[type]->size - (uintptr_t)gVertexArrayMemoryBlock[type];	// calc the total size of the memory block we're using
@@ -2447,6 +3836,10 @@ VertexArrayMemoryNode	*scanNode, *prev, *next;
 
 			SafeDisposePtr(scanNode);							// delete the node
 
+			if (gVertexArrayMemory_Tail[type])					// the buffer object only needs to cover up to the last node
+				gVertexBuffers[type].usedSize = gVertexArrayMemory_Tail[type]->pointer + gVertexArrayMemory_Tail[type]->size - gVertexArrayMemoryBlock[type];
+			else
+				gVertexBuffers[type].usedSize = 0;
 
 #if VERTEXARRAYRANGES
 					/* IS IT ALL FREED UP? */
@@ -2514,16 +3907,276 @@ void ReleaseVertexArrayRangeMemory(Byte type)
 
 void OGL_SetVertexArrayRangeDirty(short buffer)
 {
-#if VERTEXARRAYRANGES
 	if (buffer < 0)		// ignore -1
 		return;
 
 	GAME_ASSERT(buffer < NUM_VERTEX_ARRAY_RANGES);
 
+	if (buffer < VERTEX_ARRAY_RANGE_TYPE_USER1)
+		gVertexBuffers[buffer].allDirty = true;
+
+#if VERTEXARRAYRANGES
 	gForceVertexArrayUpdate[buffer] = true;
 #endif
 }
 
+
+/********************* OGL:  SET VERTEX ARRAY MEMORY DIRTY ***************************/
+//
+// Like OGL_SetVertexArrayRangeDirty, but only the given bytes need to be sent again.
+// Use this for static data that's rebuilt piecemeal (e.g. terrain supertiles).
+//
+
+void OGL_SetVertexArrayMemoryDirty(const void *pointer, long size, short type)
+{
+VertexBufferType	*vb;
+size_t				start, end;
+
+	if (!gVARMemoryAllocated || type < 0 || type >= VERTEX_ARRAY_RANGE_TYPE_USER1)
+		return;
+
+	vb = &gVertexBuffers[type];
+	if (vb->allDirty || vb->isDynamic)					// dynamic buffers are always sent whole
+	{
+		vb->allDirty = true;
+		return;
+	}
+
+	start	= (const char *) pointer - gVertexArrayMemoryBlock[type];
+	end		= start + size;
+	GAME_ASSERT(end <= (size_t) OGL_MaxMemForVARType(type));
+
+
+			/* MERGE WITH AN OVERLAPPING OR ADJACENT RANGE */
+
+	for (int i = 0; i < vb->numDirtyRanges; i++)
+	{
+		VertexBufferRange *range = &vb->dirtyRanges[i];
+
+		if (start <= range->end && end >= range->start)
+		{
+			range->start	= SDL_min(range->start, start);
+			range->end		= SDL_max(range->end, end);
+			return;
+		}
+	}
+
+
+			/* ADD A NEW RANGE, OR GIVE UP AND SEND EVERYTHING */
+
+	if (vb->numDirtyRanges >= MAX_VERTEX_BUFFER_DIRTY_RANGES)
+	{
+		vb->allDirty = true;
+		vb->numDirtyRanges = 0;
+		return;
+	}
+
+	vb->dirtyRanges[vb->numDirtyRanges].start	= start;
+	vb->dirtyRanges[vb->numDirtyRanges].end		= end;
+	vb->numDirtyRanges++;
+}
+
+
+/********************* OGL:  FLUSH VERTEX BUFFER ***************************/
+//
+// Sends whatever changed in a master block to its buffer object.
+//
+
+static void OGL_FlushVertexBuffer(Byte type)
+{
+#ifndef __EMSCRIPTEN__
+VertexBufferType	*vb = &gVertexBuffers[type];
+const char			*block = gVertexArrayMemoryBlock[type];
+
+	if (!vb->allDirty && vb->numDirtyRanges == 0)
+		return;
+
+	if (vb->usedSize == 0)
+		goto done;
+
+	gVertexBufferGL.BindBuffer(GL_ARRAY_BUFFER, vb->name);
+	gBoundArrayBuffer = vb->name;
+
+
+			/* DYNAMIC: RE-SPECIFY THE WHOLE THING */
+			//
+			// The driver can give us new storage instead of waiting
+			// on draws that still use the old contents.
+			//
+
+	if (vb->isDynamic)
+	{
+		gVertexBufferGL.BufferData(GL_ARRAY_BUFFER, vb->usedSize, block, GL_STREAM_DRAW);
+		vb->storageSize = vb->usedSize;
+		gRenderStatsVertexBytes += vb->usedSize;
+	}
+
+
+			/* STATIC: GROW THE STORAGE IF NEEDED */
+
+	else
+	if (vb->usedSize > vb->storageSize)
+	{
+		vb->storageSize = (vb->usedSize + VERTEX_BUFFER_GROW_SIZE - 1) & ~(size_t)(VERTEX_BUFFER_GROW_SIZE - 1);
+		vb->storageSize = SDL_min(vb->storageSize, (size_t) OGL_MaxMemForVARType(type));
+
+		gVertexBufferGL.BufferData(GL_ARRAY_BUFFER, vb->storageSize, nil, GL_STATIC_DRAW);
+		gVertexBufferGL.BufferSubData(GL_ARRAY_BUFFER, 0, vb->usedSize, block);
+		gRenderStatsVertexBytes += vb->usedSize;
+	}
+
+
+			/* STATIC: SEND ONLY WHAT CHANGED */
+
+	else
+	if (vb->allDirty)
+	{
+		gVertexBufferGL.BufferSubData(GL_ARRAY_BUFFER, 0, vb->usedSize, block);
+		gRenderStatsVertexBytes += vb->usedSize;
+	}
+	else
+	{
+		for (int i = 0; i < vb->numDirtyRanges; i++)
+		{
+			size_t start	= vb->dirtyRanges[i].start;
+			size_t end		= SDL_min(vb->dirtyRanges[i].end, vb->usedSize);
+
+			if (start < end)
+			{
+				gVertexBufferGL.BufferSubData(GL_ARRAY_BUFFER, start, end - start, block + start);
+				gRenderStatsVertexBytes += end - start;
+			}
+		}
+	}
+
+	if (OGL_CheckError())
+		DoFatalAlert("OGL_FlushVertexBuffer: error!");
+
+done:
+	vb->allDirty = false;
+	vb->numDirtyRanges = 0;
+#else
+	(void) type;
+#endif
+}
+
+
+/********************* OGL:  BEGIN VERTEX ARRAY BUFFER ***************************/
+//
+// Call before setting up the arrays of geometry that lives in VAR memory of the given type.
+// Brings the type's buffer object up to date; then OGL_VertexArrayOffset and
+// OGL_ElementArrayOffset turn the geometry's pointers into offsets in that buffer.
+//
+
+void OGL_BeginVertexArrayBuffer(short varType)
+{
+	gCurrentVertexBufferType = -1;
+
+	if (!gVertexBuffersSupported || !gVARMemoryAllocated)
+		return;
+
+	if (varType < 0 || varType >= VERTEX_ARRAY_RANGE_TYPE_USER1)		// "User" types aren't in our master blocks
+		return;
+
+	OGL_FlushVertexBuffer(varType);
+
+	gCurrentVertexBufferType = varType;
+}
+
+
+/********************* OGL:  VERTEX ARRAY OFFSET ***************************/
+//
+// Returns what to pass to gl*Pointer for this array, and binds GL_ARRAY_BUFFER to match.
+// Anything outside the current master block is passed through as a client-side pointer.
+//
+
+const GLvoid *OGL_VertexArrayOffset(const void *pointer)
+{
+#ifndef __EMSCRIPTEN__
+GLuint		name = 0;
+ptrdiff_t	offset = 0;
+
+	if (gCurrentVertexBufferType >= 0)
+	{
+		const VertexBufferType *vb = &gVertexBuffers[gCurrentVertexBufferType];
+
+		offset = (const char *) pointer - gVertexArrayMemoryBlock[gCurrentVertexBufferType];
+		if (offset >= 0 && (size_t) offset < vb->usedSize)
+			name = vb->name;
+	}
+
+	if (name != gBoundArrayBuffer)
+	{
+		gVertexBufferGL.BindBuffer(GL_ARRAY_BUFFER, name);
+		gBoundArrayBuffer = name;
+	}
+
+	if (name)
+		return (const GLvoid *) offset;
+#endif
+
+	return pointer;
+}
+
+
+/********************* OGL:  ELEMENT ARRAY OFFSET ***************************/
+//
+// Same as OGL_VertexArrayOffset, for the indices passed to glDrawElements.
+//
+
+const GLvoid *OGL_ElementArrayOffset(const void *pointer)
+{
+#ifndef __EMSCRIPTEN__
+GLuint		name = 0;
+ptrdiff_t	offset = 0;
+
+	if (gCurrentVertexBufferType >= 0)
+	{
+		const VertexBufferType *vb = &gVertexBuffers[gCurrentVertexBufferType];
+
+		offset = (const char *) pointer - gVertexArrayMemoryBlock[gCurrentVertexBufferType];
+		if (offset >= 0 && (size_t) offset < vb->usedSize)
+			name = vb->name;
+	}
+
+	if (name != gBoundElementArrayBuffer)
+	{
+		gVertexBufferGL.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, name);
+		gBoundElementArrayBuffer = name;
+	}
+
+	if (name)
+		return (const GLvoid *) offset;
+#endif
+
+	return pointer;
+}
+
+
+/********************* OGL:  END VERTEX ARRAY BUFFER ***************************/
+//
+// Unbinds the buffer objects so that client-side arrays work again.
+//
+
+void OGL_EndVertexArrayBuffer(void)
+{
+#ifndef __EMSCRIPTEN__
+	if (gBoundArrayBuffer)
+	{
+		gVertexBufferGL.BindBuffer(GL_ARRAY_BUFFER, 0);
+		gBoundArrayBuffer = 0;
+	}
+
+	if (gBoundElementArrayBuffer)
+	{
+		gVertexBufferGL.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+		gBoundElementArrayBuffer = 0;
+	}
+#endif
+
+	gCurrentVertexBufferType = -1;
+}
+
 /********************* OGL:  UPDATE VERTEX ARRAY RANGE ***************************/
 //
 // This function is called before each render loop to see if the Vertex Array Range needs to be updated
@@ -2660,6 +4313,9 @@ static long OGL_MaxMemForVARType(Byte varType)
 		case	VERTEX_ARRAY_RANGE_TYPE_TERRAIN:
 				return(8000000);
 
+		case	VERTEX_ARRAY_RANGE_TYPE_FOLIAGE:
+				return(6000000);
+
 		case	VERTEX_ARRAY_RANGE_TYPE_ZAPS1:
 		case	VERTEX_ARRAY_RANGE_TYPE_ZAPS2:
 				return(300000);
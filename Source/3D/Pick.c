@@ -62,6 +62,15 @@ static Boolean OGL_DoesSkeletonIntersectSphere(const OGLBoundingSphere *sphere,
 static Boolean	OGL_DoesSphereIntersectMesh(const OGLBoundingSphere *sphere, const MOVertexArrayData *mesh);
 static Boolean OGL_DoesDisplayGroupIntersectSphere(const OGLBoundingSphere *sphere, ObjNode *theNode);
 
+static Boolean SpherePickObjNode(const OGLBoundingSphere *sphere, uint32_t statusFilter, uint32_t cTypes,
+								int gridX, int gridY, int gridZ, ObjNode *thisNodePtr);
+static Boolean IsEarlierInSlot(const ObjNode *a, const ObjNode *b);
+
+static Boolean TraceTerrainHeightfield(const OGLPoint3D *origin, const OGLVector3D *dir, float tMin, float tMax, Boolean doubleSided,
+										float *tHit, OGLVector3D *hitNormal);
+static Boolean IntersectTerrainTile(long row, long col, const OGLPoint3D *origin, const OGLVector3D *dir, float tMin, float tMax,
+									Boolean doubleSided, float *tHit, OGLVector3D *hitNormal);
+
 
 
 /****************************/
@@ -73,6 +82,36 @@ static Boolean OGL_DoesDisplayGroupIntersectSphere(const OGLBoundingSphere *sphe
 
 #define	GRID_SKIP_RANGE		2						// how many grid units away to just skip collisions between objects
 
+#define	TERRAIN_PICK_EPS	.001f					// fraction of a tile's size that we allow a hit to be outside of a triangle
+
+#define	MAX_PICK_CANDIDATES	256						// objects from the object tree that fit on the stack; more go in a heap buffer
+
+
+typedef struct										// state for OGL_DoLineSegmentCollision_ObjNodes
+{
+	const OGLLineSegment	*lineSeg;
+	OGLVector3D				segVec;
+	uint32_t				statusFilter, cTypes;
+	Boolean					allowBBoxTests;
+	int						gridX1, gridY1, gridZ1, gridX2, gridY2, gridZ2;
+
+	ObjNode					*bestObj;
+	float					bestDist;
+	OGLPoint3D				*worldHitCoord;
+	OGLVector3D				*worldHitFaceNormal;
+}LineSegPickType;
+
+static void LineSegPickObjNode(LineSegPickType *pick, ObjNode *thisNodePtr);
+
+
+typedef struct										// state for walking a line thru a grid of square cells on the x/z plane
+{
+	long	col,row;
+	long	stepCol,stepRow;
+	float	tNextCol,tNextRow;						// line parameter at which we cross into the next col/row
+	float	tDeltaCol,tDeltaRow;					// line parameter between col/row crossings
+}GridWalkType;
+
 
 /*********************/
 /*    VARIABLES      */
@@ -192,59 +231,20 @@ next:
 
 Boolean OGL_DoRayCollision_Terrain(OGLRay *ray, OGLPoint3D *worldHitCoord, OGLVector3D *terrainNormal)
 {
-short	i;
-MOVertexArrayData	*mesh;
-Boolean				hit, returnTrue = false;
-OGLPoint3D			origin, sphereHitPt, hitCoord;
-OGLVector3D			hitNormal;
-float				radius;
-float				bestDist = 1000000;
-
-	radius = gTerrainSuperTileUnitSize * .5f;									// set the bounding sphere radius for all supertiles
-
-
-	for (i = 0; i < MAX_SUPERTILES; i++)
-	{
-		if (gSuperTileMemoryList[i].mode == SUPERTILE_MODE_FREE)				// look for used / active supertiles
-			continue;
-
-			/* DOES RAY INTERSECT THIS SUPERTILE'S BOUNDING SPEHRE? */
+float		t;
+OGLVector3D	hitNormal;
 
-		origin.x = gSuperTileMemoryList[i].x;									// get b-sphere coords
-		origin.y = gSuperTileMemoryList[i].y;
-		origin.z = gSuperTileMemoryList[i].z;
-
-		hit = OGL_DoesRayIntersectSphere(ray, &origin, radius, &sphereHitPt);	// see if ray hits sphere
-		if (hit)
-		{
-				/* SEE IF RAY HIT ANY SUPERTILE TRIANGLES */
-
-			mesh = gSuperTileMemoryList[i].meshData;							// get ptr to supertile's mesh data
-
-			hit = OGL_DoesRayIntersectMesh(ray, mesh, &hitCoord, &hitNormal);
-			if (hit)
-			{
-
-						/* IS THIS THE CLOSEST HIT? */
-
-				if (ray->distance < bestDist)
-				{
-							/* REMEMBER THIS HIT AS THE BEST SO FAR */
-
-					bestDist = ray->distance;
-					*worldHitCoord = hitCoord;
-					if (terrainNormal)
-						*terrainNormal = hitNormal;
-					returnTrue = true;
-				}
-			}
-		}
-	}
+	if (!TraceTerrainHeightfield(&ray->origin, &ray->direction, 0, 1000000, true, &t, &hitNormal))
+		return(false);
 
-	if (returnTrue)
-		ray->distance = bestDist;							// return the distance to the best hit
+	worldHitCoord->x = ray->origin.x + ray->direction.x * t;
+	worldHitCoord->y = ray->origin.y + ray->direction.y * t;
+	worldHitCoord->z = ray->origin.z + ray->direction.z * t;
+	if (terrainNormal)
+		*terrainNormal = hitNormal;
 
-	return(returnTrue);
+	ray->distance = t;									// return the distance to the hit
+	return(true);
 }
 
 
@@ -805,14 +805,19 @@ ObjNode *OGL_DoLineSegmentCollision_ObjNodes(const OGLLineSegment *lineSeg, uint
 											 OGLPoint3D *worldHitCoord, OGLVector3D *worldHitFaceNormal, float *distToHit,
 											 Boolean allowBBoxTests)
 {
-ObjNode		*thisNodePtr;
-ObjNode		*bestObj = nil;
-float		bestDist = 10000000;
-OGLPoint3D	hitPt;
-OGLVector3D	segVec, hitNormal;
-float		hitDist;
-int			gridX1, gridX2, gridY1, gridY2, gridZ1, gridZ2;
-Boolean		hit;
+LineSegPickType	pick;
+ObjNode			*candidateBuffer[MAX_PICK_CANDIDATES];
+ObjNode			**candidates = candidateBuffer;
+int				numCandidates;
+
+	pick.lineSeg		= lineSeg;
+	pick.statusFilter	= statusFilter;
+	pick.cTypes			= cTypes;
+	pick.allowBBoxTests	= allowBBoxTests;
+	pick.bestObj		= nil;
+	pick.bestDist		= 10000000;
+	pick.worldHitCoord	= worldHitCoord;
+	pick.worldHitFaceNormal = worldHitFaceNormal;
 
 			/* CALC GRID COORDS OF ENDPOINTS */
 			//
@@ -826,124 +831,148 @@ Boolean		hit;
 
 //	if (allowBBoxTests)
 	{
-		gridX1 = (int)lineSeg->p1.x / GRID_SIZE;
-		gridY1 = (int)lineSeg->p1.y / GRID_SIZE;
-		gridZ1 = (int)lineSeg->p1.z / GRID_SIZE;
+		pick.gridX1 = (int)lineSeg->p1.x / GRID_SIZE;
+		pick.gridY1 = (int)lineSeg->p1.y / GRID_SIZE;
+		pick.gridZ1 = (int)lineSeg->p1.z / GRID_SIZE;
 
-		gridX2 = (int)lineSeg->p2.x / GRID_SIZE;
-		gridY2 = (int)lineSeg->p2.y / GRID_SIZE;
-		gridZ2 = (int)lineSeg->p2.z / GRID_SIZE;
+		pick.gridX2 = (int)lineSeg->p2.x / GRID_SIZE;
+		pick.gridY2 = (int)lineSeg->p2.y / GRID_SIZE;
+		pick.gridZ2 = (int)lineSeg->p2.z / GRID_SIZE;
 	}
 
 			/* CALCULATE THE LINE SEGMENT VECTOR */
 
-	segVec.x = lineSeg->p2.x - lineSeg->p1.x;
-	segVec.y = lineSeg->p2.y - lineSeg->p1.y;
-	segVec.z = lineSeg->p2.z - lineSeg->p1.z;
-	OGLVector3D_Normalize(&segVec, &segVec);
+	pick.segVec.x = lineSeg->p2.x - lineSeg->p1.x;
+	pick.segVec.y = lineSeg->p2.y - lineSeg->p1.y;
+	pick.segVec.z = lineSeg->p2.z - lineSeg->p1.z;
+	OGLVector3D_Normalize(&pick.segVec, &pick.segVec);
 
 
-			/******************************************/
-			/* TEST LINE SEGMENT AGAINST ALL OBJNODES */
-			/******************************************/
+			/*************************************************/
+			/* TEST LINE SEGMENT AGAINST THE NEARBY OBJNODES */
+			/*************************************************/
+			//
+			// The object tree gives us the objects whose boxes the segment goes thru.
+			// If there are too many to hold, ask again with a buffer that's big enough.
+			//
 
-	thisNodePtr = gFirstNodePtr;
+	numCandidates = QueryObjectTree_LineSegment(lineSeg, candidates, MAX_PICK_CANDIDATES);
 
-	do
+	if (numCandidates > MAX_PICK_CANDIDATES)
 	{
-				/* VERIFY NODE */
+		candidates = (ObjNode **) AllocPtr(sizeof(ObjNode *) * numCandidates);
+		numCandidates = QueryObjectTree_LineSegment(lineSeg, candidates, numCandidates);
+	}
 
-		if (thisNodePtr->Slot >= SLOT_OF_DUMB)								// stop here
-			break;
+	for (int i = 0; i < numCandidates; i++)
+		LineSegPickObjNode(&pick, candidates[i]);
 
-		if (thisNodePtr->CType == INVALID_NODE_FLAG)						// make sure the node is even valid
-			goto next;
+	if (candidates != candidateBuffer)
+		SafeDisposePtr((Ptr) candidates);
 
-		if (thisNodePtr->StatusBits & statusFilter)							// skip it if hidden
-			goto next;
+	if (distToHit)
+		*distToHit = pick.bestDist;
 
-		if (thisNodePtr->CType & cTypes)									// only if pickable
-		{
-					/* CHECK THE GRID TO SEE IF CLOSE ENOUGH */
+	return(pick.bestObj);
+}
 
-			if (allowBBoxTests)
-			{
-				if ((abs(thisNodePtr->GridX - gridX1) > GRID_SKIP_RANGE) &&					// either endpoint must be within n grid units
-					(abs(thisNodePtr->GridX - gridX2) > GRID_SKIP_RANGE))
-					goto next;
 
-				if ((abs(thisNodePtr->GridY - gridY1) > GRID_SKIP_RANGE) &&
-					(abs(thisNodePtr->GridY - gridY2) > GRID_SKIP_RANGE))
-					goto next;
+/******************** LINE SEG PICK OBJNODE ***************************/
+//
+// Tests one objNode for OGL_DoLineSegmentCollision_ObjNodes, and keeps track of the closest hit.
+//
 
-				if ((abs(thisNodePtr->GridZ - gridZ1) > GRID_SKIP_RANGE) &&
-					(abs(thisNodePtr->GridZ - gridZ2) > GRID_SKIP_RANGE))
-					goto next;
-			}
+static void LineSegPickObjNode(LineSegPickType *pick, ObjNode *thisNodePtr)
+{
+const OGLLineSegment	*lineSeg = pick->lineSeg;
+OGLPoint3D				hitPt;
+OGLVector3D				hitNormal;
+float					hitDist;
+Boolean					hit;
 
+			/* VERIFY NODE */
 
-					/* HANDLE SKELETONS, MODELS, & CUSTOM */
+	if (thisNodePtr->Slot >= SLOT_OF_DUMB)
+		return;
 
-			switch(thisNodePtr->Genre)
-			{
-				case	SKELETON_GENRE:
-						if (allowBBoxTests)
-							hit = OGL_DoesLineSegmentIntersectBBox_Approx(lineSeg, &thisNodePtr->WorldBBox);		// skeletons have world-space bboxes which we can use for fast approx line->bbox tests
-						else
-							hit = OGL_DoesLineSegmentIntersectSphere(lineSeg, &segVec, &thisNodePtr->Coord, thisNodePtr->BoundingSphereRadius, nil);
+	if (thisNodePtr->CType == INVALID_NODE_FLAG)						// make sure the node is even valid
+		return;
 
-						if (hit)
+	if (thisNodePtr->StatusBits & (pick->statusFilter | STATUS_BIT_DETACHED))	// skip it if hidden (or not in the object list)
+		return;
+
+	if (!(thisNodePtr->CType & pick->cTypes))							// only if pickable
+		return;
+
+			/* CHECK THE GRID TO SEE IF CLOSE ENOUGH */
+
+	if (pick->allowBBoxTests)
+	{
+		if ((abs(thisNodePtr->GridX - pick->gridX1) > GRID_SKIP_RANGE) &&					// either endpoint must be within n grid units
+			(abs(thisNodePtr->GridX - pick->gridX2) > GRID_SKIP_RANGE))
+			return;
+
+		if ((abs(thisNodePtr->GridY - pick->gridY1) > GRID_SKIP_RANGE) &&
+			(abs(thisNodePtr->GridY - pick->gridY2) > GRID_SKIP_RANGE))
+			return;
+
+		if ((abs(thisNodePtr->GridZ - pick->gridZ1) > GRID_SKIP_RANGE) &&
+			(abs(thisNodePtr->GridZ - pick->gridZ2) > GRID_SKIP_RANGE))
+			return;
+	}
+
+
+			/* HANDLE SKELETONS, MODELS, & CUSTOM */
+
+	switch(thisNodePtr->Genre)
+	{
+		case	SKELETON_GENRE:
+				if (pick->allowBBoxTests)
+					hit = OGL_DoesLineSegmentIntersectBBox_Approx(lineSeg, &thisNodePtr->WorldBBox);		// skeletons have world-space bboxes which we can use for fast approx line->bbox tests
+				else
+					hit = OGL_DoesLineSegmentIntersectSphere(lineSeg, &pick->segVec, &thisNodePtr->Coord, thisNodePtr->BoundingSphereRadius, nil);
+
+				if (hit)
+				{
+					if (OGL_LineSegGetHitInfo_Skeleton(lineSeg, thisNodePtr, &hitPt, &hitNormal, &hitDist))		// does ray intersect skeleton?
+					{
+						if (hitDist < pick->bestDist)						// is this the best hit so far?
 						{
-							if (OGL_LineSegGetHitInfo_Skeleton(lineSeg, thisNodePtr, &hitPt, &hitNormal, &hitDist))		// does ray intersect skeleton?
-							{
-								if (hitDist < bestDist)								// is this the best hit so far?
-								{
-									bestDist = hitDist;
-									bestObj = thisNodePtr;
-									if (worldHitCoord)
-										*worldHitCoord = hitPt;
-									if (worldHitFaceNormal)
-										*worldHitFaceNormal = hitNormal;
-								}
-							}
+							pick->bestDist = hitDist;
+							pick->bestObj = thisNodePtr;
+							if (pick->worldHitCoord)
+								*pick->worldHitCoord = hitPt;
+							if (pick->worldHitFaceNormal)
+								*pick->worldHitFaceNormal = hitNormal;
 						}
-						break;
+					}
+				}
+				break;
 
-				case	DISPLAY_GROUP_GENRE:
-						if (OGL_DoesLineSegmentIntersectSphere(lineSeg, &segVec, &thisNodePtr->Coord, thisNodePtr->BoundingSphereRadius, nil))
+		case	DISPLAY_GROUP_GENRE:
+				if (OGL_DoesLineSegmentIntersectSphere(lineSeg, &pick->segVec, &thisNodePtr->Coord, thisNodePtr->BoundingSphereRadius, nil))
+				{
+					if (OGL_LineSegGetHitInfo_DisplayGroup(lineSeg, thisNodePtr, &hitPt, &hitNormal, &hitDist))	// does line seg hit display group geometry?
+					{
+						if (hitDist < pick->bestDist)				// is this the best hit so far?
 						{
-							if (OGL_LineSegGetHitInfo_DisplayGroup(lineSeg, thisNodePtr, &hitPt, &hitNormal, &hitDist))	// does line seg hit display group geometry?
-							{
-								if (hitDist < bestDist)						// is this the best hit so far?
-								{
-									bestDist = hitDist;
-									bestObj = thisNodePtr;
-									if (worldHitCoord)
-										*worldHitCoord = hitPt;
-									if (worldHitFaceNormal)
-										*worldHitFaceNormal = hitNormal;
-								}
-							}
+							pick->bestDist = hitDist;
+							pick->bestObj = thisNodePtr;
+							if (pick->worldHitCoord)
+								*pick->worldHitCoord = hitPt;
+							if (pick->worldHitFaceNormal)
+								*pick->worldHitFaceNormal = hitNormal;
 						}
-						break;
+					}
+				}
+				break;
 
-				case	CUSTOM_GENRE:									// ignore this or do custom handling
-						break;
+		case	CUSTOM_GENRE:											// ignore this or do custom handling
+				break;
 
-				default:
-						DoFatalAlert("OGL_DoLineSegmentCollision: unsupported genre");
-			}
-		}
-
-next:
-		thisNodePtr = thisNodePtr->NextNode;								// next node
+		default:
+				DoFatalAlert("OGL_DoLineSegmentCollision: unsupported genre");
 	}
-	while (thisNodePtr != nil);
-
-	if (distToHit)
-		*distToHit = bestDist;
-
-	return(bestObj);
 }
 
 
@@ -955,104 +984,372 @@ next:
 
 Boolean OGL_LineSegmentCollision_Terrain(const OGLLineSegment *lineSeg, OGLPoint3D *worldHitCoord, OGLVector3D *terrainNormal, float *distToHit)
 {
-short	i;
-MOVertexArrayData	*mesh;
-Boolean				hit = false;
-OGLPoint3D			hitCoord;
-OGLVector3D			hitNormal;
-float				dist;
-float				bestDist = 10000000;
 OGLVector3D			segVec;
+OGLVector3D			hitNormal;
+float				t, segLength;
+Boolean				hit;
 
 
 			/* CALCULATE THE LINE SEGMENT VECTOR */
+			//
+			// Not normalized, so that the segment is t = 0...1
+			//
 
 	segVec.x = lineSeg->p2.x - lineSeg->p1.x;
 	segVec.y = lineSeg->p2.y - lineSeg->p1.y;
 	segVec.z = lineSeg->p2.z - lineSeg->p1.z;
-	OGLVector3D_Normalize(&segVec, &segVec);
 
 
-			/*******************************/
-			/* TEST AGAINST ALL SUPERTILES */
-			/*******************************/
+			/* WALK THE HEIGHTFIELD */
+			//
+			// Like the triangle tests, only hits from the front count unless
+			// gPickAllTrianglesAsDoubleSided is set.
+			//
 
-	for (i = 0; i < MAX_SUPERTILES; i++)
+	hit = TraceTerrainHeightfield(&lineSeg->p1, &segVec, 0, 1, gPickAllTrianglesAsDoubleSided, &t, &hitNormal);
+	if (hit)
 	{
-		OGLBoundingBox		*bbox;
+		worldHitCoord->x = lineSeg->p1.x + segVec.x * t;
+		worldHitCoord->y = lineSeg->p1.y + segVec.y * t;
+		worldHitCoord->z = lineSeg->p1.z + segVec.z * t;
+		if (terrainNormal)
+			*terrainNormal = hitNormal;
+	}
 
-		if (gSuperTileMemoryList[i].mode == SUPERTILE_MODE_FREE)				// look for used / active supertiles
-			continue;
+	if (distToHit)
+	{
+		if (hit)
+		{
+			segLength = sqrtf(segVec.x * segVec.x + segVec.y * segVec.y + segVec.z * segVec.z);
+			*distToHit = t * segLength;					// return the distance from p1 to the hit
+		}
+		else
+			*distToHit = 10000000;
+	}
 
-				/* SEE IF LINE SEGMENT INTERSECTS THE BBOX */
-				//
-				// Remember tha the bbox test is approximate and can give false positives!
-				//
-#if 1
+	return(hit);
+}
 
-		bbox = &gSuperTileMemoryList[i].bBox;
-		if (!OGL_DoesLineSegmentIntersectBBox_Approx(lineSeg, bbox))
-			continue;
 
-#else
 
+#pragma mark -
+
+
+/********************* INIT GRID WALK ***************************/
+//
+// Sets up a walk along origin + dir*t thru a grid of cellSize cells,
+// starting from the cell that contains the point at t.
+// The starting cell is clamped to minCol...maxCol, minRow...maxRow.
+//
+
+static void InitGridWalk(GridWalkType *walk, const OGLPoint3D *origin, const OGLVector3D *dir, float t, float cellSize,
+						long minCol, long maxCol, long minRow, long maxRow)
+{
+float	x = origin->x + dir->x * t;
+float	z = origin->z + dir->z * t;
+
+	walk->col = SDL_clamp((long) floorf(x / cellSize), minCol, maxCol);
+	walk->row = SDL_clamp((long) floorf(z / cellSize), minRow, maxRow);
+
+	if (dir->x > 0.0f)
 	{
-		float				radius;
-		float				sqrt2 = 1.4142135f;
-		OGLPoint3D			origin;
+		walk->stepCol	= 1;
+		walk->tNextCol	= ((walk->col + 1) * cellSize - origin->x) / dir->x;
+		walk->tDeltaCol	= cellSize / dir->x;
+	}
+	else
+	if (dir->x < 0.0f)
+	{
+		walk->stepCol	= -1;
+		walk->tNextCol	= (walk->col * cellSize - origin->x) / dir->x;
+		walk->tDeltaCol	= -cellSize / dir->x;
+	}
+	else
+	{
+		walk->stepCol	= 0;
+		walk->tNextCol	= walk->tDeltaCol = 1e30f;
+	}
+
+	if (dir->z > 0.0f)
+	{
+		walk->stepRow	= 1;
+		walk->tNextRow	= ((walk->row + 1) * cellSize - origin->z) / dir->z;
+		walk->tDeltaRow	= cellSize / dir->z;
+	}
+	else
+	if (dir->z < 0.0f)
+	{
+		walk->stepRow	= -1;
+		walk->tNextRow	= (walk->row * cellSize - origin->z) / dir->z;
+		walk->tDeltaRow	= -cellSize / dir->z;
+	}
+	else
+	{
+		walk->stepRow	= 0;
+		walk->tNextRow	= walk->tDeltaRow = 1e30f;
+	}
+}
 
-			/********************************************************/
-			/* DOES RAY INTERSECT THIS SUPERTILE'S BOUNDING SPEHRE? */
-			/********************************************************/
 
-					/* CALCULATE THE SUPERTILE RADIUS */
+/********************* STEP GRID WALK ***************************/
+//
+// Moves to the next cell along the line.  Returns the t at which we entered it.
+//
 
-		dist = gSuperTileMemoryList[i].bBox.max.y - gSuperTileMemoryList[i].bBox.min.y;		// is height taller than supertile width/depth size?
-		if (dist > gTerrainSuperTileUnitSize)
-			radius = dist;
-		else
-			radius = gTerrainSuperTileUnitSize;
+static float StepGridWalk(GridWalkType *walk)
+{
+float	t;
+
+	if (walk->tNextCol < walk->tNextRow)
+	{
+		t = walk->tNextCol;
+		walk->col += walk->stepCol;
+		walk->tNextCol += walk->tDeltaCol;
+	}
+	else
+	{
+		t = walk->tNextRow;
+		walk->row += walk->stepRow;
+		walk->tNextRow += walk->tDeltaRow;
+	}
 
-		radius = radius * .5f * sqrt2;
+	return(t);
+}
 
 
-					/* DOES LINE HIT THE SPHERE? */
+/********************* CLIP LINE TO SLAB ***************************/
+//
+// Narrows tMin...tMax to the part of the line where lo <= o + d*t <= hi.
+// Returns false if there's nothing left.
+//
 
-		origin.x = gSuperTileMemoryList[i].x;									// get b-sphere coords
-		origin.y = gSuperTileMemoryList[i].y;
-		origin.z = gSuperTileMemoryList[i].z;
+static Boolean ClipLineToSlab(float o, float d, float lo, float hi, float *tMin, float *tMax)
+{
+float	t0,t1;
 
-		if (!OGL_DoesLineSegmentIntersectSphere(lineSeg, &segVec, &origin, radius, nil))	// see if ray hit sphere
-			continue;
+	if (d == 0.0f)
+		return(o >= lo && o <= hi);
+
+	t0 = (lo - o) / d;
+	t1 = (hi - o) / d;
+	if (t0 > t1)
+	{
+		float temp = t0;
+		t0 = t1;
+		t1 = temp;
 	}
-#endif
 
-			/******************************************/
-			/* SEE IF RAY HIT ANY SUPERTILE TRIANGLES */
-			/******************************************/
+	if (t0 > *tMin)
+		*tMin = t0;
+	if (t1 < *tMax)
+		*tMax = t1;
 
-		mesh = gSuperTileMemoryList[i].meshData;								// get ptr to supertile's mesh data
+	return(*tMin <= *tMax);
+}
 
-		if (!OGL_DoesLineSegIntersectMesh(lineSeg, &segVec, mesh, &hitCoord, &hitNormal, &dist))
-			continue;
 
-		if (dist < bestDist)													 // is this the closest hit so far?
+/****************** TRACE TERRAIN HEIGHTFIELD ************************/
+//
+// Finds the first place where origin + dir*t, tMin <= t <= tMax, crosses the terrain.
+//
+// Rather than testing the meshes of the supertiles that happen to be built, this walks
+// gMapYCoords directly, so it works anywhere on the map:  first a grid walk over the
+// supertiles, skipping the ones whose height range the line doesn't overlap, then a grid walk
+// over the tiles of the supertiles that are left.  Since cells are visited in order along the
+// line, the first tile with a hit has the closest hit.
+//
+// If doubleSided is false, only hits going from above the terrain to below it count.
+//
+
+static Boolean TraceTerrainHeightfield(const OGLPoint3D *origin, const OGLVector3D *dir, float tMin, float tMax, Boolean doubleSided,
+										float *tHit, OGLVector3D *hitNormal)
+{
+GridWalkType	superWalk;
+long			numSuperWide, numSuperDeep;
+float			tEnter, tExit;
+
+	if (!gMapYCoords || !gSuperTileHeightRanges)					// make sure there's a terrain
+		return(false);
+
+	numSuperWide = (gTerrainTileWidth + SUPERTILE_SIZE - 1) / SUPERTILE_SIZE;
+	numSuperDeep = (gTerrainTileDepth + SUPERTILE_SIZE - 1) / SUPERTILE_SIZE;
+
+
+			/* CLIP THE LINE TO THE TERRAIN'S BOUNDING BOX */
+
+	if (!ClipLineToSlab(origin->x, dir->x, 0, gTerrainTileWidth * gTerrainPolygonSize, &tMin, &tMax))
+		return(false);
+	if (!ClipLineToSlab(origin->z, dir->z, 0, gTerrainTileDepth * gTerrainPolygonSize, &tMin, &tMax))
+		return(false);
+	if (!ClipLineToSlab(origin->y, dir->y, gTerrainMinY, gTerrainMaxY, &tMin, &tMax))
+		return(false);
+
+
+			/*************************/
+			/* WALK THRU SUPERTILES  */
+			/*************************/
+
+	InitGridWalk(&superWalk, origin, dir, tMin, gTerrainSuperTileUnitSize, 0, numSuperWide-1, 0, numSuperDeep-1);
+
+	tEnter = tMin;
+	while (tEnter <= tMax)
+	{
+		const SuperTileHeightRange	*range;
+		float						y0, y1;
+
+		if ((superWalk.col < 0) || (superWalk.col >= numSuperWide) || (superWalk.row < 0) || (superWalk.row >= numSuperDeep))
+			break;
+
+		tExit = SDL_min(SDL_min(superWalk.tNextCol, superWalk.tNextRow), tMax);
+
+
+				/* DOES THE LINE PASS THRU THIS SUPERTILE'S HEIGHT RANGE? */
+
+		range = &gSuperTileHeightRanges[superWalk.row][superWalk.col];
+		y0 = origin->y + dir->y * tEnter;
+		y1 = origin->y + dir->y * tExit;
+
+		if ((SDL_max(y0, y1) >= range->minY) && (SDL_min(y0, y1) <= range->maxY))
 		{
-					/* REMEMBER THIS HIT AS THE BEST SO FAR */
+			GridWalkType	tileWalk;
+			long			minCol = superWalk.col * SUPERTILE_SIZE;
+			long			minRow = superWalk.row * SUPERTILE_SIZE;
+			long			maxCol = SDL_min(minCol + SUPERTILE_SIZE, gTerrainTileWidth) - 1;
+			long			maxRow = SDL_min(minRow + SUPERTILE_SIZE, gTerrainTileDepth) - 1;
+			float			tTile = tEnter;
 
-			bestDist = dist;
-			*worldHitCoord = hitCoord;
-			if (terrainNormal)
-				*terrainNormal = hitNormal;
+					/* WALK THRU THE TILES IN THIS SUPERTILE */
 
-			hit = true;
+			InitGridWalk(&tileWalk, origin, dir, tEnter, gTerrainPolygonSize, minCol, maxCol, minRow, maxRow);
+
+			while ((tTile <= tExit)
+				&& (tileWalk.col >= minCol) && (tileWalk.col <= maxCol)
+				&& (tileWalk.row >= minRow) && (tileWalk.row <= maxRow))
+			{
+				if (IntersectTerrainTile(tileWalk.row, tileWalk.col, origin, dir, tMin, tMax, doubleSided, tHit, hitNormal))
+					return(true);
+
+				tTile = StepGridWalk(&tileWalk);
+			}
 		}
+
+		tEnter = StepGridWalk(&superWalk);
 	}
 
-	if (distToHit)
-		*distToHit = bestDist;							// return the distance to the best hit
+	return(false);
+}
 
-	return(hit);
+
+/****************** INTERSECT TERRAIN TILE ************************/
+//
+// Tests the line against the 2 triangles of a tile, split the same way as in GetTerrainY.
+// Each triangle is treated as the plane y = h(x,z) over its part of the tile.
+//
+
+static Boolean IntersectTerrainTile(long row, long col, const OGLPoint3D *origin, const OGLVector3D *dir, float tMin, float tMax,
+									Boolean doubleSided, float *tHit, OGLVector3D *hitNormal)
+{
+float		size = gTerrainPolygonSize;
+float		sizeFrac = gTerrainPolygonSizeFrac;
+float		eps = size * TERRAIN_PICK_EPS;
+float		left = col * gTerrainPolygonSizeInt;
+float		back = row * gTerrainPolygonSizeInt;
+float		y0,y1,y2,y3;
+Boolean		splitBackward = (gMapSplitMode[row][col] == SPLIT_BACKWARD);
+Boolean		gotHit = false;
+float		bestT = tMax;
+
+	y0 = gMapYCoords[row][col];										// far left
+	y1 = gMapYCoords[row][col+1];									// far right
+	y2 = gMapYCoords[row+1][col+1];									// near right
+	y3 = gMapYCoords[row+1][col];									// near left
+
+	for (int tri = 0; tri < 2; tri++)
+	{
+		float	baseX, baseY, dydx, dydz;
+		float	f0, fd, t, xi, zi;
+
+				/* GET THE PLANE OF THIS TRIANGLE */
+
+		if (splitBackward)											// \ split
+		{
+			baseX = 0;
+			baseY = y0;
+			if (tri == 0)											// left triangle
+			{
+				dydx = (y2 - y3) * sizeFrac;
+				dydz = (y3 - y0) * sizeFrac;
+			}
+			else													// right triangle
+			{
+				dydx = (y1 - y0) * sizeFrac;
+				dydz = (y2 - y1) * sizeFrac;
+			}
+		}
+		else														// / split
+		{
+			if (tri == 0)											// left triangle
+			{
+				baseX = 0;
+				baseY = y0;
+				dydx = (y1 - y0) * sizeFrac;
+				dydz = (y3 - y0) * sizeFrac;
+			}
+			else													// right triangle
+			{
+				baseX = size;
+				baseY = y1;
+				dydx = (y2 - y3) * sizeFrac;
+				dydz = (y2 - y1) * sizeFrac;
+			}
+		}
+
+				/* WHERE DOES THE LINE CROSS THE PLANE? */
+				//
+				// f(t) = line y - plane y, which is linear in t
+				//
+
+		f0 = origin->y - (baseY + dydx * (origin->x - left - baseX) + dydz * (origin->z - back));
+		fd = dir->y - dydx * dir->x - dydz * dir->z;
+
+		if (fd == 0.0f)												// parallel
+			continue;
+		if (!doubleSided && (fd > 0.0f))							// coming up from underneath
+			continue;
+
+		t = -f0 / fd;
+		if ((t < tMin) || (t > bestT))
+			continue;
+
+				/* IS THE HIT ON THIS TRIANGLE? */
+
+		xi = origin->x + dir->x * t - left;
+		zi = origin->z + dir->z * t - back;
+
+		if ((xi < -eps) || (xi > size + eps) || (zi < -eps) || (zi > size + eps))
+			continue;
+
+		if (splitBackward)
+		{
+			if ((tri == 0) ? (xi > zi + eps) : (xi < zi - eps))
+				continue;
+		}
+		else
+		{
+			if ((tri == 0) ? ((size - xi) < zi - eps) : ((size - xi) > zi + eps))
+				continue;
+		}
+
+		bestT = t;
+		gotHit = true;
+		if (hitNormal)
+			FastNormalizeVector(-dydx, 1.0f, -dydz, hitNormal);
+	}
+
+	if (gotHit)
+		*tHit = bestT;
+
+	return(gotHit);
 }
 
 
@@ -1832,13 +2129,17 @@ Byte		buffNum;
 /**************** OGL: DO SPHERE COLLISION ON OBJNODES ************************/
 //
 // Checks to see if the input bounding sphere hits any eligible objNodes in the scene.
+// If it hits several, returns the one that comes first in the object list
+// (i.e. the lowest slot), like the original walk of the whole list did.
 //
 
 ObjNode *OGL_DoSphereCollision_ObjNodes(const OGLBoundingSphere *sphere, uint32_t statusFilter, uint32_t cTypes)
 {
-ObjNode		*thisNodePtr;
+ObjNode		*candidateBuffer[MAX_PICK_CANDIDATES];
+ObjNode		**candidates = candidateBuffer;
+int			numCandidates;
 int			gridX, gridY, gridZ;
-OGLBoundingSphere	sphere2;
+ObjNode		*bestHit = nil;
 
 			/* CALC GRID COORDS OF ENDPOINTS */
 
@@ -1847,77 +2148,120 @@ OGLBoundingSphere	sphere2;
 	gridZ = (int)sphere->origin.z / GRID_SIZE;
 
 
+			/*********************************************/
+			/* TEST SPHERE AGAINST THE NEARBY OBJNODES   */
+			/*********************************************/
+			//
+			// The object tree gives us the objects whose boxes the sphere touches,
+			// in no particular order, so every one of them has to be tested.
+			// If there are too many to hold, ask again with a buffer that's big enough.
+			//
 
+	numCandidates = QueryObjectTree_Sphere(sphere, candidates, MAX_PICK_CANDIDATES);
 
-			/********************************************/
-			/* TEST SPHERE SEGMENT AGAINST ALL OBJNODES */
-			/********************************************/
-
-	thisNodePtr = gFirstNodePtr;
-
-	do
+	if (numCandidates > MAX_PICK_CANDIDATES)
 	{
-				/* VERIFY NODE */
+		candidates = (ObjNode **) AllocPtr(sizeof(ObjNode *) * numCandidates);
+		numCandidates = QueryObjectTree_Sphere(sphere, candidates, numCandidates);
+	}
 
-		if (thisNodePtr->Slot >= SLOT_OF_DUMB)								// stop here
-			break;
+	for (int i = 0; i < numCandidates; i++)
+	{
+		ObjNode	*hit = candidates[i];
 
-		if (thisNodePtr->CType == INVALID_NODE_FLAG)						// make sure the node is even valid
-			goto next;
+		if (bestHit && hit->Slot > bestHit->Slot)						// can't beat what we've got
+			continue;
 
-		if (thisNodePtr->StatusBits & statusFilter)							// skip it if hidden
-			goto next;
+		if (!SpherePickObjNode(sphere, statusFilter, cTypes, gridX, gridY, gridZ, hit))
+			continue;
 
-		if (thisNodePtr->CType & cTypes)									// only if pickable
+		if (!bestHit
+			|| hit->Slot < bestHit->Slot
+			|| IsEarlierInSlot(hit, bestHit))
 		{
-					/* CHECK THE GRID TO SEE IF CLOSE ENOUGH */
+			bestHit = hit;
+		}
+	}
 
-			if (abs(thisNodePtr->GridX - gridX) > GRID_SKIP_RANGE)			// sphere origin must be within grid range of object's center
-				goto next;
+	if (candidates != candidateBuffer)
+		SafeDisposePtr((Ptr) candidates);
 
-			if (abs(thisNodePtr->GridY - gridY) > GRID_SKIP_RANGE)
-				goto next;
+	return(bestHit);
+}
 
-			if (abs(thisNodePtr->GridZ - gridZ) > GRID_SKIP_RANGE)
-				goto next;
 
+/******************** IS EARLIER IN SLOT ***************************/
+//
+// For two nodes of the same slot, sees if a comes before b in the object list.
+// AttachObject always links a node in at the end of its slot, so that's the one attached first.
+//
 
-					/* DO THE BOUNDING SPHERES INTERSECT? */
+static Boolean IsEarlierInSlot(const ObjNode *a, const ObjNode *b)
+{
+	return(a->Slot == b->Slot && a->AttachOrder < b->AttachOrder);
+}
 
-			sphere2.radius = thisNodePtr->BoundingSphereRadius;				// build a sphere for the target node
-			sphere2.origin = thisNodePtr->Coord;
 
-			if (OGL_DoesSphereIntersectSphere(sphere, &sphere2))
-			{
-						/* HANDLE SKELETONS, MODELS, & CUSTOM */
+/******************** SPHERE PICK OBJNODE ***************************/
+//
+// Tests one objNode for OGL_DoSphereCollision_ObjNodes.
+//
 
-				switch(thisNodePtr->Genre)
-				{
-					case	SKELETON_GENRE:
-							if (OGL_DoesSkeletonIntersectSphere(sphere, thisNodePtr))		// does sphere intersect skeleton?
-								return(thisNodePtr);
-							break;
+static Boolean SpherePickObjNode(const OGLBoundingSphere *sphere, uint32_t statusFilter, uint32_t cTypes,
+								int gridX, int gridY, int gridZ, ObjNode *thisNodePtr)
+{
+OGLBoundingSphere	sphere2;
 
-					case	DISPLAY_GROUP_GENRE:
-							if (OGL_DoesDisplayGroupIntersectSphere(sphere, thisNodePtr))	// does sphere hit display group geometry?
-								return(thisNodePtr);
-							break;
+			/* VERIFY NODE */
 
-					case	CUSTOM_GENRE:									// ignore this or do custom handling
-							break;
+	if (thisNodePtr->Slot >= SLOT_OF_DUMB)
+		return(false);
 
-					default:
-							DoFatalAlert("OGL_DoSphereCollision_ObjNodes: unsupported genre");
-				}
-			}
-		}
+	if (thisNodePtr->CType == INVALID_NODE_FLAG)						// make sure the node is even valid
+		return(false);
 
-next:
-		thisNodePtr = thisNodePtr->NextNode;								// next node
-	}
-	while (thisNodePtr != nil);
+	if (thisNodePtr->StatusBits & (statusFilter | STATUS_BIT_DETACHED))	// skip it if hidden (or not in the object list)
+		return(false);
 
-	return(nil);
+	if (!(thisNodePtr->CType & cTypes))									// only if pickable
+		return(false);
+
+			/* CHECK THE GRID TO SEE IF CLOSE ENOUGH */
+
+	if (abs(thisNodePtr->GridX - gridX) > GRID_SKIP_RANGE)				// sphere origin must be within grid range of object's center
+		return(false);
+
+	if (abs(thisNodePtr->GridY - gridY) > GRID_SKIP_RANGE)
+		return(false);
+
+	if (abs(thisNodePtr->GridZ - gridZ) > GRID_SKIP_RANGE)
+		return(false);
+
+
+			/* DO THE BOUNDING SPHERES INTERSECT? */
+
+	sphere2.radius = thisNodePtr->BoundingSphereRadius;					// build a sphere for the target node
+	sphere2.origin = thisNodePtr->Coord;
+
+	if (!OGL_DoesSphereIntersectSphere(sphere, &sphere2))
+		return(false);
+
+			/* HANDLE SKELETONS, MODELS, & CUSTOM */
+
+	switch(thisNodePtr->Genre)
+	{
+		case	SKELETON_GENRE:
+				return(OGL_DoesSkeletonIntersectSphere(sphere, thisNodePtr));		// does sphere intersect skeleton?
+
+		case	DISPLAY_GROUP_GENRE:
+				return(OGL_DoesDisplayGroupIntersectSphere(sphere, thisNodePtr));	// does sphere hit display group geometry?
+
+		case	CUSTOM_GENRE:										// ignore this or do custom handling
+				return(false);
+
+		default:
+				DoFatalAlert("OGL_DoSphereCollision_ObjNodes: unsupported genre");
+	}
 }
 
 
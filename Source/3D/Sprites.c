@@ -139,15 +139,21 @@ static SpriteType LoadSpriteFromDualImage(const char* path)
 
 void LoadSpriteGroupFromFile(int groupNum, const char* path, int flags)
 {
+	int prevTag = SetMemoryTag(MEMORY_TAG_UI);
+
 	AllocSpriteGroup(groupNum, 1);
 	gSpriteGroupList[groupNum][0] = LoadSpriteFromDualImage(path);
 	GAME_ASSERT(gSpriteGroupList[groupNum][0].materialObject);
+
+	SetMemoryTag(prevTag);
 }
 
 /**************** LOAD SPRITE GROUP FROM SEQUENCE OF IMAGE FILES **********************/
 
 void LoadSpriteGroupFromSeries(int groupNum, int numSprites, const char* seriesName)
 {
+	int prevTag = SetMemoryTag(MEMORY_TAG_UI);
+
 	AllocSpriteGroup(groupNum, numSprites);
 
 	for (int i = 0; i < gNumSpritesInGroupList[groupNum]; i++)
@@ -158,6 +164,8 @@ void LoadSpriteGroupFromSeries(int groupNum, int numSprites, const char* seriesN
 		gSpriteGroupList[groupNum][i] = LoadSpriteFromDualImage(path);
 		GAME_ASSERT(gSpriteGroupList[groupNum][i].materialObject);
 	}
+
+	SetMemoryTag(prevTag);
 }
 
 
@@ -165,6 +173,8 @@ void LoadSpriteGroupFromSeries(int groupNum, int numSprites, const char* seriesN
 
 void LoadSpriteGroupFromFiles(int groupNum, int numSprites, const char** spritePaths)
 {
+	int prevTag = SetMemoryTag(MEMORY_TAG_UI);
+
 	AllocSpriteGroup(groupNum, numSprites);
 
 	for (int i = 0; i < gNumSpritesInGroupList[groupNum]; i++)
@@ -172,6 +182,8 @@ void LoadSpriteGroupFromFiles(int groupNum, int numSprites, const char** spriteP
 		gSpriteGroupList[groupNum][i] = LoadSpriteFromDualImage(spritePaths[i]);
 		GAME_ASSERT(gSpriteGroupList[groupNum][i].materialObject);
 	}
+
+	SetMemoryTag(prevTag);
 }
 
 
@@ -17,23 +17,26 @@
 /*    PROTOTYPES            */
 /****************************/
 
-static void ReadBG3DHeader(short refNum);
-static void ParseBG3DFile(short refNum);
-static void ReadMaterialFlags(short refNum);
-static void ReadMaterialDiffuseColor(short refNum);
-static void ReadMaterialTextureMap(short refNum);
-static void ReadMaterialJPEGTextureMap(short refNum);
+static Boolean LoadBG3DFileImage(FSSpec *spec, Boolean allowBaked);
+static void DisposeBG3DFileImage(void);
+static void ReadBG3DHeader(void);
+static void ParseBG3DFile(void);
+static void ReadMaterialFlags(void);
+static void ReadMaterialDiffuseColor(void);
+static void ReadMaterialTextureMap(void);
+static void ReadMaterialJPEGTextureMap(void);
 static void ReadGroup(void);
-static MetaObjectPtr ReadNewGeometry(short refNum);
+static MetaObjectPtr ReadNewGeometry(void);
 static MetaObjectPtr ReadVertexElementsGeometry(BG3DGeometryHeader *header);
 static void InitBG3DContainer(void);
 static void EndGroup(void);
-static void ReadVertexArray(short refNum);
-static void ReadNormalArray(short refNum);
-static void ReadUVArray(short refNum);
-static void ReadVertexColorArray(short refNum);
-static void ReadTriangleArray(short refNum);
-static void ReadBoundingBox(short refNum);
+static void ReadVertexArray(void);
+static void ReadNormalArray(void);
+static void ReadUVArray(void);
+static void ReadVertexColorArray(void);
+static void ReadTriangleArray(void);
+static void ReadBoundingBox(void);
+static void ImportBG3DInternal(FSSpec *spec, int groupNum, short varType, Boolean allowBaked);
 
 
 
@@ -44,6 +47,22 @@ static void ReadBoundingBox(short refNum);
 #define	BG3D_GROUP_STACK_SIZE	50						// max nesting depth of groups
 
 
+		/* FILE IMAGE */
+		//
+		// The whole file is read into memory in one go and parsed from there.
+		//
+
+typedef struct
+{
+	Ptr			data;
+	long		size;
+	long		offset;								// parse cursor
+	Boolean		isBaked;							// native-endian file with aligned payloads (see BakeBG3DImage)
+	Boolean		nonFatal;							// bad data sets failed instead of calling DoFatalAlert
+	Boolean		failed;
+}BG3DFileImage;
+
+
 /*********************/
 /*    VARIABLES      */
 /*********************/
@@ -59,6 +78,8 @@ static BG3DFileContainer	*gBG3D_CurrentContainer;
 
 static	short				gImportBG3DVARType;
 
+static BG3DFileImage		gBG3D_File;							// the file ImportBG3D is parsing
+
 BG3DFileContainer		*gBG3DContainerList[MAX_BG3D_GROUPS];
 MetaObjectPtr			gBG3DGroupList[MAX_BG3D_GROUPS][MAX_OBJECTS_IN_GROUP];		// ILLEGAL references!!!
 int						gNumObjectsInBG3DGroupList[MAX_BG3D_GROUPS];
@@ -89,10 +110,20 @@ int	i;
 // varType == the Vertex Array Range group that we want to allocate the BG3D's vertex arrays with.
 // 				If it is -1 then we don't want it in VAR memory.
 //
+// If a baked copy of the file (.bg3dc, see BakeBG3DFile) sits next to it and is up to date,
+// that one is loaded instead.
+//
 
 void ImportBG3D(FSSpec *spec, int groupNum, short varType)
 {
-short				refNum;
+	int prevTag = SetMemoryTag(MEMORY_TAG_MODELS);
+	ImportBG3DInternal(spec, groupNum, varType, true);
+	SetMemoryTag(prevTag);
+}
+
+
+static void ImportBG3DInternal(FSSpec *spec, int groupNum, short varType, Boolean allowBaked)
+{
 int					i;
 MetaObjectHeader	*header;
 MOGroupObject		*group;
@@ -110,18 +141,27 @@ MOGroupData			*data;
 
 
 		/************************/
-		/* OPEN THE FILE & READ */
+		/* READ THE FILE & PARSE */
 		/************************/
 
-	if (FSpOpenDF(spec, fsRdPerm, &refNum) != noErr)
-		DoFatalAlert("ImportBG3D: FSpOpenDF failed");
+	if (!LoadBG3DFileImage(spec, allowBaked))
+		DoFatalAlert("ImportBG3D: couldn't read %s", spec->cName);
 
-	ReadBG3DHeader(refNum);
-	ParseBG3DFile(refNum);
+			/* LET TEXTURES CACHE THEIR COMPRESSED VERSIONS */
+			//
+			// A baked file already knows its source's hash.  Otherwise this is the slow path anyway.
+			//
 
-			/* CLOSE FILE */
+	uint64_t sourceKey = gBG3D_File.isBaked
+						? ((const BG3DBakedHeaderType *) gBG3D_File.data)->sourceHash
+						: HashBytes(HASH_BYTES_SEED, gBG3D_File.data, gBG3D_File.size);
+	OGL_SetTextureCacheSource(spec->cName, sourceKey);
 
-	FSClose(refNum);
+	ReadBG3DHeader();
+	ParseBG3DFile();
+
+	OGL_SetTextureCacheSource(nil, 0);
+	DisposeBG3DFileImage();
 
 
 			/********************/
@@ -162,18 +202,251 @@ MOGroupData			*data;
 }
 
 
+#pragma mark -
+
+/******************** READ WHOLE DATA FORK ************************/
+//
+// Returns nil if the file can't be read.
+//
+
+static Ptr ReadWholeDataFork(FSSpec *spec, long *outLength)
+{
+short	refNum;
+long	eof = 0;
+long	count;
+Ptr		data;
+OSErr	iErr;
+
+	if (FSpOpenDF(spec, fsRdPerm, &refNum) != noErr)
+		return nil;
+
+	GetEOF(refNum, &eof);
+
+	data = AllocPtr(eof > 0 ? eof : 1);
+	count = eof;
+	iErr = FSRead(refNum, &count, data);
+	FSClose(refNum);
+
+	if (iErr || count != eof)
+	{
+		SafeDisposePtr(data);
+		return nil;
+	}
+
+	*outLength = eof;
+	return data;
+}
+
+
+/******************** MAKE BAKED BG3D SPEC ************************/
+//
+// The baked version of foo.bg3d is foo.bg3dc in the same folder.
+// Returns noErr if it exists, fnfErr if the spec is valid but there's no file yet.
+//
+
+static OSErr MakeBakedBG3DSpec(const FSSpec *spec, FSSpec *bakedSpec)
+{
+char	path[sizeof(spec->cName) + 4];
+
+	SDL_snprintf(path, sizeof(path), ":%sc", spec->cName);
+	return FSMakeFSSpec(spec->vRefNum, spec->parID, path, bakedSpec);
+}
+
+
+/******************** IS BAKED BG3D IMAGE ************************/
+//
+// Checks that a .bg3dc image is one this build can read.
+//
+
+Boolean IsBakedBG3DImage(const char *data, long size)
+{
+const BG3DBakedHeaderType *bakedHeader = (const BG3DBakedHeaderType *) data;
+
+	return size >= (long) sizeof(BG3DBakedHeaderType)
+		&& SDL_strncmp(bakedHeader->headerString, BG3D_BAKED_HEADER_STRING, sizeof(bakedHeader->headerString)) == 0
+		&& bakedHeader->endianTag == BG3D_BAKED_ENDIAN_TAG
+		&& bakedHeader->version == BG3D_BAKED_VERSION;
+}
+
+
+/******************** IS BAKED BG3D IMAGE UP TO DATE ************************/
+//
+// Checks that a .bg3dc image is readable and was baked from exactly this .bg3d,
+// so that stale files get ignored even if the model was edited without changing size.
+//
+
+Boolean IsBakedBG3DImageUpToDate(const char *data, long size, const char *sourceData, long sourceSize)
+{
+const BG3DBakedHeaderType *bakedHeader = (const BG3DBakedHeaderType *) data;
+
+	return IsBakedBG3DImage(data, size)
+		&& bakedHeader->sourceFileSize == (uint32_t) sourceSize
+		&& bakedHeader->sourceHash == HashBytes(HASH_BYTES_SEED, sourceData, sourceSize);
+}
+
+
+/******************** LOAD BG3D FILE IMAGE ************************/
+//
+// Reads the whole file into memory so that the parser never has to go back to disk.
+// If allowed, prefers a baked image: first one the prefetch thread made
+// (see PrefetchLevelArt), then a .bg3dc baked from this exact .bg3d.
+//
+
+static Boolean LoadBG3DFileImage(FSSpec *spec, Boolean allowBaked)
+{
+FSSpec	bakedSpec;
+Ptr		bakedData;
+long	bakedSize = 0;
+
+	GAME_ASSERT(!gBG3D_File.data);
+
+	gBG3D_File.isBaked = false;
+	gBG3D_File.offset = 0;
+
+			/* SEE IF THE PREFETCH THREAD HAS IT READY */
+			//
+			// It has already checked the .bg3dc against the .bg3d, or baked the .bg3d itself.
+			//
+
+	if (allowBaked)
+	{
+		gBG3D_File.data = TakePrefetchedFile(spec, &gBG3D_File.size);
+		if (gBG3D_File.data)
+		{
+			if (IsBakedBG3DImage(gBG3D_File.data, gBG3D_File.size))
+			{
+				gBG3D_File.isBaked = true;
+				return true;
+			}
+			DisposeBG3DFileImage();
+		}
+	}
+
+			/* READ THE REGULAR BG3D FILE */
+
+	gBG3D_File.data = ReadWholeDataFork(spec, &gBG3D_File.size);
+	if (!gBG3D_File.data)
+		return false;
+
+			/* USE THE BAKED FILE INSTEAD IF IT WAS BAKED FROM THIS ONE */
+
+	if (allowBaked && MakeBakedBG3DSpec(spec, &bakedSpec) == noErr)
+	{
+		bakedData = ReadWholeDataFork(&bakedSpec, &bakedSize);
+		if (bakedData)
+		{
+			if (IsBakedBG3DImageUpToDate(bakedData, bakedSize, gBG3D_File.data, gBG3D_File.size))
+			{
+				DisposeBG3DFileImage();
+				gBG3D_File.data = bakedData;
+				gBG3D_File.size = bakedSize;
+				gBG3D_File.isBaked = true;
+				return true;
+			}
+
+			SDL_Log("%s: %s is stale or incompatible, using %s instead", __func__, bakedSpec.cName, spec->cName);
+			SafeDisposePtr(bakedData);
+		}
+	}
+
+	return true;
+}
+
+
+/******************** DISPOSE BG3D FILE IMAGE ************************/
+
+static void DisposeBG3DFileImage(void)
+{
+	if (gBG3D_File.data)
+	{
+		SafeDisposePtr(gBG3D_File.data);
+		gBG3D_File.data = nil;
+	}
+	gBG3D_File.size = 0;
+	gBG3D_File.offset = 0;
+}
+
+
+/******************** READ IMAGE BYTES ************************/
+//
+// Returns a pointer to the next count bytes of the file image and advances the cursor.
+// Returns nil if that's past the end of a nonFatal image.
+//
+
+static const void *ReadImageBytes(BG3DFileImage *image, long count)
+{
+const void	*data;
+
+	if (count < 0 || count > image->size - image->offset)
+	{
+		if (!image->nonFatal)
+			DoFatalAlert("ReadImageBytes: read past end of file");
+		image->failed = true;
+		return nil;
+	}
+
+	data = image->data + image->offset;
+	image->offset += count;
+	return data;
+}
+
+
+/******************** READ BG3D BYTES ************************/
+//
+// Same as above, for the file that's being imported.
+//
+
+static const void *ReadBG3DBytes(long count)
+{
+	return ReadImageBytes(&gBG3D_File, count);
+}
+
+
+/******************** COPY BG3D BYTES ************************/
+
+static void CopyImageBytes(BG3DFileImage *image, void *dest, long count)
+{
+const void	*src = ReadImageBytes(image, count);
+
+	if (src)
+		SDL_memcpy(dest, src, count);
+	else
+		SDL_memset(dest, 0, count);
+}
+
+static void CopyBG3DBytes(void *dest, long count)
+{
+	CopyImageBytes(&gBG3D_File, dest, count);
+}
+
+
+/******************** SKIP BG3D PADDING ************************/
+//
+// In baked files, vertex streams and texture pixels start on a BG3D_BAKED_ALIGN boundary.
+//
+
+static void SkipBG3DPadding(void)
+{
+	if (gBG3D_File.isBaked)
+		gBG3D_File.offset = (gBG3D_File.offset + BG3D_BAKED_ALIGN - 1) & ~(long)(BG3D_BAKED_ALIGN - 1);
+}
+
+
+#pragma mark -
+
 /********************** READ BG3D HEADER **************************/
 
-static void ReadBG3DHeader(short refNum)
+static void ReadBG3DHeader(void)
 {
 BG3DHeaderType	headerData;
-long			count;
 
+	if (gBG3D_File.isBaked)										// already validated in LoadBG3DFileImage
+	{
+		ReadBG3DBytes(sizeof(BG3DBakedHeaderType));
+		return;
+	}
 
-	count = sizeof(BG3DHeaderType);
-
-	if (FSRead(refNum, &count, (Ptr) &headerData) != noErr)
-		DoFatalAlert("ReadBG3DHeader: FSRead failed");
+	CopyBG3DBytes(&headerData, sizeof(BG3DHeaderType));
 
 			/* VERIFY FILE */
 
@@ -189,10 +462,9 @@ long			count;
 
 /****************** PARSE BG3D FILE ***********************/
 
-static void ParseBG3DFile(short refNum)
+static void ParseBG3DFile(void)
 {
 uint32_t			tag;
-long			count;
 Boolean			done = false;
 MetaObjectPtr 	newObj;
 
@@ -200,11 +472,10 @@ MetaObjectPtr 	newObj;
 	{
 			/* READ A TAG */
 
-		count = sizeof(tag);
-		if (FSRead(refNum, &count, (Ptr) &tag) != noErr)
-			DoFatalAlert("ParseBG3DFile: FSRead failed");
+		CopyBG3DBytes(&tag, sizeof(tag));
 
-		tag = SwizzleULong(&tag);
+		if (!gBG3D_File.isBaked)
+			tag = SwizzleULong(&tag);
 
 
 			/* HANDLE THE TAG */
@@ -212,15 +483,15 @@ MetaObjectPtr 	newObj;
 		switch(tag)
 		{
 			case	BG3D_TAGTYPE_MATERIALFLAGS:
-					ReadMaterialFlags(refNum);
+					ReadMaterialFlags();
 					break;
 
 			case	BG3D_TAGTYPE_MATERIALDIFFUSECOLOR:
-					ReadMaterialDiffuseColor(refNum);
+					ReadMaterialDiffuseColor();
 					break;
 
 			case	BG3D_TAGTYPE_TEXTUREMAP:
-					ReadMaterialTextureMap(refNum);
+					ReadMaterialTextureMap();
 					break;
 
 			case	BG3D_TAGTYPE_GROUPSTART:
@@ -232,7 +503,7 @@ MetaObjectPtr 	newObj;
 					break;
 
 			case	BG3D_TAGTYPE_GEOMETRY:
-					newObj = ReadNewGeometry(refNum);
+					newObj = ReadNewGeometry();
 					if (gBG3D_CurrentGroup)								// add new geometry to current group
 					{
 						MO_AppendToGroup(gBG3D_CurrentGroup, newObj);
@@ -241,31 +512,31 @@ MetaObjectPtr 	newObj;
 					break;
 
 			case	BG3D_TAGTYPE_VERTEXARRAY:
-					ReadVertexArray(refNum);
+					ReadVertexArray();
 					break;
 
 			case	BG3D_TAGTYPE_NORMALARRAY:
-					ReadNormalArray(refNum);
+					ReadNormalArray();
 					break;
 
 			case	BG3D_TAGTYPE_UVARRAY:
-					ReadUVArray(refNum);
+					ReadUVArray();
 					break;
 
 			case	BG3D_TAGTYPE_COLORARRAY:
-					ReadVertexColorArray(refNum);
+					ReadVertexColorArray();
 					break;
 
 			case	BG3D_TAGTYPE_TRIANGLEARRAY:
-					ReadTriangleArray(refNum);
+					ReadTriangleArray();
 					break;
 
 			case	BG3D_TAGTYPE_BOUNDINGBOX:
-					ReadBoundingBox(refNum);
+					ReadBoundingBox();
 					break;
 
 			case	BG3D_TAGTYPE_JPEGTEXTURE:
-					ReadMaterialJPEGTextureMap(refNum);
+					ReadMaterialJPEGTextureMap();
 					break;
 
 			case	BG3D_TAGTYPE_ENDFILE:
@@ -284,19 +555,18 @@ MetaObjectPtr 	newObj;
 // Reading new material flags indicatest the start of a new material.
 //
 
-static void ReadMaterialFlags(short refNum)
+static void ReadMaterialFlags(void)
 {
-long				count,i;
+long				i;
 MOMaterialData		data;
 uint32_t				flags;
 
 			/* READ FLAGS */
 
-	count = sizeof(flags);
-	if (FSRead(refNum, &count, (Ptr) &flags) != noErr)
-		DoFatalAlert("ReadMaterialFlags: FSRead failed");
+	CopyBG3DBytes(&flags, sizeof(flags));
 
-	flags = SwizzleULong(&flags);
+	if (!gBG3D_File.isBaked)
+		flags = SwizzleULong(&flags);
 
 		/* INIT NEW MATERIAL DATA */
 
@@ -326,9 +596,8 @@ uint32_t				flags;
 
 /*************** READ MATERIAL DIFFUSE COLOR **********************/
 
-static void ReadMaterialDiffuseColor(short refNum)
+static void ReadMaterialDiffuseColor(void)
 {
-long			count;
 GLfloat			color[4];
 MOMaterialData	*data;
 
@@ -338,14 +607,15 @@ MOMaterialData	*data;
 
 			/* READ COLOR VALUE */
 
-	count = sizeof(GLfloat) * 4;
-	if (FSRead(refNum, &count, (Ptr) color) != noErr)
-		DoFatalAlert("ReadMaterialDiffuseColor: FSRead failed");
+	CopyBG3DBytes(color, sizeof(GLfloat) * 4);
 
-	color[0] = SwizzleFloat(&color[0]);
-	color[1] = SwizzleFloat(&color[1]);
-	color[2] = SwizzleFloat(&color[2]);
-	color[3] = SwizzleFloat(&color[3]);
+	if (!gBG3D_File.isBaked)
+	{
+		color[0] = SwizzleFloat(&color[0]);
+		color[1] = SwizzleFloat(&color[1]);
+		color[2] = SwizzleFloat(&color[2]);
+		color[3] = SwizzleFloat(&color[3]);
+	}
 
 
 		/* ASSIGN COLOR TO CURRENT MATERIAL */
@@ -365,11 +635,11 @@ MOMaterialData	*data;
 //			material.
 //
 
-static void ReadMaterialTextureMap(short refNum)
+static void ReadMaterialTextureMap(void)
 {
 BG3DTextureHeader	textureHeader;
-long		count,i;
-void		*texturePixels;
+long		i;
+const void	*texturePixels;
 MOMaterialData	*data;
 
 			/* GET PTR TO CURRENT MATERIAL */
@@ -384,14 +654,16 @@ MOMaterialData	*data;
 			/* READ TEXTURE HEADER */
 			/***********************/
 
-	count = sizeof(textureHeader);
-	FSRead(refNum, &count, (Ptr) &textureHeader);		// read header
+	CopyBG3DBytes(&textureHeader, sizeof(textureHeader));		// read header
 
-	textureHeader.width			= SwizzleULong(&textureHeader.width);
-	textureHeader.height		= SwizzleULong(&textureHeader.height);
-	textureHeader.srcPixelFormat = SwizzleLong(&textureHeader.srcPixelFormat);
-	textureHeader.dstPixelFormat = SwizzleLong(&textureHeader.dstPixelFormat);
-	textureHeader.bufferSize	= SwizzleULong(&textureHeader.bufferSize);
+	if (!gBG3D_File.isBaked)
+	{
+		textureHeader.width			= SwizzleULong(&textureHeader.width);
+		textureHeader.height		= SwizzleULong(&textureHeader.height);
+		textureHeader.srcPixelFormat = SwizzleLong(&textureHeader.srcPixelFormat);
+		textureHeader.dstPixelFormat = SwizzleLong(&textureHeader.dstPixelFormat);
+		textureHeader.bufferSize	= SwizzleULong(&textureHeader.bufferSize);
+	}
 
 
 			/* COPY BASIC INFO */
@@ -407,14 +679,13 @@ MOMaterialData	*data;
 		/***************************/
 		/* READ THE TEXTURE PIXELS */
 		/***************************/
+		//
+		// OpenGL makes its own copy of the texture, so we can
+		// hand it the pixels straight out of the file image.
+		//
 
-	count = textureHeader.bufferSize;			// get size of buffer to load
-
-	texturePixels = AllocPtrClear(count);		// alloc memory for buffer
-	if (texturePixels == nil)
-		DoFatalAlert("ReadMaterialTextureMap: AllocPtr failed");
-
-	FSRead(refNum, &count, texturePixels);		// read pixel data
+	SkipBG3DPadding();
+	texturePixels = ReadBG3DBytes(textureHeader.bufferSize);
 
 
 		/* ASSIGN PIXELS TO CURRENT MATERIAL */
@@ -433,59 +704,43 @@ MOMaterialData	*data;
 		// Source port note: most BG3Ds in Nanosaur 2 use JPEG textures;
 		// the few that don't use JPEG always use GL_RGBA in practice.
 		case GL_RGBA:
-			data->textureName[i] = OGL_TextureMap_Load(texturePixels, w, h, GL_RGBA, GL_RGBA, GL_UNSIGNED_BYTE);
+			data->textureName[i] = OGL_TextureMap_Load((void *) texturePixels, w, h, GL_RGBA, GL_RGBA, GL_UNSIGNED_BYTE);
 			break;
 
 		// Just in case we want to import models from other games or whatever...
 		case GL_UNSIGNED_SHORT_1_5_5_5_REV:		// 16-bit packed pixel
 		case GL_UNSIGNED_INT_8_8_8_8_REV:		// ARGB (standard Mac)
 			// pass on format as dataType
-			data->textureName[i] = OGL_TextureMap_Load(texturePixels, w, h, GL_RGBA, GL_RGBA, textureHeader.srcPixelFormat);
+			data->textureName[i] = OGL_TextureMap_Load((void *) texturePixels, w, h, GL_RGBA, GL_RGBA, textureHeader.srcPixelFormat);
 			break;
 
 		default:
 			DoFatalAlert("Unsupported BG3D srcPixelFormat 0x%04x", textureHeader.srcPixelFormat);
 	}
-
-		/* DISPOSE ORIGINAL PIXELS */
-		//
-		// OpenGL now has its own copy of the texture,
-		// so we don't need ours anymore.
-		//
-
-	SafeDisposePtr(texturePixels);
 }
 
 
 
-/******************* READ MATERIAL JPEG TEXTURE MAP ***********************/
+/******************* DECODE JPEG TEXTURE MAP ***********************/
 //
-// NOTE:  This may get called multiple times - once for each mipmap associated with the
-//			material.
+// Decompresses a JPEG texture record (+ its optional alpha channel) at the image's cursor.
+// The baker uses this too, so that baked files carry the decoded RGBA pixels.
+// Doesn't touch GL or any parser globals, so it's safe on the prefetch thread.
+// Returns nil if the record is bad and the image is nonFatal.
 //
 
-static void ReadMaterialJPEGTextureMap(short refNum)
+static Ptr DecodeJPEGTextureMap(BG3DFileImage *image, int *outWidth, int *outHeight)
 {
 BG3DJPEGTextureHeader	textureHeader;
-long					count;
 int						w;
 int						h;
-MOMaterialData			*data;
 Boolean					hasAlpha;
 
-			/* GET PTR TO CURRENT MATERIAL */
-
-	GAME_ASSERT(gBG3D_CurrentMaterialObj);
-
-	data = &gBG3D_CurrentMaterialObj->objectData; 	// get ptr to material data
-
-
 			/***********************/
 			/* READ TEXTURE HEADER */
 			/***********************/
 
-	count = sizeof(textureHeader);
-	FSRead(refNum, &count, (Ptr) &textureHeader);					// read header
+	CopyImageBytes(image, &textureHeader, sizeof(textureHeader));			// read header
 
 	textureHeader.width			= SwizzleULong(&textureHeader.width);
 	textureHeader.height		= SwizzleULong(&textureHeader.height);
@@ -497,51 +752,41 @@ Boolean					hasAlpha;
 	h = textureHeader.height;
 	hasAlpha = textureHeader.hasAlphaChannel;				// see if we'll need to read in the alpha channel
 
-			/* COPY BASIC INFO */
-
-	GAME_ASSERT(data->numMipmaps < MO_MAX_MIPMAPS);			// see if overflow
-
-	if (data->numMipmaps == 0)								// see if this is the first texture
-	{
-		data->width 			= w;
-		data->height	 		= h;
-	}
 
+		/************************/
+		/* DECOMPRESS THE IMAGE */
+		/************************/
 
-		/**********************/
-		/* READ THE JPEG DATA */
-		/**********************/
+	const char *jpegData = ReadImageBytes(image, textureHeader.bufferSize);	// image desc + compressed data
+	if (!jpegData)
+		return nil;
 
-	Ptr textureRGBA = NULL;
+	Ptr textureRGBA;
+	if (image->nonFatal)
+		textureRGBA = TryDecompressQTImage(jpegData, textureHeader.bufferSize, w, h);
+	else
+		textureRGBA = DecompressQTImage(jpegData, textureHeader.bufferSize, w, h);
 
+	if (!textureRGBA)
 	{
-			/* ALLOC BUFFER FOR JPEG DATA */
-
-		count = textureHeader.bufferSize;						// get size of JPEG buffer to load
-		Ptr jpegBuffer = AllocPtrClear(count);					// alloc memory for buffer
-		GAME_ASSERT(jpegBuffer);
-
-		FSRead(refNum, &count, jpegBuffer);						// read JPEG data (image desc + compressed data)
-
-				/************************/
-				/* DECOMPRESS THE IMAGE */
-				/************************/
-
-		textureRGBA = DecompressQTImage(jpegBuffer, textureHeader.bufferSize, w, h);
-		GAME_ASSERT(textureRGBA);
-
-		SafeDisposePtr(jpegBuffer);
+		image->failed = true;
+		return nil;
 	}
 
+
 		/***************************************/
 		/* READ IN ALPHA CHANNEL IF IT HAS ONE */
 		/***************************************/
 
 	if (hasAlpha)
 	{
-		count = w * h;
-		Ptr alphaBuffer = AllocPtrClear(count);		// alloc buffer for alpha channel
-		FSRead(refNum, &count, alphaBuffer);		// read alpha buffer
+		long count = w * h;
+		const uint8_t *alphaBuffer = ReadImageBytes(image, count);
+		if (!alphaBuffer)
+		{
+			SafeDisposePtr(textureRGBA);
+			return nil;
+		}
 
 		Ptr textureAlpha = textureRGBA + 3;
 		for (int p = 0; p < count; p++)
@@ -549,10 +794,54 @@ Boolean					hasAlpha;
 			*textureAlpha = alphaBuffer[p];
 			textureAlpha += 4;
 		}
+	}
+
+	*outWidth = w;
+	*outHeight = h;
+	return textureRGBA;
+}
+
+
+/******************* READ MATERIAL JPEG TEXTURE MAP ***********************/
+//
+// NOTE:  This may get called multiple times - once for each mipmap associated with the
+//			material.
+//
+// Baked files never contain this tag -- their textures are stored pre-decoded.
+//
+
+static void ReadMaterialJPEGTextureMap(void)
+{
+int						w;
+int						h;
+MOMaterialData			*data;
+
+			/* GET PTR TO CURRENT MATERIAL */
+
+	GAME_ASSERT(gBG3D_CurrentMaterialObj);
+	GAME_ASSERT(!gBG3D_File.isBaked);
+
+	data = &gBG3D_CurrentMaterialObj->objectData; 	// get ptr to material data
+
+	GAME_ASSERT(data->numMipmaps < MO_MAX_MIPMAPS);			// see if overflow
+
+
+		/**********************/
+		/* READ THE JPEG DATA */
+		/**********************/
+
+	Ptr textureRGBA = DecodeJPEGTextureMap(&gBG3D_File, &w, &h);
+
+
+			/* COPY BASIC INFO */
 
-		SafeDisposePtr(alphaBuffer);
+	if (data->numMipmaps == 0)								// see if this is the first texture
+	{
+		data->width 			= w;
+		data->height	 		= h;
 	}
 
+
 		/*************************************/
 		/* ASSIGN PIXELS TO CURRENT MATERIAL */
 		/*************************************/
@@ -626,24 +915,25 @@ static void EndGroup(void)
 
 /******************* READ NEW GEOMETRY ***********************/
 
-static MetaObjectPtr ReadNewGeometry(short refNum)
+static MetaObjectPtr ReadNewGeometry(void)
 {
 BG3DGeometryHeader	geoHeader;
-long				count;
 MetaObjectPtr		newObj;
 
 			/* READ GEOMETRY HEADER */
 
-	count = sizeof(BG3DGeometryHeader);
-	FSRead(refNum, &count, (Ptr) &geoHeader);		// read header
+	CopyBG3DBytes(&geoHeader, sizeof(BG3DGeometryHeader));		// read header
 
-	geoHeader.type = SwizzleULong(&geoHeader.type);
-	geoHeader.numMaterials = SwizzleLong(&geoHeader.numMaterials);
-	geoHeader.layerMaterialNum[0] = SwizzleULong(&geoHeader.layerMaterialNum[0]);
-	geoHeader.layerMaterialNum[1] = SwizzleULong(&geoHeader.layerMaterialNum[1]);
-	geoHeader.flags = SwizzleULong(&geoHeader.flags);
-	geoHeader.numPoints = SwizzleULong(&geoHeader.numPoints);
-	geoHeader.numTriangles = SwizzleULong(&geoHeader.numTriangles);
+	if (!gBG3D_File.isBaked)
+	{
+		geoHeader.type = SwizzleULong(&geoHeader.type);
+		geoHeader.numMaterials = SwizzleLong(&geoHeader.numMaterials);
+		geoHeader.layerMaterialNum[0] = SwizzleULong(&geoHeader.layerMaterialNum[0]);
+		geoHeader.layerMaterialNum[1] = SwizzleULong(&geoHeader.layerMaterialNum[1]);
+		geoHeader.flags = SwizzleULong(&geoHeader.flags);
+		geoHeader.numPoints = SwizzleULong(&geoHeader.numPoints);
+		geoHeader.numTriangles = SwizzleULong(&geoHeader.numTriangles);
+	}
 
 
 
@@ -726,8 +1016,11 @@ int		i;
 
 
 /******************* READ VERTEX ARRAY *************************/
+//
+// Baked files store the arrays native-endian, so they're just copied into place.
+//
 
-static void ReadVertexArray(short refNum)
+static void ReadVertexArray(void)
 {
 long				count;
 int					numPoints, i;
@@ -743,17 +1036,21 @@ OGLPoint3D			*pointList;
 	count = sizeof(OGLPoint3D) * numPoints;							// calc size of data to read
 
 	if (gImportBG3DVARType == -1)
-		pointList = AllocPtrClear(count);
+		pointList = AllocPtr(count);
 	else
 		pointList = OGL_AllocVertexArrayMemory(count, gImportBG3DVARType);	// alloc vertex array range buffer
 
-	FSRead(refNum, &count, (Ptr) pointList);								// read the data
+	SkipBG3DPadding();
+	CopyBG3DBytes(pointList, count);								// read the data
 
-	for (i = 0; i < numPoints; i++)						// swizzle
+	if (!gBG3D_File.isBaked)
 	{
-		pointList[i].x = SwizzleFloat(&pointList[i].x);
-		pointList[i].y = SwizzleFloat(&pointList[i].y);
-		pointList[i].z = SwizzleFloat(&pointList[i].z);
+		for (i = 0; i < numPoints; i++)						// swizzle
+		{
+			pointList[i].x = SwizzleFloat(&pointList[i].x);
+			pointList[i].y = SwizzleFloat(&pointList[i].y);
+			pointList[i].z = SwizzleFloat(&pointList[i].z);
+		}
 	}
 
 
@@ -763,7 +1060,7 @@ OGLPoint3D			*pointList;
 
 /******************* READ NORMAL ARRAY *************************/
 
-static void ReadNormalArray(short refNum)
+static void ReadNormalArray(void)
 {
 long				count, i;
 int					numPoints;
@@ -776,17 +1073,21 @@ OGLVector3D			*normalList;
 	count = sizeof(OGLVector3D) * numPoints;						// calc size of data to read
 
 	if (gImportBG3DVARType == -1)
-		normalList = AllocPtrClear(count);
+		normalList = AllocPtr(count);
 	else
 		normalList = OGL_AllocVertexArrayMemory(count, gImportBG3DVARType);	// alloc vertex array range buffer
 
-	FSRead(refNum, &count, (Ptr) normalList);								// read the data
+	SkipBG3DPadding();
+	CopyBG3DBytes(normalList, count);								// read the data
 
-	for (i = 0; i < numPoints; i++)						// swizzle
+	if (!gBG3D_File.isBaked)
 	{
-		normalList[i].x = SwizzleFloat(&normalList[i].x);
-		normalList[i].y = SwizzleFloat(&normalList[i].y);
-		normalList[i].z = SwizzleFloat(&normalList[i].z);
+		for (i = 0; i < numPoints; i++)						// swizzle
+		{
+			normalList[i].x = SwizzleFloat(&normalList[i].x);
+			normalList[i].y = SwizzleFloat(&normalList[i].y);
+			normalList[i].z = SwizzleFloat(&normalList[i].z);
+		}
 	}
 
 	data->normals = normalList;										// assign normal array to geometry header
@@ -795,7 +1096,7 @@ OGLVector3D			*normalList;
 
 /******************* READ UV ARRAY *************************/
 
-static void ReadUVArray(short refNum)
+static void ReadUVArray(void)
 {
 long				count, i;
 int					numPoints;
@@ -808,16 +1109,20 @@ OGLTextureCoord		*uvList;
 	count = sizeof(OGLTextureCoord) * numPoints;					// calc size of data to read
 
 	if (gImportBG3DVARType == -1)
-		uvList = AllocPtrClear(count);
+		uvList = AllocPtr(count);
 	else
 		uvList = OGL_AllocVertexArrayMemory(count, gImportBG3DVARType);	// alloc vertex array range buffer
 
-	FSRead(refNum, &count, (Ptr) uvList);								// read the data
+	SkipBG3DPadding();
+	CopyBG3DBytes(uvList, count);									// read the data
 
-	for (i = 0; i < numPoints; i++)						// swizzle
+	if (!gBG3D_File.isBaked)
 	{
-		uvList[i].u = SwizzleFloat(&uvList[i].u);
-		uvList[i].v = SwizzleFloat(&uvList[i].v);
+		for (i = 0; i < numPoints; i++)						// swizzle
+		{
+			uvList[i].u = SwizzleFloat(&uvList[i].u);
+			uvList[i].v = SwizzleFloat(&uvList[i].v);
+		}
 	}
 
 	data->uvs[0] = uvList;												// assign uv array to geometry header
@@ -829,20 +1134,20 @@ OGLTextureCoord		*uvList;
 // NOTE: The color data in the BG3D file is always stored as Byte values since it's more compact.
 //
 
-static void ReadVertexColorArray(short refNum)
+static void ReadVertexColorArray(void)
 {
 long				count,i;
 int					numPoints;
 MOVertexArrayData	*data;
-OGLColorRGBA_Byte	*colorList;
+const OGLColorRGBA_Byte	*colorList;
 OGLColorRGBA		*colorsF;
 
 	data = &gBG3D_CurrentGeometryObj->objectData;					// point to geometry data
 	numPoints = data->numPoints;									// get # colors to expect to read
 
 	count = sizeof(OGLColorRGBA_Byte) * numPoints;					// calc size of data to read
-	colorList = AllocPtrClear(count);								// alloc buffer to read into
-	FSRead(refNum, &count, (Ptr) colorList);						// read the data
+	SkipBG3DPadding();
+	colorList = ReadBG3DBytes(count);								// bytes don't need swizzling, use them in place
 
 
 
@@ -863,15 +1168,12 @@ OGLColorRGBA		*colorsF;
 		colorsF[i].b = (float)(colorList[i].b) / 255.0f;
 		colorsF[i].a = (float)(colorList[i].a) / 255.0f;
 	}
-
-	SafeDisposePtr(colorList);										// free the Byte color data we read in
-
 }
 
 
 /******************* READ TRIANGLE ARRAY *************************/
 
-static void ReadTriangleArray(short refNum)
+static void ReadTriangleArray(void)
 {
 long				count, i;
 int					numTriangles;
@@ -884,18 +1186,22 @@ MOTriangleIndecies	*triList;
 	count = sizeof(MOTriangleIndecies) * numTriangles;				// calc size of data to read
 
 	if (gImportBG3DVARType == -1)
-		triList = AllocPtrClear(count);
+		triList = AllocPtr(count);
 	else
 		triList = OGL_AllocVertexArrayMemory(count, gImportBG3DVARType);	// alloc vertex array range buffer
 
-	FSRead(refNum, &count, (Ptr) triList);								// read the data
+	SkipBG3DPadding();
+	CopyBG3DBytes(triList, count);									// read the data
 
 
-	for (i = 0; i < numTriangles; i++)							//	swizzle
+	if (!gBG3D_File.isBaked)
 	{
-		triList[i].vertexIndices[0] = SwizzleULong(&triList[i].vertexIndices[0]);
-		triList[i].vertexIndices[1] = SwizzleULong(&triList[i].vertexIndices[1]);
-		triList[i].vertexIndices[2] = SwizzleULong(&triList[i].vertexIndices[2]);
+		for (i = 0; i < numTriangles; i++)							//	swizzle
+		{
+			triList[i].vertexIndices[0] = SwizzleULong(&triList[i].vertexIndices[0]);
+			triList[i].vertexIndices[1] = SwizzleULong(&triList[i].vertexIndices[1]);
+			triList[i].vertexIndices[2] = SwizzleULong(&triList[i].vertexIndices[2]);
+		}
 	}
 
 
@@ -905,24 +1211,24 @@ MOTriangleIndecies	*triList;
 
 /******************* READ BOUNDING BOX *************************/
 
-static void ReadBoundingBox(short refNum)
+static void ReadBoundingBox(void)
 {
-long				count;
 MOVertexArrayData	*data;
 
 	data = &gBG3D_CurrentGeometryObj->objectData;					// point to geometry data
 
-	count = sizeof(OGLBoundingBox);									// calc size of data to read
-
-	FSRead(refNum, &count, (Ptr) &data->bBox);						// read the bbox data directly into geometry header
+	CopyBG3DBytes(&data->bBox, sizeof(OGLBoundingBox));				// read the bbox data directly into geometry header
 
-	data->bBox.min.x = SwizzleFloat(&data->bBox.min.x);
-	data->bBox.min.y = SwizzleFloat(&data->bBox.min.y);
-	data->bBox.min.z = SwizzleFloat(&data->bBox.min.z);
+	if (!gBG3D_File.isBaked)
+	{
+		data->bBox.min.x = SwizzleFloat(&data->bBox.min.x);
+		data->bBox.min.y = SwizzleFloat(&data->bBox.min.y);
+		data->bBox.min.z = SwizzleFloat(&data->bBox.min.z);
 
-	data->bBox.max.x = SwizzleFloat(&data->bBox.max.x);
-	data->bBox.max.y = SwizzleFloat(&data->bBox.max.y);
-	data->bBox.max.z = SwizzleFloat(&data->bBox.max.z);
+		data->bBox.max.x = SwizzleFloat(&data->bBox.max.x);
+		data->bBox.max.y = SwizzleFloat(&data->bBox.max.y);
+		data->bBox.max.z = SwizzleFloat(&data->bBox.max.z);
+	}
 }
 
 
@@ -941,7 +1247,7 @@ static void InitBG3DContainer(void)
 {
 MOGroupObject	*rootGroup;
 
-	gBG3D_CurrentContainer = AllocPtrClear(sizeof(BG3DFileContainer));
+	gBG3D_CurrentContainer = AllocLevelPtrClear(sizeof(BG3DFileContainer));
 	if (gBG3D_CurrentContainer == nil)
 		DoFatalAlert("InitBG3DContainer: AllocPtr failed!");
 
@@ -1007,6 +1313,439 @@ int					i;
 
 #pragma mark -
 
+/************************ BAKED BG3D WRITER *****************************/
+//
+// A baked .bg3dc holds the same tag stream as the .bg3d it was made from, except that:
+//		- everything is native-endian, so the loader never swizzles
+//		- vertex streams and texture pixels start on BG3D_BAKED_ALIGN boundaries
+//		- JPEG textures are stored as pre-decoded RGBA BG3D_TAGTYPE_TEXTUREMAP records
+//
+
+static const struct
+{
+	const char*	path;
+	short		varType;
+}kBG3DFiles[] =
+{
+	{ ":Models:global.bg3d",			VERTEX_ARRAY_RANGE_TYPE_BG3DMODELS },
+	{ ":Models:playerparts.bg3d",		VERTEX_ARRAY_RANGE_TYPE_BG3DMODELS },
+	{ ":Models:weapons.bg3d",			VERTEX_ARRAY_RANGE_TYPE_BG3DMODELS },
+	{ ":Models:levelintro.bg3d",		VERTEX_ARRAY_RANGE_TYPE_BG3DMODELS },
+	{ ":Models:forest.bg3d",			VERTEX_ARRAY_RANGE_TYPE_BG3DMODELS },
+	{ ":Models:desert.bg3d",			VERTEX_ARRAY_RANGE_TYPE_BG3DMODELS },
+	{ ":Models:swamp.bg3d",				VERTEX_ARRAY_RANGE_TYPE_BG3DMODELS },
+	{ ":Skeletons:nano.bg3d",			-1 },							// skeletons are never in VAR memory (see Bones.c)
+	{ ":Skeletons:wormhole.bg3d",		-1 },
+	{ ":Skeletons:raptor.bg3d",			-1 },
+	{ ":Skeletons:bonusworm.bg3d",		-1 },
+	{ ":Skeletons:brach.bg3d",			-1 },
+	{ ":Skeletons:worm.bg3d",			-1 },
+	{ ":Skeletons:ramphor.bg3d",		-1 },
+};
+
+#define	NUM_BG3D_FILES	((int)(sizeof(kBG3DFiles) / sizeof(kBG3DFiles[0])))
+
+#define	BG3D_BAKE_GROW_SIZE		(1024*1024)
+
+typedef struct
+{
+	Ptr			data;
+	long		size;
+	long		capacity;
+	Boolean		failed;								// ran out of memory
+}BG3DBakeBuffer;
+
+
+static void WriteBakedBytes(BG3DBakeBuffer *out, const void *data, long count)
+{
+	if (count == 0 || !data || out->failed)			// nil if the source ran out: the bake gets abandoned
+		return;
+
+	if (out->size + count > out->capacity)
+	{
+		long	capacity = out->size + count + BG3D_BAKE_GROW_SIZE;
+		Ptr		grown = TryReallocPtr(out->data, capacity);
+
+		if (!grown)
+		{
+			out->failed = true;
+			return;
+		}
+
+		out->data = grown;
+		out->capacity = capacity;
+	}
+
+	SDL_memcpy(out->data + out->size, data, count);
+	out->size += count;
+}
+
+
+static void WriteBakedPadding(BG3DBakeBuffer *out)
+{
+static const char zeros[BG3D_BAKED_ALIGN] = {0};
+
+	WriteBakedBytes(out, zeros, (BG3D_BAKED_ALIGN - (out->size % BG3D_BAKED_ALIGN)) % BG3D_BAKED_ALIGN);
+}
+
+
+static void WriteBakedTag(BG3DBakeBuffer *out, uint32_t tag)
+{
+	WriteBakedBytes(out, &tag, sizeof(tag));
+}
+
+
+/*
+ * Reads numWords big-endian 32-bit values (floats or ints) at the image's cursor
+ * and writes them out native-endian.
+ */
+
+static void BakeSwizzledWords(BG3DFileImage *image, BG3DBakeBuffer *out, long numWords)
+{
+const uint32_t	*src = ReadImageBytes(image, numWords * sizeof(uint32_t));
+uint32_t		*dest;
+
+	if (numWords == 0 || !src)
+		return;
+
+	WriteBakedBytes(out, src, numWords * sizeof(uint32_t));			// copy, then swizzle in place
+	if (out->failed)
+		return;
+	dest = (uint32_t *) (out->data + out->size) - numWords;
+
+	for (long i = 0; i < numWords; i++)
+		dest[i] = SwizzleULong(&dest[i]);
+}
+
+
+/********************** BAKE BG3D IMAGE *****************************/
+//
+// Converts a .bg3d file image to a .bg3dc file image, both in memory.
+// Returns nil if the source isn't a BG3D file or is damaged, or if memory runs out.
+//
+// Touches no GL state and no parser globals, so the asset prefetch thread
+// uses this to hand LoadLevelArt models that are ready to upload.
+// For the same reason it never calls DoFatalAlert on bad data: a model that
+// won't bake is left for ImportBG3D to complain about on the main thread.
+//
+
+Ptr BakeBG3DImage(const char *sourceData, long sourceSize, long *outBakedSize)
+{
+BG3DFileImage		image;
+BG3DBakeBuffer		out;
+BG3DHeaderType		sourceHeader;
+BG3DBakedHeaderType	bakedHeader;
+uint32_t			numPoints = 0;
+uint32_t			numTriangles = 0;
+Boolean				done = false;
+
+	image.data		= (Ptr) sourceData;
+	image.size		= sourceSize;
+	image.offset	= 0;
+	image.isBaked	= false;
+	image.nonFatal	= true;
+	image.failed	= false;
+
+	if (sourceSize < (long) sizeof(sourceHeader))
+		return nil;
+
+	CopyImageBytes(&image, &sourceHeader, sizeof(sourceHeader));
+	if (SDL_strncmp(sourceHeader.headerString, "BG3D", 4) != 0)
+		return nil;
+
+	out.capacity	= sourceSize + BG3D_BAKE_GROW_SIZE;
+	out.data		= TryAllocPtr(out.capacity);
+	out.size		= 0;
+	out.failed		= false;
+
+	if (!out.data)
+		return nil;
+
+	SDL_zero(bakedHeader);
+	SDL_strlcpy(bakedHeader.headerString, BG3D_BAKED_HEADER_STRING, sizeof(bakedHeader.headerString));
+	bakedHeader.endianTag		= BG3D_BAKED_ENDIAN_TAG;
+	bakedHeader.version			= BG3D_BAKED_VERSION;
+	bakedHeader.sourceFileSize	= (uint32_t) sourceSize;
+	bakedHeader.sourceHash		= HashBytes(HASH_BYTES_SEED, sourceData, sourceSize);
+	WriteBakedBytes(&out, &bakedHeader, sizeof(bakedHeader));
+
+
+			/* CONVERT EACH TAG */
+
+	do
+	{
+		uint32_t tag;
+		CopyImageBytes(&image, &tag, sizeof(tag));
+		tag = SwizzleULong(&tag);
+
+		switch(tag)
+		{
+			case	BG3D_TAGTYPE_MATERIALFLAGS:
+					WriteBakedTag(&out, tag);
+					BakeSwizzledWords(&image, &out, 1);
+					break;
+
+			case	BG3D_TAGTYPE_MATERIALDIFFUSECOLOR:
+					WriteBakedTag(&out, tag);
+					BakeSwizzledWords(&image, &out, 4);
+					break;
+
+			case	BG3D_TAGTYPE_TEXTUREMAP:
+			{
+					BG3DTextureHeader	textureHeader;
+
+					CopyImageBytes(&image, &textureHeader, sizeof(textureHeader));
+					textureHeader.width			= SwizzleULong(&textureHeader.width);
+					textureHeader.height		= SwizzleULong(&textureHeader.height);
+					textureHeader.srcPixelFormat = SwizzleLong(&textureHeader.srcPixelFormat);
+					textureHeader.dstPixelFormat = SwizzleLong(&textureHeader.dstPixelFormat);
+					textureHeader.bufferSize	= SwizzleULong(&textureHeader.bufferSize);
+
+					WriteBakedTag(&out, tag);
+					WriteBakedBytes(&out, &textureHeader, sizeof(textureHeader));
+					WriteBakedPadding(&out);
+					WriteBakedBytes(&out, ReadImageBytes(&image, textureHeader.bufferSize), textureHeader.bufferSize);
+					break;
+			}
+
+			case	BG3D_TAGTYPE_JPEGTEXTURE:
+			{
+					BG3DTextureHeader	textureHeader;
+					int					w, h;
+					Ptr					pixels = DecodeJPEGTextureMap(&image, &w, &h);
+
+					if (!pixels)
+						break;
+
+					SDL_zero(textureHeader);
+					textureHeader.width				= w;
+					textureHeader.height			= h;
+					textureHeader.srcPixelFormat	= GL_RGBA;
+					textureHeader.dstPixelFormat	= GL_RGBA;
+					textureHeader.bufferSize		= w * h * 4;
+
+					WriteBakedTag(&out, BG3D_TAGTYPE_TEXTUREMAP);
+					WriteBakedBytes(&out, &textureHeader, sizeof(textureHeader));
+					WriteBakedPadding(&out);
+					WriteBakedBytes(&out, pixels, textureHeader.bufferSize);
+					SafeDisposePtr(pixels);
+					break;
+			}
+
+			case	BG3D_TAGTYPE_GROUPSTART:
+			case	BG3D_TAGTYPE_GROUPEND:
+					WriteBakedTag(&out, tag);
+					break;
+
+			case	BG3D_TAGTYPE_GEOMETRY:
+			{
+					BG3DGeometryHeader	geoHeader;
+
+					CopyImageBytes(&image, &geoHeader, sizeof(geoHeader));
+					geoHeader.type			= SwizzleULong(&geoHeader.type);
+					geoHeader.numMaterials	= SwizzleLong(&geoHeader.numMaterials);
+					for (int i = 0; i < MAX_MULTITEXTURE_LAYERS; i++)
+						geoHeader.layerMaterialNum[i] = SwizzleULong(&geoHeader.layerMaterialNum[i]);
+					geoHeader.flags			= SwizzleULong(&geoHeader.flags);
+					geoHeader.numPoints		= SwizzleULong(&geoHeader.numPoints);
+					geoHeader.numTriangles	= SwizzleULong(&geoHeader.numTriangles);
+
+					numPoints = geoHeader.numPoints;						// the arrays that follow are sized by these
+					numTriangles = geoHeader.numTriangles;
+
+					WriteBakedTag(&out, tag);
+					WriteBakedBytes(&out, &geoHeader, sizeof(geoHeader));
+					break;
+			}
+
+			case	BG3D_TAGTYPE_VERTEXARRAY:
+			case	BG3D_TAGTYPE_NORMALARRAY:
+					WriteBakedTag(&out, tag);
+					WriteBakedPadding(&out);
+					BakeSwizzledWords(&image, &out, numPoints * 3);
+					break;
+
+			case	BG3D_TAGTYPE_UVARRAY:
+					WriteBakedTag(&out, tag);
+					WriteBakedPadding(&out);
+					BakeSwizzledWords(&image, &out, numPoints * 2);
+					break;
+
+			case	BG3D_TAGTYPE_COLORARRAY:
+					WriteBakedTag(&out, tag);
+					WriteBakedPadding(&out);
+					WriteBakedBytes(&out, ReadImageBytes(&image, numPoints * sizeof(OGLColorRGBA_Byte)), numPoints * sizeof(OGLColorRGBA_Byte));
+					break;
+
+			case	BG3D_TAGTYPE_TRIANGLEARRAY:
+					WriteBakedTag(&out, tag);
+					WriteBakedPadding(&out);
+					BakeSwizzledWords(&image, &out, numTriangles * 3);
+					break;
+
+			case	BG3D_TAGTYPE_BOUNDINGBOX:
+					WriteBakedTag(&out, tag);
+					BakeSwizzledWords(&image, &out, sizeof(OGLBoundingBox) / sizeof(uint32_t));
+					break;
+
+			case	BG3D_TAGTYPE_ENDFILE:
+					WriteBakedTag(&out, tag);
+					done = true;
+					break;
+
+			default:
+					SDL_Log("%s: unrecognized tag %u", __func__, (unsigned int) tag);
+					image.failed = true;
+		}
+	}while(!done && !image.failed && !out.failed);
+
+	if (image.failed || out.failed)
+	{
+		SDL_Log("%s: %s, not baking it", __func__, out.failed ? "out of memory" : "source is damaged");
+		SafeDisposePtr(out.data);
+		return nil;
+	}
+
+	*outBakedSize = out.size;
+	return out.data;
+}
+
+
+/********************** BAKE BG3D FILE *****************************/
+//
+// Writes foo.bg3dc next to foo.bg3d.
+// Doesn't need a GL context: JPEGs are decoded on the CPU and nothing is uploaded.
+//
+
+OSErr BakeBG3DFile(FSSpec *spec)
+{
+FSSpec	bakedSpec;
+Ptr		sourceData;
+long	sourceSize = 0;
+Ptr		bakedData;
+long	bakedSize = 0;
+short	refNum;
+long	count;
+OSErr	iErr;
+
+	iErr = MakeBakedBG3DSpec(spec, &bakedSpec);
+	if (iErr != noErr && iErr != fnfErr)
+		return iErr;
+
+	sourceData = ReadWholeDataFork(spec, &sourceSize);
+	if (!sourceData)
+		return fnfErr;
+
+	bakedData = BakeBG3DImage(sourceData, sourceSize, &bakedSize);
+	SafeDisposePtr(sourceData);
+	if (!bakedData)
+		return paramErr;
+
+
+			/* WRITE THE BAKED FILE */
+
+	FSpDelete(&bakedSpec);
+	iErr = FSpCreate(&bakedSpec, kGameID, 'BG3C', smSystemScript);
+	if (!iErr)
+		iErr = FSpOpenDF(&bakedSpec, fsRdWrPerm, &refNum);
+	if (!iErr)
+	{
+		count = bakedSize;
+		iErr = FSWrite(refNum, &count, bakedData);
+		FSClose(refNum);
+
+		if (iErr)
+			FSpDelete(&bakedSpec);								// don't leave a truncated file around
+	}
+
+	SafeDisposePtr(bakedData);
+
+	if (!iErr)
+		SDL_Log("Wrote %s (%ld bytes)", bakedSpec.cName, bakedSize);
+
+	return iErr;
+}
+
+
+/********************** BAKE ALL BG3D FILES *****************************/
+//
+// Offline tool (--bake-models).
+//
+
+void BakeAllBG3DFiles(void)
+{
+FSSpec	spec;
+int		numFailed = 0;
+
+	for (int i = 0; i < NUM_BG3D_FILES; i++)
+	{
+		if (FSMakeFSSpec(gDataSpec.vRefNum, gDataSpec.parID, kBG3DFiles[i].path, &spec) != noErr
+			|| BakeBG3DFile(&spec) != noErr)
+		{
+			SDL_Log("%s: couldn't bake %s", __func__, kBG3DFiles[i].path);
+			numFailed++;
+		}
+	}
+
+	SDL_Log("%s: %d of %d models baked", __func__, NUM_BG3D_FILES - numFailed, NUM_BG3D_FILES);
+}
+
+
+/********************** BENCHMARK BG3D LOADING *****************************/
+//
+// --benchmark-models: times ImportBG3D on every model file, once with the tag parser
+// on the .bg3d and once with the .bg3dc, including texture upload.
+// Needs the GL context, so run it from GameMain.
+//
+
+#define	BG3D_BENCHMARK_ITERATIONS	10
+
+void BenchmarkBG3DLoading(void)
+{
+OGLSetupInputType	viewDef;
+FSSpec				spec;
+double				totalMS[2] = {0, 0};
+
+	OGL_NewViewDef(&viewDef);
+	OGL_SetupGameView(&viewDef);								// VAR memory only exists while there's a game view
+
+	for (int i = 0; i < NUM_BG3D_FILES; i++)
+	{
+		double	ms[2];
+		Boolean	wasBaked = false;
+
+		if (FSMakeFSSpec(gDataSpec.vRefNum, gDataSpec.parID, kBG3DFiles[i].path, &spec) != noErr)
+			continue;
+
+		for (int pass = 0; pass < 2; pass++)					// pass 0 = .bg3d tag parser, pass 1 = baked
+		{
+			Uint64 start = SDL_GetTicksNS();
+
+			for (int n = 0; n < BG3D_BENCHMARK_ITERATIONS; n++)
+			{
+				ImportBG3DInternal(&spec, MODEL_GROUP_LEVELSPECIFIC, kBG3DFiles[i].varType, pass == 1);
+				DisposeBG3DContainer(MODEL_GROUP_LEVELSPECIFIC);
+			}
+
+			ms[pass] = (SDL_GetTicksNS() - start) / (1e6 * BG3D_BENCHMARK_ITERATIONS);
+			totalMS[pass] += ms[pass];
+
+			if (pass == 1)
+				wasBaked = gBG3D_File.isBaked;
+		}
+
+		SDL_Log("%-28s  bg3d %8.2f ms   bg3dc %8.2f ms%s",
+				kBG3DFiles[i].path, ms[0], ms[1], wasBaked ? "" : "   (no baked file!)");
+	}
+
+	SDL_Log("%-28s  bg3d %8.2f ms   bg3dc %8.2f ms", "TOTAL", totalMS[0], totalMS[1]);
+
+	OGL_DisposeGameView();
+}
+
+
+#pragma mark -
+
 
 
 /*************** BG3D:  SET CONTAINER MATERIAL FLAGS *********************/
@@ -19,12 +19,20 @@ extern "C"
 
 	SDL_Window* gSDLWindow = nullptr;
 	FSSpec gDataSpec;
+	char gDataHostPath[1024] = "";				// host path of the Data folder, for the prefetch thread
 	int gCurrentAntialiasingLevel;
 
 	// Command-line options for direct level loading (used by WebAssembly / level editor)
 	int gCmdLevelNum = -1;						// -1 = not specified; otherwise, jump to this level directly
 	char gCmdTerrainOverridePath[512] = "";		// if set, override terrain file for the current level
 	FSSpec gCmdTerrainOverrideSpec = {0};		// FSSpec equivalent of gCmdTerrainOverridePath (set during Boot)
+	Boolean gCmdCompilePlayfields = false;		// --compile-playfields: write .terc files and quit
+	Boolean gCmdBakeModels = false;				// --bake-models: write .bg3dc files and quit
+	Boolean gCmdBenchmarkModels = false;		// --benchmark-models: time .bg3d vs .bg3dc loading and quit
+	Boolean gCmdBenchmarkObjects = false;		// --benchmark-objects: time object spawning and quit
+	char gCmdRecordPath[512] = "";				// --record <file>: record the level's input
+	char gCmdReplayPath[512] = "";				// --replay <file>: play back recorded input as a benchmark
+	Boolean gCmdHeadless = false;				// --headless: hidden window, no drawing during --replay
 
 	// C-callable wrapper: converts gCmdTerrainOverridePath to gCmdTerrainOverrideSpec.
 	// Called from LoadLevel.c just before LoadPlayfield() if a terrain override is active.
@@ -92,7 +100,9 @@ tryAgain:
 	return dataPath;
 }
 
-// Parse --level <n> and --terrain-override <path> from argv
+// Parse --level <n>, --terrain-override <path>, --compile-playfields,
+// --bake-models, --benchmark-models, --benchmark-objects,
+// --record <file>, --replay <file> and --headless from argv
 static void ParseCommandLineArgs(int argc, char** argv)
 {
 	for (int i = 1; i < argc; i++)
@@ -111,6 +121,34 @@ static void ParseCommandLineArgs(int argc, char** argv)
 			SDL_strlcpy(gCmdTerrainOverridePath, argv[++i], sizeof(gCmdTerrainOverridePath));
 			SDL_Log("Terrain override: %s", gCmdTerrainOverridePath);
 		}
+		else if (SDL_strcmp(argv[i], "--compile-playfields") == 0)
+		{
+			gCmdCompilePlayfields = true;
+		}
+		else if (SDL_strcmp(argv[i], "--bake-models") == 0)
+		{
+			gCmdBakeModels = true;
+		}
+		else if (SDL_strcmp(argv[i], "--benchmark-models") == 0)
+		{
+			gCmdBenchmarkModels = true;
+		}
+		else if (SDL_strcmp(argv[i], "--benchmark-objects") == 0)
+		{
+			gCmdBenchmarkObjects = true;
+		}
+		else if (SDL_strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+		{
+			SDL_strlcpy(gCmdRecordPath, argv[++i], sizeof(gCmdRecordPath));
+		}
+		else if (SDL_strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+		{
+			SDL_strlcpy(gCmdReplayPath, argv[++i], sizeof(gCmdReplayPath));
+		}
+		else if (SDL_strcmp(argv[i], "--headless") == 0)
+		{
+			gCmdHeadless = true;
+		}
 	}
 
 #ifdef __EMSCRIPTEN__
@@ -147,6 +185,7 @@ static void Boot(int argc, char** argv)
 	// Find path to game data folder
 	const char* executablePath = argc > 0 ? argv[0] : NULL;
 	fs::path dataPath = FindGameData(executablePath);
+	SDL_strlcpy(gDataHostPath, (const char*) dataPath.u8string().c_str(), sizeof(gDataHostPath));
 
 	// Convert terrain override path to FSSpec (requires Pomme to be initialized)
 	if (gCmdTerrainOverridePath[0] != '\0')
@@ -157,6 +196,16 @@ static void Boot(int argc, char** argv)
 	// Load game prefs before starting
 	LoadPrefs();
 
+	// Offline conversion of the .ter files; doesn't need a window
+	if (gCmdCompilePlayfields || gCmdBakeModels)
+	{
+		if (gCmdCompilePlayfields)
+			CompileAllPlayfields();
+		if (gCmdBakeModels)
+			BakeAllBG3DFiles();
+		throw Pomme::QuitRequest();
+	}
+
 retryVideo:
 	// Initialize SDL video subsystem
 	if (!SDL_Init(SDL_INIT_VIDEO))
@@ -183,9 +232,13 @@ retryVideo:
 		SDL_GL_SetAttribute(SDL_GL_MULTISAMPLESAMPLES, 1 << gCurrentAntialiasingLevel);
 	}
 
+	SDL_WindowFlags windowFlags = SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE | SDL_WINDOW_HIGH_PIXEL_DENSITY;
+	if (gCmdHeadless && gCmdReplayPath[0] != '\0')
+		windowFlags |= SDL_WINDOW_HIDDEN;		// still need a GL context to load the level
+
 	gSDLWindow = SDL_CreateWindow(
 		GAME_FULL_NAME " (" GAME_VERSION ")", 640, 480,
-		SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE | SDL_WINDOW_HIGH_PIXEL_DENSITY);
+		windowFlags);
 
 	if (!gSDLWindow)
 	{
@@ -18,15 +18,26 @@
 
 static void MoveContrails(ObjNode *dummy);
 static void DrawContrails(ObjNode *dummy);
+static void SetContrailRefPointVertices(short contrailNum, short refP, const OGLPoint3D *where);
 
 
 /****************************/
 /*    CONSTANTS             */
 /****************************/
 
-#define	MAX_CONTRAILS				15
+#define	MAX_CONTRAILS				32							// if they're all used, the most faded loose one gets recycled
 #define	MAX_REF_POINTS_IN_CONTRAIL	50
 
+#define	MAX_CONTRAIL_VERTICES		(MAX_CONTRAILS * MAX_REF_POINTS_IN_CONTRAIL * 2)
+#define	MAX_CONTRAIL_TRIANGLES		(MAX_CONTRAILS * (MAX_REF_POINTS_IN_CONTRAIL-1) * 2)
+
+
+//
+// All contrails share one mesh (double buffered for VAR).  Each contrail owns a ring of
+// MAX_REF_POINTS_IN_CONTRAIL vertex pairs in it, starting at contrailNum * MAX_REF_POINTS_IN_CONTRAIL * 2.
+// A ref pt's 2 vertices are set once when it's added, so every frame MoveContrails only has to
+// fade the alphas and list the triangles of the segments that are still visible.
+//
 
 typedef struct
 {
@@ -34,15 +45,14 @@ typedef struct
 
 	float		width;											// width of contrail
 	short		*indexPtr;										// ptr to short which contains this contrail's index
+	ObjNode		*owner;											// object adding to this contrail (drawn with its interpolation offset)
+
+	int			firstTriangle[2];								// this contrail's triangles in each buffer, for drawing it on its own
+	int			numTriangles[2];
 
-	short		numPoints;										// # reference points in contrail
-	short		nextPointIndex;									// where in the list to put the next contrail ref point
-	OGLPoint3D	refPoints[MAX_REF_POINTS_IN_CONTRAIL];
+	short		nextPointIndex;									// where in the ring to put the next contrail ref point
 	float		alphas[MAX_REF_POINTS_IN_CONTRAIL];
 	OGLVector3D	aimVectors[MAX_REF_POINTS_IN_CONTRAIL];			// direction of the contrail at this pt
-
-	MOVertexArrayData	meshData[2];							// mesh, double buffered for VAR
-
 }ContrailType;
 
 
@@ -54,7 +64,9 @@ typedef struct
 /*    VARIABLES      */
 /*********************/
 
-static ContrailType	gContrails[MAX_CONTRAILS];
+static ContrailType			gContrails[MAX_CONTRAILS];
+
+static MOVertexArrayData	gContrailMesh[2];					// all contrails, double buffered for VAR
 
 
 /************************** INIT CONTRAILS ****************************/
@@ -73,28 +85,34 @@ ObjNode				*obj;
 		/***************************/
 
 	for (i = 0; i < MAX_CONTRAILS; i++)
-	{
 		gContrails[i].isUsed = false;								// mark as free
 
-				/* INIT THE DOUBLE-BUFFERED MESH DATA */
 
-		for (b = 0; b < 2; b++)
-		{
-			mesh = &gContrails[i].meshData[b];
+			/* INIT THE DOUBLE-BUFFERED MESH DATA */
 
-			mesh->VARtype		= VERTEX_ARRAY_RANGE_TYPE_CONTRAILS1 + b;
+	for (b = 0; b < 2; b++)
+	{
+		mesh = &gContrailMesh[b];
+
+		mesh->VARtype		= VERTEX_ARRAY_RANGE_TYPE_CONTRAILS1 + b;
+
+		mesh->numMaterials 	= 0;
+		mesh->numPoints 	= MAX_CONTRAIL_VERTICES;
+		mesh->numTriangles	= 0;
+		mesh->normals		= nil;
+		mesh->uvs[0] 		= nil;
+		mesh->uvs[1] 		= nil;
 
-			mesh->numMaterials 	= 0;
-			mesh->numPoints 	= 0;
-			mesh->numTriangles	= 0;
-			mesh->normals		= nil;
-			mesh->colorsFloat	= nil;
-			mesh->uvs[0] 		= nil;
-			mesh->uvs[1] 		= nil;
+		mesh->points 		= 	OGL_AllocVertexArrayMemory(sizeof(OGLPoint3D) * MAX_CONTRAIL_VERTICES, mesh->VARtype);
+		mesh->colorsFloat	=	OGL_AllocVertexArrayMemory(sizeof(OGLColorRGBA) * MAX_CONTRAIL_VERTICES, mesh->VARtype);
+		mesh->triangles		=	OGL_AllocVertexArrayMemory(sizeof(MOTriangleIndecies) * MAX_CONTRAIL_TRIANGLES, mesh->VARtype);
 
-			mesh->points 		= 	OGL_AllocVertexArrayMemory(sizeof(OGLPoint3D) * MAX_REF_POINTS_IN_CONTRAIL * 2, mesh->VARtype);
-			mesh->colorsFloat	=	OGL_AllocVertexArrayMemory(sizeof(OGLColorRGBA) * MAX_REF_POINTS_IN_CONTRAIL * 2, mesh->VARtype);
-			mesh->triangles		=	OGL_AllocVertexArrayMemory(sizeof(MOTriangleIndecies) * MAX_REF_POINTS_IN_CONTRAIL * 2 - 2, mesh->VARtype);
+		for (i = 0; i < MAX_CONTRAIL_VERTICES; i++)					// contrails are always white, only the alpha changes
+		{
+			mesh->colorsFloat[i].r =
+			mesh->colorsFloat[i].g =
+			mesh->colorsFloat[i].b = 1.0f;
+			mesh->colorsFloat[i].a = 0.0f;
 		}
 	}
 
@@ -121,20 +139,20 @@ ObjNode				*obj;
 
 void DisposeContrails(void)
 {
-	for (int i = 0; i < MAX_CONTRAILS; i++)
+	for (int b = 0; b < 2; b++)
 	{
-		for (int b = 0; b < 2; b++)
-		{
-			MOVertexArrayData* mesh = &gContrails[i].meshData[b];
+		MOVertexArrayData* mesh = &gContrailMesh[b];
 
-			OGL_FreeVertexArrayMemory(mesh->points, mesh->VARtype);
-			OGL_FreeVertexArrayMemory(mesh->colorsFloat, mesh->VARtype);
-			OGL_FreeVertexArrayMemory(mesh->triangles, mesh->VARtype);
+		if (!mesh->points)
+			continue;
 
-			mesh->points = NULL;
-			mesh->colorsFloat = NULL;
-			mesh->triangles = NULL;
-		}
+		OGL_FreeVertexArrayMemory(mesh->points, mesh->VARtype);
+		OGL_FreeVertexArrayMemory(mesh->colorsFloat, mesh->VARtype);
+		OGL_FreeVertexArrayMemory(mesh->triangles, mesh->VARtype);
+
+		mesh->points = NULL;
+		mesh->colorsFloat = NULL;
+		mesh->triangles = NULL;
 	}
 }
 
@@ -143,10 +161,14 @@ void DisposeContrails(void)
 //
 // Returns index into contrail list, or -1 if none available.
 //
+// If all slots are used, the most faded contrail that nobody is adding to anymore
+// is recycled, so that lots of fliers don't lose their trails.
+//
 
-void MakeNewContrail(float width, short *contrailNum)
+void MakeNewContrail(ObjNode *owner, float width, short *contrailNum)
 {
 short	i, j;
+float	lowestAlpha = 1000.0f;
 
 		/* SCAN FOR A FREE CONTRAIL */
 
@@ -154,18 +176,47 @@ short	i, j;
 		if (!gContrails[i].isUsed)
 			goto got_it;
 
-	*contrailNum = -1;
-	return;															// no free contrails, so bail
+
+		/* NONE FREE, SO FIND THE MOST FADED DISCONNECTED ONE */
+
+	j = -1;
+	for (i = 0; i < MAX_CONTRAILS; i++)
+	{
+		short	head;
+
+		if (gContrails[i].indexPtr)									// something is still adding to this one
+			continue;
+
+		head = gContrails[i].nextPointIndex - 1;
+		if (head < 0)
+			head = MAX_REF_POINTS_IN_CONTRAIL-1;
+
+		if (gContrails[i].alphas[head] < lowestAlpha)
+		{
+			lowestAlpha = gContrails[i].alphas[head];
+			j = i;
+		}
+	}
+
+	if (j == -1)
+	{
+		*contrailNum = -1;
+		return;														// no free contrails, so bail
+	}
+
+	i = j;
 
 got_it:
 
 		/* INIT THIS CONTRAIL SLOT */
 
 	gContrails[i].isUsed 			= true;							// make this slot as used
-	gContrails[i].numPoints 		= 0;
 	gContrails[i].nextPointIndex	= 0;
 	gContrails[i].width				= width;
 	gContrails[i].indexPtr			= contrailNum;
+	gContrails[i].owner				= owner;
+	gContrails[i].numTriangles[0]	= 0;
+	gContrails[i].numTriangles[1]	= 0;
 
 	for (j = 0; j < MAX_REF_POINTS_IN_CONTRAIL; j++)
 		gContrails[i].alphas[j] = 0;							// clear all alpha values
@@ -186,9 +237,10 @@ long	p;
 	p = gContrails[contrailNum].nextPointIndex;				// get index into ref point list
 
 	gContrails[contrailNum].alphas[p] 		= alpha;		// set initial alpha for this ref pt.
-	gContrails[contrailNum].refPoints[p] 	= *where;		// set coord of ref pt.
 	gContrails[contrailNum].aimVectors[p] 	= *aim;			// remember the aim vector at this pt
 
+	SetContrailRefPointVertices(contrailNum, p, where);
+
 
 			/* INC REF PT INDEX */
 
@@ -215,7 +267,42 @@ long	p;
 	if (p < 0)
 		p = MAX_REF_POINTS_IN_CONTRAIL-1;
 
-	gContrails[contrailNum].refPoints[p] = *where;			// set coord of ref pt.
+	SetContrailRefPointVertices(contrailNum, p, where);			// move the head of the ribbon
+}
+
+
+/***************** SET CONTRAIL REF POINT VERTICES *********************/
+//
+// Sets the left & right vertices of a ref pt in both buffers.
+//
+
+static void SetContrailRefPointVertices(short contrailNum, short refP, const OGLPoint3D *where)
+{
+ContrailType	*contrail = &gContrails[contrailNum];
+OGLVector3D		*v = &contrail->aimVectors[refP];
+OGLVector3D		cross;
+int				vertexIndex = (contrailNum * MAX_REF_POINTS_IN_CONTRAIL + refP) * 2;
+
+		/* CALC CROSS PRODUCT TO GIVE US THE SIDE VECTOR (AND MULTIPLY BY WIDTH) */
+
+	cross.x = -v->z * contrail->width;
+	cross.z = v->x * contrail->width;
+
+
+		/* SET THE COORDS OF THE LEFT & RIGHT VERTICES */
+
+	for (int b = 0; b < 2; b++)
+	{
+		OGLPoint3D	*points = &gContrailMesh[b].points[vertexIndex];
+
+		points[0].x = where->x + cross.x;								// left vertex coord
+		points[0].z = where->z + cross.z;
+		points[0].y = where->y;
+
+		points[1].x = where->x - cross.x;								// right vertex coord
+		points[1].z = where->z - cross.z;
+		points[1].y = where->y;
+	}
 }
 
 
@@ -229,24 +316,31 @@ long	p;
 void DisconnectContrail(short contrailNum)
 {
 	if (contrailNum != -1)
+	{
 		gContrails[contrailNum].indexPtr = nil;
+		gContrails[contrailNum].owner = nil;
+	}
 }
 
 
 #pragma mark -
 
 /*********************** MOVE CONTRAILS *******************************/
+//
+// Fades the ref pts and lists the triangles of every contrail's visible segments
+// in this frame's buffer, so that DrawContrails can draw them all at once.
+//
 
 static void MoveContrails(ObjNode *theNode)
 {
-short				i, refP, startRefP, vertexIndex;
-short				numActivePts, t;
+short				i, refP, startRefP;
+short				numActivePts;
+int					vertexIndex, prevVertexIndex, t;
 float				fps = gFramesPerSecondFrac;
 MOVertexArrayData	*mesh;
-OGLPoint3D			*points;
 MOTriangleIndecies	*triangles;
 OGLColorRGBA		*colors;
-float				alphaFade;
+float				alphaFade, alpha;
 short				buffNum;
 
 
@@ -255,6 +349,10 @@ short				buffNum;
 
 	theNode->VertexArrayMode = VERTEX_ARRAY_RANGE_TYPE_CONTRAILS1 + buffNum;	// update the VAR range info
 
+	mesh 		= &gContrailMesh[buffNum];									// get ptrs to vertex arrays
+	triangles 	= mesh->triangles;
+	colors 		= mesh->colorsFloat;
+	t 			= 0;
 
 	for (i = 0; i < MAX_CONTRAILS; i++)
 	{
@@ -267,13 +365,18 @@ short				buffNum;
 		if (startRefP < 0)
 			startRefP = MAX_REF_POINTS_IN_CONTRAIL-1;
 
+		gContrails[i].firstTriangle[buffNum] = t;
+		gContrails[i].numTriangles[buffNum] = 0;
+
 
 			/*********************************************/
-			/* DEC THE ALPHA OF THE REF PT & COUNT # PTS */
+			/* DEC THE ALPHA OF THE REF PTS & SET COLORS */
 			/*********************************************/
 
 		numActivePts = 0;											// init ref pt counter
 		refP = startRefP;
+		alphaFade = 0.0f;
+		prevVertexIndex = 0;
 
 		while(gContrails[i].alphas[refP] > 0.0f)
 		{
@@ -281,190 +384,150 @@ short				buffNum;
 			if (gContrails[i].alphas[refP] <= 0.0f)					// if the alpha has gone to zero then this is the tail end of the contrail
 				break;
 
-			numActivePts++;
-
-			refP--;													// dec ref pt index
-			if (refP < 0)											// see if wrap around
-				refP = MAX_REF_POINTS_IN_CONTRAIL-1;
-			if (refP == startRefP)									// if wrapped back to start then exit loop
-				break;
-		}
-
-			/* IF NO ACTIVE PTS THEN DISABLE THE CONTRAIL */
-
-		if (numActivePts == 0)
-		{
-			gContrails[i].isUsed = false;								// not used anymore
-			if (gContrails[i].indexPtr)
-				*gContrails[i].indexPtr = -1;							// pass -1 back to the index
-
-
-			continue;
-		}
-
-				/******************/
-				/* BUILD GEOMETRY */
-				/******************/
-
-		mesh = &gContrails[i].meshData[buffNum];						// get ptr to mesh struct
-
-		if (numActivePts < 2)											// it takes at least 2 ref pts to build any geometry
-		{
-			mesh->numPoints = 0;
-			mesh->numTriangles = 0;
-			continue;
-		}
+			vertexIndex = (i * MAX_REF_POINTS_IN_CONTRAIL + refP) * 2;
 
 
-				/* SET MESH BASIC INFO */
-
-		mesh->numPoints 	= numActivePts * 2;							// set # pts in geometry
-		mesh->numTriangles	= numActivePts * 2 - 2;						// set # triangles in geometry
-
-		points 		= mesh->points;										// get ptrs to vertex arrays
-		triangles 	= mesh->triangles;
-		colors 		= mesh->colorsFloat;
-
-		refP = startRefP;
-
-		alphaFade = 0.0f;
-		vertexIndex = t = 0;
-
-		for (; numActivePts > 0; numActivePts--)						// loop thru all active ref pts to build geometry from
-		{
-			OGLVector3D	cross, *v;
-			float		refX, refY, refZ;
-			short		nextRefP;
-
-			nextRefP = refP - 1;										// get index to next ref pt, for vector calculations below
-			if (nextRefP < 0)
-				nextRefP = MAX_REF_POINTS_IN_CONTRAIL-1;
+				/* SET ALPHA TO TRANSPARENT ON THE HEAD (THE TAIL IS DONE BELOW) */
 
-
-				/**************************/
-				/* CALCULATE THE VERTICES */
-				/**************************/
-
-			refX = gContrails[i].refPoints[refP].x;						// get ref pt coords
-			refY = gContrails[i].refPoints[refP].y;
-			refZ = gContrails[i].refPoints[refP].z;
-
-			v = &gContrails[i].aimVectors[refP];							// get ptr to ref pt's aim vector
-
-
-				/* CALC CROSS PRODUCT TO GIVE US THE SIDE VECTOR (AND MULTIPLY BY WIDTH) */
-
-			cross.x = -v->z * gContrails[i].width;
-			cross.z = v->x * gContrails[i].width;
-
-
-				/* SET THE COORDS OF THE LEFT & RIGHT VERTICES */
-
-			points[vertexIndex].x = refX + cross.x;							// left vertex coord
-			points[vertexIndex].z = refZ + cross.z;
-			points[vertexIndex].y = refY;
-
-			points[vertexIndex+1].x = refX - cross.x;						// right vertex coord
-			points[vertexIndex+1].z = refZ - cross.z;
-			points[vertexIndex+1].y = refY;
-
-
-					/*********************/
-					/* SET VERTEX COLORS */
-					/*********************/
-
-				/* SET ALPHA TO TRANSPARENT ON END TIPS */
-
-			if ((vertexIndex == 0) || (numActivePts == 1))
-			{
-				colors[vertexIndex].a =
-				colors[vertexIndex+1].a = 0;
-			}
+			if (numActivePts == 0)
+				alpha = 0;
 
 				/* OTHERWISE USE CALCULATION */
 
 			else
 			{
-				colors[vertexIndex].a = gContrails[i].alphas[refP] * alphaFade;
-				colors[vertexIndex+1].a =  gContrails[i].alphas[refP] * alphaFade;
+				alpha = gContrails[i].alphas[refP] * alphaFade;
 
 				alphaFade += .05f;
 				if (alphaFade > 1.0f)
 					alphaFade = 1.0f;
 			}
 
-
-					/* SET CONTRAIL COLOR */
-
-			colors[vertexIndex].r =
-			colors[vertexIndex].g =
-			colors[vertexIndex].b =
-			colors[vertexIndex+1].r =
-			colors[vertexIndex+1].g =
-			colors[vertexIndex+1].b = 1.0f;
+			colors[vertexIndex].a =
+			colors[vertexIndex+1].a = alpha;
 
 
+				/********************************************/
+				/* CONNECT IT TO THE PREVIOUS ONE W/ 2 TRIS */
+				/********************************************/
 
-				/*******************/
-				/* BUILD TRIANGLES */
-				/*******************/
-
-			if (vertexIndex > 0)
+			if (numActivePts > 0)
 			{
-				triangles[t].vertexIndices[0] = vertexIndex-2;				// back left vert
-				triangles[t].vertexIndices[1] = vertexIndex-1;				// back right vert
+				triangles[t].vertexIndices[0] = prevVertexIndex;			// back left vert
+				triangles[t].vertexIndices[1] = prevVertexIndex+1;			// back right vert
 				triangles[t].vertexIndices[2] = vertexIndex;				// fore left vert
 				t++;
 
 				triangles[t].vertexIndices[0] = vertexIndex;				// fore left vert
-				triangles[t].vertexIndices[1] = vertexIndex-1;				// back right vert
+				triangles[t].vertexIndices[1] = prevVertexIndex+1;			// back right vert
 				triangles[t].vertexIndices[2] = vertexIndex+1;				// fore right vert
 				t++;
 			}
 
+			prevVertexIndex = vertexIndex;
+			numActivePts++;
 
-			vertexIndex += 2;
-			refP--;
-			if (refP < 0)
+			refP--;													// dec ref pt index
+			if (refP < 0)											// see if wrap around
 				refP = MAX_REF_POINTS_IN_CONTRAIL-1;
+			if (refP == startRefP)									// if wrapped back to start then exit loop
+				break;
 		}
 
+			/* IF NO ACTIVE PTS THEN DISABLE THE CONTRAIL */
 
-		OGL_SetVertexArrayRangeDirty(theNode->VertexArrayMode);				// we modified some geometry so we'll need an update
+		if (numActivePts == 0)
+		{
+			gContrails[i].isUsed = false;								// not used anymore
+			if (gContrails[i].indexPtr)
+				*gContrails[i].indexPtr = -1;							// pass -1 back to the index
+
+
+			continue;
+		}
+
+			/* TAIL TIP IS TRANSPARENT TOO */
+
+		colors[prevVertexIndex].a =
+		colors[prevVertexIndex+1].a = 0;
+
+		gContrails[i].numTriangles[buffNum] = t - gContrails[i].firstTriangle[buffNum];
 	}
+
+	GAME_ASSERT(t <= MAX_CONTRAIL_TRIANGLES);
+
+	mesh->numTriangles = t;
+
+	if (t > 0)
+		OGL_SetVertexArrayRangeDirty(theNode->VertexArrayMode);				// we modified some geometry so we'll need an update
 }
 
 
 
 /*********************** DRAW CONTRAILS **************************/
+//
+// Normally every contrail goes in one draw call.  In between fixed simulation ticks,
+// a contrail whose owner is drawn interpolated is drawn on its own with the owner's
+// offset, so that the head of the ribbon stays on the wing tip.
+//
 
 static void DrawContrails(ObjNode *dummy)
 {
-short		i;
-short		buffNum = gGameViewInfoPtr->frameCount & 1;					// which VAR buffer to use?
+short				i;
+short				buffNum = gGameViewInfoPtr->frameCount & 1;			// which VAR buffer to use?
+MOVertexArrayData	*mesh = &gContrailMesh[buffNum];
+OGLVector3D			drawOffset;
+Boolean				anyOffset = false;
 
 	(void) dummy;
 
+	if (mesh->numTriangles == 0)
+		return;
 
 	OGL_EnableBlend();
 	OGL_DisableTexture2D();
 
 	for (i = 0; i < MAX_CONTRAILS; i++)
 	{
-		if (gContrails[i].isUsed
-			&& gContrails[i].meshData[buffNum].numTriangles > 0)
+		if (gContrails[i].isUsed && GetObjectDrawOffset(gContrails[i].owner, &drawOffset))
 		{
-			MO_DrawGeometry_VertexArray(&gContrails[i].meshData[buffNum]);
+			anyOffset = true;
+			break;
 		}
 	}
-}
 
+	if (!anyOffset)
+	{
+		MO_DrawGeometry_VertexArray(mesh);									// every contrail in one go
+		return;
+	}
 
+	for (i = 0; i < MAX_CONTRAILS; i++)
+	{
+		ContrailType		*contrail = &gContrails[i];
+		MOVertexArrayData	part;
+		Boolean				offset;
 
+		if (!contrail->isUsed || contrail->numTriangles[buffNum] == 0)
+			continue;
 
+		part = *mesh;														// same vertices, just this contrail's triangles
+		part.triangles = &mesh->triangles[contrail->firstTriangle[buffNum]];
+		part.numTriangles = contrail->numTriangles[buffNum];
 
+		offset = GetObjectDrawOffset(contrail->owner, &drawOffset);
+		if (offset)
+		{
+			glPushMatrix();
+			glTranslatef(drawOffset.x, drawOffset.y, drawOffset.z);
+		}
 
+		MO_DrawGeometry_VertexArray(&part);
 
+		if (offset)
+			glPopMatrix();
+	}
+}
 
 #pragma mark -
 
@@ -545,7 +608,7 @@ do_it:
 				/* START NEW CONTRAIL IF NEEDED */
 
 		if (player->ContrailSlot[i] == -1)
-			MakeNewContrail(1.1f, &player->ContrailSlot[i]);
+			MakeNewContrail(player, 1.1f, &player->ContrailSlot[i]);
 
 
 			/* CHECK IF WE'VE GONE FAR ENOUGH TO ADD A NEW REF PT TO EXISTING CONTRAIL */
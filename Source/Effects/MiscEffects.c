@@ -36,7 +36,6 @@ void InitEffects(void)
 {
 
 	InitParticleSystem();
-	InitConfettiManager();
 	InitShardSystem();
 
 			/* SET SPRITE BLENDING FLAGS */
@@ -17,10 +17,13 @@
 /****************************/
 
 static void DeleteParticleGroup(long groupNum);
+static short GetFreeParticleSlot(short group);
 static void MoveParticleGroups(ObjNode *theNode);
 static void PurgePendingParticleGroups(Boolean forcePurgeNow);
 static void UpdateParticleGroupsGeometry(void);
+static void UpdateConfettiGeometry(ParticleGroupType *pg, MOVertexArrayData *geoData, const short *usedList, int n);
 static void DrawParticleGroups(ObjNode *theNode);
+static void DrawConfettiGroups(ObjNode *theNode);
 
 static void MoveSmoker(ObjNode *theNode);
 static void DrawFlame(ObjNode *theNode);
@@ -49,8 +52,12 @@ ParticleGroupType	*gParticleGroups[MAX_PARTICLE_GROUPS];
 static float	gGravitoidDistBuffer[MAX_PARTICLES][MAX_PARTICLES];
 
 NewParticleGroupDefType	gNewParticleGroupDef;
+NewConfettiGroupDefType	gNewConfettiGroupDef;
 
 short			gNumActiveParticleGroups = 0;
+int				gNumParticlesThisFrame = 0;					// live particles & confetti, for the debug display
+
+static ObjNode	*gConfettiDrawer = nil;
 
 #define	RippleTimer	SpecialF[0]
 
@@ -94,6 +101,26 @@ void InitParticleSystem(void)
 	};
 	ObjNode* obj = MakeNewObject(&def);
 	obj->VertexArrayMode = VERTEX_ARRAY_RANGE_TYPE_PARTICLES1;
+
+
+		/***********************************************/
+		/* AND ANOTHER ONE TO DRAW THE CONFETTI GROUPS */
+		/***********************************************/
+		//
+		// Confetti are lit & opaque-ish, so they go in before the particles (which are xparent).
+		// They're moved along with everything else in MoveParticleGroups.
+		//
+
+	NewObjectDefinitionType confettiDef =
+	{
+		.genre		= CUSTOM_GENRE,
+		.slot		= CONFETTI_SLOT,
+		.scale		= 1,
+		.flags		= STATUS_BIT_DOUBLESIDED|STATUS_BIT_DONTCULL,
+		.drawCall	= DrawConfettiGroups,
+	};
+	gConfettiDrawer = MakeNewObject(&confettiDef);
+	gConfettiDrawer->VertexArrayMode = VERTEX_ARRAY_RANGE_TYPE_PARTICLES1;
 }
 
 
@@ -102,6 +129,7 @@ void InitParticleSystem(void)
 void DisposeParticleSystem(void)
 {
 	DeleteAllParticleGroups();
+	gConfettiDrawer = nil;									// the object itself went with DeleteAllObjects
 }
 
 
@@ -162,8 +190,10 @@ short	i, g;
 
 					for (i = 0; i < gNumPlayers; i++)
 					{
-						MO_DisposeObjectReference(gParticleGroups[g]->geometryObj[0][i]);
-						MO_DisposeObjectReference(gParticleGroups[g]->geometryObj[1][i]);
+						if (gParticleGroups[g]->geometryObj[0][i])			// confetti only have pane 0's
+							MO_DisposeObjectReference(gParticleGroups[g]->geometryObj[0][i]);
+						if (gParticleGroups[g]->geometryObj[1][i])
+							MO_DisposeObjectReference(gParticleGroups[g]->geometryObj[1][i]);
 					}
 
 
@@ -192,10 +222,13 @@ short	i, g;
 
 short NewParticleGroup(NewParticleGroupDefType *def)
 {
-short					p,i,j,k,b;
+short					p,i,j,k,b,numPanes;
 OGLTextureCoord			*uv;
 MOVertexArrayData 		vertexArrayData;
 MOTriangleIndecies		*t;
+int						prevTag;
+
+	numPanes = (def->type == PARTICLE_TYPE_CONFETTI) ? 1 : gNumPlayers;		// confetti look the same from every pane
 
 
 			/*************************/
@@ -208,9 +241,14 @@ MOTriangleIndecies		*t;
 		{
 				/* ALLOCATE NEW GROUP */
 
+			prevTag = SetMemoryTag(MEMORY_TAG_PARTICLES);
+
 			gParticleGroups[i] = (ParticleGroupType *) AllocPtrClear(sizeof(ParticleGroupType));
 			if (gParticleGroups[i] == nil)
+			{
+				SetMemoryTag(prevTag);
 				return(-1);									// out of memory
+			}
 
 
 				/* INITIALIZE THE GROUP */
@@ -246,12 +284,14 @@ MOTriangleIndecies		*t;
 				// have to wait for the previous frame to complete drawing before we can modify
 				// this frame's particle geometry.
 				//
+				// Confetti don't face the camera, so they only need the 2 buffers for pane 0.
+				//
 
 			for (b = 0; b < 2; b++)
 			{
 				short	playerNum;
 
-				for (playerNum = 0; playerNum < gNumPlayers; playerNum++)
+				for (playerNum = 0; playerNum < numPanes; playerNum++)
 				{
 							/* SET THE DATA */
 
@@ -303,6 +343,7 @@ MOTriangleIndecies		*t;
 
 			gNumActiveParticleGroups++;
 
+			SetMemoryTag(prevTag);
 			return(i);
 		}
 	}
@@ -325,35 +366,23 @@ short	p,group;
 
 	group = def->groupNum;
 
-	GAME_ASSERT_MESSAGE(group >= 0 && group < MAX_PARTICLE_GROUPS, "Illegal group #");
-
-	if (gParticleGroups[group] == nil)
-	{
+	p = GetFreeParticleSlot(group);
+	if (p < 0)
 		return(true);
-	}
-
-
-			/* SCAN FOR FREE SLOT */
-
-	for (p = 0; p < MAX_PARTICLES; p++)
-	{
-		if (!gParticleGroups[group]->isUsed[p])
-			goto got_it;
-	}
-
-			/* NO FREE SLOTS */
-
-	return(true);
-
 
 			/* INIT PARAMETERS */
-got_it:
+
 	gParticleGroups[group]->alpha[p] = def->alpha;
 	gParticleGroups[group]->scale[p] = def->scale;
 	gParticleGroups[group]->coord[p] = *def->where;
 	gParticleGroups[group]->delta[p] = *def->delta;
 	gParticleGroups[group]->rotZ[p] = def->rotZ;
 	gParticleGroups[group]->rotDZ[p] = def->rotDZ;
+	gParticleGroups[group]->rotX[p] = 0;
+	gParticleGroups[group]->rotY[p] = 0;
+	gParticleGroups[group]->rotDX[p] = 0;
+	gParticleGroups[group]->rotDY[p] = 0;
+	gParticleGroups[group]->fadeDelay[p] = 0;
 	gParticleGroups[group]->isUsed[p] = true;
 
 
@@ -362,6 +391,28 @@ got_it:
 }
 
 
+/******************** GET FREE PARTICLE SLOT **********************/
+//
+// Returns -1 if particle group is invalid or full.
+//
+
+static short GetFreeParticleSlot(short group)
+{
+	GAME_ASSERT_MESSAGE(group >= 0 && group < MAX_PARTICLE_GROUPS, "Illegal group #");
+
+	if (gParticleGroups[group] == nil)
+		return(-1);
+
+	for (short p = 0; p < MAX_PARTICLES; p++)
+	{
+		if (!gParticleGroups[group]->isUsed[p])
+			return(p);
+	}
+
+	return(-1);												// no free slots
+}
+
+
 /*************** SET WHICH PANES TO DRAW THE PARTICLE GROUP IN ****************/
 
 void SetParticleGroupVisiblePanes(short group, bool visibleForPlayer1, bool visibleForPlayer2)
@@ -376,18 +427,94 @@ void SetParticleGroupVisiblePanes(short group, bool visibleForPlayer1, bool visi
 }
 
 
+#pragma mark -
+
+
+/********************** NEW CONFETTI GROUP *************************/
+//
+// Confetti are particle groups of type PARTICLE_TYPE_CONFETTI:  lit quads that
+// tumble on all 3 axes instead of facing the camera, and that can wait a while before fading.
+// They use the particle sprites and share the particle groups' pool.
+//
+// OUTPUT:	group ID#
+//
+
+short NewConfettiGroup(NewConfettiGroupDefType *def)
+{
+NewParticleGroupDefType	groupDef;
+
+	groupDef.magicNum			= def->magicNum;
+	groupDef.type				= PARTICLE_TYPE_CONFETTI;
+	groupDef.flags				= def->flags;
+	groupDef.gravity			= def->gravity;
+	groupDef.magnetism			= 0;
+	groupDef.baseScale			= def->baseScale;
+	groupDef.decayRate			= def->decayRate;
+	groupDef.fadeRate			= def->fadeRate;
+	groupDef.particleTextureNum	= def->confettiTextureNum;
+	groupDef.srcBlend			= GL_SRC_ALPHA;
+	groupDef.dstBlend			= GL_ONE_MINUS_SRC_ALPHA;
+
+	return(NewParticleGroup(&groupDef));
+}
+
+
+/******************** ADD CONFETTI TO GROUP **********************/
+//
+// Returns true if confetti group was invalid or is full.
+//
+
+Boolean AddConfettiToGroup(NewConfettiDefType *def)
+{
+ParticleGroupType	*pg;
+short				p;
+
+	p = GetFreeParticleSlot(def->groupNum);
+	if (p < 0)
+		return(true);
+
+	pg = gParticleGroups[def->groupNum];
+	GAME_ASSERT(pg->type == PARTICLE_TYPE_CONFETTI);
+
+			/* INIT PARAMETERS */
+
+	pg->alpha[p] 		= def->alpha;
+	pg->scale[p] 		= def->scale;
+	pg->coord[p] 		= *def->where;
+	pg->delta[p] 		= *def->delta;
+	pg->rotX[p]			= def->rot.x;
+	pg->rotY[p]			= def->rot.y;
+	pg->rotZ[p]			= def->rot.z;
+	pg->rotDX[p]		= def->deltaRot.x;
+	pg->rotDY[p]		= def->deltaRot.y;
+	pg->rotDZ[p]		= def->deltaRot.z;
+	pg->fadeDelay[p]	= def->fadeDelay;
+	pg->isUsed[p] 		= true;
+
+	return(false);
+}
+
+
+#pragma mark -
+
+
 /****************** MOVE PARTICLE GROUPS *********************/
 
 static void MoveParticleGroups(ObjNode *theNode)
 {
 uint32_t		flags;
-long		i,n,p,j;
+long		i,n,p,j,q,numQueries;
 float		fps = gFramesPerSecondFrac;
 float		y,baseScale,oneOverBaseScaleSquared,gravity;
 float		decayRate,magnetism,fadeRate;
 OGLPoint3D	*coord;
 OGLVector3D	*delta;
 short		buffNum, varMode;
+Byte		movedParticle[MAX_PARTICLES];
+Byte		queryParticle[MAX_PARTICLES];
+OGLPoint2D	queryCoord[MAX_PARTICLES];
+float		queryY[MAX_PARTICLES];
+OGLVector3D	queryNormal[MAX_PARTICLES];
 
 				/* FIRST UPDATE THE PURGE QUEUE */
 
@@ -399,6 +526,8 @@ short		buffNum, varMode;
 	buffNum = gGameViewInfoPtr->frameCount & 1;								// which VAR buffer to use?
 
 	varMode = theNode->VertexArrayMode = VERTEX_ARRAY_RANGE_TYPE_PARTICLES1 + buffNum;	// update the VAR range info
+	if (gConfettiDrawer)
+		gConfettiDrawer->VertexArrayMode = varMode;							// confetti use the same buffers
 
 
 	for (i = 0; i < MAX_PARTICLE_GROUPS; i++)
@@ -419,11 +548,13 @@ short		buffNum, varMode;
 			flags 		= gParticleGroups[i]->flags;
 
 			n = 0;															// init counter
+			numQueries = 0;
 			for (p = 0; p < MAX_PARTICLES; p++)
 			{
 				if (!gParticleGroups[i]->isUsed[p])							// make sure this particle is used
 					continue;
 
+				movedParticle[n] = p;
 				n++;														// inc counter
 				delta = &gParticleGroups[i]->delta[p];						// get ptr to deltas
 				coord = &gParticleGroups[i]->coord[p];						// get ptr to coords
@@ -451,6 +582,21 @@ short		buffNum, varMode;
 							break;
 
 
+							/* CONFETTI */
+							//
+							// Same as sparks, but they tumble on the other 2 axes too
+							//
+
+					case	PARTICLE_TYPE_CONFETTI:
+							gParticleGroups[i]->rotX[p] += gParticleGroups[i]->rotDX[p] * fps;
+							gParticleGroups[i]->rotY[p] += gParticleGroups[i]->rotDY[p] * fps;
+
+							coord->x += delta->x * fps;						// move it
+							coord->y += delta->y * fps;
+							coord->z += delta->z * fps;
+							break;
+
+
 							/* GRAVITOIDS */
 							//
 							// Every particle has gravity pull on other particle
@@ -534,49 +680,77 @@ short		buffNum, varMode;
 				}
 
 
+				/****************************/
+				/* QUEUE GROUND CHECK QUERY */
+				/****************************/
+
+				if (!(flags & PARTICLE_FLAGS_DONTCHECKGROUND))
+				{
+					queryParticle[numQueries] = p;
+					queryCoord[numQueries].x = coord->x;
+					queryCoord[numQueries].y = coord->z;
+					numQueries++;
+				}
+			}
+
+				/* GET TERRAIN UNDER ALL OF THIS GROUP'S PARTICLES AT ONCE */
+
+			if (numQueries > 0)
+				GetTerrainYBatch(numQueries, queryCoord, queryY, queryNormal);
+
+			for (q = 0; q < numQueries; q++)
+			{
+				p = queryParticle[q];
+				delta = &gParticleGroups[i]->delta[p];
+				coord = &gParticleGroups[i]->coord[p];
+
 				/*****************/
 				/* SEE IF BOUNCE */
 				/*****************/
 
-				if (!(flags & PARTICLE_FLAGS_DONTCHECKGROUND))
-				{
-					y = GetTerrainY(coord->x, coord->z)+10.0f;					// get terrain coord at particle x/z
+				y = queryY[q];													// terrain coord at particle x/z
+				if (y == ILLEGAL_TERRAIN_Y && gParticleGroups[i]->type == PARTICLE_TYPE_CONFETTI)
+					y = 0.0f;													// confetti bounce on the floor of the Win screen
+				y += 10.0f;
 
-					if (flags & PARTICLE_FLAGS_BOUNCE)
+				if (flags & PARTICLE_FLAGS_BOUNCE)
+				{
+					if (delta->y < 0.0f)										// if moving down, see if hit floor
 					{
-						if (delta->y < 0.0f)									// if moving down, see if hit floor
+						if (coord->y < y)
 						{
-							if (coord->y < y)
-							{
-								coord->y = y;
-								delta->y *= -.4f;
+							coord->y = y;
+							delta->y *= -.4f;
 
-								delta->x += gRecentTerrainNormal.x * 300.0f;	// reflect off of surface
-								delta->z += gRecentTerrainNormal.z * 300.0f;
+							delta->x += queryNormal[q].x * 300.0f;				// reflect off of surface
+							delta->z += queryNormal[q].z * 300.0f;
 
-								if (flags & PARTICLE_FLAGS_DISPERSEIFBOUNCE)	// see if disperse on impact
-								{
-									delta->y *= .4f;
-									delta->x *= 5.0f;
-									delta->z *= 5.0f;
-								}
+							if (flags & PARTICLE_FLAGS_DISPERSEIFBOUNCE)		// see if disperse on impact
+							{
+								delta->y *= .4f;
+								delta->x *= 5.0f;
+								delta->z *= 5.0f;
 							}
 						}
 					}
+				}
 
-					/***************/
-					/* SEE IF GONE */
-					/***************/
+				/***************/
+				/* SEE IF GONE */
+				/***************/
 
-					else
+				else
+				{
+					if (coord->y < y)											// if hit floor then nuke particle
 					{
-						if (coord->y < y)									// if hit floor then nuke particle
-						{
-							gParticleGroups[i]->isUsed[p] = false;
-						}
+						gParticleGroups[i]->isUsed[p] = false;
 					}
 				}
+			}
 
+			for (j = 0; j < n; j++)
+			{
+				p = movedParticle[j];
 
 					/* DO SCALE */
 
@@ -586,11 +760,13 @@ short		buffNum, varMode;
 
 					/* DO FADE */
 
-				gParticleGroups[i]->alpha[p] -= fadeRate * fps;				// fade it
-				if (gParticleGroups[i]->alpha[p] <= 0.0f)					// see if gone
-					gParticleGroups[i]->isUsed[p] = false;
-
-
+				gParticleGroups[i]->fadeDelay[p] -= fps;					// (confetti wait a bit)
+				if (gParticleGroups[i]->fadeDelay[p] <= 0.0f)
+				{
+					gParticleGroups[i]->alpha[p] -= fadeRate * fps;			// fade it
+					if (gParticleGroups[i]->alpha[p] <= 0.0f)				// see if gone
+						gParticleGroups[i]->isUsed[p] = false;
+				}
 			}
 
 				/* SEE IF GROUP WAS EMPTY, THEN DELETE */
@@ -614,6 +790,11 @@ short		buffNum, varMode;
 
 
 /**************** UPDATE PARTICLE GROUPS GEOMETRY *********************/
+//
+// Everything that doesn't depend on the camera (which particles are alive, their colors,
+// and the group's culling bbox) is done once per group.  Only the billboarding is redone
+// for each player's pane.  Confetti don't billboard, so they're built just once.
+//
 
 static void UpdateParticleGroupsGeometry(void)
 {
@@ -624,10 +805,13 @@ OGLPoint3D			v[4],*coord;
 static const OGLVector3D up = {0,1,0};
 const OGLPoint3D	*camCoords;
 short				paneNum;
+short				usedList[MAX_PARTICLES];
 
 
 	int buffNum = gGameViewInfoPtr->frameCount & 1;			// which VAR buffer to use?
 
+	gNumParticlesThisFrame = 0;
+
 
 	v[0].z = 												// init z's to 0
 	v[1].z =
@@ -635,157 +819,225 @@ short				paneNum;
 	v[3].z = 0;
 
 
-			/*****************************************/
-			/* BUILD GEOMETRY FOR EACH PLAYER'S PANE */
-			/*****************************************/
+				/******************************/
+				/* UPDATE EACH PARTICLE GROUP */
+				/******************************/
 
-	for (paneNum = 0; paneNum < gNumPlayers; paneNum++)
+	for (int g = 0; g < MAX_PARTICLE_GROUPS; g++)
 	{
-				/* GET CAMERA INFO FOR THIS PANE */
+		ParticleGroupType	*pg = gParticleGroups[g];
+		float				minX,minY,minZ,maxX,maxY,maxZ;
+		uint32_t			allAim;
+		int					n;
+
+		if (!pg)
+			continue;
 
-		camCoords = &gGameViewInfoPtr->cameraPlacement[paneNum].cameraLocation;
+		if (pg->inPurgeQueue)											// skip if it's in the purge queue
+			continue;
+
+		allAim 		= pg->flags & PARTICLE_FLAGS_ALLAIM;
+		baseScale 	= pg->baseScale;									// get base scale
 
-					/******************************/
-					/* UPDATE EACH PARTICLE GROUP */
-					/******************************/
 
-		for (int g = 0; g < MAX_PARTICLE_GROUPS; g++)
+				/**************************************************/
+				/* GATHER LIVE PARTICLES & BUILD BBOX FOR CULLING */
+				/**************************************************/
+				//
+				// Whichever way a particle's quad gets aimed & spun, its corners
+				// stay within scale*sqrt(2) of its coord, so every pane can share this box.
+				//
+
+		minX = minY = minZ = 100000000;									// init bbox
+		maxX = maxY = maxZ = -minX;
+
+		n = 0;
+		for (int p = 0; p < MAX_PARTICLES; p++)
 		{
-			float	minX,minY,minZ,maxX,maxY,maxZ;
-			uint32_t	allAim;
+			float	r;
 
-			if (gParticleGroups[g])
-			{
-				if (gParticleGroups[g]->inPurgeQueue)							// skip if it's in the purge queue
-					continue;
+			if (!pg->isUsed[p])											// make sure this particle is used
+				continue;
 
-				allAim 		= gParticleGroups[g]->flags & PARTICLE_FLAGS_ALLAIM;
+			usedList[n++] = p;
 
-				geoData 	= &gParticleGroups[g]->geometryObj[buffNum][paneNum]->objectData;	// get pointer to geometry object data
-				vertexColors = geoData->colorsFloat;							// get pointer to vertex color array
-				baseScale 	= gParticleGroups[g]->baseScale;					// get base scale
+			coord = &pg->coord[p];
+			r = pg->scale[p] * baseScale * 1.4143f;
 
+			if (coord->x - r < minX)	minX = coord->x - r;
+			if (coord->x + r > maxX)	maxX = coord->x + r;
+			if (coord->y - r < minY)	minY = coord->y - r;
+			if (coord->y + r > maxY)	maxY = coord->y + r;
+			if (coord->z - r < minZ)	minZ = coord->z - r;
+			if (coord->z + r > maxZ)	maxZ = coord->z + r;
+		}
 
-						/********************************/
-						/* ADD ALL PARTICLES TO TRIMESH */
-						/********************************/
+		if (n == 0)														// if no particles, then skip
+			continue;
 
-				minX = minY = minZ = 100000000;									// init bbox
-				maxX = maxY = maxZ = -minX;
+		gNumParticlesThisFrame += n;
 
-				int n = 0;
-				for (int p = 0; p < MAX_PARTICLES; p++)
-				{
-					float			rot;
-					OGLMatrix4x4	m;
+		pg->bbox.min.x = minX;
+		pg->bbox.min.y = minY;
+		pg->bbox.min.z = minZ;
+		pg->bbox.max.x = maxX;
+		pg->bbox.max.y = maxY;
+		pg->bbox.max.z = maxZ;
 
-					if (!gParticleGroups[g]->isUsed[p])							// make sure this particle is used
-						continue;
+		if (pg->type == PARTICLE_TYPE_CONFETTI)
+		{
+			UpdateConfettiGeometry(pg, &pg->geometryObj[buffNum][0]->objectData, usedList, n);
+			continue;
+		}
 
-								/* CREATE VERTEX DATA */
 
-					scale = gParticleGroups[g]->scale[p] * baseScale;
+				/*****************************************/
+				/* BUILD GEOMETRY FOR EACH PLAYER'S PANE */
+				/*****************************************/
 
-					v[0].x = -scale;
-					v[0].y = scale;
+		for (paneNum = 0; paneNum < gNumPlayers; paneNum++)
+		{
+			camCoords = &gGameViewInfoPtr->cameraPlacement[paneNum].cameraLocation;	// get camera info for this pane
 
-					v[1].x = -scale;
-					v[1].y = -scale;
+			geoData 	= &pg->geometryObj[buffNum][paneNum]->objectData;	// get pointer to geometry object data
+			vertexColors = geoData->colorsFloat;						// get pointer to vertex color array
 
-					v[2].x = scale;
-					v[2].y = -scale;
+			for (int i = 0; i < n; i++)
+			{
+				int				p = usedList[i];
+				float			rot;
+				OGLMatrix4x4	m;
 
-					v[3].x = scale;
-					v[3].y = scale;
+							/* CREATE VERTEX DATA */
 
+				scale = pg->scale[p] * baseScale;
 
-						/* TRANSFORM THIS PARTICLE'S VERTICES & ADD TO TRIMESH */
+				v[0].x = -scale;
+				v[0].y = scale;
 
-					coord = &gParticleGroups[g]->coord[p];						// get particle's coord
+				v[1].x = -scale;
+				v[1].y = -scale;
 
-					if ((n == 0) || allAim)										// only set the look-at matrix for the 1st particle unless we want to force it for all (optimization technique)
-						SetLookAtMatrixAndTranslate(&m, &up, coord, camCoords);	// aim at camera & translate
-					else
-					{
-						m.value[M03] = coord->x;								// update just the translate
-						m.value[M13] = coord->y;
-						m.value[M23] = coord->z;
-					}
+				v[2].x = scale;
+				v[2].y = -scale;
 
-					rot = gParticleGroups[g]->rotZ[p];							// get z rotation
-					if (rot != 0.0f)											// see if need to apply rotation matrix
-					{
-						OGLMatrix4x4	rm;
+				v[3].x = scale;
+				v[3].y = scale;
 
-						OGLMatrix4x4_SetRotate_Z(&rm, rot);
-						OGLMatrix4x4_Multiply(&rm, &m, &rm);
-						OGLPoint3D_TransformArray(&v[0], &rm, &geoData->points[n*4], 4);	// transform w/ rot
-					}
-					else
-						OGLPoint3D_TransformArray(&v[0], &m, &geoData->points[n*4], 4);		// transform no-rot
 
+					/* TRANSFORM THIS PARTICLE'S VERTICES & ADD TO TRIMESH */
 
-								/* UPDATE BBOX */
+				coord = &pg->coord[p];									// get particle's coord
 
-					for (int i = 0; i < 4; i++)
-					{
-						int j = n*4+i;
-
-						if (geoData->points[j].x < minX)
-							minX = geoData->points[j].x;
-						if (geoData->points[j].x > maxX)
-							maxX = geoData->points[j].x;
-						if (geoData->points[j].y < minY)
-							minY = geoData->points[j].y;
-						if (geoData->points[j].y > maxY)
-							maxY = geoData->points[j].y;
-						if (geoData->points[j].z < minZ)
-							minZ = geoData->points[j].z;
-						if (geoData->points[j].z > maxZ)
-							maxZ = geoData->points[j].z;
-					}
+				if ((i == 0) || allAim)									// only set the look-at matrix for the 1st particle unless we want to force it for all (optimization technique)
+					SetLookAtMatrixAndTranslate(&m, &up, coord, camCoords);	// aim at camera & translate
+				else
+				{
+					m.value[M03] = coord->x;							// update just the translate
+					m.value[M13] = coord->y;
+					m.value[M23] = coord->z;
+				}
 
-						/* UPDATE COLOR/TRANSPARENCY */
+				rot = pg->rotZ[p];										// get z rotation
+				if (rot != 0.0f)										// see if need to apply rotation matrix
+				{
+					OGLMatrix4x4	rm;
+
+					OGLMatrix4x4_SetRotate_Z(&rm, rot);
+					OGLMatrix4x4_Multiply(&rm, &m, &rm);
+					OGLPoint3D_TransformArray(&v[0], &rm, &geoData->points[i*4], 4);	// transform w/ rot
+				}
+				else
+					OGLPoint3D_TransformArray(&v[0], &m, &geoData->points[i*4], 4);		// transform no-rot
 
-					int temp = n*4;
-					for (int i = temp; i < (temp+4); i++)
-					{
-						vertexColors[i].r =
-						vertexColors[i].g =
-						vertexColors[i].b = 1.0;
-						vertexColors[i].a = gParticleGroups[g]->alpha[p];		// set transparency alpha
-					}
 
-					n++;											// inc particle count
+					/* UPDATE COLOR/TRANSPARENCY */
+
+				for (int j = i*4; j < (i*4+4); j++)
+				{
+					vertexColors[j].r =
+					vertexColors[j].g =
+					vertexColors[j].b = 1.0;
+					vertexColors[j].a = pg->alpha[p];					// set transparency alpha
 				}
+			}
 
-				if (n == 0)											// if no particles, then skip
-					continue;
+				/* UPDATE FINAL VALUES */
+
+			geoData->numTriangles = n*2;
+			geoData->numPoints = n*4;
+		}		// for paneNum
+	}
+}
 
-					/* UPDATE FINAL VALUES */
 
-				geoData->numTriangles = n*2;
-				geoData->numPoints = n*4;
 
 
-					/* SET BBOX FOR CULLING DURING DRAW */
 
-				gParticleGroups[g]->bbox.min.x = minX;				// build bbox for culling test
-				gParticleGroups[g]->bbox.min.y = minY;
-				gParticleGroups[g]->bbox.min.z = minZ;
-				gParticleGroups[g]->bbox.max.x = maxX;
-				gParticleGroups[g]->bbox.max.y = maxY;
-				gParticleGroups[g]->bbox.max.z = maxZ;
 
-//				gParticleGroups[g]->isCulled[paneNum] = !OGL_IsBBoxVisible(&bbox, nil);
-			}
-		}
-	}		// for paneNum
+/**************** UPDATE CONFETTI GEOMETRY *********************/
+//
+// Each confetti is a quad spun by its x/y/z rotation.  Rather than building a matrix
+// and transforming 4 points, we only need where the quad's x & y axes end up,
+// which are the first 2 columns of OGLMatrix4x4_SetRotate_XYZ.
+//
 
+static void UpdateConfettiGeometry(ParticleGroupType *pg, MOVertexArrayData *geoData, const short *usedList, int n)
+{
+OGLPoint3D			*points = geoData->points;
+OGLColorRGBA		*vertexColors = geoData->colorsFloat;
+float				baseScale = pg->baseScale;
 
-}
+	for (int i = 0; i < n; i++)
+	{
+		int			p = usedList[i];
+		float		sx,cx,sy,cy,sz,cz,scale;
+		OGLVector3D	ax,ay;
+		OGLPoint3D	*coord = &pg->coord[p];
+		OGLPoint3D	*v = &points[i*4];
+
+		sx = sin(pg->rotX[p]);
+		cx = cos(pg->rotX[p]);
+		sy = sin(pg->rotY[p]);
+		cy = cos(pg->rotY[p]);
+		sz = sin(pg->rotZ[p]);
+		cz = cos(pg->rotZ[p]);
+
+		scale = pg->scale[p] * baseScale;
+
+		ax.x = cy*cz * scale;											// quad's x axis
+		ax.y = cy*sz * scale;
+		ax.z = -sy * scale;
+
+		ay.x = (sx*sy*cz - cx*sz) * scale;								// quad's y axis
+		ay.y = (sx*sy*sz + cx*cz) * scale;
+		ay.z = sx*cy * scale;
+
+					/* SET CORNERS */
+					//
+					// Wound to match the particle UVs: (-x,-y) (-x,+y) (+x,+y) (+x,-y)
+					//
+
+		v[0].x = coord->x - ax.x - ay.x;	v[0].y = coord->y - ax.y - ay.y;	v[0].z = coord->z - ax.z - ay.z;
+		v[1].x = coord->x - ax.x + ay.x;	v[1].y = coord->y - ax.y + ay.y;	v[1].z = coord->z - ax.z + ay.z;
+		v[2].x = coord->x + ax.x + ay.x;	v[2].y = coord->y + ax.y + ay.y;	v[2].z = coord->z + ax.z + ay.z;
+		v[3].x = coord->x + ax.x - ay.x;	v[3].y = coord->y + ax.y - ay.y;	v[3].z = coord->z + ax.z - ay.z;
+
+
+				/* UPDATE COLOR/TRANSPARENCY */
 
+		for (int j = i*4; j < (i*4+4); j++)
+		{
+			vertexColors[j].r =
+			vertexColors[j].g =
+			vertexColors[j].b = 1.0;
+			vertexColors[j].a = pg->alpha[p];							// set transparency alpha
+		}
+	}
 
+	geoData->numTriangles = n*2;
+	geoData->numPoints = n*4;
+}
 
 
 
@@ -819,6 +1071,7 @@ short				paneNum = gCurrentSplitScreenPane;
 
 		if (NULL == pg														// skip if not allocated
 			|| pg->inPurgeQueue 											// skip if it's in the purge queue
+			|| pg->type == PARTICLE_TYPE_CONFETTI							// skip confetti (see DrawConfettiGroups)
 			|| !OGL_IsBBoxVisible(&pg->bbox, nil)							// skip if culled
 			|| (paneNum == 0 && !pg->visibleForPlayer1)						// skip if hidden for this pane
 			|| (paneNum == 1 && !pg->visibleForPlayer2))					// skip if hidden for this pane
@@ -844,6 +1097,47 @@ short				paneNum = gCurrentSplitScreenPane;
 
 
 
+/**************** DRAW CONFETTI GROUPS *********************/
+
+static void DrawConfettiGroups(ObjNode *theNode)
+{
+long				buffNum;
+
+	(void) theNode;
+
+				/* SETUP ENVIRONTMENT */
+
+	OGL_PushState();
+	glLightModeli(GL_LIGHT_MODEL_TWO_SIDE, GL_TRUE);						// we want double sided lighting
+	OGL_SetColor4f(1,1,1,1);												// full white & alpha to start with
+
+	buffNum = gGameViewInfoPtr->frameCount & 1;								// which VAR buffer to use?
+
+	for (int g = 0; g < MAX_PARTICLE_GROUPS; g++)
+	{
+		const ParticleGroupType* pg = gParticleGroups[g];
+
+		if (NULL == pg														// skip if not allocated
+			|| pg->inPurgeQueue 											// skip if it's in the purge queue
+			|| pg->type != PARTICLE_TYPE_CONFETTI							// only confetti here
+			|| pg->geometryObj[buffNum][0]->objectData.numPoints == 0		// skip if nothing built yet
+			|| !OGL_IsBBoxVisible(&pg->bbox, nil))							// skip if culled
+		{
+			continue;
+		}
+
+		MO_DrawObject(pg->geometryObj[buffNum][0]);							// same geometry for every pane
+	}
+
+			/* RESTORE MODES */
+
+	OGL_PopState();
+	OGL_SetColor4f(1,1,1,1);												// reset this
+	glLightModeli(GL_LIGHT_MODEL_TWO_SIDE, GL_FALSE);
+}
+
+
+
 #pragma mark -
 
 /**************** VERIFY PARTICLE GROUP MAGIC NUM ******************/
@@ -853,6 +1147,26 @@ Boolean VerifyParticleGroupMagicNum(short group, uint32_t magicNum)
 	if (gParticleGroups[group] == nil)
 		return(false);
 
+	if (gParticleGroups[group]->type == PARTICLE_TYPE_CONFETTI)			// not a particle group anymore
+		return(false);
+
+	if (gParticleGroups[group]->magicNum != magicNum)
+		return(false);
+
+	return(true);
+}
+
+
+/**************** VERIFY CONFETTI GROUP MAGIC NUM ******************/
+
+Boolean VerifyConfettiGroupMagicNum(short group, uint32_t magicNum)
+{
+	if (gParticleGroups[group] == nil)
+		return(false);
+
+	if (gParticleGroups[group]->type != PARTICLE_TYPE_CONFETTI)			// group # was reused for particles
+		return(false);
+
 	if (gParticleGroups[group]->magicNum != magicNum)
 		return(false);
 
@@ -876,6 +1190,9 @@ OGLPoint3D	*coord;
 		if (!gParticleGroups[i])									// see if group active
 			continue;
 
+		if (gParticleGroups[i]->type == PARTICLE_TYPE_CONFETTI)		// confetti are harmless
+			continue;
+
 		if (inFlags)												// see if check flags
 		{
 			flags = gParticleGroups[i]->flags;
@@ -1029,6 +1346,62 @@ float					x,y,z;
 	}
 }
 
+
+/********************* MAKE CONFETTI EXPLOSION ***********************/
+
+void MakeConfettiExplosion(float x, float y, float z, float force, float scale, short texture, short quantity)
+{
+long					pg,i;
+OGLVector3D				delta,v;
+OGLPoint3D				pt;
+NewConfettiDefType		newConfettiDef;
+float					radius = 1.0f * scale;
+
+	gNewConfettiGroupDef.magicNum				= 0;
+	gNewConfettiGroupDef.flags					= PARTICLE_FLAGS_BOUNCE;
+	gNewConfettiGroupDef.gravity				= 250;
+	gNewConfettiGroupDef.baseScale				= 4.5f * scale;
+	gNewConfettiGroupDef.decayRate				= 0;
+	gNewConfettiGroupDef.fadeRate				= 1.0;
+	gNewConfettiGroupDef.confettiTextureNum		= texture;
+
+	pg = NewConfettiGroup(&gNewConfettiGroupDef);
+	if (pg != -1)
+	{
+		for (i = 0; i < quantity; i++)
+		{
+			pt.x = x + RandomFloat2() * radius;
+			pt.y = y + RandomFloat2() * radius;
+			pt.z = z + RandomFloat2() * radius;
+
+			v.x = pt.x - x;
+			v.y = pt.y - y;
+			v.z = pt.z - z;
+			FastNormalizeVector(v.x,v.y,v.z,&v);
+
+			delta.x = v.x * (force * scale);
+			delta.y = v.y * (force * scale);
+			delta.z = v.z * (force * scale);
+
+			newConfettiDef.groupNum		= pg;
+			newConfettiDef.where		= &pt;
+			newConfettiDef.delta		= &delta;
+			newConfettiDef.scale		= 1.0f + RandomFloat()  * .5f;
+			newConfettiDef.rot.x		= RandomFloat()*PI2;
+			newConfettiDef.rot.y		= RandomFloat()*PI2;
+			newConfettiDef.rot.z		= RandomFloat()*PI2;
+			newConfettiDef.deltaRot.x	= RandomFloat2()*5.0f;
+			newConfettiDef.deltaRot.y	= RandomFloat2()*5.0f;
+			newConfettiDef.deltaRot.z	= RandomFloat2()*5.0f;
+			newConfettiDef.alpha		= FULL_ALPHA;
+			newConfettiDef.fadeDelay	= .5f + RandomFloat();
+			if (AddConfettiToGroup(&newConfettiDef))
+				break;
+		}
+	}
+}
+
+
 /****************** MAKE STEAM ************************/
 
 void MakeSteam(ObjNode *theNode, float x, float y, float z)
@@ -1340,6 +1713,9 @@ OGLPoint3D			p;
 		/* MAKE SMOKE */
 		/**************/
 
+			// gFramesPerSecond is the tick rate when the simulation runs at a fixed step,
+			// so this can't make a replay depend on how fast it's being drawn.
+
 	if (doSmoke && (gFramesPerSecond > 20.0f))										// only do smoke if running at good frame rate
 	{
 		theNode->SmokeTimer -= fps;													// see if add smoke
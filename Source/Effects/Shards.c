@@ -372,12 +372,19 @@ OGLPoint3D			origin;
 
 
 /************************** MOVE SHARDS ****************************/
+//
+// Moves all shards first, then looks up the terrain height under all of them
+// with a single batched query, then does the bounce & decay pass.
+//
 
 static void MoveShards(ObjNode *theNode)
 {
 #pragma unused (theNode)
-float	ty,y,fps,x,z;
-long	i;
+static	short		queryShard[MAX_SHARDS];
+static	OGLPoint2D	queryCoord[MAX_SHARDS];
+static	float		queryY[MAX_SHARDS];
+float	ty,fps;
+long	i,q,numQueries;
 
 	if (gNumShards == 0)												// quick check if any particles at all
 		return;
@@ -386,6 +393,12 @@ long	i;
 
 	fps = gFramesPerSecondFrac;
 
+			/*******************/
+			/* MOVE ALL SHARDS */
+			/*******************/
+
+	numQueries = 0;
+
 	for (i=0; i < MAX_SHARDS; i++)
 	{
 		if (!gShards[i].isUsed)
@@ -406,15 +419,33 @@ long	i;
 		else
 			gShards[i].coordDelta.y -= fps * 300.0f;		// gravity
 
-		x = (gShards[i].coord.x += gShards[i].coordDelta.x * fps);
-		y = (gShards[i].coord.y += gShards[i].coordDelta.y * fps);
-		z = (gShards[i].coord.z += gShards[i].coordDelta.z * fps);
+		gShards[i].coord.x += gShards[i].coordDelta.x * fps;
+		gShards[i].coord.y += gShards[i].coordDelta.y * fps;
+		gShards[i].coord.z += gShards[i].coordDelta.z * fps;
+
+				/* QUEUE TERRAIN QUERY */
 
+		queryShard[numQueries] = i;
+		queryCoord[numQueries].x = gShards[i].coord.x;
+		queryCoord[numQueries].y = gShards[i].coord.z;
+		numQueries++;
+	}
+
+	GetTerrainYBatch(numQueries, queryCoord, queryY, nil);		// get terrain height under all shards
+
+
+			/*****************************/
+			/* BOUNCE, DECAY & TRANSFORM */
+			/*****************************/
+
+	for (q = 0; q < numQueries; q++)
+	{
+		i = queryShard[q];
 
 					/* SEE IF BOUNCE */
 
-		ty = GetTerrainY(x,z);								// get terrain height here
-		if (y <= ty)
+		ty = queryY[q];										// terrain height here
+		if (gShards[i].coord.y <= ty)
 		{
 			if (gShards[i].mode & SHARD_MODE_BOUNCE)
 			{
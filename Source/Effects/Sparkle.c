@@ -15,6 +15,7 @@
 /*    PROTOTYPES            */
 /****************************/
 
+static void InitSparkleBatch(void);
 
 
 /****************************/
@@ -33,6 +34,23 @@ static float	gPlayerSparkleColor = 0;
 
 int	gNumSparkles;
 
+
+		/* BATCH */
+		//
+		// Quads are queued in any order, then sorted by texture so that each
+		// particle texture is submitted once, as a single vertex array.
+		//
+
+static int					gSparkleBatchNumQuads = 0;
+static short				gSparkleBatchTexture[MAX_SPARKLE_BATCH_QUADS];
+static float				gSparkleBatchAlpha[MAX_SPARKLE_BATCH_QUADS];
+static OGLPoint3D			gSparkleBatchCorners[MAX_SPARKLE_BATCH_QUADS * 4];
+
+static OGLPoint3D			gSparkleBatchPoints[MAX_SPARKLE_BATCH_QUADS * 4];		// sorted by texture
+static OGLColorRGBA			gSparkleBatchColors[MAX_SPARKLE_BATCH_QUADS * 4];
+static OGLTextureCoord		gSparkleBatchUVs[MAX_SPARKLE_BATCH_QUADS * 4];			// same for every quad
+static MOTriangleIndecies	gSparkleBatchTriangles[MAX_SPARKLE_BATCH_QUADS * 2];	// same for every run
+
 /*************************** INIT SPARKLES **********************************/
 
 void InitSparkles(void)
@@ -47,6 +65,8 @@ int		i;
 	gPlayerSparkleColor = 0;
 
 	gNumSparkles = 0;
+
+	InitSparkleBatch();
 }
 
 
@@ -99,12 +119,17 @@ void DeleteSparkle(short i)
 
 
 /*************************** DRAW SPARKLES ******************************/
+//
+// Called by the particle group drawer, so the glow state (additive blend,
+// no z-writes, no fog, no lighting) is already set.  The depth test is on, which
+// is what hides the sparkles behind terrain & objects.
+//
 
 void DrawSparkles(void)
 {
 uint32_t			flags;
 int				i;
-float			dot,separation;
+float			dot,separation,alpha;
 OGLMatrix4x4	m;
 OGLVector3D		v;
 OGLPoint3D		where;
@@ -121,9 +146,11 @@ static OGLPoint3D		frame[4] =
 };
 
 
-			/*********************/
-			/* DRAW EACH SPARKLE */
-			/*********************/
+			/**********************/
+			/* QUEUE EACH SPARKLE */
+			/**********************/
+
+	BeginSparkleBatch();
 
 	cameraLocation = &gGameViewInfoPtr->cameraPlacement[gCurrentSplitScreenPane].cameraLocation;		// point to camera coord
 
@@ -206,61 +233,163 @@ static OGLPoint3D		frame[4] =
 		OGLPoint3D_TransformArray(&frame[0], &m, tc, 4);
 
 
-			/***********/
-			/* DRAW IT */
-			/***********/
-
-			/* SET ALPHA */
+			/* CALC ALPHA */
 
 		if (flags & SPARKLE_FLAG_FLICKER)								// randomly flicker alpha
 		{
-			float	a = gSparkles[i].color.a;
+			alpha = gSparkles[i].color.a;
 
-			a += RandomFloat2() * .5f;
-			if (a < 0.0)
+			alpha += RandomFloat2() * .5f;
+			if (alpha < 0.0)
 				continue;
 			else
-			if (a > 1.0f)
-				a = 1.0;
-
-			gGlobalTransparency = a;
+			if (alpha > 1.0f)
+				alpha = 1.0;
 		}
 		else
-			gGlobalTransparency = gSparkles[i].color.a;
+			alpha = gSparkles[i].color.a;
+
+
+			/* ADD TO BATCH */
+
+		AddSparkleBatchQuad(gSparkles[i].textureNum, tc, alpha);
+	}
+
 
+			/* DRAW THEM ALL */
+
+	DrawSparkleBatch();
+}
 
-			/* SUBMIT MATERIAL */
 
-		MO_DrawMaterial(gSpriteGroupList[SPRITE_GROUP_PARTICLES][gSparkles[i].textureNum].materialObject);	// submit material
+#pragma mark -
 
 
-				/* DRAW QUAD */
+/*************************** INIT SPARKLE BATCH ******************************/
 
-		glBegin(GL_QUADS);
-		glTexCoord2f(0,0);	glVertex3fv(&tc[0].x);
-		glTexCoord2f(1,0);	glVertex3fv(&tc[1].x);
-		glTexCoord2f(1,1);	glVertex3fv(&tc[2].x);
-		glTexCoord2f(0,1);	glVertex3fv(&tc[3].x);
-		glEnd();
+static void InitSparkleBatch(void)
+{
+	for (int q = 0; q < MAX_SPARKLE_BATCH_QUADS; q++)
+	{
+		OGLTextureCoord		*uv = &gSparkleBatchUVs[q * 4];
+		MOTriangleIndecies	*t = &gSparkleBatchTriangles[q * 2];
+
+		uv[0] = (OGLTextureCoord) {0,0};
+		uv[1] = (OGLTextureCoord) {1,0};
+		uv[2] = (OGLTextureCoord) {1,1};
+		uv[3] = (OGLTextureCoord) {0,1};
+
+		t[0].vertexIndices[0] = q*4 + 0;
+		t[0].vertexIndices[1] = q*4 + 1;
+		t[0].vertexIndices[2] = q*4 + 2;
+		t[1].vertexIndices[0] = q*4 + 0;
+		t[1].vertexIndices[1] = q*4 + 2;
+		t[1].vertexIndices[2] = q*4 + 3;
 	}
 
+	gSparkleBatchNumQuads = 0;
+}
 
-			/* RESTORE STATE */
 
-	gGlobalTransparency = 1.0f;
+/*************************** BEGIN SPARKLE BATCH ******************************/
+
+void BeginSparkleBatch(void)
+{
+	gSparkleBatchNumQuads = 0;
+}
+
+
+/*************************** ADD SPARKLE BATCH QUAD ******************************/
+//
+// Queues a quad textured with one of the particle sprites.
+// Corners go clockwise from the top left, in whatever space the caller's matrices expect.
+//
+
+void AddSparkleBatchQuad(short textureNum, const OGLPoint3D corners[4], float alpha)
+{
+int		q = gSparkleBatchNumQuads;
+
+	GAME_ASSERT(textureNum >= 0 && textureNum < PARTICLE_SObjType_COUNT);
+
+	if (q >= MAX_SPARKLE_BATCH_QUADS)
+		return;
+
+	gSparkleBatchTexture[q] = textureNum;
+	gSparkleBatchAlpha[q] = alpha;
+	SDL_memcpy(&gSparkleBatchCorners[q * 4], corners, sizeof(OGLPoint3D) * 4);
+
+	gSparkleBatchNumQuads++;
 }
 
 
+/*************************** DRAW SPARKLE BATCH ******************************/
+//
+// Draws everything queued since BeginSparkleBatch with the current blend & depth state,
+// one vertex array per particle texture.
+//
+
+void DrawSparkleBatch(void)
+{
+int		runStart[PARTICLE_SObjType_COUNT];
+int		runLength[PARTICLE_SObjType_COUNT];
+int		runFill[PARTICLE_SObjType_COUNT];
+int		n = gSparkleBatchNumQuads;
+
+	if (n == 0)
+		return;
 
 
+			/* COUNTING SORT BY TEXTURE */
 
+	SDL_zeroa(runLength);
 
+	for (int q = 0; q < n; q++)
+		runLength[gSparkleBatchTexture[q]]++;
 
+	for (int tex = 0, start = 0; tex < PARTICLE_SObjType_COUNT; tex++)
+	{
+		runStart[tex] = runFill[tex] = start;
+		start += runLength[tex];
+	}
 
+	for (int q = 0; q < n; q++)
+	{
+		int				dest = runFill[gSparkleBatchTexture[q]]++;
+		OGLColorRGBA	*colors = &gSparkleBatchColors[dest * 4];
 
+		SDL_memcpy(&gSparkleBatchPoints[dest * 4], &gSparkleBatchCorners[q * 4], sizeof(OGLPoint3D) * 4);
 
+		for (int j = 0; j < 4; j++)
+			colors[j] = (OGLColorRGBA) {1, 1, 1, gSparkleBatchAlpha[q]};
+	}
 
 
+			/* SUBMIT EACH RUN */
 
+	gGlobalTransparency = .99f;									// (leave @ < 1 to ensure GL_BLEND)
 
+	for (int tex = 0; tex < PARTICLE_SObjType_COUNT; tex++)
+	{
+		MOVertexArrayData	data;
+		int					start = runStart[tex];
 
+		if (runLength[tex] == 0)
+			continue;
+
+		SDL_zero(data);
+		data.VARtype		= -1;									// lives in regular memory
+		data.numMaterials	= 1;
+		data.materials[0]	= gSpriteGroupList[SPRITE_GROUP_PARTICLES][tex].materialObject;
+		data.numPoints		= runLength[tex] * 4;
+		data.numTriangles	= runLength[tex] * 2;
+		data.points			= &gSparkleBatchPoints[start * 4];
+		data.uvs[0]			= &gSparkleBatchUVs[start * 4];
+		data.colorsFloat	= &gSparkleBatchColors[start * 4];
+		data.triangles		= gSparkleBatchTriangles;				// indices are relative to the run
+
+		MO_DrawGeometry_VertexArray(&data);
+	}
+
+	gGlobalTransparency = 1.0f;
+	gSparkleBatchNumQuads = 0;
+}
@@ -36,6 +36,28 @@ typedef struct
 }BG3DHeaderType;
 
 
+		/* BAKED BG3D HEADER */
+		//
+		// Header of a .bg3dc file (see BakeBG3DImage).  The tag stream that follows is
+		// native-endian, with vertex streams and texture pixels aligned to BG3D_BAKED_ALIGN.
+		//
+
+#define	BG3D_BAKED_HEADER_STRING	"BG3D-BAKED"
+#define	BG3D_BAKED_VERSION			2
+#define	BG3D_BAKED_ENDIAN_TAG		0x01020304		// reads back differently on a machine of the other endianness
+#define	BG3D_BAKED_ALIGN			16
+
+typedef struct
+{
+	char			headerString[16];			// BG3D_BAKED_HEADER_STRING
+	uint32_t		endianTag;					// BG3D_BAKED_ENDIAN_TAG
+	uint32_t		version;					// BG3D_BAKED_VERSION
+	uint32_t		sourceFileSize;				// size of the .bg3d this was baked from, to catch stale files
+	uint32_t		reserved;
+	uint64_t		sourceHash;					// HashBytes of the .bg3d, to catch same-size edits
+}BG3DBakedHeaderType;
+
+
 	/* BG3D MATERIAL FLAGS */
 
 enum
@@ -121,6 +143,12 @@ void InitBG3DManager(void);
 void ImportBG3D(FSSpec *spec, int groupNum, short varType);
 void DisposeBG3DContainer(int groupNum);
 void DisposeAllBG3DContainers(void);
+Ptr BakeBG3DImage(const char *sourceData, long sourceSize, long *outBakedSize);
+Boolean IsBakedBG3DImage(const char *data, long size);
+Boolean IsBakedBG3DImageUpToDate(const char *data, long size, const char *sourceData, long sourceSize);
+OSErr BakeBG3DFile(FSSpec *spec);
+void BakeAllBG3DFiles(void);
+void BenchmarkBG3DLoading(void);
 void BG3D_SetContainerMaterialFlags(short group, short type, short geometryNum, uint32_t flags);
 void BG3D_SphereMapGeomteryMaterial(short group, short type, short geometryNum, uint16_t combineMode, uint16_t envMapNum);
 void SetSphereMapInfoOnVertexArrayData(MOVertexArrayData *va, uint16_t combineMode, uint16_t envMapNum);
@@ -22,8 +22,13 @@ float GetSplitscreenPaneFOV(void);
 void UpdateCameras(void);
 void InitCamera_Terrain(short playerNum);
 void DrawLensFlare(void);
+void DisposeSunQueries(void);
 
 
+void RememberCameraPlacements(void);
+void BeginCameraInterpolation(float frac);
+void EndCameraInterpolation(void);
+
 void PrepAnaglyphCameras(void);
 void RestoreCamerasFromAnaglyph(void);
 void CalcAnaglyphCameraOffset(Byte pane, Byte pass);
@@ -4,12 +4,9 @@
 
 #pragma once
 
-#define	MAX_PARTICLE_GROUPS		80
+#define	MAX_PARTICLE_GROUPS		100		// shared by particles & confetti
 #define	MAX_PARTICLES			150		// (note change Byte below if > 255)
 
-#define	MAX_CONFETTI_GROUPS		50
-#define	MAX_CONFETTIS			150		// (note change Byte below if > 255)
-
 
 		/* FIRE & SMOKE */
 
@@ -43,13 +40,18 @@ typedef struct
 	float			scale[MAX_PARTICLES];
 	float			rotZ[MAX_PARTICLES];
 	float			rotDZ[MAX_PARTICLES];
+	float			rotX[MAX_PARTICLES];			// confetti only: they tumble on all 3 axes
+	float			rotY[MAX_PARTICLES];
+	float			rotDX[MAX_PARTICLES];
+	float			rotDY[MAX_PARTICLES];
+	float			fadeDelay[MAX_PARTICLES];		// seconds before it starts to fade
 	OGLPoint3D		coord[MAX_PARTICLES];
 	OGLVector3D		delta[MAX_PARTICLES];
 
 	float			maxY;
 
 	MOVertexArrayObject	*geometryObj[2][MAX_PLAYERS];		// there are 2 objects for each PG because we double-buffer it for the VAR
-															// plus an object for each player
+															// plus an object for each player (confetti only need one: they don't face the camera)
 
 	OGLBoundingBox  bbox;
 
@@ -59,37 +61,11 @@ typedef struct
 }ParticleGroupType;
 
 
-		/* CONFETTI GROUP TYPE */
-
-typedef struct
-{
-	uint32_t		magicNum;
-	Byte			isUsed[MAX_CONFETTIS];
-	uint32_t		flags;
-	Byte			confettiTextureNum;
-	float			gravity;
-	float			baseScale;
-	float			decayRate;						// shrink speed
-	float			fadeRate;
-
-	float			fadeDelay[MAX_CONFETTIS];
-	float			alpha[MAX_CONFETTIS];
-	float			scale[MAX_CONFETTIS];
-	OGLVector3D		rot[MAX_CONFETTIS];
-	OGLVector3D		deltaRot[MAX_CONFETTIS];
-	OGLPoint3D		coord[MAX_CONFETTIS];
-	OGLVector3D		delta[MAX_CONFETTIS];
-
-	MOVertexArrayObject	*geometryObj;
-
-}ConfettiGroupType;
-
-
-
 enum
 {
 	PARTICLE_TYPE_FALLINGSPARKS,
-	PARTICLE_TYPE_GRAVITOIDS
+	PARTICLE_TYPE_GRAVITOIDS,
+	PARTICLE_TYPE_CONFETTI							// lit, tumbling quads (see NewConfettiGroup)
 };
 
 enum
@@ -170,6 +146,7 @@ typedef struct
 
 extern	NewParticleGroupDefType	gNewParticleGroupDef;
 extern	NewConfettiGroupDefType	gNewConfettiGroupDef;
+extern	int						gNumParticlesThisFrame;
 
 
 
@@ -218,8 +195,6 @@ ObjNode *MakeFireRing(float x, float y, float z);
 
 		/* CONFETTI */
 
-void InitConfettiManager(void);
-void DeleteAllConfettiGroups(void);
 short NewConfettiGroup(NewConfettiGroupDefType *def);
 Boolean AddConfettiToGroup(NewConfettiDefType *def);
 Boolean VerifyConfettiGroupMagicNum(short group, uint32_t magicNum);
@@ -230,7 +205,7 @@ void DoPlayerGroundScrape(ObjNode *player, short playerNum);
 		/* CONTRAILS */
 
 void InitContrails(void);
-void MakeNewContrail(float width, short *contrailNum);
+void MakeNewContrail(ObjNode *owner, float width, short *contrailNum);
 void AddPointToContrail(short contrailNum, OGLPoint3D *where, OGLVector3D *aim, float alpha);
 void ModifyContrailPreviousAddition(short contrailNum, OGLPoint3D *where);
 void DisposeContrails(void);
@@ -0,0 +1,8 @@
+//
+// etc1.h
+//
+
+#pragma once
+
+long ETC1_GetImageSize(int width, int height);
+void ETC1_EncodeImage(const uint8_t *rgba, int width, int height, uint8_t *out);
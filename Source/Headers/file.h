@@ -7,7 +7,7 @@
 #include "input.h"
 
 #define PREFS_FOLDER_NAME	"Nanosaur2"
-#define PREFS_MAGIC			"Nanosaur2 Prefs v0"
+#define PREFS_MAGIC			"Nanosaur2 Prefs v2"
 #define PREFS_FILENAME		"Preferences"
 #define SAVEGAME_MAGIC		"Nanosaur2 Save v0"
 
@@ -78,7 +78,9 @@ typedef struct
 	Byte	displayNumMinus1;
 	Boolean	fullscreen;
 	Boolean	vsync;
+	Boolean	fixedTimestep;			// simulate at a fixed rate, independent of the frame rate
 	Byte	antialiasingLevel;
+	Byte	textureQuality[NUM_TEXTURE_GROUPS];
 	Boolean	cutsceneSubtitles;
 
 	Byte	splitScreenMode;
@@ -137,7 +139,20 @@ OSErr SavePrefs(void);
 #define IsStereoShutter() (gGamePrefs.stereoGlassesMode == STEREO_GLASSES_MODE_SHUTTER)
 #define IsStereo() (gGamePrefs.stereoGlassesMode != STEREO_GLASSES_MODE_OFF)
 
-void LoadPlayfield(FSSpec *specPtr);
+void LoadPlayfield(FSSpec *specPtr, FSSpec *compiledSpecPtr);
+OSErr CompilePlayfield(FSSpec *terSpec, FSSpec *compiledSpec);
+Boolean IsCompiledPlayfieldMemory(const void *ptr);
+void SafeDisposePlayfieldPtr(void *ptr);
+void DisposeCompiledPlayfield(void);
+
+			// Like Free_2d_array, for arrays whose data may live inside the compiled playfield
+
+#define Free_Playfield_2d_array(array)			\
+{												\
+		SafeDisposePlayfieldPtr(array[0]);		\
+		SafeDisposePtr((Ptr)array);				\
+		array = nil;							\
+}
 
 Boolean SaveGame(int fileSlot);
 Boolean LoadSavedGame(int fileSlot, SaveGameType* outData);
@@ -145,16 +160,24 @@ Boolean DeleteSavedGame(int fileSlot);
 void UseSaveGame(const SaveGameType* saveData);
 
 void LoadLevelArt(void);
+void PrefetchLevelArt(short levelNum);
+void CompileAllPlayfields(void);
 Ptr LoadSuperTilePixelBuffer(short fRefNum);
+Ptr DecodeSuperTilePixelBuffer(const char* data, int dataSize);
+Ptr TryDecodeSuperTilePixelBuffer(const char* data, int dataSize);
 MOMaterialObject* LoadSuperTileTexture(Ptr pixelBuffer, int texSize);
 void AssembleSeamlessSuperTileTexture(int row, int col, Ptr canvas);
 
 OSErr LoadUserDataFile(const char* filename, const char* magic, long payloadLength, Ptr payloadPtr);
 OSErr SaveUserDataFile(const char* filename, const char* magic, long payloadLength, Ptr payloadPtr);
 OSErr DeleteUserDataFile(const char* filename);
+OSErr MakeUserDataFolder(const char* folderName);
+Ptr LoadUserDataBlob(const char* filename, long* outLength);
+OSErr SaveUserDataBlob(const char* filename, const void* data, long length);
 Ptr LoadDataFile(const char* path, long* outLength);
 char* LoadTextFile(const char* path, long* outLength);
 
 char* CSVIterator(char** csvCursor, bool* eolOut);
 
 Ptr DecompressQTImage(const char* data, int dataSize, int expectedWidth, int expectedHeight);
+Ptr TryDecompressQTImage(const char* data, int dataSize, int expectedWidth, int expectedHeight);
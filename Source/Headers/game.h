@@ -57,6 +57,9 @@
 #include 	"input.h"
 #include "skeleton.h"
 #include "file.h"
+#include "prefetch.h"
+#include "jobs.h"
+#include "replay.h"
 #include "fences.h"
 #include "splineitems.h"
 #include "items.h"
@@ -69,6 +72,7 @@
 #include "splinemanager.h"
 #include "3dmath.h"
 #include "quadmesh.h"
+#include "etc1.h"
 #include "atlas.h"
 #include "menu.h"
 
@@ -78,6 +82,7 @@
 extern	Boolean					gDisableAnimSounds;
 extern	Boolean					gDisableHiccupTimer;
 extern	Boolean					gDrawLensFlare;
+extern	Boolean					gFixedTimestepActive;
 extern	Boolean					gGameOver;
 extern	Boolean					gGamePaused;
 extern	Boolean					gLevelCompleted;
@@ -99,6 +104,7 @@ extern	Byte					gNumPlayers;
 extern	Byte					gTotalSides;
 extern	CollisionRec			gCollisionList[];
 extern	FSSpec					gDataSpec;
+extern	char					gDataHostPath[];
 extern	FenceDefType			*gFenceList;
 extern	GLuint					gVertexArrayRangeObjects[NUM_VERTEX_ARRAY_RANGES];
 extern	LineMarkerDefType		gLineMarkerList[MAX_LINEMARKERS];
@@ -135,6 +141,7 @@ extern	SDL_GLContext			gAGLContext;
 extern	SDL_Window*				gSDLWindow;
 extern	SparkleType				gSparkles[MAX_SPARKLES];
 extern	SpriteType				*gSpriteGroupList[MAX_SPRITE_GROUPS];
+extern	SuperTileHeightRange	**gSuperTileHeightRanges;
 extern	SuperTileItemIndexType	**gSuperTileItemIndexGrid;
 extern	SuperTileMemoryType		gSuperTileMemoryList[MAX_SUPERTILES];
 extern	SuperTileStatus			**gSuperTileStatusGrid;
@@ -155,6 +162,8 @@ extern	float					gBestCheckpointAim[MAX_PLAYERS];
 extern	float					gCurrentMaxSpeed[MAX_PLAYERS];
 extern	float					gCurrentPaneAspectRatio;
 extern	float					gDeathTimer[MAX_PLAYERS];
+extern	float					gDrawFramesPerSecond;
+extern	float					gDrawFramesPerSecondFrac;
 extern	float					gFramesPerSecond;
 extern	float					gFramesPerSecondFrac;
 extern	float					gGammaFadeFrac;
@@ -164,8 +173,12 @@ extern	float					gMapToUnitValue;
 extern	float					gMapToUnitValueFrac;
 extern	float					gObjectGroupBSphereList[MAX_BG3D_GROUPS][MAX_OBJECTS_IN_GROUP];
 extern	float					gRaceReadySetGoTimer;
+extern	float					gRenderInterpolation;
 extern	float					gTargetMaxSpeed[MAX_PLAYERS];
+extern	float					gTerrainMaxY;
+extern	float					gTerrainMinY;
 extern	float					gTerrainPolygonSize;
+extern	float					gTerrainPolygonSizeFrac;
 extern	float					gTerrainSuperTileUnitSize;
 extern	float					gTerrainSuperTileUnitSizeFrac;
 extern	int						gCurrentAntialiasingLevel;
@@ -218,5 +231,12 @@ extern	uint32_t 				gAutoFadeStatusBits;
 extern	int						gCmdLevelNum;				// -1 = use menu; >=0 = jump directly to this level
 extern	char					gCmdTerrainOverridePath[512];	// if set, override terrain file for the current level
 extern	FSSpec					gCmdTerrainOverrideSpec;		// FSSpec equivalent of gCmdTerrainOverridePath
+extern	Boolean					gCmdCompilePlayfields;		// convert all .ter files to .terc and quit
+extern	Boolean					gCmdBakeModels;				// convert all .bg3d files to .bg3dc and quit
+extern	Boolean					gCmdBenchmarkModels;		// time model loading from both formats and quit
+extern	Boolean					gCmdBenchmarkObjects;		// time object spawning with a full object list and quit
+extern	char					gCmdRecordPath[512];		// if set, record the level's input to this file
+extern	char					gCmdReplayPath[512];		// if set, replay the level recorded in this file
+extern	Boolean					gCmdHeadless;				// don't show a window or draw while replaying
 
 void Boot_UpdateTerrainOverrideSpec(void);	// call this before loading terrain to convert path -> FSSpec
@@ -96,6 +96,7 @@ extern "C" {
 #define GL_QUAD_STRIP                   0x0008
 
 // Pixel format constants (GL 1.x, not in GLES2)
+#define GL_BGR                          0x80E0
 #define GL_BGRA                         0x80E1
 #define GL_UNSIGNED_INT_8_8_8_8_REV     0x8367
 #define GL_UNSIGNED_SHORT_1_5_5_5_REV   0x8366
@@ -51,6 +51,22 @@ uint32_t _i;															\
 }
 
 
+// Same thing, but out of the level arena (see AllocLevelPtr). Free_2d_array still works on it.
+#define Alloc_Level_2d_array(type, array, n, m)							\
+{																		\
+uint32_t _i;															\
+																		\
+	array = (type **) AllocLevelPtrClear((long)(n) * sizeof(type *));	\
+	if (array == nil)													\
+		DoFatalAlert("Alloc_Level_2d_array failed!");					\
+	array[0] = (type *) AllocLevelPtrClear((long)(n) * (long)(m) * sizeof(type));	\
+	if (array[0] == nil)												\
+		DoFatalAlert("Alloc_Level_2d_array failed!");					\
+	for (_i = 1; _i < (uint32_t)(n); _i++)								\
+		array[_i] = array[_i-1] + (m);									\
+}
+
+
 #define Free_2d_array(array)				\
 {											\
 		SafeDisposePtr((Ptr)array[0]);		\
@@ -80,6 +80,16 @@ enum
 };
 
 
+		/* ONE TICK OF GAMEPLAY INPUT (FOR RECORDING & REPLAY) */
+
+typedef struct
+{
+	uint8_t			needStates[MAX_PLAYERS][NUM_REMAPPABLE_NEEDS];		// KEYSTATE_xxx
+	uint8_t			needAnalog[MAX_PLAYERS][NUM_REMAPPABLE_NEEDS];		// 0..255
+	OGLVector2D		mouseDelta;
+} InputFrame;
+
+
 //============================================================================================
 
 void InitInput(void);
@@ -113,6 +123,10 @@ Boolean IsCmdQDown(void);
 Boolean IsCheatKeyComboDown(void);
 
 void DoSDLMaintenance(void);
+void PumpSDLEvents(void);
+void UpdateInputStates(void);
+void CaptureInputFrame(InputFrame *frame);
+void SetInputFrame(const InputFrame *frame);
 
 int GetNumGamepad(void);
 SDL_Gamepad* GetGamepad(int n);
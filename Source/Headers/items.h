@@ -96,6 +96,13 @@ Boolean AddSproutPlant(TerrainItemEntryType *itemPtr, float  x, float z);
 Boolean AddIvy(TerrainItemEntryType *itemPtr, float  x, float z);
 
 
+		/* FOLIAGE */
+
+void InitFoliage(void);
+Boolean AddFoliage(TerrainItemEntryType *itemPtr, const NewObjectDefinitionType *def);
+void BuildPendingFoliage(void);
+
+
 		/* TREES */
 
 Boolean AddBirchTree(TerrainItemEntryType *itemPtr, float  x, float z);
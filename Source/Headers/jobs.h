@@ -0,0 +1,15 @@
+//
+// jobs.h
+//
+
+#pragma once
+
+#define	MAX_JOBS				32
+
+typedef void (*JobProcPtr)(void *refCon);
+
+
+void InitJobs(void);
+void ShutdownJobs(void);
+uint32_t KickJob(JobProcPtr proc, void *refCon);
+void WaitForJob(uint32_t ticket);
@@ -116,6 +116,15 @@ typedef enum LocStrID
 	STR_PREFERRED_DISPLAY,
 	STR_DISPLAY,
 	STR_ANTIALIASING_CHANGE_WARNING,
+	STR_TEXTURES_MODELS,
+	STR_TEXTURES_TERRAIN,
+	STR_TEXTURES_SPRITES,
+	STR_TEXTURE_QUALITY_ORIGINAL,
+	STR_TEXTURE_QUALITY_MIPMAPPED,
+	STR_TEXTURE_QUALITY_COMPRESSED,
+	STR_SIMULATION_RATE,
+	STR_SIMULATION_RATE_VARIABLE,
+	STR_SIMULATION_RATE_FIXED,
 
 	STR_HUD_POSITION,
 	STR_HUD_FULLSCREEN,
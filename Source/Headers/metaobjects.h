@@ -232,6 +232,8 @@ void MO_DrawPicture(const MOPictureObject *picObj);
 void MO_DisposeObjectReference(MetaObjectPtr obj);
 void MO_DuplicateVertexArrayData(MOVertexArrayData *inData, MOVertexArrayData *outData, short varType);
 void MO_DeleteObjectInfo_Geometry_VertexArray(MOVertexArrayData *data);
+void *MO_AllocVertexArrayPtr(long size);
+void MO_FreeVertexArrayPtr(void *ptr);
 void MO_CalcBoundingBox(MetaObjectPtr object, OGLBoundingBox *bBox, OGLMatrix4x4 *m);
 void MO_CalcBoundingSphere(MetaObjectPtr object, float *bSphere);
 
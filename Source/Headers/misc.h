@@ -8,20 +8,59 @@ void	DoAlert(const char* format, ...);
 POMME_NORETURN void DoFatalAlert(const char* format, ...);
 POMME_NORETURN void CleanQuit(void);
 
+#define	SIMULATION_TICK_RATE	60			// ticks/second in fixed-timestep mode
+
+enum
+{
+	MEMORY_TAG_MISC,				// anything that isn't inside a SetMemoryTag scope
+	MEMORY_TAG_TERRAIN,
+	MEMORY_TAG_MODELS,
+	MEMORY_TAG_SKELETONS,
+	MEMORY_TAG_PARTICLES,
+	MEMORY_TAG_SOUND,
+	MEMORY_TAG_UI,
+	MEMORY_TAG_VAR,
+	MEMORY_TAG_POOLS,				// MetaObject pool slabs: they live for the whole run, so the leak report skips them
+	NUM_MEMORY_TAGS
+};
+
 void* AllocPtr(long size);
 void* AllocPtrClear(long size);
 void* ReallocPtr(void* ptr, long size);
+void* TryAllocPtr(long size);
+void* TryReallocPtr(void* ptr, long size);
 void SafeDisposePtr(void* ptr);
 
+void OpenLevelArena(void);
+void CloseLevelArena(void);
+void* AllocLevelPtr(long size);
+void* AllocLevelPtrClear(long size);
+
+int SetMemoryTag(int tag);
+int GetMemoryTag(void);
+void CountHandleMemory(int tag, Handle h, Boolean allocated);
+const char* GetMemoryTagStats(int tag, long *liveBytes, long *peakBytes, int *livePtrs);
+void ReportMemoryTags(void);
+void MarkMemoryTags(void);
+void ReportMemoryLeaks(const char* label);
+
 void VerifySystem(void);
 
 void SetMyRandomSeed(uint32_t seed);
 uint32_t MyRandomLong(void);
 void InitMyRandomSeed(void);
+void GetMyRandomState(uint32_t state[3]);
+void SetMyRandomState(const uint32_t state[3]);
 float RandomFloat(void);
 uint16_t	RandomRange(unsigned short min, unsigned short max);
 void CalcFramesPerSecond(void);
+int CalcSimulationTicks(void);
+void ResetSimulationClock(void);
 Boolean IsPowerOf2(int num);
+
+#define	HASH_BYTES_SEED		0xcbf29ce484222325ULL
+uint64_t HashBytes(uint64_t hash, const void *data, long size);
+
 float RandomFloat2(void);
 
 void MyFlushEvents(void);
@@ -17,6 +17,7 @@
 #define	CONFETTI_SLOT	(PARTICLE_SLOT-1)		// do confetti before particles since particles are xparent
 #define	WATER_SLOT		(SLOT_OF_DUMB - 50)		// do before DUMB because some glowing weapons need to be drawn after the water
 #define	CONTRAIL_SLOT	(SPRITE_SLOT - 10)
+#define	SHADOW_SLOT		(SLOT_OF_DUMB + 2)		// one batch for the shadows at SLOT_OF_DUMB+1, right after them & ahead of the effects
 #define	INFOBAR_SLOT	(SLOT_OF_DUMB + 3000)
 #define	FADEPANE_SLOT	(SLOT_OF_DUMB + 4000)
 #define	MENU_SLOT		INFOBAR_SLOT
@@ -59,6 +60,11 @@ enum
 #define	ShadowScaleX	SpecialF[0]
 #define	ShadowScaleZ	SpecialF[1]
 #define	CheckForBlockers	Flag[0]
+#define	ShadowIsPlaced		Flag[1]
+#define	ShadowOnBlocker		Flag[2]			// last placed on a blocker or water, not the terrain
+#define	ShadowOwnerX		SpecialF[2]			// where the owner was when its shadow was last placed
+#define	ShadowOwnerBottom	SpecialF[3]
+#define	ShadowOwnerZ		SpecialF[4]
 
 
 //========================================================
@@ -66,6 +72,9 @@ enum
 extern	void InitObjectManager(void);
 extern	ObjNode	*MakeNewObject(NewObjectDefinitionType *newObjDef);
 extern	void MoveObjects(void);
+void RememberObjectTickCoords(void);
+Boolean GetObjectDrawOffset(const ObjNode *theNode, OGLVector3D *offset);
+void PrepareObjectsForDrawing(void);
 void DrawObjects(void);
 
 extern	void DeleteAllObjects(void);
@@ -81,6 +90,7 @@ extern	void SetObjectTransformMatrix(ObjNode *theNode);
 extern	void DisposeObjectBaseGroup(ObjNode *theNode);
 extern	void ResetDisplayGroupObject(ObjNode *theNode);
 void AttachObject(ObjNode *theNode, Boolean recurse);
+void BenchmarkObjectManager(void);
 void CalcObjectRadiusFromBBox(ObjNode *theNode);
 
 void MoveStaticObject(ObjNode *theNode);
@@ -98,8 +108,11 @@ void SetObjectCollisionBounds(ObjNode *theNode, float top, float bottom, float l
 							 float right, float front, float back);
 ObjNode	*AttachStaticShadowToObject(ObjNode *theNode, int shadowType, float scaleX, float scaleZ);
 void UpdateShadow(ObjNode *theNode);
+void FlushPendingShadowUpdates(void);
 
-void CullTestAllObjects(void);
+void CalcObjectCullBounds(ObjNode *theNode);
+void CullTestAllObjects(ObjNode **nodeList, int numNodes);
+void CullTestObjectsForPlayer(short playerNum, uint32_t cTypes);
 Boolean	IsObjectTotallyCulled(ObjNode *theNode);
 
 ObjNode	*AttachShadowToObject(ObjNode *theNode, int shadowType, float scaleX, float scaleZ, Boolean checkBlockers);
@@ -127,3 +140,12 @@ void UnchainNode(ObjNode* theNode);
 ObjNode* MakeBackgroundPictureObject(const char* imagePath);
 
 void SendNodeToOverlayPane(ObjNode* theNode);
+
+//===================
+
+void InitObjectTree(void);
+void UpdateObjectTreeNode(ObjNode *theNode);
+void RemoveFromObjectTree(ObjNode *theNode);
+int QueryObjectTree_LineSegment(const OGLLineSegment *lineSeg, ObjNode **results, int maxResults);
+int QueryObjectTree_Sphere(const OGLBoundingSphere *sphere, ObjNode **results, int maxResults);
+
@@ -17,6 +17,27 @@ enum
 	STEREO_GLASSES_MODE_SHUTTER
 };
 
+		/* TEXTURE QUALITY PREFS */
+		//
+		// Each group of textures gets its own setting (gGamePrefs.textureQuality).
+		// The group is picked from the memory tag of whoever is loading the texture.
+		//
+
+enum
+{
+	TEXTURE_GROUP_MODELS = 0,
+	TEXTURE_GROUP_TERRAIN,
+	TEXTURE_GROUP_SPRITES,
+	NUM_TEXTURE_GROUPS
+};
+
+enum
+{
+	TEXTURE_QUALITY_ORIGINAL = 0,			// full-size RGBA8, no mipmaps
+	TEXTURE_QUALITY_MIPMAPPED,
+	TEXTURE_QUALITY_COMPRESSED,				// mipmapped, and S3TC or ETC1 (opaque only) if the GPU has it
+};
+
 
 		/* 4x4 MATRIX INDECIES */
 enum
@@ -256,6 +277,7 @@ enum
 	VERTEX_ARRAY_RANGE_TYPE_CONTRAILS2,
 	VERTEX_ARRAY_RANGE_TYPE_ZAPS1,
 	VERTEX_ARRAY_RANGE_TYPE_ZAPS2,
+	VERTEX_ARRAY_RANGE_TYPE_FOLIAGE,				// baked supertile foliage (see Foliage.c)
 
 
 	VERTEX_ARRAY_RANGE_TYPE_USER1,					// memory block is defined by the caller
@@ -295,8 +317,12 @@ void OGL_UpdateCameraFromToUp(OGLPoint3D *from, OGLPoint3D *to, const OGLVector3
 void OGL_Camera_SetPlacementAndUpdateMatrices(int camNum);
 void OGL_Texture_SetOpenGLTexture(GLuint textureName);
 GLuint OGL_TextureMap_Load(void *imageMemory, int width, int height, GLint destFormat, GLint srcFormat, GLint dataType);
+void OGL_SetTextureCacheSource(const char* sourceName, uint64_t sourceKey);
 GLuint OGL_TextureMap_LoadImageFile(const char* path, int* outWidth, int* outHeight, int* outHasAlpha);
+void OGL_TextureMap_Dispose(int numTextures, const GLuint *textureNames);
 void OGL_RAMTextureHasChanged(GLuint textureName, short width, short height, uint32_t *pixels);
+void OGL_MarkRenderStats(void);
+void OGL_ReportRenderStats(const char* label);
 GLenum OGL_CheckError_Impl(const char* file, int line);
 #define OGL_CheckError() OGL_CheckError_Impl(__FILE__, __LINE__)
 void OGL_GetCurrentViewport(int *x, int *y, int *w, int *h, Byte whichPane);
@@ -325,8 +351,20 @@ void OGL_DrawFloat(float f, GLint x, GLint y);
 void OGL_DrawInt(int f, GLint x, GLint y);
 
 void *OGL_AllocVertexArrayMemory(long size, Byte type);
+void *OGL_TryAllocVertexArrayMemory(long size, Byte type);
 void OGL_FreeVertexArrayMemory(void *pointer, Byte type);
 void OGL_SetVertexArrayRangeDirty(short buffer);
+void OGL_SetVertexArrayMemoryDirty(const void *pointer, long size, short type);
+void OGL_BeginVertexArrayBuffer(short varType);
+const GLvoid *OGL_VertexArrayOffset(const void *pointer);
+const GLvoid *OGL_ElementArrayOffset(const void *pointer);
+void OGL_EndVertexArrayBuffer(void);
+
+GLuint OGL_NewOcclusionQuery(void);
+void OGL_DisposeOcclusionQuery(GLuint *query);
+void OGL_BeginOcclusionQuery(GLuint query);
+void OGL_EndOcclusionQuery(void);
+Boolean OGL_GetOcclusionQueryResult(GLuint query, GLuint *samplesPassed);
 #if VERTEXARRAYRANGES
 void AssignVertexArrayRangeMemory(long size, void *pointer, Byte type);
 void ReleaseVertexArrayRangeMemory(Byte type);
@@ -334,5 +372,6 @@ void ReleaseVertexArrayRangeMemory(Byte type);
 
 
 void ColorBalanceRGBForAnaglyph(uint32_t *rr, uint32_t *gg, uint32_t *bb, Boolean doChannelBalancing);
+Boolean OGL_IsAnaglyphShaderActive(void);
 
 #define GetOverlayPaneNumber() (gNumPlayers)
@@ -0,0 +1,38 @@
+//
+// prefetch.h
+//
+
+#pragma once
+
+#define	MAX_PREFETCH_FILES		24
+
+enum
+{
+	PREFETCH_KIND_RAW,					// just read the data fork
+	PREFETCH_KIND_BG3D,					// read a .bg3d's up to date .bg3dc, or bake the .bg3d in memory (see BakeBG3DImage)
+	PREFETCH_KIND_IMAGE,				// decode a sprite's .jpg and/or .png (see PrefetchImage)
+	PREFETCH_KIND_SUPERTILE,			// decode a supertile JPEG (see PrefetchSuperTile)
+};
+
+
+		/* WHAT A PREFETCH_KIND_IMAGE ENTRY HANDS OUT, FOLLOWED BY THE RGBA PIXELS */
+
+typedef struct
+{
+	int32_t		width;
+	int32_t		height;
+	int32_t		hasAlpha;				// there was a .png
+	int32_t		pad;
+	uint64_t	sourceKey;				// HashBytes of the .jpg then the .png, for the texture cache
+}PrefetchedImageHeader;
+
+
+void InitPrefetcher(void);
+void ShutdownPrefetcher(void);
+void PrefetchFile(const char *path, Byte kind);
+void PrefetchImage(const char *partialPath);
+void PrefetchSuperTile(const char *jpeg, long size);
+Ptr TakePrefetchedFile(const FSSpec *spec, long *outSize);
+Ptr TakePrefetchedSuperTile(const char *jpeg);
+void SharePrefetchedFiles(Boolean share);
+void FlushPrefetchedFiles(void);
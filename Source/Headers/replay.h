@@ -0,0 +1,17 @@
+//
+// replay.h
+//
+
+#pragma once
+
+#define	REPLAY_FILE_MAGIC		'N2RP'
+#define	REPLAY_FILE_VERSION		2
+
+
+void OpenInputReplay(void);
+void ApplyInputReplaySetup(void);
+void BeginInputReplayLevel(void);
+Boolean UpdateInputReplay(void);
+void EndInputReplayLevel(void);
+Boolean IsInputReplayActive(void);
+Boolean IsReplayingInput(void);
@@ -7,6 +7,8 @@
 
 #define	MAX_SPARKLES	600
 
+#define	MAX_SPARKLE_BATCH_QUADS	(MAX_SPARKLES + 8)		// room for the lens flare too
+
 enum
 {
 	SPARKLE_FLAG_OMNIDIRECTIONAL 	= 1,				// if is visible from any angle
@@ -34,5 +36,8 @@ void InitSparkles(void);
 short GetFreeSparkle(ObjNode *theNode);
 void DeleteSparkle(short i);
 void DrawSparkles(void);
+void BeginSparkleBatch(void);
+void AddSparkleBatchQuad(short textureNum, const OGLPoint3D corners[4], float alpha);
+void DrawSparkleBatch(void);
 
 #endif
\ No newline at end of file
@@ -269,6 +269,7 @@ struct ObjNode
 	struct ObjNode	*TwitchNode;		// ptr to node's twitch driver (if any)
 
 	uint16_t			Slot;				// sort value
+	uint32_t		AttachOrder;		// bumped each time it's attached, so it orders nodes of the same slot like the list does
 	Byte			Genre;				// obj genre
 	int				Type;				// obj type
 	int				Group;				// obj group
@@ -290,6 +291,7 @@ struct ObjNode
 
 	OGLPoint3D		Coord;				// coord of object
 	OGLPoint3D		OldCoord;			// coord @ previous frame
+	OGLPoint3D		TickCoord;			// coord @ start of the current fixed simulation tick (for drawing in between ticks)
 	OGLPoint3D		InitCoord;			// coord where was created
 	OGLVector3D		Delta;				// delta velocity of object
 	OGLVector3D		MotionVector;		// normalized version of Delta
@@ -316,6 +318,7 @@ struct ObjNode
 	float				LeftOff,RightOff,FrontOff,BackOff,TopOff,BottomOff;		// box offsets (only used by simple objects with 1 collision box)
 
 	float				BoundingSphereRadius;
+	int					TreeProxy;												// leaf in the object tree for picking (-1 = none)
 	struct ObjNode 		*CurrentTriggerObj;										// set when trigger occurs
 
 	Boolean				(*TriggerCallback)(struct ObjNode *, struct ObjNode *);			// callback when trigger occurs
@@ -358,6 +361,7 @@ struct ObjNode
 
 	OGLBoundingBox		LocalBBox;				// local-space bbox for the model
 	OGLBoundingBox		WorldBBox;				// world-space bbox for the model
+	OGLBoundingBox		CullBBox;				// world-space box for frustum culling, refreshed once per frame (see PrepareObjectsForDrawing)
 
 	SkeletonObjDataType	*Skeleton;				// pointer to skeleton record data
 
@@ -82,6 +82,12 @@ typedef struct
 }SuperTileItemIndexType;
 
 
+typedef struct
+{
+	float			minY,maxY;							// lowest & highest heightfield vertex in the supertile
+}SuperTileHeightRange;
+
+
 #define	BOTTOMLESS_PIT_Y	-100000.0f				// to identify a blank area on Cloud Level
 
 
@@ -142,6 +148,7 @@ extern 	void DisposeTerrain(void);
 void GetSuperTileInfo(long x, long z, int *superCol, int *superRow, int *tileCol, int *tileRow);
 extern	void InitTerrainManager(void);
 float	GetTerrainY(float x, float z);
+void GetTerrainYBatch(int numQueries, const OGLPoint2D *where, float *outY, OGLVector3D *outNormals);
 float	GetMinTerrainY(float x, float z, short group, short type, float scale);
 void InitCurrentScrollSettings(void);
 
@@ -153,11 +160,13 @@ Boolean SeeIfCoordsOutOfRange(float x, float z);
 void InitSuperTileGrid(void);
 void RotateOnTerrain(ObjNode *theNode, float yOffset, OGLVector3D *surfaceNormal);
 void RotateOnTerrain_WideArea(ObjNode *theNode, float yOffset, float radius);
+void SetTerrainAlignedMatrix(ObjNode *theNode, const OGLVector3D *up, const OGLPoint3D *to);
 void DoPlayerTerrainUpdate(void);
 void CalcTileNormals(long row, long col, OGLVector3D *n1, OGLVector3D *n2);
 void CalcTileNormals_NotNormalized(long row, long col, OGLVector3D *n1, OGLVector3D *n2);
 void CalculateSplitModeMatrix(void);
+void CalculateSuperTileHeightRanges(void);
 void CalculateSupertileVertexNormals(MOVertexArrayData	*meshData, long	startRow, long startCol);
 
-void DoItemShadowCasting(void);
+void DoItemShadowCasting(const char *terrainName);
 Boolean SeeIfCrossedLineMarker(ObjNode *theNode, long *whichLine);
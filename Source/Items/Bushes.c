@@ -135,6 +135,9 @@ Boolean AddFern(TerrainItemEntryType *itemPtr, float  x, float z)
 		.rot 		= RandomFloat()*PI2,
 	};
 
+	if (AddFoliage(itemPtr, &def))								// static & non-interactive, so batch it
+		return(true);
+
 	ObjNode* newObj = MakeNewDisplayGroupObject(&def);
 
 	newObj->TerrainItemPtr = itemPtr;								// keep ptr to item list
@@ -206,6 +209,9 @@ Boolean AddCatTail(TerrainItemEntryType *itemPtr, float  x, float z)
 		.moveCall 	= MoveStaticObject,
 	};
 
+	if (AddFoliage(itemPtr, &def))								// static & non-interactive, so batch it
+		return(true);
+
 	ObjNode* newObj = MakeNewDisplayGroupObject(&def);
 
 	newObj->TerrainItemPtr = itemPtr;								// keep ptr to item list
@@ -445,6 +451,10 @@ Boolean AddSproutPlant(TerrainItemEntryType *itemPtr, float  x, float z)
 		.moveCall 	= MoveStaticObject,
 		.rot 		= RandomFloat()*PI2,
 	};
+
+	if (AddFoliage(itemPtr, &def))								// static & non-interactive, so batch it
+		return(true);
+
 	ObjNode* newObj = MakeNewDisplayGroupObject(&def);
 
 	newObj->TerrainItemPtr = itemPtr;								// keep ptr to item list
@@ -488,6 +498,9 @@ short   color = itemPtr->parm[1];
 		.rot 		= RandomFloat()*PI2,
 	};
 
+	if (AddFoliage(itemPtr, &def))								// static & non-interactive, so batch it
+		return(true);
+
 	ObjNode* newObj = MakeNewDisplayGroupObject(&def);
 
 	newObj->TerrainItemPtr = itemPtr;								// keep ptr to item list
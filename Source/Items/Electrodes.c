@@ -26,6 +26,7 @@ static void DrawZaps(ObjNode *dummy);
 static void MoveZaps(ObjNode *theNode);
 static void AllocateZapGeometry(short zapSlot);
 static void FreeZap(short zapNum);
+static void BuildZapGeometryJob(void *refCon);
 
 
 /****************************/
@@ -54,6 +55,9 @@ typedef struct
 
 	OGLPoint3D	endpointCoords[MAX_ZAP_ENDPOINTS];
 
+	Boolean		isBuilt;										// has a job filled in triMesh[gZapBuffer] yet?
+	uint32_t	jitterSeed;										// rolled by MoveZaps so the job doesn't touch the game's RNG
+
 	MOVertexArrayData	triMesh[2];								// double-buffered VAR trimeshes
 }ZapType;
 
@@ -74,6 +78,10 @@ static	ZapType			gZaps[MAX_ZAPS];
 
 static	short			gZapBuffer = 0;								// which VAR double buffer? 0 or 1
 
+static	uint32_t		gZapJob = 0;								// ticket of the job building gZapBuffer
+static	short			gZapJobList[MAX_ZAPS];						// zaps that job is building
+static	short			gNumZapsInJob = 0;
+
 
 /************************* ADD ELECTRODE *********************************/
 
@@ -514,6 +522,8 @@ ObjNode		*newObj;
 short		i;
 
 	gZapBuffer = 0;
+	gZapJob = 0;
+	gNumZapsInJob = 0;
 
 	for (i = 0; i < MAX_ZAPS; i++)
 		gZaps[i].isUsed = false;				// all slots are free
@@ -543,6 +553,8 @@ short		i;
 
 void FreeAllZaps(void)
 {
+	WaitForJob(gZapJob);										// don't free anything the job is writing to
+
 	for (short i = 0; i < MAX_ZAPS; i++)
 	{
 		if (gZaps[i].isUsed)
@@ -554,16 +566,14 @@ void FreeAllZaps(void)
 
 /********************* ALLOCATE ZAP GEOMETRY **************************/
 //
-// Initializes the trimesh vertex array data for this zap
+// Allocates the trimesh vertex arrays for this zap.  They get filled in by BuildZapGeometryJob.
 //
 
 static void AllocateZapGeometry(short zapSlot)
 {
-int		numEndpoints = gZaps[zapSlot].numEndpoints;
-int		numVerts = numEndpoints * 2;
+int		numVerts = gZaps[zapSlot].numEndpoints * 2;
 int		numTriangles = numVerts - 2;
-short	i, p, t, b;
-float	u;
+short	b;
 MOVertexArrayData	*triMesh;
 
 	for (b = 0; b < 2; b++)													// allocate for both double-buffers
@@ -586,24 +596,63 @@ MOVertexArrayData	*triMesh;
 
 		triMesh->normals 		= nil;
 		triMesh->colorsFloat 	= nil;
+	}
+
+	gZaps[zapSlot].isBuilt = false;											// don't draw it until a job has filled it in
+}
+
+
+/******************* ZAP NOISE *****************************/
+//
+// The job's own little random number generator, returns 0..1.
+//
+
+static inline float ZapNoise(uint32_t *seed)
+{
+uint32_t	s = *seed;
+
+	s ^= s << 13;
+	s ^= s >> 17;
+	s ^= s << 5;
+	*seed = s;
+
+	return((float)(s >> 8) * (1.0f / 16777216.0f));
+}
+
+
+/******************* BUILD ZAP GEOMETRY JOB *****************************/
+//
+// Runs on the job thread.  Builds the jagged strip of every zap that MoveZaps put
+// in gZapJobList into that zap's gZapBuffer trimesh.
+//
 
+static void BuildZapGeometryJob(void *refCon)
+{
+#pragma unused (refCon)
+short	n, i, p, t;
+float	u;
 
-				/**********************/
-				/* BUILD THE GEOMETRY */
-				/**********************/
+	for (n = 0; n < gNumZapsInJob; n++)
+	{
+		ZapType				*zap = &gZaps[gZapJobList[n]];
+		MOVertexArrayData	*triMesh = &zap->triMesh[gZapBuffer];
+		uint32_t			seed = zap->jitterSeed;
 
-				/* SET VERTEX POINTS */
+				/* SET RANDOMIZED VERTEX POINTS */
 
 		p = 0;
-		for (i = 0; i < numEndpoints; i++)
+		for (i = 0; i < zap->numEndpoints; i++)
 		{
-			triMesh->points[p].x = gZaps[zapSlot].endpointCoords[i].x;				// top vertex
-			triMesh->points[p].y = gZaps[zapSlot].endpointCoords[i].y + ZAP_THICKNESS;
-			triMesh->points[p].z = gZaps[zapSlot].endpointCoords[i].z;
+			float	y = zap->endpointCoords[i].y + (ZapNoise(&seed) * 2.0f - 1.0f) * ZAP_RANDOM_SIZE;
+			float	thick = (ZAP_THICKNESS / 3) + ZAP_THICKNESS * ZapNoise(&seed);
 
-			triMesh->points[p+1].x = gZaps[zapSlot].endpointCoords[i].x;				// bottom vertex
-			triMesh->points[p+1].y = gZaps[zapSlot].endpointCoords[i].y - ZAP_THICKNESS;
-			triMesh->points[p+1].z = gZaps[zapSlot].endpointCoords[i].z;
+			triMesh->points[p].x = zap->endpointCoords[i].x;				// top vertex
+			triMesh->points[p].y = y + thick;
+			triMesh->points[p].z = zap->endpointCoords[i].z;
+
+			triMesh->points[p+1].x = zap->endpointCoords[i].x;				// bottom vertex
+			triMesh->points[p+1].y = y - thick;
+			triMesh->points[p+1].z = zap->endpointCoords[i].z;
 
 			p += 2;
 		}
@@ -613,7 +662,7 @@ MOVertexArrayData	*triMesh;
 
 		p = 0;
 		u = 0;
-		for (i = 0; i < numEndpoints; i++)
+		for (i = 0; i < zap->numEndpoints; i++)
 		{
 			triMesh->uvs[0][p].u = u;									// top vertex
 			triMesh->uvs[0][p].v = 1.0;
@@ -629,7 +678,7 @@ MOVertexArrayData	*triMesh;
 
 		t = 0;
 		p = 0;
-		for (i = 0; i < (numEndpoints-1); i++)
+		for (i = 0; i < (zap->numEndpoints-1); i++)
 		{
 			triMesh->triangles[t].vertexIndices[0] = p;
 			triMesh->triangles[t].vertexIndices[1] = p+1;
@@ -648,18 +697,24 @@ MOVertexArrayData	*triMesh;
 
 
 /******************* MOVE ZAPS *****************************/
+//
+// Fades the zaps and does their collision here on the main thread, then kicks
+// a job to build this frame's geometry while the rest of the objects move.
+//
 
 static void MoveZaps(ObjNode *theNode)
 {
 #pragma unused (theNode)
-short	i, j, p, numEndpoints;
+short	i, numEndpoints;
 float	fps = gFramesPerSecondFrac;
-MOVertexArrayData	*triMesh;
 OGLLineSegment		lineSeg;
 ObjNode				*hitObj;
 OGLPoint3D			worldHitCoord;
 
+	WaitForJob(gZapJob);								// last frame's job must be done before we touch the zaps
+
 	gZapBuffer ^= 1;									// toggle buffer to move & then draw
+	gNumZapsInJob = 0;
 
 	for (i = 0; i < MAX_ZAPS; i++)
 	{
@@ -680,25 +735,13 @@ OGLPoint3D			worldHitCoord;
 
 		numEndpoints = gZaps[i].numEndpoints;
 
-				/************************/
-				/* RANDOMIZE THE COORDS */
-				/************************/
+				/***************************/
+				/* HAVE THE JOB REBUILD IT */
+				/***************************/
 
-		triMesh = &gZaps[i].triMesh[gZapBuffer];									// point to VAR double-buffer #n
-
-		p = 0;
-		for (j = 0; j < numEndpoints; j++)
-		{
-			float	y = gZaps[i].endpointCoords[j].y + RandomFloat2() * ZAP_RANDOM_SIZE;
-			float	thick = (ZAP_THICKNESS / 3) + ZAP_THICKNESS * RandomFloat();
-
-			triMesh->points[p].y = y + thick;
-			triMesh->points[p+1].y = y - thick;
-
-			p += 2;
-		}
-
-		OGL_SetVertexArrayRangeDirty(VERTEX_ARRAY_RANGE_TYPE_ZAPS1 + gZapBuffer);
+		gZaps[i].jitterSeed = MyRandomLong() | 1;		// xorshift can't start from 0
+		gZaps[i].isBuilt = true;						// DrawZaps waits for the job before drawing it
+		gZapJobList[gNumZapsInJob++] = i;
 
 
 				/*********************/
@@ -715,6 +758,15 @@ OGLPoint3D			worldHitCoord;
 				hitObj->HitByWeaponHandler(theNode, hitObj, nil, nil);
 		}
 	}
+
+
+			/* BUILD THE GEOMETRY IN THE BACKGROUND */
+
+	if (gNumZapsInJob > 0)
+	{
+		OGL_SetVertexArrayRangeDirty(VERTEX_ARRAY_RANGE_TYPE_ZAPS1 + gZapBuffer);	// gets uploaded by DrawZaps, after the job is done
+		gZapJob = KickJob(BuildZapGeometryJob, nil);
+	}
 }
 
 
@@ -727,11 +779,13 @@ static void DrawZaps(ObjNode *dummy)
 
 short	i;
 
+	WaitForJob(gZapJob);								// only draw finished geometry
+
 	OGL_SetColor4f(1,1,1,1);
 
 	for (i = 0; i < MAX_ZAPS; i++)
 	{
-		if (!gZaps[i].isUsed)							// is this one active
+		if (!gZaps[i].isUsed || !gZaps[i].isBuilt)		// is this one active
 			continue;
 
 		gGlobalTransparency = gZaps[i].alpha;
@@ -0,0 +1,683 @@
+/****************************/
+/*   		FOLIAGE.C	    */
+/****************************/
+
+//
+// Static terrain foliage (ferns, cattails, ivy...) doesn't need an ObjNode each:
+// it never moves, never collides and never gets hit.  Instead, each supertile keeps
+// a list of the foliage items on it, and once the supertile's items have been added,
+// the instances of each model are baked into one world-space vertex array per
+// geometry.  Then a whole supertile's worth of a model is a single draw call,
+// and culling & auto-fade are done once per supertile instead of once per item.
+//
+// The baked arrays live in their own static VAR type, so they're uploaded to a
+// buffer object once and drawn from VRAM like the BG3D models they came from.
+//
+// There's one drawer node per slot the items asked for, so that the foliage
+// still draws in the same order relative to everything else as the items did.
+//
+// Items that do need per-instance behaviour (triggers, collision, burning trees...)
+// still get their own ObjNode, as does anything AddFoliage can't take (see below).
+//
+
+
+/****************************/
+/*    EXTERNALS             */
+/****************************/
+
+
+#include "game.h"
+
+
+/****************************/
+/*    PROTOTYPES            */
+/****************************/
+
+typedef struct FoliageSuperTileType FoliageSuperTileType;
+
+static FoliageSuperTileType *GetFoliageSuperTile(int row, int col);
+static Boolean CanBatchFoliageModel(short type);
+static ObjNode *GetFoliageDrawer(short slot);
+static void BuildFoliageBatches(FoliageSuperTileType *st);
+static void AllocFoliageMesh(MOVertexArrayData *out, const MOVertexArrayData *in);
+static void DisposeFoliageBatches(FoliageSuperTileType *st);
+static void PurgeFoliageSuperTile(FoliageSuperTileType *st);
+static void MoveFoliage(ObjNode *theNode);
+static void DrawFoliage(ObjNode *theNode);
+static void DisposeFoliage(ObjNode *theNode);
+
+
+/****************************/
+/*    CONSTANTS             */
+/****************************/
+
+#define	MAX_FOLIAGE_DRAWERS			8								// # different slots the foliage items use
+#define	MAX_FOLIAGE_SUPERTILES		((MAX_SUPERTILE_ACTIVE_RANGE*2 * MAX_SUPERTILE_ACTIVE_RANGE*2) * MAX_SPLITSCREENS)
+#define	MAX_FOLIAGE_BATCHES			8								// # different models on one supertile
+#define	MAX_FOLIAGE_MESHES			8								// # geometries in one foliage model
+
+
+typedef struct
+{
+	short					type;									// model in MODEL_GROUP_LEVELSPECIFIC
+	short					batch;									// index into the supertile's batches
+	OGLMatrix4x4			matrix;
+	TerrainItemEntryType	*itemPtr;
+}FoliageInstanceType;
+
+typedef struct
+{
+	short				type;
+	short				slot;										// drawn by the drawer for this slot
+	int					numMeshes;
+	MOVertexArrayData	meshes[MAX_FOLIAGE_MESHES];					// all instances of the model, in world coords
+}FoliageBatchType;
+
+struct FoliageSuperTileType
+{
+	Boolean				isUsed;
+	Boolean				needsRebuild;								// instances were added since the batches were made
+	int					row,col;
+
+	int					numInstances;
+	int					instanceCapacity;
+	FoliageInstanceType	*instances;
+
+	int					numBatches;
+	FoliageBatchType	batches[MAX_FOLIAGE_BATCHES];
+	OGLBoundingBox		bBox;										// world bbox of all the batches
+};
+
+
+/*********************/
+/*    VARIABLES      */
+/*********************/
+
+static Boolean				gFoliageActive = false;
+static int					gNumFoliageDrawers = 0;
+static ObjNode				*gFoliageDrawers[MAX_FOLIAGE_DRAWERS];
+static FoliageSuperTileType	gFoliageSuperTiles[MAX_FOLIAGE_SUPERTILES];
+static FoliageSuperTileType	*gLastFoliageSuperTile = nil;			// items come in a supertile at a time
+
+
+/********************* INIT FOLIAGE *************************/
+//
+// Called by InitItemsManager at the start of each level.
+// The drawer nodes are made as AddFoliage needs them.  They own everything:
+// once DeleteAllObjects has deleted the last of them, the foliage is freed.
+//
+
+void InitFoliage(void)
+{
+	SDL_zeroa(gFoliageSuperTiles);
+	SDL_zeroa(gFoliageDrawers);
+	gNumFoliageDrawers = 0;
+	gLastFoliageSuperTile = nil;
+	gFoliageActive = true;
+}
+
+
+/********************* GET FOLIAGE DRAWER *************************/
+//
+// Finds or makes the drawer node for this slot.
+//
+
+static ObjNode *GetFoliageDrawer(short slot)
+{
+	for (int i = 0; i < gNumFoliageDrawers; i++)
+	{
+		if (gFoliageDrawers[i]->Slot == slot)
+			return gFoliageDrawers[i];
+	}
+
+	if (gNumFoliageDrawers >= MAX_FOLIAGE_DRAWERS)
+		return nil;
+
+	NewObjectDefinitionType def =
+	{
+		.genre		= EVENT_GENRE,
+		.coord		= {0,0,0},
+		.flags		= STATUS_BIT_DONTCULL | STATUS_BIT_CLIPALPHA6 | STATUS_BIT_DONTPURGE,
+		.slot		= slot,
+		.moveCall	= (gNumFoliageDrawers == 0) ? MoveFoliage : nil,		// only one of them needs to purge
+		.drawCall	= DrawFoliage,
+		.scale		= 1,
+	};
+
+	ObjNode	*drawer = MakeNewObject(&def);
+	drawer->Destructor = DisposeFoliage;
+
+	gFoliageDrawers[gNumFoliageDrawers++] = drawer;
+	return drawer;
+}
+
+
+/********************* DISPOSE FOLIAGE *************************/
+
+static void DisposeFoliage(ObjNode *theNode)
+{
+	for (int i = 0; i < gNumFoliageDrawers; i++)
+	{
+		if (gFoliageDrawers[i] == theNode)
+		{
+			gFoliageDrawers[i] = gFoliageDrawers[--gNumFoliageDrawers];
+			break;
+		}
+	}
+
+	if (gNumFoliageDrawers > 0)												// the others still need the supertiles
+	{
+		if (theNode->MoveCall && gFoliageDrawers[0]->MoveCall == nil)		// hand the purging over
+			gFoliageDrawers[0]->MoveCall = MoveFoliage;
+		return;
+	}
+
+	for (int i = 0; i < MAX_FOLIAGE_SUPERTILES; i++)
+	{
+		FoliageSuperTileType *st = &gFoliageSuperTiles[i];
+
+		DisposeFoliageBatches(st);
+		SafeDisposePtr((Ptr) st->instances);
+		st->instances = nil;
+		st->instanceCapacity = 0;
+		st->numInstances = 0;
+		st->isUsed = false;
+	}
+
+	gLastFoliageSuperTile = nil;
+	gFoliageActive = false;
+}
+
+
+#pragma mark -
+
+
+/********************* ADD FOLIAGE *************************/
+//
+// Registers a terrain item as a foliage instance instead of making an ObjNode for it.
+// Returns false if it can't be batched, in which case the caller should make the
+// ObjNode as usual.
+//
+
+Boolean AddFoliage(TerrainItemEntryType *itemPtr, const NewObjectDefinitionType *def)
+{
+FoliageSuperTileType	*st;
+FoliageInstanceType		*inst;
+OGLMatrix4x4			m, m2;
+int						row, col, b;
+
+	if (!gFoliageActive || def->group != MODEL_GROUP_LEVELSPECIFIC)
+		return(false);
+
+	if (!CanBatchFoliageModel(def->type))
+		return(false);
+
+	if (!GetFoliageDrawer(def->slot))
+		return(false);
+
+	col = def->coord.x * gTerrainSuperTileUnitSizeFrac;						// same supertile the item list sorted it into
+	row = def->coord.z * gTerrainSuperTileUnitSizeFrac;
+
+	st = GetFoliageSuperTile(row, col);
+	if (!st)
+		return(false);
+
+
+			/* MAKE SURE THERE'S A BATCH FOR THIS MODEL */
+
+	for (b = 0; b < st->numBatches; b++)
+	{
+		if (st->batches[b].type == def->type && st->batches[b].slot == def->slot)
+			break;
+	}
+
+	if (b == st->numBatches)
+	{
+		if (st->numBatches >= MAX_FOLIAGE_BATCHES)
+			return(false);
+		st->batches[st->numBatches].type = def->type;
+		st->batches[st->numBatches].slot = def->slot;
+		st->batches[st->numBatches].numMeshes = 0;
+		st->numBatches++;
+	}
+
+
+			/* ADD THE INSTANCE */
+
+	if (st->numInstances >= st->instanceCapacity)
+	{
+		st->instanceCapacity = SDL_max(32, st->instanceCapacity * 2);
+		st->instances = ReallocPtr(st->instances, sizeof(FoliageInstanceType) * st->instanceCapacity);
+	}
+
+	inst = &st->instances[st->numInstances++];
+	inst->type = def->type;
+	inst->batch = b;
+	inst->itemPtr = itemPtr;
+
+	OGLMatrix4x4_SetScale(&m, def->scale, def->scale, def->scale);		// same as UpdateObjectTransforms would do
+	OGLMatrix4x4_SetRotate_Y(&m2, def->rot);
+	m2.value[M03] = def->coord.x;
+	m2.value[M13] = def->coord.y;
+	m2.value[M23] = def->coord.z;
+	OGLMatrix4x4_Multiply(&m, &m2, &inst->matrix);
+
+	st->needsRebuild = true;
+
+	return(true);
+}
+
+
+/********************* GET FOLIAGE SUPERTILE *************************/
+//
+// Finds or starts the foliage list for this supertile.
+//
+
+static FoliageSuperTileType *GetFoliageSuperTile(int row, int col)
+{
+FoliageSuperTileType	*freeST = nil;
+
+	if (gLastFoliageSuperTile && gLastFoliageSuperTile->isUsed
+		&& gLastFoliageSuperTile->row == row && gLastFoliageSuperTile->col == col)
+	{
+		return gLastFoliageSuperTile;
+	}
+
+	for (int i = 0; i < MAX_FOLIAGE_SUPERTILES; i++)
+	{
+		FoliageSuperTileType *st = &gFoliageSuperTiles[i];
+
+		if (!st->isUsed)
+		{
+			if (!freeST)
+				freeST = st;
+		}
+		else
+		if (st->row == row && st->col == col)
+		{
+			gLastFoliageSuperTile = st;
+			return st;
+		}
+	}
+
+	if (freeST)
+	{
+		freeST->isUsed			= true;
+		freeST->needsRebuild	= true;
+		freeST->row				= row;
+		freeST->col				= col;
+		freeST->numInstances	= 0;
+		freeST->numBatches		= 0;
+	}
+
+	gLastFoliageSuperTile = freeST;
+	return freeST;
+}
+
+
+/********************* CAN BATCH FOLIAGE MODEL *************************/
+//
+// We only know how to bake a model that's a plain group of vertex arrays
+// with a single uv layer.
+//
+
+static Boolean CanBatchFoliageModel(short type)
+{
+MetaObjectHeader	*mo;
+MOGroupObject		*group;
+
+	if (type >= gNumObjectsInBG3DGroupList[MODEL_GROUP_LEVELSPECIFIC])
+		return(false);
+
+	mo = gBG3DGroupList[MODEL_GROUP_LEVELSPECIFIC][type];
+	if (!mo || mo->type != MO_TYPE_GROUP)
+		return(false);
+
+	group = (MOGroupObject *) mo;
+	if (group->objectData.numObjectsInGroup > MAX_FOLIAGE_MESHES)
+		return(false);
+
+	for (int i = 0; i < group->objectData.numObjectsInGroup; i++)
+	{
+		MetaObjectHeader	*child = group->objectData.groupContents[i];
+
+		if (child->type != MO_TYPE_GEOMETRY || child->subType != MO_GEOMETRY_SUBTYPE_VERTEXARRAY)
+			return(false);
+
+		if (((MOVertexArrayObject *) child)->objectData.uvs[1])
+			return(false);
+	}
+
+	return(true);
+}
+
+
+#pragma mark -
+
+
+/********************* BUILD FOLIAGE BATCHES *************************/
+//
+// Bakes every instance on the supertile into its model's batch.
+//
+
+static void BuildFoliageBatches(FoliageSuperTileType *st)
+{
+	DisposeFoliageBatches(st);
+
+	st->bBox.min.x = st->bBox.min.y = st->bBox.min.z = 100000000;
+	st->bBox.max.x = st->bBox.max.y = st->bBox.max.z = -st->bBox.min.x;
+	st->bBox.isEmpty = true;
+
+	for (int b = 0; b < st->numBatches; b++)
+	{
+		FoliageBatchType	*batch = &st->batches[b];
+		MOGroupObject		*model = (MOGroupObject *) gBG3DGroupList[MODEL_GROUP_LEVELSPECIFIC][batch->type];
+		int					count = 0;
+
+		for (int i = 0; i < st->numInstances; i++)
+		{
+			if (st->instances[i].batch == b)
+				count++;
+		}
+
+		batch->numMeshes = model->objectData.numObjectsInGroup;
+
+		for (int g = 0; g < batch->numMeshes; g++)
+		{
+			const MOVertexArrayData	*in = &((MOVertexArrayObject *) model->objectData.groupContents[g])->objectData;
+			MOVertexArrayData		*out = &batch->meshes[g];
+			int						np = in->numPoints;
+			int						nt = in->numTriangles;
+			int						p = 0, t = 0;
+
+			SDL_zerop(out);
+
+			out->numMaterials	= in->numMaterials;
+			for (int j = 0; j < in->numMaterials; j++)
+				out->materials[j] = MO_GetNewReference(in->materials[j]);
+
+			out->numPoints		= np * count;
+			out->numTriangles	= nt * count;
+			AllocFoliageMesh(out, in);
+
+
+					/* APPEND EACH INSTANCE */
+
+			for (int i = 0; i < st->numInstances; i++)
+			{
+				const FoliageInstanceType *inst = &st->instances[i];
+
+				if (inst->batch != b)
+					continue;
+
+				OGLPoint3D_TransformArray(in->points, &inst->matrix, &out->points[p], np);
+
+				if (out->normals)
+				{
+					OGLVector3D_TransformArray(in->normals, &inst->matrix, &out->normals[p], np);
+					for (int j = p; j < p + np; j++)								// scaled, so renormalize here instead of with GL_NORMALIZE
+						OGLVector3D_Normalize(&out->normals[j], &out->normals[j]);
+				}
+
+				if (out->uvs[0])
+					SDL_memcpy(&out->uvs[0][p], in->uvs[0], sizeof(OGLTextureCoord) * np);
+
+				if (out->colorsFloat)
+					SDL_memcpy(&out->colorsFloat[p], in->colorsFloat, sizeof(OGLColorRGBA) * np);
+
+				for (int j = 0; j < nt; j++)
+				{
+					out->triangles[t+j].vertexIndices[0] = in->triangles[j].vertexIndices[0] + p;
+					out->triangles[t+j].vertexIndices[1] = in->triangles[j].vertexIndices[1] + p;
+					out->triangles[t+j].vertexIndices[2] = in->triangles[j].vertexIndices[2] + p;
+				}
+
+				p += np;
+				t += nt;
+			}
+
+
+					/* CALC BBOX */
+
+			out->bBox.min.x = out->bBox.min.y = out->bBox.min.z = 100000000;
+			out->bBox.max.x = out->bBox.max.y = out->bBox.max.z = -out->bBox.min.x;
+
+			for (int j = 0; j < out->numPoints; j++)
+			{
+				const OGLPoint3D *pt = &out->points[j];
+
+				if (pt->x < out->bBox.min.x)	out->bBox.min.x = pt->x;
+				if (pt->x > out->bBox.max.x)	out->bBox.max.x = pt->x;
+				if (pt->y < out->bBox.min.y)	out->bBox.min.y = pt->y;
+				if (pt->y > out->bBox.max.y)	out->bBox.max.y = pt->y;
+				if (pt->z < out->bBox.min.z)	out->bBox.min.z = pt->z;
+				if (pt->z > out->bBox.max.z)	out->bBox.max.z = pt->z;
+			}
+			out->bBox.isEmpty = (out->numPoints == 0);
+
+			if (!out->bBox.isEmpty)
+			{
+				st->bBox.min.x = SDL_min(st->bBox.min.x, out->bBox.min.x);
+				st->bBox.min.y = SDL_min(st->bBox.min.y, out->bBox.min.y);
+				st->bBox.min.z = SDL_min(st->bBox.min.z, out->bBox.min.z);
+				st->bBox.max.x = SDL_max(st->bBox.max.x, out->bBox.max.x);
+				st->bBox.max.y = SDL_max(st->bBox.max.y, out->bBox.max.y);
+				st->bBox.max.z = SDL_max(st->bBox.max.z, out->bBox.max.z);
+				st->bBox.isEmpty = false;
+			}
+		}
+	}
+
+	st->needsRebuild = false;
+}
+
+
+/********************* ALLOC FOLIAGE MESH *************************/
+//
+// Puts the baked arrays in the foliage VAR so they get a static buffer object.
+// If that's full, they go in regular memory instead and get drawn from there.
+//
+
+static void AllocFoliageMesh(MOVertexArrayData *out, const MOVertexArrayData *in)
+{
+Byte	varType = VERTEX_ARRAY_RANGE_TYPE_FOLIAGE;
+
+	out->VARtype		= varType;
+	out->points			= OGL_TryAllocVertexArrayMemory(sizeof(OGLPoint3D) * out->numPoints, varType);
+	out->triangles		= OGL_TryAllocVertexArrayMemory(sizeof(MOTriangleIndecies) * out->numTriangles, varType);
+	if (in->normals)
+		out->normals	= OGL_TryAllocVertexArrayMemory(sizeof(OGLVector3D) * out->numPoints, varType);
+	if (in->uvs[0])
+		out->uvs[0]		= OGL_TryAllocVertexArrayMemory(sizeof(OGLTextureCoord) * out->numPoints, varType);
+	if (in->colorsFloat)
+		out->colorsFloat = OGL_TryAllocVertexArrayMemory(sizeof(OGLColorRGBA) * out->numPoints, varType);
+
+	if (out->points && out->triangles
+		&& (out->normals || !in->normals)
+		&& (out->uvs[0] || !in->uvs[0])
+		&& (out->colorsFloat || !in->colorsFloat))
+	{
+		return;
+	}
+
+
+			/* DIDN'T ALL FIT, SO USE REGULAR MEMORY */
+
+	if (out->points)		OGL_FreeVertexArrayMemory(out->points, varType);
+	if (out->triangles)		OGL_FreeVertexArrayMemory(out->triangles, varType);
+	if (out->normals)		OGL_FreeVertexArrayMemory(out->normals, varType);
+	if (out->uvs[0])		OGL_FreeVertexArrayMemory(out->uvs[0], varType);
+	if (out->colorsFloat)	OGL_FreeVertexArrayMemory(out->colorsFloat, varType);
+
+	out->VARtype		= -1;
+	out->points			= MO_AllocVertexArrayPtr(sizeof(OGLPoint3D) * out->numPoints);
+	out->triangles		= MO_AllocVertexArrayPtr(sizeof(MOTriangleIndecies) * out->numTriangles);
+	out->normals		= in->normals ? MO_AllocVertexArrayPtr(sizeof(OGLVector3D) * out->numPoints) : nil;
+	out->uvs[0]			= in->uvs[0] ? MO_AllocVertexArrayPtr(sizeof(OGLTextureCoord) * out->numPoints) : nil;
+	out->colorsFloat	= in->colorsFloat ? MO_AllocVertexArrayPtr(sizeof(OGLColorRGBA) * out->numPoints) : nil;
+}
+
+
+/********************* BUILD PENDING FOLIAGE *************************/
+//
+// Called by AddTerrainItemsOnSuperTile once all of a supertile's items have been
+// added, so the baking happens when the supertile comes into range rather than
+// in the middle of drawing it.
+//
+
+void BuildPendingFoliage(void)
+{
+	if (!gFoliageActive)
+		return;
+
+	for (int i = 0; i < MAX_FOLIAGE_SUPERTILES; i++)
+	{
+		FoliageSuperTileType *st = &gFoliageSuperTiles[i];
+
+		if (st->isUsed && st->needsRebuild && st->numInstances > 0)
+			BuildFoliageBatches(st);
+	}
+}
+
+
+/********************* DISPOSE FOLIAGE BATCHES *************************/
+
+static void DisposeFoliageBatches(FoliageSuperTileType *st)
+{
+	for (int b = 0; b < st->numBatches; b++)
+	{
+		FoliageBatchType *batch = &st->batches[b];
+
+		for (int g = 0; g < batch->numMeshes; g++)
+			MO_DeleteObjectInfo_Geometry_VertexArray(&batch->meshes[g]);
+
+		batch->numMeshes = 0;
+	}
+
+	st->needsRebuild = true;
+}
+
+
+/********************* PURGE FOLIAGE SUPERTILE *************************/
+//
+// No player is near this supertile anymore.  Like DeleteObject does for
+// a terrain item's ObjNode, let the items be added again later.
+//
+
+static void PurgeFoliageSuperTile(FoliageSuperTileType *st)
+{
+	for (int i = 0; i < st->numInstances; i++)
+		st->instances[i].itemPtr->flags &= ~ITEM_FLAGS_INUSE;
+
+	DisposeFoliageBatches(st);
+
+	st->numInstances = 0;
+	st->numBatches = 0;
+	st->isUsed = false;
+
+	if (gLastFoliageSuperTile == st)
+		gLastFoliageSuperTile = nil;
+}
+
+
+#pragma mark -
+
+
+/********************* MOVE FOLIAGE *************************/
+
+static void MoveFoliage(ObjNode *theNode)
+{
+	(void) theNode;
+
+	for (int i = 0; i < MAX_FOLIAGE_SUPERTILES; i++)
+	{
+		FoliageSuperTileType *st = &gFoliageSuperTiles[i];
+
+		if (!st->isUsed)
+			continue;
+
+		float	x = (st->col + .5f) * gTerrainSuperTileUnitSize;				// any coord on the supertile will do
+		float	z = (st->row + .5f) * gTerrainSuperTileUnitSize;
+
+		if (SeeIfCoordsOutOfRange(x, z))
+			PurgeFoliageSuperTile(st);
+	}
+}
+
+
+/********************* DRAW FOLIAGE *************************/
+//
+// DrawObjects has already set the state for a CLIPALPHA6 node.
+// Each drawer only draws the batches in its own slot.
+// Auto-fade is done per supertile, from the camera to the nearest edge of its bbox.
+//
+
+static void DrawFoliage(ObjNode *theNode)
+{
+float	cameraX = gGameViewInfoPtr->cameraPlacement[gCurrentSplitScreenPane].cameraLocation.x;
+float	cameraZ = gGameViewInfoPtr->cameraPlacement[gCurrentSplitScreenPane].cameraLocation.z;
+Boolean	clipAlpha = true;
+
+	glDisable(GL_NORMALIZE);											// normals were renormalized when baked
+
+	for (int i = 0; i < MAX_FOLIAGE_SUPERTILES; i++)
+	{
+		FoliageSuperTileType *st = &gFoliageSuperTiles[i];
+
+		if (!st->isUsed || st->numInstances == 0 || st->needsRebuild)
+			continue;
+
+		if (st->bBox.isEmpty || !OGL_IsBBoxVisible(&st->bBox, nil))
+			continue;
+
+
+				/* CHECK AUTOFADE */
+
+		gGlobalTransparency = 1.0f;
+
+		if (gAutoFadeStatusBits)
+		{
+			float	nearX = SDL_clamp(cameraX, st->bBox.min.x, st->bBox.max.x);
+			float	nearZ = SDL_clamp(cameraZ, st->bBox.min.z, st->bBox.max.z);
+			float	dist = CalcQuickDistance(cameraX, cameraZ, nearX, nearZ);
+
+			if (dist >= gAutoFadeStartDist)
+			{
+				gGlobalTransparency -= (dist - gAutoFadeStartDist) * gAutoFadeRange_Frac;
+				if (gGlobalTransparency <= 0.0f)
+					continue;
+			}
+		}
+
+		if ((gGlobalTransparency == 1.0f) != clipAlpha)						// same as DrawObjects: only clip opaque stuff
+		{
+			clipAlpha = !clipAlpha;
+			if (clipAlpha)
+				glAlphaFunc(GL_GREATER, .6);
+			else
+				glAlphaFunc(GL_NOTEQUAL, 0);
+		}
+
+
+				/* DRAW EACH MODEL IN ONE GO */
+
+		for (int b = 0; b < st->numBatches; b++)
+		{
+			FoliageBatchType *batch = &st->batches[b];
+
+			if (batch->slot != theNode->Slot)
+				continue;
+
+			for (int g = 0; g < batch->numMeshes; g++)
+			{
+				if (batch->meshes[g].numTriangles > 0)
+					MO_DrawGeometry_VertexArray(&batch->meshes[g]);
+			}
+		}
+	}
+
+	if (!clipAlpha)
+		glAlphaFunc(GL_GREATER, .6);
+
+	gGlobalTransparency = theNode->ColorFilter.a;
+}
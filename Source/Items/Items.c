@@ -48,6 +48,7 @@ void InitItemsManager(void)
 	InitZaps();
 	InitWormholes();
 	InitDustDevilMemory();
+	InitFoliage();
 
 	CreateCyclorama();
 	CreateCloudLayer();
@@ -22,9 +22,12 @@ static void MoveLaserOrb(ObjNode *theNode);
 static void MoveLaserOrbOnSpline(ObjNode *theNode);
 static Boolean LaserOrbHitByWeaponCallback(ObjNode *bullet, ObjNode *theNode, OGLPoint3D *hitCoord, OGLVector3D *hitTriangleNormal);
 static void ExplodeLaserOrb(ObjNode *theNode);
-static void DrawOrbLaserBeam(ObjNode *beam);
+static void DrawOrbLaserBeam(ObjNode *laser);
 static Boolean CalcLaserVectorToPlayer(ObjNode *orb, short p);
 static void UpdateLaserOrbSparkles(ObjNode *orb);
+static void UpdateLaserBeam(ObjNode *orb);
+static void BuildLaserBeam(ObjNode *laser);
+static void DisposeLaserBeam(ObjNode *laser);
 
 
 /****************************/
@@ -50,12 +53,30 @@ enum
 #define	ORB_RING_DIAMETER	(LASER_ORB_SCALE * 21.0f)
 
 
+typedef struct
+{
+	Boolean				isBuilt;
+
+	OGLPoint3D			origin;
+	OGLVector3D			aim;
+	float				dist;
+	float				u;
+
+	OGLPoint3D			points[8];							// a vertical & a horizontal quad
+	OGLTextureCoord		uvs[8];
+	MOTriangleIndecies	triangles[4];
+	MOVertexArrayData	mesh;
+}LaserBeamType;
+
+
 /*********************/
 /*    VARIABLES      */
 /*********************/
 
 #define	LaserDistance	SpecialF[0]
 
+#define	LaserBeam		SpecialPtr[0]					// LaserBeamType, on the laser's dummy object
+
 
 /************************* ADD LASER ORB *********************************/
 
@@ -149,6 +170,30 @@ static ObjNode *MakeLaserOrb(float  x, float z)
 	ObjNode* laser = MakeNewObject(&def);
 	def.drawCall = NULL;
 
+	LaserBeamType* beam = AllocPtrClear(sizeof(LaserBeamType));
+	laser->LaserBeam 	= beam;
+	laser->Destructor 	= DisposeLaserBeam;
+
+	for (int q = 0; q < 2; q++)										// 2 triangles per quad
+	{
+		int	i = q * 4;
+
+		beam->triangles[q*2].vertexIndices[0] 	= i;
+		beam->triangles[q*2].vertexIndices[1] 	= i+1;
+		beam->triangles[q*2].vertexIndices[2] 	= i+2;
+		beam->triangles[q*2+1].vertexIndices[0] = i;
+		beam->triangles[q*2+1].vertexIndices[1] = i+2;
+		beam->triangles[q*2+1].vertexIndices[2] = i+3;
+	}
+
+	beam->mesh.VARtype 		= -1;
+	beam->mesh.numMaterials = -1;							// DrawOrbLaserBeam submits the material
+	beam->mesh.numPoints 	= 8;
+	beam->mesh.numTriangles = 4;
+	beam->mesh.points 		= beam->points;
+	beam->mesh.uvs[0] 		= beam->uvs;
+	beam->mesh.triangles 	= beam->triangles;
+
 	newObj->ChainNode = green;
 	green->ChainHead = newObj;
 
@@ -297,6 +342,7 @@ update:
 	UpdateShadow(theNode);
 	CalcObjectBoxFromNode(theNode);
 	UpdateLaserOrbSparkles(theNode);
+	UpdateLaserBeam(theNode);
 
 
 			/* ANIMATE GREEN THING */
@@ -503,110 +549,159 @@ float					x,y,z, q;
 
 #pragma mark -
 
-/*************************** DRAW ORB LASER BEAM ***************************/
+/*************************** UPDATE LASER BEAM ***************************/
+//
+// Builds the beam's quads from the orb's current position.
+// It's only 8 vertices, so it's done right here in the move.
+//
 
-static void DrawOrbLaserBeam(ObjNode *beam)
+static void UpdateLaserBeam(ObjNode *orb)
 {
-ObjNode	*orb = beam->ChainHead->ChainHead;
+ObjNode			*laser = orb->ChainNode->ChainNode;
+LaserBeamType	*beam = laser->LaserBeam;
+float			vx,vz;
 
-		/***********************/
-		/* DRAW THE LASER BEAM */
-		/***********************/
-
-	if (orb->Mode == ORB_MODE_SHOOTING)
+	if (orb->Mode != ORB_MODE_SHOOTING)
 	{
-		OGLTextureCoord	uv[4];
-		OGLPoint3D	p[4];
-		OGLVector3D	side;
-		float		x,y,z,dist;
-		float		vx,vy,vz, u;
+		beam->isBuilt = false;
+		return;
+	}
 
-		MO_DrawMaterial(gSpriteGroupList[SPRITE_GROUP_GLOBAL][GLOBAL_SObjType_LaserOrbBeam].materialObject);		// activate material
-		OGL_SetColor4f(1,1,1,orb->Timer * 2.0f);
+	vx = orb->MotionVector.x;
+	vz = orb->MotionVector.z;
 
-		dist =  orb->LaserDistance;
+	beam->origin.x 	= orb->Coord.x + vx * ORB_RING_DIAMETER;
+	beam->origin.y 	= orb->Coord.y + ORB_RING_YOFF;
+	beam->origin.z 	= orb->Coord.z + vz * ORB_RING_DIAMETER;
+	beam->aim 		= orb->MotionVector;
+	beam->dist 		= orb->LaserDistance;
+	beam->u 		= orb->TextureTransformU -= gFramesPerSecondFrac * 8.0f;
+	beam->isBuilt 	= true;
 
+	BuildLaserBeam(laser);
+}
 
-		u = orb->TextureTransformU -= gFramesPerSecondFrac * 8.0f;
 
-		uv[0].u = u;
-		uv[0].v = 0;
-		uv[1].u = u;
-		uv[1].v = 1;
-		uv[2].u = u + dist * .007f;
-		uv[2].v = 1;
-		uv[3].u = u + dist * .007f;
-		uv[3].v = 0;
+/*************************** BUILD LASER BEAM ***************************/
 
+static void BuildLaserBeam(ObjNode *laser)
+{
+LaserBeamType	*beam = laser->LaserBeam;
+OGLPoint3D		*p = beam->points;
+OGLTextureCoord	*uv = beam->uvs;
+OGLVector3D		side;
+float			x,y,z,dist;
+float			vx,vy,vz, u;
+
+	dist 	= beam->dist;
+	u 		= beam->u;
+
+	uv[0].u = u;
+	uv[0].v = 0;
+	uv[1].u = u;
+	uv[1].v = 1;
+	uv[2].u = u + dist * .007f;
+	uv[2].v = 1;
+	uv[3].u = u + dist * .007f;
+	uv[3].v = 0;
+
+	uv[4] = uv[0];											// both quads are mapped the same
+	uv[5] = uv[1];
+	uv[6] = uv[2];
+	uv[7] = uv[3];
 
 
 				/* GET INFO */
 
-		vx = orb->MotionVector.x;
-		vy = orb->MotionVector.y;
-		vz = orb->MotionVector.z;
+	vx = beam->aim.x;
+	vy = beam->aim.y;
+	vz = beam->aim.z;
 
-		x 	= orb->Coord.x + vx * ORB_RING_DIAMETER;
-		y 	= orb->Coord.y + ORB_RING_YOFF;
-		z 	= orb->Coord.z + vz * ORB_RING_DIAMETER;
+	x 	= beam->origin.x;
+	y 	= beam->origin.y;
+	z 	= beam->origin.z;
+
+
+			/* VERTICAL QUAD */
 
+	p[0].x = x;
+	p[0].y = y - LASER_BEAM_SIZE;
+	p[0].z = z;
 
-			/* DRAW VERTICAL QUAD */
+	p[1].x = x;
+	p[1].y = y + LASER_BEAM_SIZE;
+	p[1].z = z;
 
-		p[0].x = x;
-		p[0].y = y - LASER_BEAM_SIZE;
-		p[0].z = z;
+	p[2].x = x 		+ vx * dist;
+	p[2].y = p[1].y + vy * dist;
+	p[2].z = z 		+ vz * dist;
 
-		p[1].x = x;
-		p[1].y = y + LASER_BEAM_SIZE;
-		p[1].z = z;
+	p[3].x = p[2].x;
+	p[3].y = p[0].y + vy * dist;
+	p[3].z = p[2].z;
 
-		p[2].x = x 		+ vx * dist;
-		p[2].y = p[1].y + vy * dist;
-		p[2].z = z 		+ vz * dist;
 
-		p[3].x = p[2].x;
-		p[3].y = p[0].y + vy * dist;
-		p[3].z = p[2].z;
+			/* HORIZONTAL QUAD */
 
-		glBegin(GL_QUADS);
+	OGLVector3D_Cross(&gUp, &beam->aim, &side);					// calc side x-axis vector
+
+	p[4].x = x + side.x * LASER_BEAM_SIZE;
+	p[4].y = y;
+	p[4].z = z + side.z * LASER_BEAM_SIZE;
+
+	p[5].x = x - side.x * LASER_BEAM_SIZE;
+	p[5].y = y;
+	p[5].z = z - side.z * LASER_BEAM_SIZE;
+
+	p[6].x = p[5].x	+ vx * dist;
+	p[6].y = y + vy * dist;
+	p[6].z = p[5].z	+ vz * dist;
+
+	p[7].x = p[4].x	+ vx * dist;
+	p[7].y = p[6].y;
+	p[7].z = p[4].z	+ vz * dist;
+}
 
-		glTexCoord2fv(&uv[0].u);	glVertex3fv(&p[0].x);
-		glTexCoord2fv(&uv[1].u);	glVertex3fv(&p[1].x);
-		glTexCoord2fv(&uv[2].u);	glVertex3fv(&p[2].x);
-		glTexCoord2fv(&uv[3].u);	glVertex3fv(&p[3].x);
 
-		glEnd();
+/*************************** DRAW ORB LASER BEAM ***************************/
 
-			/* DRAW HORIZONTAL QUAD */
+static void DrawOrbLaserBeam(ObjNode *laser)
+{
+ObjNode			*orb = laser->ChainHead->ChainHead;
+LaserBeamType	*beam = laser->LaserBeam;
+OGLVector3D		drawOffset;
 
-		OGLVector3D_Cross(&gUp, &orb->MotionVector, &side);					// calc side x-axis vector
+	if (orb->Mode == ORB_MODE_SHOOTING && beam->isBuilt)
+	{
+		Boolean	offset = GetObjectDrawOffset(orb, &drawOffset);		// the beam is built in world space from the orb, so draw it where the orb is drawn
 
-		p[0].x = x + side.x * LASER_BEAM_SIZE;
-		p[0].y = y;
-		p[0].z = z + side.z * LASER_BEAM_SIZE;
+		if (offset)
+		{
+			glPushMatrix();
+			glTranslatef(drawOffset.x, drawOffset.y, drawOffset.z);
+		}
 
-		p[1].x = x - side.x * LASER_BEAM_SIZE;
-		p[1].y = y;
-		p[1].z = z - side.z * LASER_BEAM_SIZE;
+		MO_DrawMaterial(gSpriteGroupList[SPRITE_GROUP_GLOBAL][GLOBAL_SObjType_LaserOrbBeam].materialObject);		// activate material
+		OGL_SetColor4f(1,1,1,orb->Timer * 2.0f);
 
-		p[2].x = p[1].x	+ vx * dist;
-		p[2].y = y + vy * dist;
-		p[2].z = p[1].z	+ vz * dist;
+		MO_DrawGeometry_VertexArray(&beam->mesh);
 
-		p[3].x = p[0].x	+ vx * dist;
-		p[3].y = p[2].y;
-		p[3].z = p[0].z	+ vz * dist;
+		if (offset)
+			glPopMatrix();
+	}
+}
 
-		glBegin(GL_QUADS);
 
-		glTexCoord2fv(&uv[0].u);	glVertex3fv(&p[0].x);
-		glTexCoord2fv(&uv[1].u);	glVertex3fv(&p[1].x);
-		glTexCoord2fv(&uv[2].u);	glVertex3fv(&p[2].x);
-		glTexCoord2fv(&uv[3].u);	glVertex3fv(&p[3].x);
+/*************************** DISPOSE LASER BEAM ***************************/
 
-		glEnd();
+static void DisposeLaserBeam(ObjNode *laser)
+{
+LaserBeamType	*beam = laser->LaserBeam;
 
+	if (beam)
+	{
+		SafeDisposePtr(beam);
+		laser->LaserBeam = nil;
 	}
 }
 
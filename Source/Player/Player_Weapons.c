@@ -116,6 +116,8 @@ uint32_t				ctype;
 	ctype |= CTYPE_PLAYER2 >> p;							// and also other players
 
 	ray.origin = gCoord;
+	if (IsInputReplayActive())
+		CullTestObjectsForPlayer(p, ctype);					// cull bits from this tick's camera, not the last frame drawn
 	hitNode = OGL_DoRayCollision_ObjNodes(&ray, STATUS_BIT_HIDDEN | (STATUS_BIT_ISCULLED1 << p), ctype, nil, nil);
 
 	if (hitNode)
@@ -154,13 +154,19 @@ void SetUpAnaglyphCalibrationScreen(void)
 	}
 
 			/* NUKE AND RELOAD TEXTURES SO THE CURRENT ANAGLYPH FILTER APPLIES TO THEM */
+			//
+			// Not needed if the anaglyph shader is doing the filtering: it picks up the new prefs next frame.
+			//
 
 	DisposeAnaglyphCalibrationScreen();
 
-	DisposeGlobalAssets();		// reload the font - won't apply to current menu because it keeps a reference to the
-	LoadGlobalAssets();			// old material, but at least the text will look correct when we exit the menu.
+	if (!OGL_IsAnaglyphShaderActive())
+	{
+		DisposeGlobalAssets();		// reload the font - won't apply to current menu because it keeps a reference to the
+		LoadGlobalAssets();			// old material, but at least the text will look correct when we exit the menu.
 
-	BuildMainMenuObjects();		// rebuild background image
+		BuildMainMenuObjects();		// rebuild background image
+	}
 
 	DisposeSpriteAtlas(ATLAS_GROUP_FONT3);
 	LoadSpriteAtlas(ATLAS_GROUP_FONT3, ":Sprites:fonts:swiss", kAtlasLoadFont);
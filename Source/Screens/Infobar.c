@@ -276,6 +276,7 @@ static ObjNode* MakePaneDivider(void)
 void InitInfobar(void)
 {
 MOMaterialObject	*mo;
+int					prevTag = SetMemoryTag(MEMORY_TAG_UI);
 
 
 	gBlinkingEggType = -1;
@@ -438,6 +439,7 @@ no_ohm:
 	gFuelTriMesh.colorsFloat 		= nil;
 	gFuelTriMesh.triangles 			= &gFuelTriangles[0];
 
+	SetMemoryTag(prevTag);
 }
 
 
@@ -1260,7 +1262,7 @@ static void Infobar_DrawEggs(void)
 float	x,y;
 
 
-	gBlinkingEggTimer += gFramesPerSecondFrac;
+	gBlinkingEggTimer += gDrawFramesPerSecondFrac;
 
 
 	x = EGGS_X;
@@ -1306,7 +1308,7 @@ short	eggType = gCurrentSplitScreenPane^1;			// egg type is OTHER player's, so ^
 short	i;
 float	x,y;
 	
-	gBlinkingEggTimer += gFramesPerSecondFrac / (float)gNumPlayers;
+	gBlinkingEggTimer += gDrawFramesPerSecondFrac / (float)gNumPlayers;
 
 	y = CAP_EGGS_Y;
 	x = CAP_EGGS_X;
@@ -1384,7 +1386,7 @@ static void Infobar_DrawMissionStatus(void)
 
 	else if (gOpenPlayerWormhole && (!gCameraInExitMode))
 	{
-		flux += gFramesPerSecondFrac;
+		flux += gDrawFramesPerSecondFrac;
 
 		float scale = 0.5f * (1.0f + sinf(GAME_MIN(PI, flux*6.0f) - (PI*0.5f)));
 		int flags = 0;
@@ -1926,7 +1928,7 @@ float		scale;
 	{
 		static float q = 0;
 
-		q += gFramesPerSecondFrac * PI2;
+		q += gDrawFramesPerSecondFrac * PI2;
 		DrawInfobarSprite_Rotated(screenCoord.x, screenCoord.y, scale * 1.3, INFOBAR_SObjType_GunSight_Locked, q);
 		DrawInfobarSprite_Centered(screenCoord.x, screenCoord.y, scale * 1.6, INFOBAR_SObjType_GunSight_OuterRing);
 	}
@@ -231,6 +231,8 @@ ObjNode	*newObj;
 
 			/* LOAD MODELS */
 
+	SharePrefetchedFiles(true);									// the level is going to need some of these too
+
 	FSMakeFSSpec(gDataSpec.vRefNum, gDataSpec.parID, ":Models:playerparts.bg3d", &spec);
 	ImportBG3D(&spec, MODEL_GROUP_PLAYER, VERTEX_ARRAY_RANGE_TYPE_BG3DMODELS);
 
@@ -248,6 +250,8 @@ ObjNode	*newObj;
 	LoadASkeleton(SKELETON_TYPE_BONUSWORMHOLE);
 	LoadASkeleton(SKELETON_TYPE_PLAYER);
 
+	SharePrefetchedFiles(false);
+
 
 
 			/*****************/
@@ -371,6 +371,53 @@ static const MenuItem gSettingsMenuTree[] =
 			},
 		},
 	},
+	{
+		kMICycler2, STR_TEXTURES_MODELS,
+		.cycler =
+		{
+			.valuePtr = &gGamePrefs.textureQuality[TEXTURE_GROUP_MODELS],
+			.choices =
+			{
+				{STR_TEXTURE_QUALITY_ORIGINAL, TEXTURE_QUALITY_ORIGINAL},
+				{STR_TEXTURE_QUALITY_MIPMAPPED, TEXTURE_QUALITY_MIPMAPPED},
+				{STR_TEXTURE_QUALITY_COMPRESSED, TEXTURE_QUALITY_COMPRESSED},
+			},
+		},
+	},
+	{
+		kMICycler2, STR_TEXTURES_TERRAIN,
+		.cycler =
+		{
+			.valuePtr = &gGamePrefs.textureQuality[TEXTURE_GROUP_TERRAIN],
+			.choices =
+			{
+				{STR_TEXTURE_QUALITY_ORIGINAL, TEXTURE_QUALITY_ORIGINAL},
+				{STR_TEXTURE_QUALITY_MIPMAPPED, TEXTURE_QUALITY_MIPMAPPED},
+				{STR_TEXTURE_QUALITY_COMPRESSED, TEXTURE_QUALITY_COMPRESSED},
+			},
+		},
+	},
+	{
+		kMICycler2, STR_TEXTURES_SPRITES,
+		.cycler =
+		{
+			.valuePtr = &gGamePrefs.textureQuality[TEXTURE_GROUP_SPRITES],
+			.choices =
+			{
+				{STR_TEXTURE_QUALITY_ORIGINAL, TEXTURE_QUALITY_ORIGINAL},
+				{STR_TEXTURE_QUALITY_MIPMAPPED, TEXTURE_QUALITY_MIPMAPPED},
+				{STR_TEXTURE_QUALITY_COMPRESSED, TEXTURE_QUALITY_COMPRESSED},
+			},
+		},
+	},
+	{
+		kMICycler2, STR_SIMULATION_RATE,
+		.cycler =
+		{
+			.valuePtr = &gGamePrefs.fixedTimestep,
+			.choices = { {STR_SIMULATION_RATE_VARIABLE, 0}, {STR_SIMULATION_RATE_FIXED, 1} },
+		}
+	},
 	{
 		kMIPick,
 		STR_3D_GLASSES_CALIBRATE,
@@ -61,7 +61,9 @@ void LoadASkeleton(Byte num)
 
 				/* LOAD THE SKELETON FILE */
 
+	int prevTag = SetMemoryTag(MEMORY_TAG_SKELETONS);
 	gLoadedSkeletonsList[num] = LoadSkeletonFile(num);
+	SetMemoryTag(prevTag);
 
 
 	gNumDecomposedTriMeshesInSkeleton[num] = gLoadedSkeletonsList[num]->numDecomposedTriMeshes;		// keep easy access version of this value
@@ -178,19 +180,19 @@ long	numAnims,numJoints;
 				/* ALLOC ANIM EVENTS LISTS */
 				/***************************/
 
-	skeleton->NumAnimEvents = (Byte *) AllocPtrClear(sizeof(Byte)*numAnims);			// array which holds # events for each anim
-	Alloc_2d_array(AnimEventType, skeleton->AnimEventsList, numAnims, MAX_ANIM_EVENTS);
+	skeleton->NumAnimEvents = (Byte *) AllocLevelPtrClear(sizeof(Byte)*numAnims);			// array which holds # events for each anim
+	Alloc_Level_2d_array(AnimEventType, skeleton->AnimEventsList, numAnims, MAX_ANIM_EVENTS);
 
 
 			/* ALLOC BONE INFO */
 
-	skeleton->Bones = (BoneDefinitionType *) AllocPtrClear(sizeof(BoneDefinitionType)*numJoints);
+	skeleton->Bones = (BoneDefinitionType *) AllocLevelPtrClear(sizeof(BoneDefinitionType)*numJoints);
 
 
 		/* ALLOC DECOMPOSED DATA */
 
-	skeleton->decomposedPointList = (DecomposedPointType *) AllocPtrClear(sizeof(DecomposedPointType)*MAX_DECOMPOSED_POINTS);
-	skeleton->decomposedNormalsList = (OGLVector3D *) AllocPtrClear(sizeof(OGLVector3D)*MAX_DECOMPOSED_NORMALS);
+	skeleton->decomposedPointList = (DecomposedPointType *) AllocLevelPtrClear(sizeof(DecomposedPointType)*MAX_DECOMPOSED_POINTS);
+	skeleton->decomposedNormalsList = (OGLVector3D *) AllocLevelPtrClear(sizeof(OGLVector3D)*MAX_DECOMPOSED_NORMALS);
 }
 
 
@@ -20,6 +20,11 @@
 
 static void ReadDataFromSkeletonFile(SkeletonDefType *skeleton, FSSpec *fsSpec, int skeletonType);
 static void ReadDataFromPlayfieldFile(FSSpec *specPtr);
+static Boolean LoadCompiledPlayfield(FSSpec *terSpec, FSSpec *compiledSpec);
+static Boolean GetPlayfieldSourceKey(const FSSpec *terSpec, uint32_t *dataForkSize, uint32_t *rsrcForkSize, uint64_t *rsrcHash);
+static long HashFile(const FSSpec *spec, uint64_t *hash);
+static void LoadSuperTileTextures(FSSpec *specPtr);
+static void MakeSuperTileLoadOrder(void);
 
 /****************************/
 /*    CONSTANTS             */
@@ -27,6 +32,8 @@ static void ReadDataFromPlayfieldFile(FSSpec *specPtr);
 
 #define	SKELETON_FILE_VERS_NUM	0x0110			// v1.1
 
+#define	SUPERTILE_DECODE_AHEAD	8				// how many supertile JPEGs the prefetch thread decodes ahead of the upload
+
 		/* PLAYFIELD HEADER */
 
 typedef struct
@@ -68,6 +75,107 @@ typedef struct
 }FileFenceDefType;
 
 
+		/* COMPILED PLAYFIELD */
+		//
+		// A .terc file is a native-endian copy of a .ter file with all coordinates
+		// already scaled to world units, written by --compile-playfields.
+		// Every section is aligned so that it can be used in place once the file
+		// is in memory, so loading one is a single read instead of dozens of
+		// resource fetches + swizzles.
+		//
+
+#define	COMPILED_PLAYFIELD_MAGIC		"N2PF"
+#define	COMPILED_PLAYFIELD_VERSION		3
+#define	COMPILED_PLAYFIELD_ENDIAN_TAG	0x01020304				// reads back differently on a machine of the other endianness
+#define	COMPILED_PLAYFIELD_ALIGN		16
+
+enum
+{
+	CPF_SECTION_SUPERTILEGRID,			// short[numSuperTilesDeep][numSuperTilesWide]
+	CPF_SECTION_YCOORDS,				// float[mapHeight+1][mapWidth+1], already scaled to world units
+	CPF_SECTION_ITEMS,					// TerrainItemEntryType[numItems], already in world units
+	CPF_SECTION_SPLINES,				// CompiledSplineDefType[numSplines]
+	CPF_SECTION_SPLINEPOINTS,			// SplinePointType[], all splines back to back
+	CPF_SECTION_SPLINEITEMS,			// SplineItemType[], all splines back to back
+	CPF_SECTION_FENCES,					// CompiledFenceDefType[numFences]
+	CPF_SECTION_FENCENUBS,				// OGLPoint3D[], all fences back to back
+	CPF_SECTION_WATER,					// WaterDefType[numWaterPatches]
+	CPF_SECTION_LINEMARKERS,			// LineMarkerDefType[numLineMarkers], already in world units
+	CPF_SECTION_SUPERTILEIMAGES,		// CompiledSuperTileImageType[numUniqueSuperTiles], indexed by supertile id
+	CPF_SECTION_SUPERTILEJPEGS,			// the QT image records from the .ter data fork
+	NUM_CPF_SECTIONS
+};
+
+typedef struct
+{
+	uint32_t		offset;				// from start of file
+	uint32_t		size;				// in bytes
+	uint32_t		elementSize;		// sizeof one record, so that a build with a different struct layout rejects the file
+}CompiledPlayfieldSectionType;
+
+typedef struct
+{
+	char			magic[4];
+	uint32_t		endianTag;
+	uint32_t		version;
+	uint32_t		headerSize;
+	uint32_t		sourceDataForkSize;	// size of the .ter data fork this was compiled from, to catch stale files
+	uint32_t		sourceRsrcForkSize;	// size of its resource fork (items, splines, fences, water...)
+	uint64_t		sourceRsrcHash;		// HashBytes of the resource fork, to catch same-size edits
+	float			terrainPolygonSize;	// gTerrainPolygonSize that the coordinates were scaled with
+	int32_t			numItems;
+	int32_t			mapWidth;
+	int32_t			mapHeight;
+	float			tileSize;
+	float			minY,maxY;
+	int32_t			numSplines;
+	int32_t			numFences;
+	int32_t			numUniqueSuperTiles;
+	int32_t			numWaterPatches;
+	int32_t			numLineMarkers;
+	CompiledPlayfieldSectionType	sections[NUM_CPF_SECTIONS];
+}CompiledPlayfieldHeaderType;
+
+typedef struct
+{
+	int16_t			numNubs;
+	int16_t			numItems;
+	int32_t			numPoints;
+	uint32_t		firstPoint;			// index into CPF_SECTION_SPLINEPOINTS
+	uint32_t		firstItem;			// index into CPF_SECTION_SPLINEITEMS
+	Rect			bBox;
+}CompiledSplineDefType;
+
+typedef struct
+{
+	uint16_t		type;
+	int16_t			numNubs;
+	uint32_t		firstNub;			// index into CPF_SECTION_FENCENUBS
+}CompiledFenceDefType;
+
+typedef struct
+{
+	uint32_t		offset;				// into CPF_SECTION_SUPERTILEJPEGS
+	uint32_t		size;
+}CompiledSuperTileImageType;
+
+static const uint32_t kCompiledPlayfieldElementSizes[NUM_CPF_SECTIONS] =
+{
+	[CPF_SECTION_SUPERTILEGRID]		= sizeof(short),
+	[CPF_SECTION_YCOORDS]			= sizeof(float),
+	[CPF_SECTION_ITEMS]				= sizeof(TerrainItemEntryType),
+	[CPF_SECTION_SPLINES]			= sizeof(CompiledSplineDefType),
+	[CPF_SECTION_SPLINEPOINTS]		= sizeof(SplinePointType),
+	[CPF_SECTION_SPLINEITEMS]		= sizeof(SplineItemType),
+	[CPF_SECTION_FENCES]			= sizeof(CompiledFenceDefType),
+	[CPF_SECTION_FENCENUBS]			= sizeof(OGLPoint3D),
+	[CPF_SECTION_WATER]				= sizeof(WaterDefType),
+	[CPF_SECTION_LINEMARKERS]		= sizeof(LineMarkerDefType),
+	[CPF_SECTION_SUPERTILEIMAGES]	= sizeof(CompiledSuperTileImageType),
+	[CPF_SECTION_SUPERTILEJPEGS]	= 1,
+};
+
+
 
 
 /**********************/
@@ -79,6 +187,14 @@ static	PrefsType gDiskShadowPrefs;
 
 float	g3DTileSize, g3DMinY, g3DMaxY;
 
+static	Ptr		gCompiledPlayfield = nil;				// entire .terc file of the current level, used in place
+static	long	gCompiledPlayfieldSize = 0;
+
+static	short	*gSuperTileLoadOrder = nil;				// supertile ids in the order LoadSuperTileTextures needs them
+static	int		gNumSuperTilesInLoadOrder = 0;
+static	int		gNumSuperTilesRequested = 0;			// how far into gSuperTileLoadOrder the prefetch thread has been asked to decode
+static	int		gNumSuperTilesLoaded = 0;
+
 
 
 
@@ -133,7 +249,7 @@ const char*	modelNames[MAX_SKELETON_TYPES] =
 
 			/* ALLOC MEMORY FOR SKELETON INFO STRUCTURE */
 
-	skeleton = (SkeletonDefType *) AllocPtrClear(sizeof(SkeletonDefType));
+	skeleton = (SkeletonDefType *) AllocLevelPtrClear(sizeof(SkeletonDefType));
 	GAME_ASSERT(skeleton);
 
 
@@ -248,11 +364,11 @@ OGLPoint3D				*pointPtr;
 
 			/* ALLOC THE POINT & NORMALS SUB-ARRAYS */
 
-		skeleton->Bones[i].pointList = (uint16_t *) AllocPtrClear(sizeof(uint16_t) * (int)skeleton->Bones[i].numPointsAttachedToBone);
+		skeleton->Bones[i].pointList = (uint16_t *) AllocLevelPtrClear(sizeof(uint16_t) * (int)skeleton->Bones[i].numPointsAttachedToBone);
 		if (skeleton->Bones[i].pointList == nil)
 			DoFatalAlert("ReadDataFromSkeletonFile: AllocPtr/pointList failed!");
 
-		skeleton->Bones[i].normalList = (uint16_t *) AllocPtrClear(sizeof(uint16_t) * (int)skeleton->Bones[i].numNormalsAttachedToBone);
+		skeleton->Bones[i].normalList = (uint16_t *) AllocLevelPtrClear(sizeof(uint16_t) * (int)skeleton->Bones[i].numNormalsAttachedToBone);
 		if (skeleton->Bones[i].normalList == nil)
 			DoFatalAlert("ReadDataFromSkeletonFile: AllocPtr/normalList failed!");
 
@@ -368,7 +484,7 @@ OGLPoint3D				*pointPtr;
 
 				/* ALLOC 2D ARRAY FOR KEYFRAMES */
 
-		Alloc_2d_array(JointKeyframeType,skeleton->JointKeyframes[j].keyFrames,	numAnims,MAX_KEYFRAMES);
+		Alloc_Level_2d_array(JointKeyframeType,skeleton->JointKeyframes[j].keyFrames,	numAnims,MAX_KEYFRAMES);
 
 		if ((skeleton->JointKeyframes[j].keyFrames == nil) || (skeleton->JointKeyframes[j].keyFrames[0] == nil))
 			DoFatalAlert("ReadDataFromSkeletonFile: Error allocating Keyframe Array.");
@@ -447,21 +563,30 @@ OSErr SavePrefs(void)
 #pragma mark -
 
 /******************* LOAD PLAYFIELD *******************/
+//
+// compiledSpecPtr is the .terc version of the level, which is preferred if it's
+// present and up to date.  Pass nil to always read the .ter resources.
+//
 
-void LoadPlayfield(FSSpec *specPtr)
+void LoadPlayfield(FSSpec *specPtr, FSSpec *compiledSpecPtr)
 {
+int	prevTag = SetMemoryTag(MEMORY_TAG_TERRAIN);
 
 	gDisableHiccupTimer = true;
 
-			/* READ PLAYFIELD RESOURCES */
+			/* READ PLAYFIELD DATA */
 
-	ReadDataFromPlayfieldFile(specPtr);
+	if (!compiledSpecPtr || !LoadCompiledPlayfield(specPtr, compiledSpecPtr))
+		ReadDataFromPlayfieldFile(specPtr);
+
+	LoadSuperTileTextures(specPtr);
 
 
 				/* DO ADDITIONAL SETUP */
 
 	CreateSuperTileMemoryList();		// allocate memory for the supertile geometry
 	CalculateSplitModeMatrix();					// precalc the tile split mode matrix
+	CalculateSuperTileHeightRanges();			// precalc the min/max heights used for picking
 	InitSuperTileGrid();						// init the supertile state grid
 
 	BuildTerrainItemList();						// build list of items & find player start coords
@@ -469,7 +594,9 @@ void LoadPlayfield(FSSpec *specPtr)
 
 			/* CAST ITEM SHADOWS */
 
-	DoItemShadowCasting();
+	DoItemShadowCasting(specPtr->cName);
+
+	SetMemoryTag(prevTag);
 }
 
 
@@ -481,7 +608,6 @@ Handle					hand;
 PlayfieldHeaderType		**header;
 float					yScale;
 short					fRefNum;
-OSErr					iErr;
 
 #if 0
 			/* USE 16-BIT IF IN LOW-QUALITY RENDER MODES OR LOW ON VRAM */
@@ -551,7 +677,7 @@ OSErr					iErr;
 
 	if (gSuperTileTextureGrid)														// free old array
 		Free_2d_array(gSuperTileTextureGrid);
-	Alloc_2d_array(short, gSuperTileTextureGrid, gNumSuperTilesDeep, gNumSuperTilesWide);
+	Alloc_Level_2d_array(short, gSuperTileTextureGrid, gNumSuperTilesDeep, gNumSuperTilesWide);
 
 	hand = GetResource('STgd',1000);												// load grid from rez
 	if (hand == nil)
@@ -602,8 +728,8 @@ OSErr					iErr;
 
 	yScale = gTerrainPolygonSize / g3DTileSize;											// need to scale original geometry units to game units
 
-	Alloc_2d_array(float, gMapYCoords, gTerrainTileDepth+1, gTerrainTileWidth+1);			// alloc 2D array for map
-	Alloc_2d_array(float, gMapYCoordsOriginal, gTerrainTileDepth+1, gTerrainTileWidth+1);	// and the copy of it
+	Alloc_Level_2d_array(float, gMapYCoords, gTerrainTileDepth+1, gTerrainTileWidth+1);			// alloc 2D array for map
+	Alloc_Level_2d_array(float, gMapYCoordsOriginal, gTerrainTileDepth+1, gTerrainTileWidth+1);	// and the copy of it
 
 	hand = GetResource('YCrd',1000);
 	if (hand == nil)
@@ -639,7 +765,7 @@ OSErr					iErr;
 
 					/* COPY INTO OUR STRUCT */
 
-		gMasterItemList = AllocPtrClear(sizeof(TerrainItemEntryType) * gNumTerrainItems);			// alloc array of items
+		gMasterItemList = AllocLevelPtrClear(sizeof(TerrainItemEntryType) * gNumTerrainItems);			// alloc array of items
 
 		for (int i = 0; i < gNumTerrainItems; i++)
 		{
@@ -670,7 +796,7 @@ OSErr					iErr;
 	{
 		File_SplineDefType	*splinePtr = (File_SplineDefType *)*hand;
 
-		gSplineList = AllocPtrClear(sizeof(SplineDefType) * gNumSplines);				// allocate memory for spline data
+		gSplineList = AllocLevelPtrClear(sizeof(SplineDefType) * gNumSplines);				// allocate memory for spline data
 
 		for (int i = 0; i < gNumSplines; i++)
 		{
@@ -706,7 +832,7 @@ OSErr					iErr;
 		{
 			SplinePointType	*ptList = (SplinePointType *)*hand;
 
-			spline->pointList = AllocPtrClear(sizeof(SplinePointType) * spline->numPoints);	// alloc memory for point list
+			spline->pointList = AllocLevelPtrClear(sizeof(SplinePointType) * spline->numPoints);	// alloc memory for point list
 
 			for (int j = 0; j < spline->numPoints; j++)			// swizzle
 			{
@@ -733,7 +859,7 @@ OSErr					iErr;
 
 			SplineItemType	*itemList = (SplineItemType *)*hand;
 
-			spline->itemList = AllocPtrClear(sizeof(SplineItemType) * spline->numItems);	// alloc memory for item list
+			spline->itemList = AllocLevelPtrClear(sizeof(SplineItemType) * spline->numItems);	// alloc memory for item list
 
 			for (int j = 0; j < spline->numItems; j++)			// swizzle
 			{
@@ -760,7 +886,7 @@ OSErr					iErr;
 	{
 		FileFenceDefType *inData;
 
-		gFenceList = (FenceDefType *) AllocPtrClear(sizeof(FenceDefType) * gNumFences);	// alloc new ptr for fence data
+		gFenceList = (FenceDefType *) AllocLevelPtrClear(sizeof(FenceDefType) * gNumFences);	// alloc new ptr for fence data
 		if (gFenceList == nil)
 			DoFatalAlert("ReadDataFromPlayfieldFile: AllocPtr failed");
 
@@ -789,7 +915,7 @@ OSErr					iErr;
 		{
    			FencePointType *fileFencePoints = (FencePointType *)*hand;
 
-			gFenceList[i].nubList = (OGLPoint3D *) AllocPtrClear(sizeof(FenceDefType) * gFenceList[i].numNubs);	// alloc new ptr for nub array
+			gFenceList[i].nubList = (OGLPoint3D *) AllocLevelPtrClear(sizeof(FenceDefType) * gFenceList[i].numNubs);	// alloc new ptr for nub array
 			if (gFenceList[i].nubList == nil)
 				DoFatalAlert("ReadDataFromPlayfieldFile: AllocPtr failed");
 
@@ -894,27 +1020,779 @@ OSErr					iErr;
 			/* CLOSE REZ FILE */
 
 	CloseResFile(fRefNum);
+}
 
 
+#pragma mark -
 
-		/********************************************/
-		/* READ SUPERTILE IMAGE DATA FROM DATA FORK */
-		/********************************************/
+/********************** LOAD COMPILED PLAYFIELD ************************/
+//
+// Reads a .terc file in one go and points the terrain globals straight into it.
+// Returns false if the file is missing, stale or was written by an incompatible build,
+// in which case the caller falls back to the .ter resources.
+//
+
+static Boolean LoadCompiledPlayfield(FSSpec *terSpec, FSSpec *compiledSpec)
+{
+CompiledPlayfieldHeaderType	*header;
+short						fRefNum;
+uint32_t					sourceDataForkSize = 0;
+uint32_t					sourceRsrcForkSize = 0;
+uint64_t					sourceRsrcHash = 0;
+long						eof = 0;
+long						count;
+OSErr						iErr;
 
+	GAME_ASSERT_MESSAGE(!gCompiledPlayfield, "compiled playfield already loaded!");
 
 
-				/* OPEN THE DATA FORK */
+			/* GET THE SOURCE .TER'S KEY TO CATCH STALE FILES */
+
+	if (!GetPlayfieldSourceKey(terSpec, &sourceDataForkSize, &sourceRsrcForkSize, &sourceRsrcHash))
+		return false;
+
+
+			/* READ THE WHOLE COMPILED FILE */
+
+	gCompiledPlayfield = TakePrefetchedFile(compiledSpec, &gCompiledPlayfieldSize);	// the prefetch thread may have read it already
+	if (gCompiledPlayfield)
+	{
+		eof = gCompiledPlayfieldSize;
+		if (eof < (long) sizeof(CompiledPlayfieldHeaderType))
+			goto reject;
+	}
+	else
+	{
+		if (FSpOpenDF(compiledSpec, fsRdPerm, &fRefNum) != noErr)	// not an error, there just isn't one
+			return false;
+
+		GetEOF(fRefNum, &eof);
+		if (eof < (long) sizeof(CompiledPlayfieldHeaderType))
+		{
+			FSClose(fRefNum);
+			return false;
+		}
+
+		gCompiledPlayfield = AllocLevelPtr(eof);
+		gCompiledPlayfieldSize = eof;
+
+		count = eof;
+		iErr = FSRead(fRefNum, &count, gCompiledPlayfield);
+		FSClose(fRefNum);
+		if (iErr || count != eof)
+			goto reject;
+	}
+
+
+			/* VALIDATE HEADER */
+
+	header = (CompiledPlayfieldHeaderType *) gCompiledPlayfield;
+
+	if (SDL_memcmp(header->magic, COMPILED_PLAYFIELD_MAGIC, 4) != 0
+		|| header->endianTag != COMPILED_PLAYFIELD_ENDIAN_TAG
+		|| header->version != COMPILED_PLAYFIELD_VERSION
+		|| header->headerSize != sizeof(CompiledPlayfieldHeaderType)
+		|| header->sourceDataForkSize != sourceDataForkSize
+		|| header->sourceRsrcForkSize != sourceRsrcForkSize
+		|| header->sourceRsrcHash != sourceRsrcHash
+		|| header->terrainPolygonSize != gTerrainPolygonSize)
+	{
+		goto reject;
+	}
+
+	if (header->mapWidth <= 0 || header->mapHeight <= 0
+		|| (header->mapWidth % SUPERTILE_SIZE) != 0
+		|| (header->mapHeight % SUPERTILE_SIZE) != 0
+		|| header->numUniqueSuperTiles > MAX_SUPERTILE_TEXTURES
+		|| header->numLineMarkers > MAX_LINEMARKERS)
+	{
+		goto reject;
+	}
+
+	for (int i = 0; i < NUM_CPF_SECTIONS; i++)
+	{
+		const CompiledPlayfieldSectionType *section = &header->sections[i];
+
+		if ((section->offset % COMPILED_PLAYFIELD_ALIGN) != 0
+			|| section->offset > (uint32_t) eof
+			|| section->size > (uint32_t) eof - section->offset
+			|| section->elementSize != kCompiledPlayfieldElementSizes[i]
+			|| (section->size % section->elementSize) != 0)
+		{
+			goto reject;
+		}
+	}
+
+#define	NUM_CPF_ELEMENTS(s)	(header->sections[(s)].size / header->sections[(s)].elementSize)
+
+	if (NUM_CPF_ELEMENTS(CPF_SECTION_SUPERTILEGRID) != (uint32_t) ((header->mapWidth / SUPERTILE_SIZE) * (header->mapHeight / SUPERTILE_SIZE))
+		|| NUM_CPF_ELEMENTS(CPF_SECTION_YCOORDS) != (uint32_t) ((header->mapWidth + 1) * (header->mapHeight + 1))
+		|| NUM_CPF_ELEMENTS(CPF_SECTION_ITEMS) != (uint32_t) header->numItems
+		|| NUM_CPF_ELEMENTS(CPF_SECTION_SPLINES) != (uint32_t) header->numSplines
+		|| NUM_CPF_ELEMENTS(CPF_SECTION_FENCES) != (uint32_t) header->numFences
+		|| NUM_CPF_ELEMENTS(CPF_SECTION_WATER) != (uint32_t) header->numWaterPatches
+		|| NUM_CPF_ELEMENTS(CPF_SECTION_LINEMARKERS) != (uint32_t) header->numLineMarkers
+		|| NUM_CPF_ELEMENTS(CPF_SECTION_SUPERTILEIMAGES) != (uint32_t) header->numUniqueSuperTiles)
+	{
+		goto reject;
+	}
+
+
+			/* VALIDATE INDICES INTO THE SHARED LISTS */
+
+	const CompiledSplineDefType *splines = (const CompiledSplineDefType *) (gCompiledPlayfield + header->sections[CPF_SECTION_SPLINES].offset);
+	for (int i = 0; i < header->numSplines; i++)
+	{
+		if (splines[i].numPoints < 0 || splines[i].numItems < 0
+			|| splines[i].firstPoint + (uint32_t) splines[i].numPoints > NUM_CPF_ELEMENTS(CPF_SECTION_SPLINEPOINTS)
+			|| splines[i].firstItem + (uint32_t) splines[i].numItems > NUM_CPF_ELEMENTS(CPF_SECTION_SPLINEITEMS))
+		{
+			goto reject;
+		}
+	}
+
+	const CompiledFenceDefType *fences = (const CompiledFenceDefType *) (gCompiledPlayfield + header->sections[CPF_SECTION_FENCES].offset);
+	for (int i = 0; i < header->numFences; i++)
+	{
+		if (fences[i].numNubs < 0
+			|| fences[i].firstNub + (uint32_t) fences[i].numNubs > NUM_CPF_ELEMENTS(CPF_SECTION_FENCENUBS))
+		{
+			goto reject;
+		}
+	}
+
+	const CompiledSuperTileImageType *images = (const CompiledSuperTileImageType *) (gCompiledPlayfield + header->sections[CPF_SECTION_SUPERTILEIMAGES].offset);
+	for (int i = 0; i < header->numUniqueSuperTiles; i++)
+	{
+		if (images[i].offset > header->sections[CPF_SECTION_SUPERTILEJPEGS].size
+			|| images[i].size > header->sections[CPF_SECTION_SUPERTILEJPEGS].size - images[i].offset)
+		{
+			goto reject;
+		}
+	}
+
+#undef NUM_CPF_ELEMENTS
+
+
+			/* SET GLOBALS */
+
+	gNumTerrainItems		= header->numItems;
+	gTerrainTileWidth		= header->mapWidth;
+	gTerrainTileDepth		= header->mapHeight;
+	g3DTileSize				= header->tileSize;
+	g3DMinY					= header->minY;
+	g3DMaxY					= header->maxY;
+	gNumSplines				= header->numSplines;
+	gNumFences				= header->numFences;
+	gNumWaterPatches		= header->numWaterPatches;
+	gNumUniqueSuperTiles	= header->numUniqueSuperTiles;
+	gNumLineMarkers			= header->numLineMarkers;
+
+	gTerrainUnitWidth = gTerrainTileWidth*gTerrainPolygonSize;
+	gTerrainUnitDepth = gTerrainTileDepth*gTerrainPolygonSize;
+	gNumSuperTilesDeep = gTerrainTileDepth/SUPERTILE_SIZE;
+	gNumSuperTilesWide = gTerrainTileWidth/SUPERTILE_SIZE;
+
+
+			/* 2D ARRAYS: ONLY THE ROW TABLES ARE ALLOCATED */
+
+	if (gSuperTileTextureGrid)
+		Free_Playfield_2d_array(gSuperTileTextureGrid);
+
+	gSuperTileTextureGrid = (short **) AllocLevelPtr(sizeof(short *) * gNumSuperTilesDeep);
+	gSuperTileTextureGrid[0] = (short *) (gCompiledPlayfield + header->sections[CPF_SECTION_SUPERTILEGRID].offset);
+	for (int row = 1; row < gNumSuperTilesDeep; row++)
+		gSuperTileTextureGrid[row] = gSuperTileTextureGrid[row-1] + gNumSuperTilesWide;
+
+	gMapYCoords = (float **) AllocLevelPtr(sizeof(float *) * (gTerrainTileDepth+1));
+	gMapYCoordsOriginal = (float **) AllocLevelPtr(sizeof(float *) * (gTerrainTileDepth+1));
+	gMapYCoords[0] = (float *) (gCompiledPlayfield + header->sections[CPF_SECTION_YCOORDS].offset);
+	gMapYCoordsOriginal[0] = gMapYCoords[0];										// heights are never modified after load, so both can share the data
+	for (int row = 1; row <= gTerrainTileDepth; row++)
+	{
+		gMapYCoords[row] = gMapYCoords[row-1] + (gTerrainTileWidth+1);
+		gMapYCoordsOriginal[row] = gMapYCoords[row];
+	}
+
+
+			/* ITEMS */
+
+	gMasterItemList = (TerrainItemEntryType *) (gCompiledPlayfield + header->sections[CPF_SECTION_ITEMS].offset);
+
+
+			/* SPLINES */
+
+	if (gNumSplines > 0)
+	{
+		SplinePointType	*points = (SplinePointType *) (gCompiledPlayfield + header->sections[CPF_SECTION_SPLINEPOINTS].offset);
+		SplineItemType	*items = (SplineItemType *) (gCompiledPlayfield + header->sections[CPF_SECTION_SPLINEITEMS].offset);
+
+		gSplineList = AllocLevelPtrClear(sizeof(SplineDefType) * gNumSplines);
+
+		for (int i = 0; i < gNumSplines; i++)
+		{
+			gSplineList[i].numNubs		= splines[i].numNubs;
+			gSplineList[i].numPoints	= splines[i].numPoints;
+			gSplineList[i].numItems		= splines[i].numItems;
+			gSplineList[i].bBox			= splines[i].bBox;
+			gSplineList[i].pointList	= points + splines[i].firstPoint;
+			gSplineList[i].itemList		= items + splines[i].firstItem;
+		}
+	}
+	else
+		gSplineList = nil;
+
+
+			/* FENCES */
+
+	if (gNumFences > 0)
+	{
+		OGLPoint3D	*nubs = (OGLPoint3D *) (gCompiledPlayfield + header->sections[CPF_SECTION_FENCENUBS].offset);
+
+		gFenceList = (FenceDefType *) AllocLevelPtrClear(sizeof(FenceDefType) * gNumFences);
+
+		for (int i = 0; i < gNumFences; i++)
+		{
+			gFenceList[i].type		= fences[i].type;
+			gFenceList[i].numNubs	= fences[i].numNubs;
+			gFenceList[i].nubList	= nubs + fences[i].firstNub;
+			gFenceList[i].sectionVectors = nil;
+		}
+	}
+
+
+			/* WATER */
+
+	gWaterListHandle = nil;
+	gWaterList = (gNumWaterPatches > 0) ? (WaterDefType *) (gCompiledPlayfield + header->sections[CPF_SECTION_WATER].offset) : nil;
+
+
+			/* LINE MARKERS */
+
+	if (gNumLineMarkers > 0)
+		SDL_memcpy(gLineMarkerList, gCompiledPlayfield + header->sections[CPF_SECTION_LINEMARKERS].offset, header->sections[CPF_SECTION_LINEMARKERS].size);
+
+	return true;
+
+
+reject:
+	SDL_Log("%s: %s is stale or incompatible, using the .ter file instead", __func__, compiledSpec->cName);
+	DisposeCompiledPlayfield();
+	return false;
+}
+
+
+/******************** IS COMPILED PLAYFIELD MEMORY ***********************/
+//
+// True if ptr points inside the compiled playfield, i.e. it must not be freed on its own.
+//
+
+Boolean IsCompiledPlayfieldMemory(const void *ptr)
+{
+	if (!gCompiledPlayfield || !ptr)
+		return false;
+
+	return (const char *) ptr >= gCompiledPlayfield
+		&& (const char *) ptr < gCompiledPlayfield + gCompiledPlayfieldSize;
+}
+
+
+/******************** SAFE DISPOSE PLAYFIELD PTR ***********************/
+//
+// Use this for any playfield data that may be living inside the compiled playfield.
+//
+
+void SafeDisposePlayfieldPtr(void *ptr)
+{
+	if (ptr && !IsCompiledPlayfieldMemory(ptr))
+		SafeDisposePtr((Ptr) ptr);
+}
+
+
+/******************** DISPOSE COMPILED PLAYFIELD ***********************/
+//
+// Called by DisposeTerrain once nothing points into the compiled data anymore.
+//
+
+void DisposeCompiledPlayfield(void)
+{
+	if (gCompiledPlayfield)
+	{
+		SafeDisposePtr(gCompiledPlayfield);
+		gCompiledPlayfield = nil;
+	}
+	gCompiledPlayfieldSize = 0;
+}
+
+
+/******************** GET PLAYFIELD SOURCE KEY ***********************/
+//
+// What a .terc remembers about the .ter it was compiled from, so that one compiled
+// from an older version of either fork is never used.
+//
+// The data fork is just the supertile JPEGs, so its size will do; hashing it
+// would cost more reading than the .terc saves.  The resource fork has everything
+// else (items, splines, fences, water...) and is small, so that gets hashed too.
+// It's looked for as a "<name>.rsrc" file next to the data fork, the way it ships;
+// if it isn't there, it counts as empty.
+//
+
+static Boolean GetPlayfieldSourceKey(const FSSpec *terSpec, uint32_t *dataForkSize, uint32_t *rsrcForkSize, uint64_t *rsrcHash)
+{
+FSSpec	rsrcSpec;
+char	rsrcName[sizeof(rsrcSpec.cName) + 6];
+short	fRefNum;
+long	size = 0;
+
+	if (FSpOpenDF(terSpec, fsRdPerm, &fRefNum) != noErr)
+		return false;
+	GetEOF(fRefNum, &size);
+	FSClose(fRefNum);
+	*dataForkSize = (uint32_t) size;
+
+	*rsrcHash = HASH_BYTES_SEED;
+	*rsrcForkSize = 0;
+	SDL_snprintf(rsrcName, sizeof(rsrcName), ":%s.rsrc", terSpec->cName);
+	if (FSMakeFSSpec(terSpec->vRefNum, terSpec->parID, rsrcName, &rsrcSpec) == noErr)
+	{
+		size = HashFile(&rsrcSpec, rsrcHash);
+		if (size < 0)
+			return false;
+		*rsrcForkSize = (uint32_t) size;
+	}
+
+	return true;
+}
+
+
+/******************** HASH FILE ***********************/
+//
+// Feeds a file's data fork into *hash.  Returns its size, or -1 if it can't be read.
+//
+
+static long HashFile(const FSSpec *spec, uint64_t *hash)
+{
+Byte	buffer[64*1024];
+short	fRefNum;
+long	eof = 0;
+long	done = 0;
+
+	if (FSpOpenDF(spec, fsRdPerm, &fRefNum) != noErr)
+		return -1;
+
+	GetEOF(fRefNum, &eof);
+
+	while (done < eof)
+	{
+		long count = SDL_min(eof - done, (long) sizeof(buffer));
+
+		if (FSRead(fRefNum, &count, (Ptr) buffer) != noErr || count <= 0)
+		{
+			FSClose(fRefNum);
+			return -1;
+		}
+
+		*hash = HashBytes(*hash, buffer, count);
+		done += count;
+	}
+
+	FSClose(fRefNum);
+
+	return eof;
+}
 
-	iErr = FSpOpenDF(specPtr, fsRdPerm, &fRefNum);
+
+/*********************** COMPILE PLAYFIELD ***************************/
+//
+// Converts a .ter file into a .terc file that LoadPlayfield can use in place.
+// The coordinates are baked with the current terrain scale, so call SetTerrainScale first.
+//
+
+OSErr CompilePlayfield(FSSpec *terSpec, FSSpec *compiledSpec)
+{
+CompiledPlayfieldHeaderType	header;
+Ptr							*jpegs;
+int32_t						*jpegSizes;
+Ptr							blob;
+uint32_t					blobSize;
+uint32_t					sourceDataForkSize = 0;
+uint32_t					sourceRsrcForkSize = 0;
+uint64_t					sourceRsrcHash = 0;
+long						count;
+short						fRefNum;
+OSErr						iErr;
+
+	GAME_ASSERT(!gCompiledPlayfield);
+
+
+			/* PARSE THE .TER RESOURCES */
+
+	ReadDataFromPlayfieldFile(terSpec);
+
+	if (!GetPlayfieldSourceKey(terSpec, &sourceDataForkSize, &sourceRsrcForkSize, &sourceRsrcHash))
+		DoFatalAlert("CompilePlayfield: can't read %s", terSpec->cName);
+
+
+			/* READ THE SUPERTILE JPEGS */
+			//
+			// They're stored in the order the supertiles appear in the grid,
+			// so file them under their supertile id.
+			//
+
+	jpegs = (Ptr *) AllocPtrClear(sizeof(Ptr) * gNumUniqueSuperTiles);
+	jpegSizes = (int32_t *) AllocPtrClear(sizeof(int32_t) * gNumUniqueSuperTiles);
+
+	iErr = FSpOpenDF(terSpec, fsRdPerm, &fRefNum);
 	if (iErr)
-		DoFatalAlert("ReadDataFromPlayfieldFile: FSpOpenDF failed!");
+		DoFatalAlert("CompilePlayfield: FSpOpenDF failed!");
+
+	for (int row = 0; row < gNumSuperTilesDeep; row++)
+	{
+		for (int col = 0; col < gNumSuperTilesWide; col++)
+		{
+			short stId = gSuperTileTextureGrid[row][col];
+			if (stId < 0)
+				continue;
+
+			int32_t dataSize = 0;
+			count = sizeof(int32_t);
+			iErr = FSRead(fRefNum, &count, (Ptr) &dataSize);
+			GAME_ASSERT(!iErr);
+
+			jpegSizes[stId] = SwizzleLong(&dataSize);
+			jpegs[stId] = AllocPtr(jpegSizes[stId]);
+
+			count = jpegSizes[stId];
+			iErr = FSRead(fRefNum, &count, jpegs[stId]);
+			GAME_ASSERT(!iErr);
+		}
+	}
+
+	FSClose(fRefNum);
+
 
+			/* FILL HEADER */
+
+	SDL_memset(&header, 0, sizeof(header));
+	SDL_memcpy(header.magic, COMPILED_PLAYFIELD_MAGIC, 4);
+	header.endianTag			= COMPILED_PLAYFIELD_ENDIAN_TAG;
+	header.version				= COMPILED_PLAYFIELD_VERSION;
+	header.headerSize			= sizeof(CompiledPlayfieldHeaderType);
+	header.sourceDataForkSize	= sourceDataForkSize;
+	header.sourceRsrcForkSize	= sourceRsrcForkSize;
+	header.sourceRsrcHash		= sourceRsrcHash;
+	header.terrainPolygonSize	= gTerrainPolygonSize;
+	header.numItems				= gNumTerrainItems;
+	header.mapWidth				= gTerrainTileWidth;
+	header.mapHeight			= gTerrainTileDepth;
+	header.tileSize				= g3DTileSize;
+	header.minY					= g3DMinY;
+	header.maxY					= g3DMaxY;
+	header.numSplines			= gNumSplines;
+	header.numFences			= gNumFences;
+	header.numUniqueSuperTiles	= gNumUniqueSuperTiles;
+	header.numWaterPatches		= gNumWaterPatches;
+	header.numLineMarkers		= gNumLineMarkers;
+
+
+			/* CALC SECTION SIZES */
+
+	uint32_t numSplinePoints = 0;
+	uint32_t numSplineItems = 0;
+	uint32_t numFenceNubs = 0;
+	uint32_t jpegBytes = 0;
+
+	for (int i = 0; i < gNumSplines; i++)
+	{
+		numSplinePoints += gSplineList[i].numPoints;
+		numSplineItems += gSplineList[i].numItems;
+	}
+
+	for (int i = 0; i < gNumFences; i++)
+		numFenceNubs += gFenceList[i].numNubs;
+
+	for (int i = 0; i < gNumUniqueSuperTiles; i++)
+		jpegBytes += jpegSizes[i];
+
+	const uint32_t numElements[NUM_CPF_SECTIONS] =
+	{
+		[CPF_SECTION_SUPERTILEGRID]		= gNumSuperTilesDeep * gNumSuperTilesWide,
+		[CPF_SECTION_YCOORDS]			= (gTerrainTileDepth+1) * (gTerrainTileWidth+1),
+		[CPF_SECTION_ITEMS]				= gNumTerrainItems,
+		[CPF_SECTION_SPLINES]			= gNumSplines,
+		[CPF_SECTION_SPLINEPOINTS]		= numSplinePoints,
+		[CPF_SECTION_SPLINEITEMS]		= numSplineItems,
+		[CPF_SECTION_FENCES]			= gNumFences,
+		[CPF_SECTION_FENCENUBS]			= numFenceNubs,
+		[CPF_SECTION_WATER]				= gNumWaterPatches,
+		[CPF_SECTION_LINEMARKERS]		= gNumLineMarkers,
+		[CPF_SECTION_SUPERTILEIMAGES]	= gNumUniqueSuperTiles,
+		[CPF_SECTION_SUPERTILEJPEGS]	= jpegBytes,
+	};
+
+	blobSize = sizeof(CompiledPlayfieldHeaderType);
+	for (int i = 0; i < NUM_CPF_SECTIONS; i++)
+	{
+		blobSize = (blobSize + COMPILED_PLAYFIELD_ALIGN - 1) & ~(COMPILED_PLAYFIELD_ALIGN - 1);
+
+		header.sections[i].offset		= blobSize;
+		header.sections[i].elementSize	= kCompiledPlayfieldElementSizes[i];
+		header.sections[i].size			= numElements[i] * kCompiledPlayfieldElementSizes[i];
+
+		blobSize += header.sections[i].size;
+	}
+
+
+			/* FILL SECTIONS */
+
+	blob = AllocPtrClear(blobSize);
+	SDL_memcpy(blob, &header, sizeof(header));
+
+#define	CPF_SECTION_PTR(type, s)	((type *) (blob + header.sections[(s)].offset))
+
+	SDL_memcpy(CPF_SECTION_PTR(short, CPF_SECTION_SUPERTILEGRID), gSuperTileTextureGrid[0], header.sections[CPF_SECTION_SUPERTILEGRID].size);
+	SDL_memcpy(CPF_SECTION_PTR(float, CPF_SECTION_YCOORDS), gMapYCoords[0], header.sections[CPF_SECTION_YCOORDS].size);
+	if (gNumTerrainItems > 0)
+		SDL_memcpy(CPF_SECTION_PTR(TerrainItemEntryType, CPF_SECTION_ITEMS), gMasterItemList, header.sections[CPF_SECTION_ITEMS].size);
+
+	numSplinePoints = 0;
+	numSplineItems = 0;
+	for (int i = 0; i < gNumSplines; i++)
+	{
+		CompiledSplineDefType *spline = &CPF_SECTION_PTR(CompiledSplineDefType, CPF_SECTION_SPLINES)[i];
+
+		spline->numNubs		= gSplineList[i].numNubs;
+		spline->numItems	= gSplineList[i].numItems;
+		spline->numPoints	= gSplineList[i].numPoints;
+		spline->bBox		= gSplineList[i].bBox;
+		spline->firstPoint	= numSplinePoints;
+		spline->firstItem	= numSplineItems;
+
+		SDL_memcpy(CPF_SECTION_PTR(SplinePointType, CPF_SECTION_SPLINEPOINTS) + numSplinePoints, gSplineList[i].pointList, sizeof(SplinePointType) * gSplineList[i].numPoints);
+		SDL_memcpy(CPF_SECTION_PTR(SplineItemType, CPF_SECTION_SPLINEITEMS) + numSplineItems, gSplineList[i].itemList, sizeof(SplineItemType) * gSplineList[i].numItems);
+
+		numSplinePoints += gSplineList[i].numPoints;
+		numSplineItems += gSplineList[i].numItems;
+	}
+
+	numFenceNubs = 0;
+	for (int i = 0; i < gNumFences; i++)
+	{
+		CompiledFenceDefType *fence = &CPF_SECTION_PTR(CompiledFenceDefType, CPF_SECTION_FENCES)[i];
+
+		fence->type		= gFenceList[i].type;
+		fence->numNubs	= gFenceList[i].numNubs;
+		fence->firstNub	= numFenceNubs;
+
+		SDL_memcpy(CPF_SECTION_PTR(OGLPoint3D, CPF_SECTION_FENCENUBS) + numFenceNubs, gFenceList[i].nubList, sizeof(OGLPoint3D) * gFenceList[i].numNubs);
+
+		numFenceNubs += gFenceList[i].numNubs;
+	}
+
+	if (gNumWaterPatches > 0)
+		SDL_memcpy(CPF_SECTION_PTR(WaterDefType, CPF_SECTION_WATER), gWaterList, header.sections[CPF_SECTION_WATER].size);
+
+	if (gNumLineMarkers > 0)
+		SDL_memcpy(CPF_SECTION_PTR(LineMarkerDefType, CPF_SECTION_LINEMARKERS), gLineMarkerList, header.sections[CPF_SECTION_LINEMARKERS].size);
+
+	jpegBytes = 0;
+	for (int i = 0; i < gNumUniqueSuperTiles; i++)
+	{
+		CompiledSuperTileImageType *image = &CPF_SECTION_PTR(CompiledSuperTileImageType, CPF_SECTION_SUPERTILEIMAGES)[i];
+
+		GAME_ASSERT_MESSAGE(jpegs[i], "CompilePlayfield: supertile id missing from grid");
+
+		image->offset	= jpegBytes;
+		image->size		= jpegSizes[i];
+
+		SDL_memcpy(CPF_SECTION_PTR(char, CPF_SECTION_SUPERTILEJPEGS) + jpegBytes, jpegs[i], jpegSizes[i]);
+
+		jpegBytes += jpegSizes[i];
+	}
+
+#undef CPF_SECTION_PTR
+
+
+			/* WRITE IT */
+
+	FSpDelete(compiledSpec);
+	iErr = FSpCreate(compiledSpec, kGameID, 'Terc', smSystemScript);
+	if (!iErr)
+	{
+		iErr = FSpOpenDF(compiledSpec, fsRdWrPerm, &fRefNum);
+		if (!iErr)
+		{
+			count = blobSize;
+			iErr = FSWrite(fRefNum, &count, blob);
+			FSClose(fRefNum);
+		}
+	}
+
+	if (!iErr)
+		SDL_Log("Wrote %s (%u bytes)", compiledSpec->cName, blobSize);
+
+
+			/* CLEAN UP */
+			//
+			// The parsed data is ours since ReadDataFromPlayfieldFile didn't touch GL.
+			//
+
+	SafeDisposePtr(blob);
+
+	for (int i = 0; i < gNumUniqueSuperTiles; i++)
+		SafeDisposePtr(jpegs[i]);
+	SafeDisposePtr((Ptr) jpegs);
+	SafeDisposePtr((Ptr) jpegSizes);
+
+	Free_2d_array(gSuperTileTextureGrid);
+	Free_2d_array(gMapYCoords);
+	Free_2d_array(gMapYCoordsOriginal);
+
+	SafeDisposePtr((Ptr) gMasterItemList);
+	gMasterItemList = nil;
+
+	for (int i = 0; i < gNumSplines; i++)
+	{
+		SafeDisposePtr((Ptr) gSplineList[i].pointList);
+		SafeDisposePtr((Ptr) gSplineList[i].itemList);
+	}
+	SafeDisposePtr((Ptr) gSplineList);
+	gSplineList = nil;
+	gNumSplines = 0;
+
+	for (int i = 0; i < gNumFences; i++)
+		SafeDisposePtr((Ptr) gFenceList[i].nubList);
+	SafeDisposePtr((Ptr) gFenceList);
+	gFenceList = nil;
+	gNumFences = 0;
+
+	DisposeWater();
+
+	gNumUniqueSuperTiles = 0;
+	gNumTerrainItems = 0;
+	gNumLineMarkers = 0;
+
+	return iErr;
+}
+
+
+#pragma mark -
+
+/********************** LOAD SUPERTILE TEXTURES ************************/
+//
+// The JPEG images come from the compiled playfield if we have one,
+// otherwise they're read sequentially from the .ter data fork.
+//
+// With a compiled playfield, the prefetch thread decodes the JPEGs a few supertiles
+// ahead, while this thread uploads the ones before them.
+//
+
+static Ptr LoadNextSuperTilePixelBuffer(short fRefNum, short stId)
+{
+	if (gCompiledPlayfield)
+	{
+		const CompiledPlayfieldHeaderType *header = (const CompiledPlayfieldHeaderType *) gCompiledPlayfield;
+		const CompiledSuperTileImageType *images = (const CompiledSuperTileImageType *) (gCompiledPlayfield + header->sections[CPF_SECTION_SUPERTILEIMAGES].offset);
+		const char *jpegs = gCompiledPlayfield + header->sections[CPF_SECTION_SUPERTILEJPEGS].offset;
+		Ptr pixels;
+
+				/* KEEP THE PREFETCH THREAD AHEAD OF US */
+
+		while (gNumSuperTilesRequested < gNumSuperTilesInLoadOrder
+			&& gNumSuperTilesRequested < gNumSuperTilesLoaded + SUPERTILE_DECODE_AHEAD)
+		{
+			short next = gSuperTileLoadOrder[gNumSuperTilesRequested++];
+			PrefetchSuperTile(jpegs + images[next].offset, images[next].size);
+		}
+
+		gNumSuperTilesLoaded++;
+
+		pixels = TakePrefetchedSuperTile(jpegs + images[stId].offset);
+		if (pixels)
+			return pixels;
+
+		return DecodeSuperTilePixelBuffer(jpegs + images[stId].offset, images[stId].size);	// wasn't queued, or is bad (this reports it)
+	}
+
+	return LoadSuperTilePixelBuffer(fRefNum);
+}
+
+
+/********************** MAKE SUPERTILE LOAD ORDER ************************/
+
+static void MakeSuperTileLoadOrder(void)
+{
+	gNumSuperTilesInLoadOrder = 0;
+	gNumSuperTilesRequested = 0;
+	gNumSuperTilesLoaded = 0;
 
 #if !(HQ_TERRAIN)
+	gSuperTileLoadOrder = (short *) AllocPtr(sizeof(short) * gNumUniqueSuperTiles);
 
 	for (int i = 0; i < gNumUniqueSuperTiles; i++)
+		gSuperTileLoadOrder[gNumSuperTilesInLoadOrder++] = i;
+#else
+	gSuperTileLoadOrder = (short *) AllocPtr(sizeof(short) * gNumSuperTilesDeep * gNumSuperTilesWide);
+
+	for (int row = 0; row < gNumSuperTilesDeep; row++)					// same order as the 1st pass in LoadSuperTileTextures
+	{
+		for (int col = 0; col < gNumSuperTilesWide; col++)
+		{
+			short stId = gSuperTileTextureGrid[row][col];
+			if (stId >= 0)
+				gSuperTileLoadOrder[gNumSuperTilesInLoadOrder++] = stId;
+		}
+	}
+#endif
+}
+
+
+static void LoadSuperTileTextures(FSSpec *specPtr)
+{
+short		fRefNum = 0;
+OSErr		iErr;
+uint32_t	sourceForkSizes[2] = {0, 0};
+uint64_t	sourceRsrcHash = 0;
+
+				/* OPEN THE DATA FORK */
+
+	if (!gCompiledPlayfield)
 	{
-		Ptr superTilePixels = LoadSuperTilePixelBuffer(fRefNum);
+		iErr = FSpOpenDF(specPtr, fsRdPerm, &fRefNum);
+		if (iErr)
+			DoFatalAlert("LoadSuperTileTextures: FSpOpenDF failed!");
+	}
+
+
+			/* LET TEXTURES CACHE THEIR COMPRESSED VERSIONS */
+			//
+			// They're keyed on the same things a .terc is checked against, either way.
+			//
+
+	if (gCompiledPlayfield)
+	{
+		const CompiledPlayfieldHeaderType *header = (const CompiledPlayfieldHeaderType *) gCompiledPlayfield;
+
+		sourceForkSizes[0]	= header->sourceDataForkSize;
+		sourceForkSizes[1]	= header->sourceRsrcForkSize;
+		sourceRsrcHash		= header->sourceRsrcHash;
+	}
+	else
+	{
+		GetPlayfieldSourceKey(specPtr, &sourceForkSizes[0], &sourceForkSizes[1], &sourceRsrcHash);
+	}
+
+	OGL_SetTextureCacheSource(specPtr->cName, HashBytes(sourceRsrcHash, sourceForkSizes, sizeof(sourceForkSizes)));
+
+	if (gCompiledPlayfield)
+		MakeSuperTileLoadOrder();
+
+
+#if !(HQ_TERRAIN)
+
+	for (int i = 0; i < gNumUniqueSuperTiles; i++)
+	{
+		Ptr superTilePixels = LoadNextSuperTilePixelBuffer(fRefNum, i);
 		gSuperTileTextureObjects[i] = LoadSuperTileTexture(superTilePixels, SUPERTILE_TEXMAP_SIZE);
 
 		SafeDisposePtr(superTilePixels);
@@ -948,7 +1826,7 @@ OSErr					iErr;
 				short stId = gSuperTileTextureGrid[rowPass1][col];
 				if (stId >= 0)
 				{
-					gSuperTilePixelBuffers[stId] = LoadSuperTilePixelBuffer(fRefNum);
+					gSuperTilePixelBuffers[stId] = LoadNextSuperTilePixelBuffer(fRefNum, stId);
 
 					// Update loading screen here
 					DrawLoading(stId/(float)(gNumUniqueSuperTiles));
@@ -995,10 +1873,18 @@ OSErr					iErr;
 
 	DrawLoading(1.0);
 
+	OGL_SetTextureCacheSource(nil, 0);
+
+	GAME_ASSERT(gNumSuperTilesLoaded == gNumSuperTilesInLoadOrder);	// so every decode we queued has been taken
+	SafeDisposePtr(gSuperTileLoadOrder);
+	gSuperTileLoadOrder = nil;
+	gNumSuperTilesInLoadOrder = 0;
+
 
 			/* CLOSE THE FILE */
 
-	FSClose(fRefNum);
+	if (!gCompiledPlayfield)
+		FSClose(fRefNum);
 }
 
 
@@ -1006,7 +1892,6 @@ OSErr					iErr;
 
 Ptr LoadSuperTilePixelBuffer(short fRefNum)
 {
-	int texSize = SUPERTILE_TEXMAP_SIZE;
 	// if (gLowRam) texSize /= 4;
 
 				/* READ THE SIZE OF THE NEXT COMPRESSED SUPERTILE TEXTURE */
@@ -1031,11 +1916,37 @@ Ptr LoadSuperTilePixelBuffer(short fRefNum)
 
 				/* DECOMPRESS THE IMAGE */
 
-	Ptr textureBuffer = DecompressQTImage(jpegBuffer, dataSize, texSize, texSize);
+	Ptr textureBuffer = DecodeSuperTilePixelBuffer(jpegBuffer, dataSize);
 
 	SafeDisposePtr(jpegBuffer);
 	jpegBuffer = NULL;
 
+	return textureBuffer;
+}
+
+
+/********************* DECODE A SINGLE SUPERTILE TEXTURE *********************/
+//
+// Decompresses one QT image record from a .ter data fork (or a .terc file).
+//
+
+Ptr DecodeSuperTilePixelBuffer(const char* data, int dataSize)
+{
+	Ptr textureBuffer = TryDecodeSuperTilePixelBuffer(data, dataSize);
+	GAME_ASSERT_MESSAGE(textureBuffer, "Couldn't decompress supertile image");
+	return textureBuffer;
+}
+
+// Same, but returns nil instead of failing an assertion if the data is bad.
+// Safe to call off the main thread (the prefetch thread decodes supertiles ahead of LoadSuperTileTextures).
+Ptr TryDecodeSuperTilePixelBuffer(const char* data, int dataSize)
+{
+	int texSize = SUPERTILE_TEXMAP_SIZE;
+
+	Ptr textureBuffer = TryDecompressQTImage(data, dataSize, texSize, texSize);
+	if (!textureBuffer)
+		return nil;
+
 				/* FLIP IT VERTICALLY */
 				//
 				// Texture pixel rows are stored bottom-up in the .ter file.
@@ -1045,7 +1956,7 @@ Ptr LoadSuperTilePixelBuffer(short fRefNum)
 				//
 
 	int rowBytes = texSize*4;
-	Ptr topRowPixelsCopy = AllocPtrClear(rowBytes);
+	uint32_t topRowPixelsCopy[SUPERTILE_TEXMAP_SIZE];
 
 	int topRow = 0;
 	int bottomRow = texSize-1;
@@ -1062,8 +1973,6 @@ Ptr LoadSuperTilePixelBuffer(short fRefNum)
 		bottomRow--;
 	}
 
-	SafeDisposePtr(topRowPixelsCopy);
-
 	return textureBuffer;
 }
 
@@ -1453,6 +2362,104 @@ OSErr DeleteUserDataFile(const char* filename)
 	return iErr;
 }
 
+/********* MAKE SUBFOLDER IN PREFS FOLDER ********************/
+//
+// So a cache can keep its files together, e.g. "Folder:file" for LoadUserDataBlob.
+//
+
+OSErr MakeUserDataFolder(const char* folderName)
+{
+FSSpec	spec;
+long	createdDirID;
+OSErr	iErr;
+
+	InitPrefsFolder(true);
+
+	iErr = MakeFSSpecForUserDataFile(folderName, &spec);
+	if (iErr == fnfErr)
+		iErr = FSpDirCreate(&spec, smSystemScript, &createdDirID);
+	return iErr;
+}
+
+/********* LOAD VARIABLE-SIZE USER FILE IN PREFS FOLDER ***********/
+//
+// For caches whose size isn't known up front.  Returns nil if the file isn't there.
+// Use SafeDisposePtr when done.
+//
+
+Ptr LoadUserDataBlob(const char* filename, long* outLength)
+{
+FSSpec		file;
+short		refNum;
+long		eof = 0;
+long		count;
+Ptr			data;
+
+	InitPrefsFolder(false);
+
+	if (MakeFSSpecForUserDataFile(filename, &file) != noErr)
+		return nil;
+
+	if (FSpOpenDF(&file, fsRdPerm, &refNum) != noErr)
+		return nil;
+
+	GetEOF(refNum, &eof);
+	if (eof <= 0)
+	{
+		FSClose(refNum);
+		return nil;
+	}
+
+	data = AllocPtr(eof);
+	count = eof;
+	if (FSRead(refNum, &count, data) != noErr || count != eof)
+	{
+		SafeDisposePtr(data);
+		data = nil;
+	}
+
+	FSClose(refNum);
+
+	*outLength = eof;
+	return data;
+}
+
+
+/********* SAVE VARIABLE-SIZE USER FILE IN PREFS FOLDER ***********/
+
+OSErr SaveUserDataBlob(const char* filename, const void* data, long length)
+{
+FSSpec				file;
+OSErr				iErr;
+short				refNum;
+long				count;
+
+	InitPrefsFolder(true);
+
+	MakeFSSpecForUserDataFile(filename, &file);
+	FSpDelete(&file);															// delete any existing file
+	iErr = FSpCreate(&file, kGameID, 'Pref', smSystemScript);
+	if (iErr)
+		return iErr;
+
+	iErr = FSpOpenDF(&file, fsRdWrPerm, &refNum);
+	if (iErr)
+	{
+		FSpDelete(&file);
+		return iErr;
+	}
+
+	count = length;
+	iErr = FSWrite(refNum, &count, (Ptr) data);
+	FSClose(refNum);
+
+	if (iErr)																	// don't leave a truncated file behind
+		FSpDelete(&file);
+
+	return iErr;
+}
+
+
 /*********************** LOAD DATA FILE INTO MEMORY ***********************************/
 //
 // Use SafeDisposePtr when done.
@@ -1647,9 +2654,24 @@ char* CSVIterator(char** csvCursor, bool* eolOut)
 // Caller is responsible for freeing the pointer!
 Ptr DecompressQTImage(const char* data, int dataSize, int w, int h)
 {
+	Ptr pixelData = TryDecompressQTImage(data, dataSize, w, h);
+	GAME_ASSERT_MESSAGE(pixelData, "Couldn't decompress QT image");
+	return pixelData;
+}
+
+// Same, but returns nil instead of failing an assertion if the data is bad.
+// Safe to call off the main thread.
+Ptr TryDecompressQTImage(const char* data, int dataSize, int w, int h)
+{
+	if (dataSize < (int) sizeof(int32_t))
+		return nil;
+
 	// The beginning of the buffer is an ImageDescription record.
 	// The first int is an offset to the actual data.
 	int offset = SwizzleLong((int32_t*) data);
+	if (offset < 0 || offset >= dataSize)
+		return nil;
+
 	int payloadSize = dataSize - offset;
 	const uint8_t* payload = (const uint8_t*) data + offset;
 
@@ -1667,9 +2689,14 @@ Ptr DecompressQTImage(const char* data, int dataSize, int w, int h)
 
 	int actualW, actualH;
 	uint8_t* pixelData = (uint8_t*) stbi_load_from_memory(payload, payloadSize, &actualW, &actualH, NULL, 4);
-	GAME_ASSERT(pixelData);
-	GAME_ASSERT(actualW == w);
-	GAME_ASSERT(actualH == h);
+	if (!pixelData)
+		return nil;
+
+	if (actualW != w || actualH != h)
+	{
+		stbi_image_free(pixelData);
+		return nil;
+	}
 
 	return (Ptr) pixelData;
 }
@@ -52,6 +52,10 @@ static int			gLastGamepadForNeedAnyP[NUM_CONTROL_NEEDS];
 
 Boolean				gMouseMotionNow = false;
 char				gTextInput[64];
+static int			gMouseWheelDeltaX = 0;					// since the last UpdateInputStates
+static int			gMouseWheelDeltaY = 0;
+
+static const InputFrame	*gInputFrame = nil;					// if set, gameplay needs come from here instead (see SetInputFrame)
 
 #if MOUSE_SMOOTHING
 static struct MouseSmoothingState
@@ -283,11 +287,23 @@ static void UpdateControllerSpecificInputNeeds(int controllerNum)
 /**********************/
 
 void DoSDLMaintenance(void)
+{
+	PumpSDLEvents();
+	UpdateInputStates();
+}
+
+
+/*********************** PUMP SDL EVENTS ***********************/
+//
+// Handles the window, quit & device events without touching the key states,
+// so it can run every frame even when the simulation doesn't sample input
+// (see PlayLevelFixedTimestepFrame).  Wheel motion adds up until UpdateInputStates.
+//
+
+void PumpSDLEvents(void)
 {
 	gTextInput[0] = '\0';
 	gMouseMotionNow = false;
-	int mouseWheelDeltaX = 0;
-	int mouseWheelDeltaY = 0;
 
 			/**********************/
 			/* DO SDL MAINTENANCE */
@@ -326,8 +342,8 @@ void DoSDLMaintenance(void)
 
 			case SDL_EVENT_MOUSE_WHEEL:
 				gUserPrefersGamepad = false;
-				mouseWheelDeltaX += event.wheel.y;
-				mouseWheelDeltaY += event.wheel.x;
+				gMouseWheelDeltaX += event.wheel.y;
+				gMouseWheelDeltaY += event.wheel.x;
 				break;
 
 			case SDL_EVENT_GAMEPAD_ADDED:
@@ -344,7 +360,16 @@ void DoSDLMaintenance(void)
 				break;
 		}
 	}
+}
+
+
+/*********************** UPDATE INPUT STATES ***********************/
+//
+// Samples the devices & steps each key/need state machine once (DOWN becomes HELD, etc.)
+//
 
+void UpdateInputStates(void)
+{
 	// Refresh the state of each individual keyboard key
 	UpdateRawKeyboardStates();
 
@@ -353,7 +378,9 @@ void DoSDLMaintenance(void)
 	ProcessSystemKeyChords();
 
 	// Refresh the state of each mouse button
-	UpdateMouseButtonStates(mouseWheelDeltaX, mouseWheelDeltaY);
+	UpdateMouseButtonStates(gMouseWheelDeltaX, gMouseWheelDeltaY);
+	gMouseWheelDeltaX = 0;
+	gMouseWheelDeltaY = 0;
 
 	// Refresh the state of each input need
 	UpdateInputNeeds();
@@ -368,6 +395,52 @@ void DoSDLMaintenance(void)
 	}
 }
 
+#pragma mark - Input frames
+
+/*********************** CAPTURE INPUT FRAME ***********************/
+//
+// Snapshots what each player's gameplay needs are doing right now.
+// Analog values are stored as bytes, so whoever plays from the frame
+// (see SetInputFrame) sees exactly what a replay of it will see.
+//
+
+void CaptureInputFrame(InputFrame *frame)
+{
+	const InputFrame *prevFrame = gInputFrame;
+
+	gInputFrame = nil;										// read the live state
+
+	SDL_zerop(frame);
+
+	for (int p = 0; p < MAX_LOCAL_PLAYERS; p++)
+	{
+		for (int need = 0; need < NUM_REMAPPABLE_NEEDS; need++)
+		{
+			float analog = GetNeedAnalogValue(need, p);
+
+			frame->needStates[p][need] = GetNeedState(need, p);
+			frame->needAnalog[p][need] = (uint8_t) (SDL_clamp(analog, 0.0f, 1.0f) * 255.0f + .5f);
+		}
+	}
+
+	frame->mouseDelta = GetMouseDelta();
+
+	gInputFrame = prevFrame;
+}
+
+
+/*********************** SET INPUT FRAME ***********************/
+//
+// From now on, the gameplay needs and the mouse delta come from this frame
+// instead of the devices.  UI needs are always live.  Pass nil to go back to live input.
+// The frame isn't copied, so it must stay around.
+//
+
+void SetInputFrame(const InputFrame *frame)
+{
+	gInputFrame = frame;
+}
+
 #pragma mark - Keyboard states
 
 int GetKeyState(uint16_t sdlScancode)
@@ -407,6 +480,16 @@ static int GetNeedStateAnyP(int needID)
 
 int GetNeedState(int needID, int playerID)
 {
+	if (gInputFrame && needID < NUM_REMAPPABLE_NEEDS)
+	{
+		for (int i = 0; i < MAX_LOCAL_PLAYERS; i++)
+		{
+			if (playerID == i || (playerID == ANY_PLAYER && gInputFrame->needStates[i][needID]))
+				return gInputFrame->needStates[i][needID];
+		}
+		return KEYSTATE_OFF;
+	}
+
 	if (playerID == ANY_PLAYER)
 	{
 		return GetNeedStateAnyP(needID);
@@ -461,6 +544,16 @@ static float GetNeedAnalogValueAnyP(int needID)
 
 float GetNeedAnalogValue(int needID, int playerID)
 {
+	if (gInputFrame && needID < NUM_REMAPPABLE_NEEDS)
+	{
+		for (int i = 0; i < MAX_LOCAL_PLAYERS; i++)
+		{
+			if (playerID == i || (playerID == ANY_PLAYER && gInputFrame->needAnalog[i][needID]))
+				return gInputFrame->needAnalog[i][needID] * (1.0f / 255.0f);
+		}
+		return 0.0f;
+	}
+
 	if (playerID == ANY_PLAYER)
 	{
 		return GetNeedAnalogValueAnyP(needID);
@@ -1081,6 +1174,9 @@ static void MouseSmoothing_OnMouseMotion(const SDL_MouseMotionEvent* motion)
 
 OGLVector2D GetMouseDelta(void)
 {
+	if (gInputFrame)
+		return gInputFrame->mouseDelta;
+
 #if MOUSE_SMOOTHING
 	struct MouseSmoothingState* state = &gMouseSmoothing;
 
@@ -0,0 +1,225 @@
+/****************************/
+/*        JOBS.C            */
+/****************************/
+
+//
+// Per-frame work that can run next to the main thread.
+//
+// A move function kicks a job to build procedural geometry (lightning zaps,
+// laser beams), carries on with the rest of MoveObjects, and the draw function
+// waits for the job's ticket before it consumes the result.  Jobs run one at a
+// time in the order they were kicked, so a ticket is done once every ticket
+// before it is done.
+//
+// Level loading uses it too: DoItemShadowCasting kicks a job that shares the
+// item shadow bake with the main thread.
+//
+// A job only gets to write into memory that the main thread has handed over to
+// it and won't touch until it has waited for the job.  It must not call into
+// Pomme, GL, the random number generator (replays depend on its sequence),
+// the object list or the memory allocator.
+//
+
+/***************/
+/* EXTERNALS   */
+/***************/
+
+#include "game.h"
+
+
+/****************************/
+/*    PROTOTYPES            */
+/****************************/
+
+static int SDLCALL JobThread(void *unused);
+
+
+/****************************/
+/*    CONSTANTS             */
+/****************************/
+
+typedef struct
+{
+	JobProcPtr	proc;
+	void		*refCon;
+	uint32_t	ticket;
+}JobType;
+
+
+/**********************/
+/*     VARIABLES      */
+/**********************/
+
+static SDL_Thread			*gJobThread = nil;
+static SDL_Mutex			*gJobMutex = nil;
+static SDL_Condition		*gJobCondition = nil;
+static Boolean				gJobQuit = false;
+
+static JobType				gJobQueue[MAX_JOBS];
+static int					gJobQueueHead = 0;
+static int					gJobQueueCount = 0;
+
+static uint32_t				gJobNextTicket = 1;				// 0 means "nothing to wait for"
+static uint32_t				gJobDoneTicket = 0;				// every ticket up to this one is finished
+
+
+/********************** INIT JOBS **************************/
+//
+// If there's no thread support (e.g. a WebAssembly build without pthreads),
+// KickJob just runs the job on the spot.
+//
+
+void InitJobs(void)
+{
+	gJobQuit 		= false;
+	gJobQueueHead 	= 0;
+	gJobQueueCount 	= 0;
+	gJobNextTicket 	= 1;
+	gJobDoneTicket 	= 0;
+
+	gJobMutex = SDL_CreateMutex();
+	gJobCondition = SDL_CreateCondition();
+
+	if (gJobMutex && gJobCondition)
+		gJobThread = SDL_CreateThread(JobThread, "Jobs", nil);
+
+	if (!gJobThread)
+	{
+		SDL_Log("%s: no job thread (%s), effect geometry will be built on the main thread", __func__, SDL_GetError());
+		ShutdownJobs();
+	}
+}
+
+
+/********************** SHUTDOWN JOBS **************************/
+//
+// Lets the worker finish whatever is still queued, so any outstanding ticket is done afterwards.
+//
+
+void ShutdownJobs(void)
+{
+	if (gJobThread)
+	{
+		SDL_LockMutex(gJobMutex);
+		gJobQuit = true;
+		SDL_BroadcastCondition(gJobCondition);
+		SDL_UnlockMutex(gJobMutex);
+
+		SDL_WaitThread(gJobThread, nil);
+		gJobThread = nil;
+	}
+
+	if (gJobCondition)
+	{
+		SDL_DestroyCondition(gJobCondition);
+		gJobCondition = nil;
+	}
+
+	if (gJobMutex)
+	{
+		SDL_DestroyMutex(gJobMutex);
+		gJobMutex = nil;
+	}
+}
+
+
+#pragma mark -
+
+
+/*********************** KICK JOB ****************************/
+//
+// Queues proc(refCon) for the worker and returns a ticket to pass to WaitForJob.
+// If there's no worker, or the queue is full, the job is run right here and 0 is returned.
+//
+
+uint32_t KickJob(JobProcPtr proc, void *refCon)
+{
+uint32_t	ticket = 0;
+
+	if (gJobThread)
+	{
+		SDL_LockMutex(gJobMutex);
+
+		if (gJobQueueCount < MAX_JOBS)
+		{
+			JobType *job = &gJobQueue[(gJobQueueHead + gJobQueueCount) % MAX_JOBS];
+
+			job->proc 	= proc;
+			job->refCon = refCon;
+			job->ticket = ticket = gJobNextTicket++;
+			gJobQueueCount++;
+
+			SDL_BroadcastCondition(gJobCondition);
+		}
+
+		SDL_UnlockMutex(gJobMutex);
+	}
+
+	if (ticket == 0)
+		proc(refCon);
+
+	return(ticket);
+}
+
+
+/*********************** WAIT FOR JOB ****************************/
+
+void WaitForJob(uint32_t ticket)
+{
+	if (!gJobThread || ticket == 0)
+		return;
+
+	SDL_LockMutex(gJobMutex);
+
+	while (gJobDoneTicket < ticket)
+		SDL_WaitCondition(gJobCondition, gJobMutex);
+
+	SDL_UnlockMutex(gJobMutex);
+}
+
+
+#pragma mark -
+
+
+/*********************** JOB THREAD ****************************/
+
+static int SDLCALL JobThread(void *unused)
+{
+	(void) unused;
+
+	SDL_LockMutex(gJobMutex);
+
+	while (true)
+	{
+		JobType		job;
+
+		if (gJobQueueCount == 0)
+		{
+			if (gJobQuit)
+				break;
+
+			SDL_WaitCondition(gJobCondition, gJobMutex);
+			continue;
+		}
+
+		job = gJobQueue[gJobQueueHead];
+		gJobQueueHead = (gJobQueueHead + 1) % MAX_JOBS;
+		gJobQueueCount--;
+
+
+				/* RUN IT WITHOUT HOLDING THE LOCK */
+
+		SDL_UnlockMutex(gJobMutex);
+
+		job.proc(job.refCon);
+
+		SDL_LockMutex(gJobMutex);
+
+		gJobDoneTicket = job.ticket;
+		SDL_BroadcastCondition(gJobCondition);
+	}
+
+	SDL_UnlockMutex(gJobMutex);
+
+	return 0;
+}
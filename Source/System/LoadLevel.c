@@ -15,12 +15,15 @@
 /*    PROTOTYPES            */
 /****************************/
 
+static int GetLevelSpecificSpritePaths(int biome, const char** paths);
 
 
 /****************************/
 /*    CONSTANTS             */
 /****************************/
 
+#define	MAX_LEVEL_SPECIFIC_SPRITES	5
+
 
 /**********************/
 /*     VARIABLES      */
@@ -60,7 +63,93 @@ static const char*	kBiomeNames[NUM_BIOMES] =
 };
 
 
+/************************** PREFETCH LEVEL ART ***************************/
+//
+// Starts reading (and baking or decoding) the files LoadLevelArt is going to need, in the
+// order it needs them, on the prefetch thread.  Call it as early as possible -- e.g. before
+// the level intro screen -- and it's fine to call it again for the same level.
+//
+// The supertile JPEGs are decoded later, as LoadSuperTileTextures gets to them.
+//
+// Keep this in sync with LoadLevelArt.
+//
+
+void PrefetchLevelArt(short levelNum)
+{
+char		path[256];
+const char*	spritePaths[MAX_LEVEL_SPECIFIC_SPRITES];
+int			numSprites;
+
+	const int biome = kLevelBiomes[levelNum];
+
+	PrefetchFile(":Models:global.bg3d", PREFETCH_KIND_BG3D);
+	PrefetchFile(":Models:playerparts.bg3d", PREFETCH_KIND_BG3D);
+	PrefetchFile(":Models:weapons.bg3d", PREFETCH_KIND_BG3D);
+
+	SDL_snprintf(path, sizeof(path), ":Models:%s.bg3d", kBiomeNames[biome]);
+	PrefetchFile(path, PREFETCH_KIND_BG3D);
+
+	numSprites = GetLevelSpecificSpritePaths(biome, spritePaths);
+	for (int i = 0; i < numSprites; i++)
+		PrefetchImage(spritePaths[i]);
+
+	SDL_snprintf(path, sizeof(path), ":Sprites:maps:%s", kLevelNames[levelNum]);
+	PrefetchImage(path);
+
+	PrefetchFile(":Skeletons:nano.bg3d", PREFETCH_KIND_BG3D);
+	PrefetchFile(":Skeletons:raptor.bg3d", PREFETCH_KIND_BG3D);
+	PrefetchFile(":Skeletons:brach.bg3d", PREFETCH_KIND_BG3D);
+	PrefetchFile(":Skeletons:wormhole.bg3d", PREFETCH_KIND_BG3D);
+
+	if (gCmdTerrainOverridePath[0] == '\0')						// the override is never compiled
+	{
+		SDL_snprintf(path, sizeof(path), ":Terrain:%s.terc", kLevelNames[levelNum]);
+		PrefetchFile(path, PREFETCH_KIND_RAW);
+	}
+
+	if (biome == BIOME_SWAMP)
+	{
+		PrefetchFile(":Skeletons:worm.bg3d", PREFETCH_KIND_BG3D);
+		PrefetchFile(":Skeletons:ramphor.bg3d", PREFETCH_KIND_BG3D);
+	}
+}
+
+
+/********************* GET LEVEL SPECIFIC SPRITE PATHS ***********************/
+//
+// Fills paths with the SPRITE_GROUP_LEVELSPECIFIC images for this biome, returns how many.
+//
+
+static int GetLevelSpecificSpritePaths(int biome, const char** paths)
+{
+int		n = 0;
+
+	paths[n++] = ":Sprites:textures:blockenemy";
+
+	switch (biome)
+	{
+		case BIOME_FOREST:
+			paths[n++] = ":Sprites:textures:pinefence";
+			break;
+
+		case BIOME_DESERT:
+			paths[n++] = ":Sprites:textures:dustdevil";
+			break;
+
+		default:
+			break;
+	}
+
+	GAME_ASSERT_MESSAGE(n <= MAX_LEVEL_SPECIFIC_SPRITES, "too many level-specific sprites in array");
+
+	return n;
+}
+
+
 /************************** LOAD LEVEL ART ***************************/
+//
+// Whatever PrefetchLevelArt queued up gets picked up by ImportBG3D and LoadPlayfield.
+//
 
 void LoadLevelArt(void)
 {
@@ -121,29 +210,8 @@ char	path[256];
 			/* LOAD SPRITES */
 			/****************/
 
-	const char* levelSpecificSpritePaths[5] =
-	{
-		":Sprites:textures:blockenemy",
-	};
-	int numLevelSpecificSprites = 1;
-
-	switch (currentBiome)
-	{
-		case BIOME_FOREST:
-			levelSpecificSpritePaths[numLevelSpecificSprites++] = ":Sprites:textures:pinefence";
-			break;
-
-		case BIOME_DESERT:
-			levelSpecificSpritePaths[numLevelSpecificSprites++] = ":Sprites:textures:dustdevil";
-			break;
-
-		default:
-			break;
-	}
-
-	GAME_ASSERT_MESSAGE(
-			numLevelSpecificSprites <= (int) (sizeof(levelSpecificSpritePaths)/sizeof(levelSpecificSpritePaths[0])),
-			"too many level-specific sprites in array");
+	const char* levelSpecificSpritePaths[MAX_LEVEL_SPECIFIC_SPRITES];
+	int numLevelSpecificSprites = GetLevelSpecificSpritePaths(currentBiome, levelSpecificSpritePaths);
 
 	LoadSpriteGroupFromFiles(SPRITE_GROUP_LEVELSPECIFIC, numLevelSpecificSprites, levelSpecificSpritePaths);
 
@@ -177,10 +245,14 @@ char	path[256];
 			/****************/
 
 	{
+		FSSpec	compiledSpec;
+		Boolean	useCompiled = false;
+
 		Boot_UpdateTerrainOverrideSpec();  // convert path string -> FSSpec if a terrain override was set
 		if (gCmdTerrainOverrideSpec.vRefNum != 0)
 		{
-			// Use the terrain FSSpec specified via command line / WebAssembly JS interop
+			// Use the terrain FSSpec specified via command line / WebAssembly JS interop.
+			// The level editor hands us a fresh .ter, so never use a compiled copy here.
 			SDL_Log("Using terrain override spec");
 			spec = gCmdTerrainOverrideSpec;
 		}
@@ -188,8 +260,11 @@ char	path[256];
 		{
 			SDL_snprintf(path, sizeof(path), ":Terrain:%s.ter", kLevelNames[gLevelNum]);
 			FSMakeFSSpec(gDataSpec.vRefNum, gDataSpec.parID, path, &spec);
+
+			SDL_snprintf(path, sizeof(path), ":Terrain:%s.terc", kLevelNames[gLevelNum]);
+			useCompiled = (FSMakeFSSpec(gDataSpec.vRefNum, gDataSpec.parID, path, &compiledSpec) == noErr);
 		}
-		LoadPlayfield(&spec);
+		LoadPlayfield(&spec, useCompiled ? &compiledSpec : nil);
 	}
 
 
@@ -225,6 +300,8 @@ char	path[256];
 				break;
 	}
 
+	FlushPrefetchedFiles();							// drop anything we didn't end up using
+
 	UnsignedWide timeEndLoad;
 	Microseconds(&timeEndLoad);
 
@@ -233,21 +310,39 @@ char	path[256];
 
 
 
+/************************** COMPILE ALL PLAYFIELDS ***************************/
+//
+// Offline tool (--compile-playfields): writes a .terc next to every level's .ter
+// so that LoadLevelArt can skip the resource parsing.
+//
 
+void CompileAllPlayfields(void)
+{
+FSSpec	terSpec, compiledSpec;
+char	path[256];
+int		numFailed = 0;
 
+	SetTerrainScale(DEFAULT_TERRAIN_SCALE);						// coordinates get baked with the in-game scale
 
+	for (int i = 0; i < NUM_LEVELS; i++)
+	{
+		SDL_snprintf(path, sizeof(path), ":Terrain:%s.ter", kLevelNames[i]);
+		if (FSMakeFSSpec(gDataSpec.vRefNum, gDataSpec.parID, path, &terSpec) != noErr)
+		{
+			SDL_Log("%s: can't find %s", __func__, path);
+			numFailed++;
+			continue;
+		}
 
+		SDL_snprintf(path, sizeof(path), ":Terrain:%s.terc", kLevelNames[i]);
+		FSMakeFSSpec(gDataSpec.vRefNum, gDataSpec.parID, path, &compiledSpec);	// fnfErr is expected here
 
+		if (CompilePlayfield(&terSpec, &compiledSpec) != noErr)
+		{
+			SDL_Log("%s: couldn't write %s", __func__, path);
+			numFailed++;
+		}
+	}
 
-
-
-
-
-
-
-
-
-
-
-
-
+	SDL_Log("%s: %d of %d levels compiled", __func__, NUM_LEVELS - numFailed, NUM_LEVELS);
+}
@@ -29,6 +29,11 @@ static void PlayLevel(void);
 static void DrawLevelCallback(void);
 static void MoveTimeDemoOnSpline(ObjNode *theNode);
 static void ShowTimeDemoResults(int numFrames, float numSeconds, float averageFPS);
+static Boolean UseFixedTimestep(void);
+static Boolean PlayLevelFixedTimestepFrame(void);
+static void UpdateLevelTimers(float fps);
+static void CheckLevelKeys(void);
+static Boolean IsLevelOver(float fps);
 
 #ifdef __EMSCRIPTEN__
 static void PlayLevelTick(void);
@@ -147,11 +152,15 @@ void InitDefaultPrefs(void)
 
 	gGamePrefs.fullscreen				= true;
 	gGamePrefs.vsync					= true;
+	gGamePrefs.fixedTimestep			= false;					// simulate once per frame, like the original game
 
 	gGamePrefs.language				= GetBestLanguageIDFromSystemLocale();
 	gGamePrefs.cutsceneSubtitles	= !IsNativeEnglishSystem();		// enable subtitles if user's native language isn't English
 
 	gGamePrefs.lowRenderQuality		= false;
+	gGamePrefs.textureQuality[TEXTURE_GROUP_MODELS]		= TEXTURE_QUALITY_MIPMAPPED;
+	gGamePrefs.textureQuality[TEXTURE_GROUP_TERRAIN]	= TEXTURE_QUALITY_MIPMAPPED;
+	gGamePrefs.textureQuality[TEXTURE_GROUP_SPRITES]	= TEXTURE_QUALITY_ORIGINAL;	// keep the UI crisp
 	gGamePrefs.splitScreenMode		= SPLITSCREEN_MODE_VERT;
 	gGamePrefs.stereoGlassesMode	= STEREO_GLASSES_MODE_OFF;
 	gGamePrefs.anaglyphCalibrationRed = DEFAULT_ANAGLYPH_R;
@@ -201,6 +210,8 @@ static void PlayGame_Adventure(void)
 	{
 				/* DO LEVEL INTRO */
 
+		PrefetchLevelArt(gLevelNum);		// start loading the level while the intro plays
+
 		PlaySong(gLevelSongs[gLevelNum], true);
 
 		if (!gSkipLevelIntro)
@@ -313,6 +324,15 @@ OGLSetupInputType	viewDef;
 	if (gTimeDemo)					// if time demo always reset random seed
 		SetMyRandomSeed(0);
 
+	BeginInputReplayLevel();		// --record/--replay: seed the level & start the input file
+
+	OpenLevelArena();				// level-lifetime data goes here until CleanupLevel
+	MarkMemoryTags();				// for the leak report in CleanupLevel
+	OGL_MarkRenderStats();			// for the texture & frame time report in CleanupLevel
+
+
+	PrefetchLevelArt(gLevelNum);	// no-op for files already queued or kept from the level intro; otherwise overlaps with the view setup below
+
 
 
 		/*********************/
@@ -533,6 +553,10 @@ OGLSetupInputType	viewDef;
 
 
 /************************* PLAY LEVEL *******************************/
+//
+// By default, each frame moves everything once over the measured frame time, then draws.
+// With the fixed simulation rate pref, see PlayLevelFixedTimestepFrame instead.
+//
 
 #ifdef __EMSCRIPTEN__
 
@@ -541,6 +565,15 @@ static void PlayLevelTick(void)
 {
 	float fps;
 
+	if (UseFixedTimestep())
+	{
+		if (PlayLevelFixedTimestepFrame())
+			emscripten_cancel_main_loop();
+		return;
+	}
+
+	ResetSimulationClock();
+
 			/* INPUT */
 
 	DoSDLMaintenance();
@@ -570,71 +603,15 @@ static void PlayLevelTick(void)
 	CalcFramesPerSecond();
 	fps = gFramesPerSecondFrac;
 
-	gGameFrameNum++;
-	gGameLevelTimer += fps;
-	gDisableHiccupTimer = false;
-
-			/***************************/
-			/* SEE IF RESET PLAYER NOW */
-			/***************************/
-
-	for (int i = 0; i < gNumPlayers; i++)
-	{
-		if (gPlayerIsDead[i])
-		{
-			float	oldTimer = gDeathTimer[i];
-			gDeathTimer[i] -= fps;
-			if (gDeathTimer[i] <= 0.0f)
-			{
-				const float fadeOutSpeed = 4.0f;
-				if (oldTimer > 0.0f)
-				{
-					if (gNumPlayers > 1 || gPlayerInfo[i].numFreeLives > 0)
-					{
-						MakeFadeEvent(kFadeFlags_Out | (kFadeFlags_P1<<i), fadeOutSpeed);
-					}
-				}
-				else if (gDeathTimer[i] < -(1.0f / fadeOutSpeed))
-				{
-					ResetPlayerAtBestCheckpoint(i);
-				}
-			}
-		}
-	}
-
-		/*****************/
-		/* SEE IF PAUSED */
-		/*****************/
-
-	if (IsNeedDown(kNeed_UIPause, ANY_PLAYER))
-	{
-		DoPaused();
-	}
-
-			/* LEVEL CHEAT */
-
-	if ((IsKeyActive(SDL_SCANCODE_LGUI) || IsKeyActive(SDL_SCANCODE_RGUI))
-		&& IsKeyDown(SDL_SCANCODE_F10))
-	{
-		gLevelCompleted = true;
-	}
+	UpdateLevelTimers(fps);
+	CheckLevelKeys();
 
 			/*****************************/
 			/* SEE IF LEVEL IS COMPLETED */
 			/*****************************/
 
-	if (gGameOver)
-	{
+	if (IsLevelOver(fps))
 		emscripten_cancel_main_loop();
-		return;
-	}
-
-	if (gLevelCompleted)
-	{
-		gLevelCompletedCoolDownTimer -= fps;
-		if (gLevelCompletedCoolDownTimer <= 0.0f)
-			emscripten_cancel_main_loop();
-	}
 }
 
 static void PlayLevel(void)
@@ -644,6 +621,7 @@ static void PlayLevel(void)
 	DoSDLMaintenance();
 	CalcFramesPerSecond();
 	CalcFramesPerSecond();
+	ResetSimulationClock();
 
 	MakeFadeEvent(kFadeFlags_In, 1.0);
 
@@ -654,6 +632,7 @@ static void PlayLevel(void)
 	emscripten_set_main_loop(PlayLevelTick, 0, 1);
 
 	GrabMouse(false);
+	ResetSimulationClock();
 
 	// Skip the blocking fade-out on Emscripten; just snap to black
 	gGammaFadeFrac = 0;
@@ -670,6 +649,7 @@ float	fps;
 	DoSDLMaintenance();
 	CalcFramesPerSecond();
 	CalcFramesPerSecond();
+	ResetSimulationClock();
 
 	MakeFadeEvent(kFadeFlags_In, 1.0);
 
@@ -688,6 +668,16 @@ float	fps;
 
 	while(true)
 	{
+		if (UseFixedTimestep())
+		{
+			if (PlayLevelFixedTimestepFrame())
+				break;
+			continue;
+		}
+
+		ResetSimulationClock();											// in case we just switched from the fixed timestep
+
+
 				/* INPUT */
 
 		DoSDLMaintenance();
@@ -720,103 +710,26 @@ float	fps;
 		CalcFramesPerSecond();
 		fps = gFramesPerSecondFrac;
 
-		gGameFrameNum++;
-		gGameLevelTimer += fps;
-		gDisableHiccupTimer = false;									// reenable this after the 1st frame
-
-
-				/***************************/
-				/* SEE IF RESET PLAYER NOW */
-				/***************************/
-
-		for (int i = 0; i < gNumPlayers; i++)							// check all players
-		{
-			if (gPlayerIsDead[i])										// is this player dead?
-			{
-				float	oldTimer = gDeathTimer[i];
-				gDeathTimer[i] -= fps;
-				if (gDeathTimer[i] <= 0.0f)								// is it time to reincarnate player?
-				{
-					const float fadeOutSpeed = 4.0f;
-
-					if (oldTimer > 0.0f)								// if just now crossed zero then start fade
-					{
-						if (gNumPlayers > 1
-							|| gPlayerInfo[i].numFreeLives > 0)		// ...only if hasn't lost adventure mode yet (gameover will freeze-frame fadeout)
-						{
-							MakeFadeEvent(kFadeFlags_Out | (kFadeFlags_P1<<i), fadeOutSpeed);
-						}
-					}
-					else if (gDeathTimer[i] < -(1.0f / fadeOutSpeed))	// once fully faded out reset player @ checkpoint
-					{
-						ResetPlayerAtBestCheckpoint(i);
-					}
-				}
-			}
-		}
-
-
-		/*****************/
-		/* SEE IF PAUSED */
-		/*****************/
-
-		if (IsNeedDown(kNeed_UIPause, ANY_PLAYER))						// do regular pause mode
-		{
-			DoPaused();
-		}
-
-#if __APPLE__
-		if (IsCmdQDown())
-		{
-			DoReallyQuit();
-		}
-#endif
-
-#if 0
-		if (GetNewKeyState(KEY_F15))									// do screen-saver-safe paused mode
-		{
-			glFinish();
-
-			do
-			{
-				EventRecord	e;
-				WaitNextEvent(everyEvent,&e, 0, 0);
-				UpdateInput();
-			}while(!GetNewKeyState(KEY_F15));
-
-			CalcFramesPerSecond();
-		}
-#endif
-
-				/* LEVEL CHEAT */
-
-		if ((IsKeyActive(SDL_SCANCODE_LGUI) || IsKeyActive(SDL_SCANCODE_RGUI))
-			&& IsKeyDown(SDL_SCANCODE_F10))									// see if skip level
-		{
-			gLevelCompleted = true;
-//			gSkipLevelIntro = true;
-		}
-
+		UpdateLevelTimers(fps);
+		CheckLevelKeys();
 
 
 				/*****************************/
 				/* SEE IF LEVEL IS COMPLETED */
 				/*****************************/
 
-		if (gGameOver)													// if we need immediate abort, then bail now
+		if (IsLevelOver(fps))
 			break;
-
-		if (gLevelCompleted)
-		{
-			gLevelCompletedCoolDownTimer -= fps;						// game is done, but wait for cool-down timer before bailing
-			if (gLevelCompletedCoolDownTimer <= 0.0f)
-				break;
-		}
 	}
 
 	GrabMouse(false);
+	ResetSimulationClock();
 
-	if (gGammaFadeFrac > 0)												// only fade out if we haven't called MakeFadeEvent(kFadeFlags_Out) already
+	Boolean wasReplaying = IsReplayingInput();
+	EndInputReplayLevel();
+
+	if (gGammaFadeFrac > 0												// only fade out if we haven't called MakeFadeEvent(kFadeFlags_Out) already
+		&& !wasReplaying)												// (and don't add the fade to a replay's timing)
 	{
 		gGameViewInfoPtr->fadeSound = true;
 		OGL_FadeOutScene(DrawLevelCallback, DoPlayerTerrainUpdate);
@@ -844,6 +757,191 @@ float	fps;
 
 #endif // __EMSCRIPTEN__
 
+
+/******************** USE FIXED TIMESTEP *************************/
+//
+// The pause menu always runs at the frame rate, and the time demo
+// measures frames, so neither uses the fixed simulation rate.
+// Recording & replaying input always does, since input is stored per tick.
+//
+
+static Boolean UseFixedTimestep(void)
+{
+	return (gGamePrefs.fixedTimestep || IsInputReplayActive()) && !gGamePaused && !gTimeDemo;
+}
+
+
+/******************** PLAY LEVEL: FIXED TIMESTEP FRAME *************************/
+//
+// Every move routine integrates with gFramesPerSecondFrac, so holding it at one fixed tick
+// makes the simulation independent of the display: we run however many ticks the elapsed
+// time calls for (none if we're drawing faster than the simulation, several if slower),
+// then draw the objects & cameras part of the way between the last two ticks.
+//
+// Events are pumped once per frame, but the key states only step once per tick so that
+// a press shows up as "down" on exactly one tick, even if it came in on a frame with none.
+//
+// When recording or replaying input, the terrain is also updated every tick (it's what
+// adds the terrain items, so it must happen at the same ticks), and the random generator
+// is set aside while drawing.
+//
+// Returns true when the level is over.
+//
+
+static Boolean PlayLevelFixedTimestepFrame(void)
+{
+int			numTicks;
+Boolean		replayActive = IsInputReplayActive();
+uint32_t	randomState[3];
+
+	CalcFramesPerSecond();											// still does the frame rate limiting
+	numTicks = CalcSimulationTicks();								// sets gFramesPerSecondFrac to the tick length
+
+	PumpSDLEvents();												// every frame, even if no tick runs
+
+	for (int tick = 0; tick < numTicks; tick++)
+	{
+				/* INPUT IS SAMPLED ONCE PER TICK */
+
+		UpdateInputStates();
+
+		if (!UpdateInputReplay())									// replay ran out of recorded input
+			return true;
+
+		gGameViewInfoPtr->frameCount++;								// double-buffered geometry flips once per tick
+		RememberObjectTickCoords();
+		RememberCameraPlacements();
+
+		for (int i = 0; i < gNumPlayers; i++)
+			UpdatePlayerSteering(i);
+
+		MoveEverything();
+
+		UpdateLevelTimers(gFramesPerSecondFrac);
+		CheckLevelKeys();
+
+		if (IsLevelOver(gFramesPerSecondFrac))
+			return true;
+
+		if (replayActive)
+			DoPlayerTerrainUpdate();
+
+		if (gGamePaused)											// just paused: let the pause menu take over
+			break;
+	}
+
+
+			/* UPDATE TERRAIN & DRAW IN BETWEEN TICKS */
+
+	if (!replayActive)
+		DoPlayerTerrainUpdate();
+
+	if (gCmdHeadless && IsReplayingInput())
+		return false;
+
+	if (replayActive)
+		GetMyRandomState(randomState);
+
+	BeginCameraInterpolation(gRenderInterpolation);
+	OGL_DrawScene(DrawLevelCallback);
+	EndCameraInterpolation();
+
+	if (replayActive)
+		SetMyRandomState(randomState);
+
+	return false;
+}
+
+
+/******************** UPDATE LEVEL TIMERS *************************/
+
+static void UpdateLevelTimers(float fps)
+{
+	gGameFrameNum++;
+	gGameLevelTimer += fps;
+	gDisableHiccupTimer = false;									// reenable this after the 1st frame
+
+
+			/***************************/
+			/* SEE IF RESET PLAYER NOW */
+			/***************************/
+
+	for (int i = 0; i < gNumPlayers; i++)							// check all players
+	{
+		if (gPlayerIsDead[i])										// is this player dead?
+		{
+			float	oldTimer = gDeathTimer[i];
+			gDeathTimer[i] -= fps;
+			if (gDeathTimer[i] <= 0.0f)								// is it time to reincarnate player?
+			{
+				const float fadeOutSpeed = 4.0f;
+
+				if (oldTimer > 0.0f)								// if just now crossed zero then start fade
+				{
+					if (gNumPlayers > 1
+						|| gPlayerInfo[i].numFreeLives > 0)		// ...only if hasn't lost adventure mode yet (gameover will freeze-frame fadeout)
+					{
+						MakeFadeEvent(kFadeFlags_Out | (kFadeFlags_P1<<i), fadeOutSpeed);
+					}
+				}
+				else if (gDeathTimer[i] < -(1.0f / fadeOutSpeed))	// once fully faded out reset player @ checkpoint
+				{
+					ResetPlayerAtBestCheckpoint(i);
+				}
+			}
+		}
+	}
+}
+
+
+/******************** CHECK LEVEL KEYS *************************/
+
+static void CheckLevelKeys(void)
+{
+		/*****************/
+		/* SEE IF PAUSED */
+		/*****************/
+
+	if (IsNeedDown(kNeed_UIPause, ANY_PLAYER))						// do regular pause mode
+	{
+		DoPaused();
+	}
+
+#if __APPLE__
+	if (IsCmdQDown())
+	{
+		DoReallyQuit();
+	}
+#endif
+
+			/* LEVEL CHEAT */
+
+	if ((IsKeyActive(SDL_SCANCODE_LGUI) || IsKeyActive(SDL_SCANCODE_RGUI))
+		&& IsKeyDown(SDL_SCANCODE_F10))									// see if skip level
+	{
+		gLevelCompleted = true;
+//		gSkipLevelIntro = true;
+	}
+}
+
+
+/******************** IS LEVEL OVER *************************/
+
+static Boolean IsLevelOver(float fps)
+{
+	if (gGameOver)													// if we need immediate abort, then bail now
+		return true;
+
+	if (gLevelCompleted)
+	{
+		gLevelCompletedCoolDownTimer -= fps;						// game is done, but wait for cool-down timer before bailing
+		if (gLevelCompletedCoolDownTimer <= 0.0f)
+			return true;
+	}
+
+	return false;
+}
+
 /************************* SHOW TIME DEMO RESULTS *******************************/
 
 static void ShowTimeDemoResults(int numFrames, float numSeconds, float averageFPS)
@@ -910,7 +1008,6 @@ static void CleanupLevel(void)
 	FreeAllSkeletonFiles(-1);
 	DisposeTerrain();
 	DeleteAllParticleGroups();
-	DeleteAllConfettiGroups();
 	DisposeInfobar();
 	DisposeParticleSystem();
 	DisposeSpriteGroup(SPRITE_GROUP_LEVELSPECIFIC);
@@ -918,9 +1015,14 @@ static void CleanupLevel(void)
 	DisposeAllBG3DContainers();
 	DisposeContrails();
 	FreeAllZaps();
+	DisposeSunQueries();
 
 	OGL_DisposeGameView();	// do this last!
 
+	CloseLevelArena();		// everything above has let go of its level data by now
+	ReportMemoryLeaks("CleanupLevel");
+	OGL_ReportRenderStats("CleanupLevel");
+
 
 		/* SET SOME IMPORTANT GLOBALS BACK TO DEFAULTS */
 
@@ -1159,6 +1261,8 @@ unsigned long	someLong;
 	InitTerrainManager();
 	InitSkeletonManager();
 	InitSoundTools();
+	InitPrefetcher();
+	InitJobs();
 	InitTwitchSystem();
 
 
@@ -1170,6 +1274,29 @@ unsigned long	someLong;
 	SetMyRandomSeed((uint32_t) someLong);
 
 
+			/* MODEL LOADING BENCHMARK (--benchmark-models flag) */
+
+	if (gCmdBenchmarkModels)
+	{
+		BenchmarkBG3DLoading();
+		CleanQuit();
+	}
+
+
+			/* OBJECT MANAGER BENCHMARK (--benchmark-objects flag) */
+
+	if (gCmdBenchmarkObjects)
+	{
+		BenchmarkObjectManager();
+		CleanQuit();
+	}
+
+
+			/* RECORDED INPUT (--record/--replay flags) */
+
+	OpenInputReplay();								// --replay sets gCmdLevelNum
+
+
 			/* PRELOAD SPRITES FOR ENTIRE GAME */
 
 	LoadGlobalAssets();
@@ -1196,6 +1323,7 @@ unsigned long	someLong;
 		gVSMode = VS_MODE_NONE;
 		gPlayingFromSavedGame = false;
 		gSkipLevelIntro = true;
+		ApplyInputReplaySetup();
 		InitPlayerInfo_Game();
 		InitLevel();
 		PlayLevel();
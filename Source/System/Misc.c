@@ -20,8 +20,28 @@
 #define	MAX_FPS				300		// mac original was 190
 #define	DEFAULT_FPS			13
 
+#define	SIMULATION_TICK_FRAC			(1.0 / SIMULATION_TICK_RATE)
+#define	MAX_SIMULATION_TICKS_PER_FRAME	4			// below 15 fps, slow the game down rather than fall further behind
+
 #define	PTRCOOKIE_SIZE		16
 
+#define	LEVEL_ARENA_CHUNK_SIZE	(8*1024*1024)		// bigger blocks get a chunk of their own
+#define	MAX_LEVEL_ARENA_CHUNKS	64
+
+typedef struct
+{
+	Ptr		base;
+	long	size;
+	long	used;
+}LevelArenaChunkType;
+
+typedef struct
+{
+	long	liveBytes;
+	long	peakBytes;
+	int		livePtrs;
+}MemoryTagStatsType;
+
 
 /**********************/
 /*     VARIABLES      */
@@ -33,9 +53,47 @@ uint32_t 	gSeed0 = 0, gSeed1 = 0, gSeed2 = 0;
 
 float	gFramesPerSecond = DEFAULT_FPS;
 float	gFramesPerSecondFrac = 1.0f / DEFAULT_FPS;
+float	gDrawFramesPerSecond = DEFAULT_FPS;		// the real frame rate, even when the simulation runs at a fixed tick
+float	gDrawFramesPerSecondFrac = 1.0f / DEFAULT_FPS;
+
+Boolean	gFixedTimestepActive = false;			// frameCount is advanced by the simulation ticks instead of OGL_DrawScene
+float	gRenderInterpolation = 1.0f;			// how far from the previous simulation tick to the current one we're drawing
+
+static Uint64	gSimulationPrevTime = 0;
+static double	gSimulationAccumulator = 0;
 
 int		gNumPointers = 0;
 
+static SDL_SpinLock	gPtrStatsLock = 0;			// the asset prefetch thread allocates too
+
+static SDL_TLSID			gMemoryTagTLS;				// each thread has its own current tag (see SetMemoryTag)
+static MemoryTagStatsType	gMemoryTagStats[NUM_MEMORY_TAGS];
+static MemoryTagStatsType	gMemoryTagMarks[NUM_MEMORY_TAGS];	// snapshot for the leak report
+
+static const char* const	kMemoryTagNames[NUM_MEMORY_TAGS] =
+{
+	[MEMORY_TAG_MISC]		= "misc",
+	[MEMORY_TAG_TERRAIN]	= "terrain",
+	[MEMORY_TAG_MODELS]		= "models",
+	[MEMORY_TAG_SKELETONS]	= "skeletons",
+	[MEMORY_TAG_PARTICLES]	= "particles",
+	[MEMORY_TAG_SOUND]		= "sound",
+	[MEMORY_TAG_UI]			= "ui",
+	[MEMORY_TAG_VAR]		= "var",
+	[MEMORY_TAG_POOLS]		= "pools",
+};
+
+static Boolean				gLevelArenaOpen = false;
+static int					gNumLevelArenaChunks = 0;
+static int					gCurrentLevelArenaChunk = 0;
+static LevelArenaChunkType	gLevelArenaChunks[MAX_LEVEL_ARENA_CHUNKS];
+
+static long					gLevelArenaBytesUsed = 0;			// bump-allocated bytes, including dead blocks
+static long					gLevelArenaBytesPeak = 0;
+static int					gLevelArenaChunksPeak = 0;
+static int					gLevelArenaBlocksPeak = 0;
+static int					gLevelArenaNumBlocks = 0;
+
 
 /**********************/
 /*     PROTOTYPES     */
@@ -94,6 +152,8 @@ static Boolean	beenHere = false;
 
 		SavePrefs();									// save prefs before bailing
 
+		ShutdownPrefetcher();							// stop reading files in the background
+		ShutdownJobs();									// finish any effect geometry still being built
 		DeleteAllObjects();
 		DisposeTerrain();								// dispose of any memory allocated by terrain manager
 		DisposeAllBG3DContainers();						// nuke all models
@@ -206,6 +266,26 @@ void SetMyRandomSeed(uint32_t seed)
 
 }
 
+/**************** GET/SET MY RANDOM STATE *******************/
+//
+// The whole generator state, so that something which shouldn't
+// disturb the random sequence (e.g. drawing during a replay) can put it back.
+//
+
+void GetMyRandomState(uint32_t state[3])
+{
+	state[0] = gSeed0;
+	state[1] = gSeed1;
+	state[2] = gSeed2;
+}
+
+void SetMyRandomState(const uint32_t state[3])
+{
+	gSeed0 = state[0];
+	gSeed1 = state[1];
+	gSeed2 = state[2];
+}
+
 /**************** INIT MY RANDOM SEED *******************/
 
 void InitMyRandomSeed(void)
@@ -219,6 +299,39 @@ void InitMyRandomSeed(void)
 #pragma mark -
 
 
+/****************** COUNT ALLOC / COUNT FREE ********************/
+//
+// Keeps gRAMAlloced/gNumPointers and the per-tag stats in sync.
+// The tag lives in the 3rd word of the cookie.
+//
+
+static void CountAlloc(uint32_t tag, long size)
+{
+	GAME_ASSERT(tag < NUM_MEMORY_TAGS);
+
+	SDL_LockSpinlock(&gPtrStatsLock);
+	gNumPointers++;
+	gRAMAlloced += size;
+	gMemoryTagStats[tag].livePtrs++;
+	gMemoryTagStats[tag].liveBytes += size;
+	if (gMemoryTagStats[tag].liveBytes > gMemoryTagStats[tag].peakBytes)
+		gMemoryTagStats[tag].peakBytes = gMemoryTagStats[tag].liveBytes;
+	SDL_UnlockSpinlock(&gPtrStatsLock);
+}
+
+static void CountFree(uint32_t tag, long size)
+{
+	GAME_ASSERT(tag < NUM_MEMORY_TAGS);
+
+	SDL_LockSpinlock(&gPtrStatsLock);
+	gNumPointers--;
+	gRAMAlloced -= size;
+	gMemoryTagStats[tag].livePtrs--;
+	gMemoryTagStats[tag].liveBytes -= size;
+	SDL_UnlockSpinlock(&gPtrStatsLock);
+}
+
+
 /****************** ALLOC PTR ********************/
 
 void *AllocPtr(long size)
@@ -226,18 +339,36 @@ void *AllocPtr(long size)
 	GAME_ASSERT(size >= 0);
 	GAME_ASSERT(size <= 0x7FFFFFFF);
 
+	void *p = TryAllocPtr(size);
+	GAME_ASSERT(p);
+
+	return p;
+}
+
+
+/****************** TRY ALLOC PTR ********************/
+//
+// Same as AllocPtr, but returns nil instead of failing an assertion.
+// Safe to call off the main thread.
+//
+
+void *TryAllocPtr(long size)
+{
+	if (size < 0 || size > 0x7FFFFFFF - PTRCOOKIE_SIZE)
+		return nil;
+
 	size += PTRCOOKIE_SIZE;						// make room for our cookie & whatever else (also keep to 16-byte alignment!)
 	Ptr p = SDL_malloc(size);
-	GAME_ASSERT(p);
+	if (!p)
+		return nil;
 
 	uint32_t* cookiePtr = (uint32_t *)p;
 	cookiePtr[0] = 'FACE';
 	cookiePtr[1] = (uint32_t) size;
-	cookiePtr[2] = 'PTR3';
+	cookiePtr[2] = GetMemoryTag();
 	cookiePtr[3] = 'PTR4';
 
-	gNumPointers++;
-	gRAMAlloced += size;
+	CountAlloc(cookiePtr[2], size);
 
 	return p + PTRCOOKIE_SIZE;
 }
@@ -257,11 +388,10 @@ void *AllocPtrClear(long size)
 	uint32_t* cookiePtr = (uint32_t *)p;
 	cookiePtr[0] = 'FACE';
 	cookiePtr[1] = (uint32_t) size;
-	cookiePtr[2] = 'PTC3';
+	cookiePtr[2] = GetMemoryTag();
 	cookiePtr[3] = 'PTC4';
 
-	gNumPointers++;
-	gRAMAlloced += size;
+	CountAlloc(cookiePtr[2], size);
 
 	return p + PTRCOOKIE_SIZE;
 }
@@ -274,26 +404,55 @@ void* ReallocPtr(void* initialPtr, long newSize)
 	GAME_ASSERT(newSize >= 0);
 	GAME_ASSERT(newSize <= 0x7FFFFFFF);
 
+	void *p = TryReallocPtr(initialPtr, newSize);
+	GAME_ASSERT(p);
+
+	return p;
+}
+
+
+/****************** TRY REALLOC PTR ********************/
+//
+// Same as ReallocPtr, but returns nil instead of failing an assertion,
+// in which case initialPtr is left alone.  Safe to call off the main
+// thread, except on level arena blocks.
+//
+
+void* TryReallocPtr(void* initialPtr, long newSize)
+{
+	if (newSize < 0 || newSize > 0x7FFFFFFF - PTRCOOKIE_SIZE)
+		return nil;
+
 	if (initialPtr == NULL)
 	{
-		return AllocPtr(newSize);
+		return TryAllocPtr(newSize);
 	}
 
 	Ptr p = ((Ptr)initialPtr) - PTRCOOKIE_SIZE;	// back up pointer to cookie
+
+	if (((uint32_t *)p)[0] == 'LVLA')			// arena blocks can't grow in place: move it
+	{
+		long oldSize = ((uint32_t *)p)[1] - PTRCOOKIE_SIZE;
+		Ptr newPtr = AllocLevelPtr(newSize);
+		SDL_memcpy(newPtr, initialPtr, SDL_min(oldSize, newSize));
+		SafeDisposePtr(initialPtr);
+		return newPtr;
+	}
+
 	newSize += PTRCOOKIE_SIZE;					// make room for our cookie & whatever else (also keep to 16-byte alignment!)
 
 	p = SDL_realloc(p, newSize);				// reallocate it
-	GAME_ASSERT(p);
+	if (!p)
+		return nil;
 
 	uint32_t* cookiePtr = (uint32_t *)p;
 	GAME_ASSERT(cookiePtr[0] == 'FACE');		// realloc shouldn't have touched our cookie
 
-	uint32_t initialSize = cookiePtr[1];		// update heap size metric
-	gRAMAlloced += newSize - initialSize;
+	CountFree(cookiePtr[2], cookiePtr[1]);		// update heap size metric (the block keeps its tag)
+	CountAlloc(cookiePtr[2], newSize);
 
 	cookiePtr[0] = 'FACE';						// rewrite cookie
 	cookiePtr[1] = (uint32_t) newSize;
-	cookiePtr[2] = 'REA3';
 	cookiePtr[3] = 'REA4';
 
 	return p + PTRCOOKIE_SIZE;
@@ -312,14 +471,311 @@ void SafeDisposePtr(void *ptr)
 	Ptr p = ((Ptr)ptr) - PTRCOOKIE_SIZE;			// back up to pt to cookie
 
 	uint32_t* cookiePtr = (uint32_t *)p;
+
+	if (cookiePtr[0] == 'LVLA')						// level arena block: memory goes back when the arena is released
+	{
+		CountFree(cookiePtr[2], cookiePtr[1]);
+
+		cookiePtr[0] = 'LVLX';						// keep the size so CloseLevelArena can walk past it
+		return;
+	}
+
 	GAME_ASSERT(cookiePtr[0] == 'FACE');
-	gRAMAlloced -= cookiePtr[1];					// deduct ptr size from heap size
+	CountFree(cookiePtr[2], cookiePtr[1]);			// deduct ptr size from heap size
 
 	cookiePtr[0] = 'DEAD';							// zap cookie
 
 	SDL_free(p);
+}
 
-	gNumPointers--;
+
+#pragma mark -
+
+
+/****************** OPEN LEVEL ARENA ********************/
+//
+// Data that lives for exactly one level (terrain grids, items, splines, fences,
+// skeleton files, model containers) is bump-allocated out of a few big chunks
+// between OpenLevelArena and CloseLevelArena, so that CleanupLevel gives it all
+// back in one go instead of hundreds of SDL_free calls.
+//
+// Call sites opt in by using AllocLevelPtr instead of AllocPtr.  Those blocks
+// still count in gNumPointers/gRAMAlloced and may still be passed to
+// SafeDisposePtr or ReallocPtr as usual.  When the arena isn't open (menus,
+// --compile-playfields...) AllocLevelPtr is plain AllocPtr.
+//
+// Main thread only.
+//
+
+void OpenLevelArena(void)
+{
+	GAME_ASSERT(!gLevelArenaOpen);
+
+	gLevelArenaOpen			= true;
+	gCurrentLevelArenaChunk	= 0;
+	gLevelArenaBytesUsed	= 0;
+	gLevelArenaBytesPeak	= 0;
+	gLevelArenaChunksPeak	= 0;
+	gLevelArenaBlocksPeak	= 0;
+	gLevelArenaNumBlocks	= 0;
+}
+
+
+/****************** CLOSE LEVEL ARENA ********************/
+//
+// Frees everything that was allocated out of the arena and reports its high-water marks.
+// Any pointer still held into it is garbage from now on.
+//
+
+void CloseLevelArena(void)
+{
+int		numLive = 0;
+
+	if (!gLevelArenaOpen)
+		return;
+
+
+			/* DEDUCT BLOCKS THAT WERE NEVER DISPOSED FROM THE HEAP STATS */
+
+	for (int i = 0; i < gNumLevelArenaChunks; i++)
+	{
+		LevelArenaChunkType *chunk = &gLevelArenaChunks[i];
+		long offset = 0;
+
+		while (offset < chunk->used)
+		{
+			uint32_t *cookiePtr = (uint32_t *)(chunk->base + offset);
+
+			GAME_ASSERT(cookiePtr[0] == 'LVLA' || cookiePtr[0] == 'LVLX');
+
+			if (cookiePtr[0] == 'LVLA')
+			{
+				numLive++;
+				CountFree(cookiePtr[2], cookiePtr[1]);
+			}
+
+			offset += cookiePtr[1];
+		}
+
+		SDL_free(chunk->base);
+	}
+
+	SDL_Log("Level arena: peak %ld KB in %d chunk(s), %d blocks; %d block(s) were still live at release",
+			gLevelArenaBytesPeak / 1024, gLevelArenaChunksPeak, gLevelArenaBlocksPeak, numLive);
+
+	gNumLevelArenaChunks = 0;
+	gLevelArenaOpen = false;
+}
+
+
+/****************** ALLOC LEVEL PTR ********************/
+
+void *AllocLevelPtr(long size)
+{
+	GAME_ASSERT(size >= 0);
+	GAME_ASSERT(size <= 0x7FFFFFFF);
+
+	if (!gLevelArenaOpen)
+		return AllocPtr(size);
+
+	size = (size + PTRCOOKIE_SIZE + 15) & ~15L;		// cookie + keep the next block 16-byte aligned
+
+
+			/* USE THE CURRENT CHUNK IF THERE'S ROOM */
+
+	LevelArenaChunkType *chunk = nil;
+
+	if (gNumLevelArenaChunks > 0
+		&& gLevelArenaChunks[gCurrentLevelArenaChunk].size - gLevelArenaChunks[gCurrentLevelArenaChunk].used >= size)
+	{
+		chunk = &gLevelArenaChunks[gCurrentLevelArenaChunk];
+	}
+
+	if (!chunk)
+	{
+		if (gNumLevelArenaChunks >= MAX_LEVEL_ARENA_CHUNKS)		// arena is full: fall back to the heap
+			return AllocPtr(size - PTRCOOKIE_SIZE);
+
+		long chunkSize = SDL_max(size, LEVEL_ARENA_CHUNK_SIZE);
+		chunk = &gLevelArenaChunks[gNumLevelArenaChunks];
+		chunk->base = SDL_malloc(chunkSize);
+		GAME_ASSERT(chunk->base);
+		chunk->size = chunkSize;
+		chunk->used = 0;
+		gCurrentLevelArenaChunk = gNumLevelArenaChunks++;
+	}
+
+
+			/* BUMP */
+
+	Ptr p = chunk->base + chunk->used;
+	chunk->used += size;
+
+	uint32_t* cookiePtr = (uint32_t *)p;
+	cookiePtr[0] = 'LVLA';
+	cookiePtr[1] = (uint32_t) size;
+	cookiePtr[2] = GetMemoryTag();
+	cookiePtr[3] = 'ARN4';
+
+	CountAlloc(cookiePtr[2], size);
+
+
+			/* HIGH-WATER MARKS */
+
+	gLevelArenaBytesUsed += size;
+	gLevelArenaNumBlocks++;
+	gLevelArenaBytesPeak	= SDL_max(gLevelArenaBytesPeak, gLevelArenaBytesUsed);
+	gLevelArenaBlocksPeak	= SDL_max(gLevelArenaBlocksPeak, gLevelArenaNumBlocks);
+	gLevelArenaChunksPeak	= SDL_max(gLevelArenaChunksPeak, gCurrentLevelArenaChunk + 1);
+
+	return p + PTRCOOKIE_SIZE;
+}
+
+
+/****************** ALLOC LEVEL PTR CLEAR ********************/
+
+void *AllocLevelPtrClear(long size)
+{
+	void *p = AllocLevelPtr(size);
+	SDL_memset(p, 0, size);
+	return p;
+}
+
+
+#pragma mark -
+
+
+/****************** SET MEMORY TAG ********************/
+//
+// Everything this thread allocates from now on is charged to the given subsystem.
+// Returns the previous tag so the caller can put it back when it's done:
+//
+//		int prevTag = SetMemoryTag(MEMORY_TAG_TERRAIN);
+//		...
+//		SetMemoryTag(prevTag);
+//
+
+int SetMemoryTag(int tag)
+{
+	int prevTag = GetMemoryTag();
+
+	GAME_ASSERT(tag >= 0 && tag < NUM_MEMORY_TAGS);
+	SDL_SetTLS(&gMemoryTagTLS, (void *) (intptr_t) (tag + 1), nil);		// +1: a thread that never set a tag reads back nil
+
+	return prevTag;
+}
+
+
+/****************** GET MEMORY TAG ********************/
+
+int GetMemoryTag(void)
+{
+	intptr_t tag = (intptr_t) SDL_GetTLS(&gMemoryTagTLS);
+
+	return tag ? (int) (tag - 1) : MEMORY_TAG_MISC;
+}
+
+
+/****************** COUNT HANDLE MEMORY ********************/
+//
+// Handles come from the Memory Manager, not AllocPtr, so subsystems that hold
+// big ones (sound banks) report them here to have them show up in the stats.
+// Call it with allocated=true once the handle has its final size, and with
+// allocated=false right before disposing of it.
+//
+
+void CountHandleMemory(int tag, Handle h, Boolean allocated)
+{
+	if (!h)
+		return;
+
+	if (allocated)
+		CountAlloc(tag, GetHandleSize(h));
+	else
+		CountFree(tag, GetHandleSize(h));
+}
+
+
+/****************** GET MEMORY TAG STATS ********************/
+
+const char* GetMemoryTagStats(int tag, long *liveBytes, long *peakBytes, int *livePtrs)
+{
+	GAME_ASSERT(tag >= 0 && tag < NUM_MEMORY_TAGS);
+
+	SDL_LockSpinlock(&gPtrStatsLock);
+	if (liveBytes)	*liveBytes	= gMemoryTagStats[tag].liveBytes;
+	if (peakBytes)	*peakBytes	= gMemoryTagStats[tag].peakBytes;
+	if (livePtrs)	*livePtrs	= gMemoryTagStats[tag].livePtrs;
+	SDL_UnlockSpinlock(&gPtrStatsLock);
+
+	return kMemoryTagNames[tag];
+}
+
+
+/****************** REPORT MEMORY TAGS ********************/
+
+void ReportMemoryTags(void)
+{
+	SDL_Log("%-10s %10s %10s %8s", "tag", "live KB", "peak KB", "ptrs");
+
+	for (int tag = 0; tag < NUM_MEMORY_TAGS; tag++)
+	{
+		long	live, peak;
+		int		ptrs;
+		const char* name = GetMemoryTagStats(tag, &live, &peak, &ptrs);
+
+		SDL_Log("%-10s %10ld %10ld %8d", name, live / 1024, peak / 1024, ptrs);
+	}
+
+	SDL_Log("%-10s %10ld %10s %8d", "total", gRAMAlloced / 1024, "", gNumPointers);
+}
+
+
+/****************** MARK MEMORY TAGS ********************/
+//
+// Snapshots the live stats so that ReportMemoryLeaks can tell what's been left behind since.
+//
+
+void MarkMemoryTags(void)
+{
+	SDL_LockSpinlock(&gPtrStatsLock);
+	SDL_memcpy(gMemoryTagMarks, gMemoryTagStats, sizeof(gMemoryTagMarks));
+	SDL_UnlockSpinlock(&gPtrStatsLock);
+}
+
+
+/****************** REPORT MEMORY LEAKS ********************/
+//
+// Logs every tag that has more pointers alive than when MarkMemoryTags was called.
+// Pool slabs are never given back, so a level that grows a pool isn't leaking.
+//
+
+void ReportMemoryLeaks(const char* label)
+{
+MemoryTagStatsType	now[NUM_MEMORY_TAGS];
+Boolean				clean = true;
+
+	SDL_LockSpinlock(&gPtrStatsLock);
+	SDL_memcpy(now, gMemoryTagStats, sizeof(now));
+	SDL_UnlockSpinlock(&gPtrStatsLock);
+
+	for (int tag = 0; tag < NUM_MEMORY_TAGS; tag++)
+	{
+		if (tag == MEMORY_TAG_POOLS)
+			continue;
+
+		int		extraPtrs	= now[tag].livePtrs - gMemoryTagMarks[tag].livePtrs;
+		long	extraBytes	= now[tag].liveBytes - gMemoryTagMarks[tag].liveBytes;
+
+		if (extraPtrs > 0)
+		{
+			SDL_Log("%s: %d %s pointer(s) still alive (%ld KB)", label, extraPtrs, kMemoryTagNames[tag], extraBytes / 1024);
+			clean = false;
+		}
+	}
+
+	if (clean)
+		SDL_Log("%s: no leaks", label);
 }
 
 
@@ -361,6 +817,10 @@ wait:
 	{
 		fps = 40;
 	}
+	else if (IsReplayingInput())					// replays run as fast as they can
+	{
+		fps = SIMULATION_TICK_RATE;
+	}
 	else
 	{
 		deltaTime = currTime.lo - time.lo;
@@ -413,11 +873,84 @@ wait:
 		gFramesPerSecond = DEFAULT_FPS;
 	gFramesPerSecondFrac = 1.0f/gFramesPerSecond;		// calc fractional for multiplication
 
+	gDrawFramesPerSecond = gFramesPerSecond;			// CalcSimulationTicks may override the above, but not these
+	gDrawFramesPerSecondFrac = gFramesPerSecondFrac;
+
 
 	time = currTime;	// reset for next time interval
 }
 
 
+/************** CALC SIMULATION TICKS *****************/
+//
+// For the fixed-timestep mode: call once per drawn frame, after CalcFramesPerSecond
+// (which still does the frame rate limiting).  Returns how many ticks of
+// SIMULATION_TICK_RATE to run before drawing -- none if we're drawing faster than
+// the simulation, several if slower -- and sets gFramesPerSecond/gFramesPerSecondFrac
+// to the tick length so that all the move routines integrate over the same step.
+// Anything animated while drawing should use gDrawFramesPerSecondFrac instead.
+//
+// gRenderInterpolation is set to how far we are into the next tick, so that the
+// frame can be drawn between the last two simulated states.
+//
+// When replaying recorded input, the clock is ignored: exactly one tick per frame.
+//
+
+int CalcSimulationTicks(void)
+{
+Uint64	now = SDL_GetTicksNS();
+int		numTicks;
+
+	if (IsReplayingInput())
+	{
+		gFixedTimestepActive = true;
+		gRenderInterpolation = 1.0f;
+		gFramesPerSecond = SIMULATION_TICK_RATE;
+		gFramesPerSecondFrac = (float) SIMULATION_TICK_FRAC;
+		return 1;
+	}
+
+	if (!gFixedTimestepActive)
+	{
+		gFixedTimestepActive = true;
+		gSimulationPrevTime = now;
+		gSimulationAccumulator = SIMULATION_TICK_FRAC;		// run a tick right away
+	}
+
+	gSimulationAccumulator += (now - gSimulationPrevTime) * 1e-9;
+	gSimulationPrevTime = now;
+
+	numTicks = (int) (gSimulationAccumulator / SIMULATION_TICK_FRAC);
+	if (numTicks > MAX_SIMULATION_TICKS_PER_FRAME)
+	{
+		numTicks = MAX_SIMULATION_TICKS_PER_FRAME;
+		gSimulationAccumulator = numTicks * SIMULATION_TICK_FRAC;		// drop the time we can't catch up on
+	}
+
+	gSimulationAccumulator -= numTicks * SIMULATION_TICK_FRAC;
+
+	gRenderInterpolation = (float) (gSimulationAccumulator / SIMULATION_TICK_FRAC);
+
+	gFramesPerSecond = SIMULATION_TICK_RATE;
+	gFramesPerSecondFrac = (float) SIMULATION_TICK_FRAC;
+
+	return numTicks;
+}
+
+
+/************** RESET SIMULATION CLOCK *****************/
+//
+// Goes back to the variable timestep (one move per drawn frame).
+// The next CalcSimulationTicks starts a fresh clock.
+//
+
+void ResetSimulationClock(void)
+{
+	gFixedTimestepActive = false;
+	gRenderInterpolation = 1.0f;
+}
+
+
 /********************* IS POWER OF 2 ****************************/
 
 Boolean IsPowerOf2(int num)
@@ -435,6 +968,25 @@ int		i;
 	return(false);
 }
 
+
+/********************* HASH BYTES ****************************/
+//
+// FNV-1a.  Start with HASH_BYTES_SEED and feed the result back in to hash more.
+//
+
+uint64_t HashBytes(uint64_t hash, const void *data, long size)
+{
+const uint8_t	*p = (const uint8_t *) data;
+
+	for (long i = 0; i < size; i++)
+	{
+		hash ^= p[i];
+		hash *= 0x100000001b3ULL;
+	}
+
+	return hash;
+}
+
 #pragma mark-
 
 /******************* MY FLUSH EVENTS **********************/
@@ -0,0 +1,655 @@
+/****************************/
+/*      OBJECT TREE.C       */
+/****************************/
+
+//
+// A dynamic AABB tree over the pickable ObjNodes, so that line segment and sphere
+// picks only have to look at the objects near them instead of the whole object list.
+//
+// Each leaf holds a "fat" box, a bit bigger than the object, so that an object
+// that only moves a little doesn't need to be moved in the tree every frame.
+// The leaves are refitted from UpdateObjectTransforms and from MoveObjects (after
+// the skeleton's WorldBBox has been updated), and removed in DeleteObject.
+//
+// Only skeletons & display groups below SLOT_OF_DUMB are in the tree since those are
+// the only ones that the picking code tests.  CType & StatusBits aren't looked at here:
+// they can change at any time, so the picking code filters the candidates itself.
+//
+
+/***************/
+/* EXTERNALS   */
+/***************/
+
+#include "game.h"
+
+
+/****************************/
+/*    PROTOTYPES            */
+/****************************/
+
+static int AllocateTreeNode(void);
+static void FreeTreeNode(int nodeID);
+static void InsertLeaf(int leaf);
+static void RemoveLeaf(int leaf);
+static int BalanceTreeNode(int a);
+static void CalcObjNodeTreeBox(const ObjNode *theNode, OGLBoundingBox *box);
+
+
+/****************************/
+/*    CONSTANTS             */
+/****************************/
+
+#define	OBJTREE_NULL			(-1)
+#define	OBJTREE_FAT_MARGIN		60.0f					// how much to grow each leaf's box by so that it doesn't have to be moved every frame
+#define	OBJTREE_INITIAL_NODES	1024
+
+typedef struct
+{
+	OGLPoint3D	min, max;							// fat box for leaves, union of children for branches
+	ObjNode		*objNode;							// leaves only
+	int			parent;								// or next free node if this one is free
+	int			child1, child2;						// OBJTREE_NULL for leaves
+	int			height;								// 0 for leaves, -1 if free
+}ObjectTreeNodeType;
+
+
+/**********************/
+/*     VARIABLES      */
+/**********************/
+
+static ObjectTreeNodeType	*gTreeNodes = nil;
+static int					gTreeCapacity = 0;
+static int					gTreeRoot = OBJTREE_NULL;
+static int					gTreeFreeList = OBJTREE_NULL;
+
+static int					*gTreeStack = nil;		// for traversing the tree without recursion
+static int					gTreeStackCapacity = 0;
+
+
+/********************** INIT OBJECT TREE **************************/
+
+void InitObjectTree(void)
+{
+	if (!gTreeNodes)
+	{
+		gTreeCapacity = OBJTREE_INITIAL_NODES;
+		gTreeNodes = AllocPtrClear(sizeof(ObjectTreeNodeType) * gTreeCapacity);
+
+		gTreeStackCapacity = OBJTREE_INITIAL_NODES;
+		gTreeStack = AllocPtr(sizeof(int) * gTreeStackCapacity);
+	}
+
+			/* PUT ALL NODES IN THE FREE LIST */
+
+	for (int i = 0; i < gTreeCapacity; i++)
+	{
+		gTreeNodes[i].parent = (i < gTreeCapacity-1) ? i+1 : OBJTREE_NULL;
+		gTreeNodes[i].height = -1;
+		gTreeNodes[i].objNode = nil;
+	}
+
+	gTreeFreeList = 0;
+	gTreeRoot = OBJTREE_NULL;
+}
+
+
+/********************* UPDATE OBJECT TREE NODE ***************************/
+//
+// Puts the objNode in the tree, or moves it if it's gotten out of its fat box.
+// Cheap if the object hasn't gone far, so it's fine to call every frame.
+//
+
+void UpdateObjectTreeNode(ObjNode *theNode)
+{
+OGLBoundingBox	box;
+int				leaf;
+
+	if (!gTreeNodes)
+		return;
+
+			/* SEE IF IT SHOULD EVEN BE IN THE TREE */
+
+	if ((theNode->CType == INVALID_NODE_FLAG)
+		|| (theNode->Slot >= SLOT_OF_DUMB)
+		|| ((theNode->Genre != SKELETON_GENRE) && (theNode->Genre != DISPLAY_GROUP_GENRE)))
+	{
+		RemoveFromObjectTree(theNode);
+		return;
+	}
+
+	CalcObjNodeTreeBox(theNode, &box);
+
+	leaf = theNode->TreeProxy;
+
+
+			/* IF STILL INSIDE ITS FAT BOX, THEN NOTHING TO DO */
+
+	if (leaf != OBJTREE_NULL)
+	{
+		ObjectTreeNodeType *n = &gTreeNodes[leaf];
+
+		if ((box.min.x >= n->min.x) && (box.min.y >= n->min.y) && (box.min.z >= n->min.z)
+			&& (box.max.x <= n->max.x) && (box.max.y <= n->max.y) && (box.max.z <= n->max.z))
+		{
+			return;
+		}
+
+		RemoveLeaf(leaf);
+	}
+	else
+	{
+		leaf = AllocateTreeNode();
+		gTreeNodes[leaf].objNode = theNode;
+		gTreeNodes[leaf].height = 0;
+		theNode->TreeProxy = leaf;
+	}
+
+
+			/* (RE)INSERT IT WITH A FAT BOX */
+
+	gTreeNodes[leaf].min.x = box.min.x - OBJTREE_FAT_MARGIN;
+	gTreeNodes[leaf].min.y = box.min.y - OBJTREE_FAT_MARGIN;
+	gTreeNodes[leaf].min.z = box.min.z - OBJTREE_FAT_MARGIN;
+	gTreeNodes[leaf].max.x = box.max.x + OBJTREE_FAT_MARGIN;
+	gTreeNodes[leaf].max.y = box.max.y + OBJTREE_FAT_MARGIN;
+	gTreeNodes[leaf].max.z = box.max.z + OBJTREE_FAT_MARGIN;
+
+	InsertLeaf(leaf);
+}
+
+
+/********************* REMOVE FROM OBJECT TREE ***************************/
+
+void RemoveFromObjectTree(ObjNode *theNode)
+{
+int	leaf = theNode->TreeProxy;
+
+	if (leaf == OBJTREE_NULL)
+		return;
+
+	RemoveLeaf(leaf);
+	FreeTreeNode(leaf);
+	theNode->TreeProxy = OBJTREE_NULL;
+}
+
+
+/********************** CALC OBJNODE TREE BOX ****************************/
+//
+// The box has to hold everything the picking code might test the object against:
+// the bounding sphere, and for skeletons, the world-space bbox too.
+//
+
+static void CalcObjNodeTreeBox(const ObjNode *theNode, OGLBoundingBox *box)
+{
+float	r = theNode->BoundingSphereRadius;
+
+	box->min.x = theNode->Coord.x - r;
+	box->min.y = theNode->Coord.y - r;
+	box->min.z = theNode->Coord.z - r;
+	box->max.x = theNode->Coord.x + r;
+	box->max.y = theNode->Coord.y + r;
+	box->max.z = theNode->Coord.z + r;
+
+	if ((theNode->Genre == SKELETON_GENRE) && !theNode->WorldBBox.isEmpty)
+	{
+		const OGLBoundingBox *w = &theNode->WorldBBox;
+
+		box->min.x = SDL_min(box->min.x, w->min.x);
+		box->min.y = SDL_min(box->min.y, w->min.y);
+		box->min.z = SDL_min(box->min.z, w->min.z);
+		box->max.x = SDL_max(box->max.x, w->max.x);
+		box->max.y = SDL_max(box->max.y, w->max.y);
+		box->max.z = SDL_max(box->max.z, w->max.z);
+	}
+}
+
+
+#pragma mark -
+
+
+/************************ PUSH TREE STACK ****************************/
+
+static inline void PushTreeStack(int *count, int nodeID)
+{
+	if (*count >= gTreeStackCapacity)
+	{
+		gTreeStackCapacity *= 2;
+		gTreeStack = ReallocPtr(gTreeStack, sizeof(int) * gTreeStackCapacity);
+	}
+
+	gTreeStack[(*count)++] = nodeID;
+}
+
+
+/******************* QUERY OBJECT TREE: LINE SEGMENT ***********************/
+//
+// Fills results with the objNodes whose fat boxes the segment passes thru.
+// Returns how many there are -- which may be more than maxResults, in which case
+// only the first maxResults were stored.
+//
+
+int QueryObjectTree_LineSegment(const OGLLineSegment *lineSeg, ObjNode **results, int maxResults)
+{
+int			count = 0;
+int			stackCount = 0;
+float		d[3], o[3];
+
+	if (gTreeRoot == OBJTREE_NULL)
+		return(0);
+
+	o[0] = lineSeg->p1.x;
+	o[1] = lineSeg->p1.y;
+	o[2] = lineSeg->p1.z;
+	d[0] = lineSeg->p2.x - o[0];
+	d[1] = lineSeg->p2.y - o[1];
+	d[2] = lineSeg->p2.z - o[2];
+
+	PushTreeStack(&stackCount, gTreeRoot);
+
+	while (stackCount > 0)
+	{
+		const ObjectTreeNodeType	*n = &gTreeNodes[gTreeStack[--stackCount]];
+		const float					bmin[3] = {n->min.x, n->min.y, n->min.z};
+		const float					bmax[3] = {n->max.x, n->max.y, n->max.z};
+		float						t0 = 0, t1 = 1;
+		Boolean						overlap = true;
+
+				/* CLIP THE SEGMENT TO THE BOX, ONE AXIS AT A TIME */
+
+		for (int axis = 0; axis < 3 && overlap; axis++)
+		{
+			if (d[axis] == 0.0f)
+			{
+				if ((o[axis] < bmin[axis]) || (o[axis] > bmax[axis]))
+					overlap = false;
+			}
+			else
+			{
+				float	inv = 1.0f / d[axis];
+				float	ta = (bmin[axis] - o[axis]) * inv;
+				float	tb = (bmax[axis] - o[axis]) * inv;
+
+				if (ta > tb)
+				{
+					float temp = ta;
+					ta = tb;
+					tb = temp;
+				}
+
+				t0 = SDL_max(t0, ta);
+				t1 = SDL_min(t1, tb);
+				if (t0 > t1)
+					overlap = false;
+			}
+		}
+
+		if (!overlap)
+			continue;
+
+		if (n->height == 0)											// leaf
+		{
+			if (count < maxResults)
+				results[count] = n->objNode;
+			count++;
+		}
+		else
+		{
+			PushTreeStack(&stackCount, n->child1);
+			PushTreeStack(&stackCount, n->child2);
+		}
+	}
+
+	return(count);
+}
+
+
+/******************* QUERY OBJECT TREE: SPHERE ***********************/
+//
+// Same as above, but for the objNodes whose fat boxes touch the sphere.
+//
+
+int QueryObjectTree_Sphere(const OGLBoundingSphere *sphere, ObjNode **results, int maxResults)
+{
+int			count = 0;
+int			stackCount = 0;
+float		r2 = sphere->radius * sphere->radius;
+
+	if (gTreeRoot == OBJTREE_NULL)
+		return(0);
+
+	PushTreeStack(&stackCount, gTreeRoot);
+
+	while (stackCount > 0)
+	{
+		const ObjectTreeNodeType	*n = &gTreeNodes[gTreeStack[--stackCount]];
+		float						dx, dy, dz;
+
+				/* DISTANCE FROM SPHERE CENTER TO BOX */
+
+		dx = SDL_max(0.0f, SDL_max(n->min.x - sphere->origin.x, sphere->origin.x - n->max.x));
+		dy = SDL_max(0.0f, SDL_max(n->min.y - sphere->origin.y, sphere->origin.y - n->max.y));
+		dz = SDL_max(0.0f, SDL_max(n->min.z - sphere->origin.z, sphere->origin.z - n->max.z));
+
+		if ((dx*dx + dy*dy + dz*dz) > r2)
+			continue;
+
+		if (n->height == 0)											// leaf
+		{
+			if (count < maxResults)
+				results[count] = n->objNode;
+			count++;
+		}
+		else
+		{
+			PushTreeStack(&stackCount, n->child1);
+			PushTreeStack(&stackCount, n->child2);
+		}
+	}
+
+	return(count);
+}
+
+
+#pragma mark -
+
+
+/************************ ALLOCATE TREE NODE ****************************/
+
+static int AllocateTreeNode(void)
+{
+int	nodeID;
+
+			/* GROW THE POOL IF IT'S FULL */
+
+	if (gTreeFreeList == OBJTREE_NULL)
+	{
+		int	oldCapacity = gTreeCapacity;
+
+		gTreeCapacity *= 2;
+		gTreeNodes = ReallocPtr(gTreeNodes, sizeof(ObjectTreeNodeType) * gTreeCapacity);
+
+		for (int i = oldCapacity; i < gTreeCapacity; i++)
+		{
+			gTreeNodes[i].parent = (i < gTreeCapacity-1) ? i+1 : OBJTREE_NULL;
+			gTreeNodes[i].height = -1;
+			gTreeNodes[i].objNode = nil;
+		}
+		gTreeFreeList = oldCapacity;
+	}
+
+	nodeID = gTreeFreeList;
+	gTreeFreeList = gTreeNodes[nodeID].parent;
+
+	gTreeNodes[nodeID].parent = OBJTREE_NULL;
+	gTreeNodes[nodeID].child1 = OBJTREE_NULL;
+	gTreeNodes[nodeID].child2 = OBJTREE_NULL;
+	gTreeNodes[nodeID].height = 0;
+	gTreeNodes[nodeID].objNode = nil;
+
+	return(nodeID);
+}
+
+
+/************************ FREE TREE NODE ****************************/
+
+static void FreeTreeNode(int nodeID)
+{
+	gTreeNodes[nodeID].parent = gTreeFreeList;
+	gTreeNodes[nodeID].height = -1;
+	gTreeNodes[nodeID].objNode = nil;
+	gTreeFreeList = nodeID;
+}
+
+
+/************************ BOX HELPERS ****************************/
+
+static inline void CombineTreeBoxes(ObjectTreeNodeType *out, const ObjectTreeNodeType *a, const ObjectTreeNodeType *b)
+{
+	out->min.x = SDL_min(a->min.x, b->min.x);
+	out->min.y = SDL_min(a->min.y, b->min.y);
+	out->min.z = SDL_min(a->min.z, b->min.z);
+	out->max.x = SDL_max(a->max.x, b->max.x);
+	out->max.y = SDL_max(a->max.y, b->max.y);
+	out->max.z = SDL_max(a->max.z, b->max.z);
+}
+
+static inline float TreeBoxArea(const OGLPoint3D *min, const OGLPoint3D *max)		// half the surface area, which is all we need for comparisons
+{
+float	w = max->x - min->x;
+float	h = max->y - min->y;
+float	d = max->z - min->z;
+
+	return(w*h + h*d + d*w);
+}
+
+static inline float CombinedTreeBoxArea(const ObjectTreeNodeType *a, const ObjectTreeNodeType *b)
+{
+OGLPoint3D	min, max;
+
+	min.x = SDL_min(a->min.x, b->min.x);
+	min.y = SDL_min(a->min.y, b->min.y);
+	min.z = SDL_min(a->min.z, b->min.z);
+	max.x = SDL_max(a->max.x, b->max.x);
+	max.y = SDL_max(a->max.y, b->max.y);
+	max.z = SDL_max(a->max.z, b->max.z);
+
+	return(TreeBoxArea(&min, &max));
+}
+
+
+/************************ INSERT LEAF ****************************/
+//
+// Finds the cheapest sibling for the leaf by surface area, then walks back up
+// the tree fixing the boxes & heights and rebalancing as it goes.
+//
+
+static void InsertLeaf(int leaf)
+{
+int		sibling, oldParent, newParent, index;
+
+	if (gTreeRoot == OBJTREE_NULL)
+	{
+		gTreeRoot = leaf;
+		gTreeNodes[leaf].parent = OBJTREE_NULL;
+		return;
+	}
+
+			/* FIND THE BEST SIBLING */
+
+	sibling = gTreeRoot;
+	while (gTreeNodes[sibling].height > 0)
+	{
+		const ObjectTreeNodeType	*s = &gTreeNodes[sibling];
+		const ObjectTreeNodeType	*c1 = &gTreeNodes[s->child1];
+		const ObjectTreeNodeType	*c2 = &gTreeNodes[s->child2];
+		const ObjectTreeNodeType	*l = &gTreeNodes[leaf];
+		float						area = TreeBoxArea(&s->min, &s->max);
+		float						combinedArea = CombinedTreeBoxArea(s, l);
+		float						cost = 2.0f * combinedArea;						// cost of making a new parent for this node & the leaf
+		float						inheritanceCost = 2.0f * (combinedArea - area);	// minimum cost of pushing the leaf further down
+		float						cost1, cost2;
+
+		cost1 = CombinedTreeBoxArea(c1, l) + inheritanceCost;
+		if (c1->height > 0)
+			cost1 -= TreeBoxArea(&c1->min, &c1->max);
+
+		cost2 = CombinedTreeBoxArea(c2, l) + inheritanceCost;
+		if (c2->height > 0)
+			cost2 -= TreeBoxArea(&c2->min, &c2->max);
+
+		if ((cost < cost1) && (cost < cost2))
+			break;
+
+		sibling = (cost1 < cost2) ? s->child1 : s->child2;
+	}
+
+
+			/* CREATE A NEW PARENT FOR THE SIBLING & THE LEAF */
+
+	oldParent = gTreeNodes[sibling].parent;
+	newParent = AllocateTreeNode();
+
+	gTreeNodes[newParent].parent = oldParent;
+	gTreeNodes[newParent].height = gTreeNodes[sibling].height + 1;
+	gTreeNodes[newParent].child1 = sibling;
+	gTreeNodes[newParent].child2 = leaf;
+	CombineTreeBoxes(&gTreeNodes[newParent], &gTreeNodes[sibling], &gTreeNodes[leaf]);
+
+	gTreeNodes[sibling].parent = newParent;
+	gTreeNodes[leaf].parent = newParent;
+
+	if (oldParent == OBJTREE_NULL)
+		gTreeRoot = newParent;
+	else if (gTreeNodes[oldParent].child1 == sibling)
+		gTreeNodes[oldParent].child1 = newParent;
+	else
+		gTreeNodes[oldParent].child2 = newParent;
+
+
+			/* FIX UP THE ANCESTORS */
+
+	index = gTreeNodes[leaf].parent;
+	while (index != OBJTREE_NULL)
+	{
+		ObjectTreeNodeType	*n;
+
+		index = BalanceTreeNode(index);
+		n = &gTreeNodes[index];
+
+		n->height = 1 + SDL_max(gTreeNodes[n->child1].height, gTreeNodes[n->child2].height);
+		CombineTreeBoxes(n, &gTreeNodes[n->child1], &gTreeNodes[n->child2]);
+
+		index = n->parent;
+	}
+}
+
+
+/************************ REMOVE LEAF ****************************/
+//
+// Takes the leaf out of the tree (but doesn't free it).
+// Its parent is replaced by its sibling.
+//
+
+static void RemoveLeaf(int leaf)
+{
+int		parent, grandParent, sibling;
+
+	if (leaf == gTreeRoot)
+	{
+		gTreeRoot = OBJTREE_NULL;
+		return;
+	}
+
+	parent = gTreeNodes[leaf].parent;
+	grandParent = gTreeNodes[parent].parent;
+	sibling = (gTreeNodes[parent].child1 == leaf) ? gTreeNodes[parent].child2 : gTreeNodes[parent].child1;
+
+	if (grandParent == OBJTREE_NULL)
+	{
+		gTreeRoot = sibling;
+		gTreeNodes[sibling].parent = OBJTREE_NULL;
+		FreeTreeNode(parent);
+		return;
+	}
+
+	if (gTreeNodes[grandParent].child1 == parent)
+		gTreeNodes[grandParent].child1 = sibling;
+	else
+		gTreeNodes[grandParent].child2 = sibling;
+
+	gTreeNodes[sibling].parent = grandParent;
+	FreeTreeNode(parent);
+
+
+			/* FIX UP THE ANCESTORS */
+
+	int index = grandParent;
+	while (index != OBJTREE_NULL)
+	{
+		ObjectTreeNodeType	*n;
+
+		index = BalanceTreeNode(index);
+		n = &gTreeNodes[index];
+
+		n->height = 1 + SDL_max(gTreeNodes[n->child1].height, gTreeNodes[n->child2].height);
+		CombineTreeBoxes(n, &gTreeNodes[n->child1], &gTreeNodes[n->child2]);
+
+		index = n->parent;
+	}
+}
+
+
+/************************ BALANCE TREE NODE ****************************/
+//
+// If one side of node a is more than 1 level taller than the other, rotates the
+// taller child up to a's place.  Returns the index of whatever node is now where a was.
+//
+
+static int BalanceTreeNode(int iA)
+{
+ObjectTreeNodeType	*A = &gTreeNodes[iA];
+int					iB, iC, balance;
+
+	if (A->height < 2)
+		return(iA);
+
+	iB = A->child1;
+	iC = A->child2;
+	balance = gTreeNodes[iC].height - gTreeNodes[iB].height;
+
+	if ((balance > 1) || (balance < -1))
+	{
+		int					iUp = (balance > 1) ? iC : iB;				// the taller child moves up
+		int					iOther = (balance > 1) ? iB : iC;
+		ObjectTreeNodeType	*Up = &gTreeNodes[iUp];
+		int					iF = Up->child1;
+		int					iG = Up->child2;
+		ObjectTreeNodeType	*F = &gTreeNodes[iF];
+		ObjectTreeNodeType	*G = &gTreeNodes[iG];
+		int					iKeep, iGive;
+
+				/* SWAP A AND UP */
+
+		Up->child1 = iA;
+		Up->parent = A->parent;
+		A->parent = iUp;
+
+		if (Up->parent == OBJTREE_NULL)
+			gTreeRoot = iUp;
+		else if (gTreeNodes[Up->parent].child1 == iA)
+			gTreeNodes[Up->parent].child1 = iUp;
+		else
+			gTreeNodes[Up->parent].child2 = iUp;
+
+
+				/* UP KEEPS ITS TALLER CHILD, A GETS THE OTHER ONE */
+
+		if (F->height > G->height)
+		{
+			iKeep = iF;
+			iGive = iG;
+		}
+		else
+		{
+			iKeep = iG;
+			iGive = iF;
+		}
+
+		Up->child2 = iKeep;
+		if (balance > 1)
+			A->child2 = iGive;
+		else
+			A->child1 = iGive;
+		gTreeNodes[iGive].parent = iA;
+
+		CombineTreeBoxes(A, &gTreeNodes[iOther], &gTreeNodes[iGive]);
+		CombineTreeBoxes(Up, A, &gTreeNodes[iKeep]);
+
+		A->height = 1 + SDL_max(gTreeNodes[iOther].height, gTreeNodes[iGive].height);
+		Up->height = 1 + SDL_max(A->height, gTreeNodes[iKeep].height);
+
+		return(iUp);
+	}
+
+	return(iA);
+}
@@ -21,6 +21,8 @@ static void DrawCollisionBoxes(ObjNode *theNode, Boolean old);
 static void DrawBoundingBoxes(ObjNode *theNode);
 static void DrawBoundingSpheres(ObjNode *theNode);
 static void CreateDummyInitObject(void);
+static void ResetSlotBuckets(void);
+static ObjNode *FindInsertionPoint(uint16_t slot);
 
 
 /****************************/
@@ -31,6 +33,10 @@ static void CreateDummyInitObject(void);
 
 #define MAX_OBJECTS		5000
 
+#define	NUM_OBJECT_SLOTS		65536					// every value ObjNode.Slot can take
+#define	SLOT_MASK_WORDS			(NUM_OBJECT_SLOTS / 32)
+#define	SLOT_SUMMARY_WORDS		(SLOT_MASK_WORDS / 32)
+
 /**********************/
 /*     VARIABLES      */
 /**********************/
@@ -55,6 +61,29 @@ int			gNumObjectNodesPeak = 0;
 
 static  ObjNode *gClearedObj;
 
+static	short		gFreeObjectStack[MAX_OBJECTS];		// indices of unused gObjectList entries
+static	int			gNumFreeObjects = 0;
+
+			/* SLOT BUCKETS */
+			//
+			// The object list is still one list sorted by Slot, but each slot value
+			// remembers the last node it has in that list, so AttachObject can link
+			// a new node right behind it instead of walking the list from the top.
+			// The bitmasks say which slots have any nodes (one bit per slot, and one bit
+			// per 32 slots in the summary), so that the previous occupied slot is found
+			// in a few word tests when a node is the first of its slot.
+			//
+
+static	ObjNode		*gSlotTail[NUM_OBJECT_SLOTS];
+static	uint32_t	gSlotMask[SLOT_MASK_WORDS];
+static	uint32_t	gSlotSummary[SLOT_SUMMARY_WORDS];
+static	uint32_t	gAttachCounter = 0;
+
+static	ObjNode		**gDrawList = nil;			// nodes DrawObjects will consider this frame (see PrepareObjectsForDrawing)
+static	int			gDrawListLength = 0;
+static	int			gDrawListCapacity = 0;
+static	Boolean		gDrawListValid = false;
+
 //============================================================================================================
 //============================================================================================================
 //============================================================================================================
@@ -73,10 +102,13 @@ int		i;
 	for (i = 0; i < MAX_OBJECTS; i++)
 	{
 		gObjectList[i].isUsed = false;
+		gFreeObjectStack[i] = MAX_OBJECTS - 1 - i;			// hand out low indices first
 	}
+	gNumFreeObjects = MAX_OBJECTS;
 
 
 	CreateDummyInitObject();
+	InitObjectTree();
 
 
 
@@ -88,6 +120,7 @@ int		i;
 					/* CLEAR ENTIRE OBJECT LIST */
 
 	gFirstNodePtr = nil;									// no node yet
+	ResetSlotBuckets();
 
 	gNumObjectNodes = 0;
 }
@@ -110,9 +143,11 @@ int   i;
 		gClearedObj->Sparkles[i] = -1;
 
 	gClearedObj->LocalBBox.isEmpty =
-	gClearedObj->WorldBBox.isEmpty = true;
+	gClearedObj->WorldBBox.isEmpty =
+	gClearedObj->CullBBox.isEmpty = true;
 
 	gClearedObj->BoundingSphereRadius = 100;
+	gClearedObj->TreeProxy = -1;							// not in the object tree yet
 
 	gClearedObj->VertexArrayMode = VERTEX_ARRAY_RANGE_TYPE_BG3DMODELS;		// assume this object's vertex data is in the cached/static mode
 
@@ -159,13 +194,11 @@ uint32_t flags = newObjDef->flags;
 			// the game from just crashing.
 			//
 
-	for (i = 0; i < MAX_OBJECTS; i++)
+	if (gNumFreeObjects > 0)
 	{
-		if (!gObjectList[i].isUsed)
-		{
-			newNodePtr = &gObjectList[i];					// point to object from list
-			goto got_it;
-		}
+		i = gFreeObjectStack[--gNumFreeObjects];
+		newNodePtr = &gObjectList[i];						// point to object from list
+		goto got_it;
 	}
 
 			/* NOTHING AVAILBLE IN LIST, SO MALLOC A NEW ONE */
@@ -203,6 +236,7 @@ got_it:
 
 	newNodePtr->Genre = newObjDef->genre;
 	newNodePtr->Coord = newNodePtr->InitCoord = newNodePtr->OldCoord = newObjDef->coord;		// save coords
+	newNodePtr->TickCoord = newNodePtr->Coord;
 
 	newNodePtr->GridX = (int)newNodePtr->Coord.x / GRID_SIZE;			// set initial grid position
 	newNodePtr->GridY = (int)newNodePtr->Coord.y / GRID_SIZE;
@@ -359,13 +393,13 @@ short	i;
 	{
 		if (theNode->WorldMeshes[i].points)
 		{
-			SafeDisposePtr(theNode->WorldMeshes[i].points);
+			MO_FreeVertexArrayPtr(theNode->WorldMeshes[i].points);
 			theNode->WorldMeshes[i].points = nil;
 		}
 
 		if (theNode->WorldPlaneEQs[i])
 		{
-			SafeDisposePtr(theNode->WorldPlaneEQs[i]);
+			MO_FreeVertexArrayPtr(theNode->WorldPlaneEQs[i]);
 			theNode->WorldPlaneEQs[i] = nil;
 		}
 	}
@@ -500,9 +534,13 @@ ObjNode		*thisNodePtr;
 				/* UPDATE SKELETON'S MESH */
 
 		if (thisNodePtr->CType != INVALID_NODE_FLAG)
+		{
 			if (thisNodePtr->Skeleton)
 				UpdateSkinnedGeometry(thisNodePtr);
 
+			UpdateObjectTreeNode(thisNodePtr);				// catch anything that moved without UpdateObjectTransforms
+		}
+
 next:
 		thisNodePtr = gNextNode;							// next node
 	}
@@ -517,6 +555,84 @@ next:
 
 
 
+/************************ REMEMBER OBJECT TICK COORDS ****************************/
+//
+// Called at the start of each fixed simulation tick.  DrawObjects then draws
+// objects part of the way between these coords and wherever the tick moved them.
+//
+
+void RememberObjectTickCoords(void)
+{
+	for (ObjNode *theNode = gFirstNodePtr; theNode != nil; theNode = theNode->NextNode)
+		theNode->TickCoord = theNode->Coord;
+}
+
+
+/************************ GET OBJECT DRAW OFFSET ****************************/
+//
+// How far from its coord DrawObjects draws an object this frame, in between
+// fixed simulation ticks.  Custom drawers that put geometry in world space
+// use this to stay with their (interpolated) owner.
+//
+// Returns false if the object is drawn right at its coord.
+//
+
+Boolean GetObjectDrawOffset(const ObjNode *theNode, OGLVector3D *offset)
+{
+float	back;
+
+	if (theNode == nil || gRenderInterpolation >= 1.0f)
+		return(false);
+
+	back = 1.0f - gRenderInterpolation;
+
+	offset->x = (theNode->TickCoord.x - theNode->Coord.x) * back;
+	offset->y = (theNode->TickCoord.y - theNode->Coord.y) * back;
+	offset->z = (theNode->TickCoord.z - theNode->Coord.z) * back;
+
+	return(offset->x != 0.0f || offset->y != 0.0f || offset->z != 0.0f);
+}
+
+
+
+/************************ PREPARE OBJECTS FOR DRAWING ****************************/
+//
+// The pane-independent half of DrawObjects.  OGL_DrawScene calls this once per frame,
+// before it loops through the split-screen panes & stereo passes, so that each pass
+// only has to do the view-dependent work (frustum test, camera aiming, drawing).
+//
+// Skinning was already done by MoveObjects, and particle geometry by MoveParticleGroups.
+// Here we gather the nodes that can be drawn at all and give each one its world-space cull box.
+//
+
+void PrepareObjectsForDrawing(void)
+{
+	if (gDrawListCapacity < gNumObjectNodes)
+	{
+		gDrawListCapacity = gNumObjectNodes + 256;
+		gDrawList = ReallocPtr(gDrawList, sizeof(ObjNode *) * gDrawListCapacity);
+	}
+
+	gDrawListLength = 0;
+
+	for (ObjNode *theNode = gFirstNodePtr; theNode != nil; theNode = theNode->NextNode)
+	{
+		if (theNode->StatusBits & STATUS_BIT_HIDDEN)					// hidden nodes don't even get cull-tested
+			continue;
+
+		if (theNode->CType == INVALID_NODE_FLAG)						// see if already deleted
+			continue;
+
+		GAME_ASSERT(gDrawListLength < gDrawListCapacity);
+
+		CalcObjectCullBounds(theNode);
+		gDrawList[gDrawListLength++] = theNode;
+	}
+
+	gDrawListValid = true;
+}
+
+
 /**************************** DRAW OBJECTS ***************************/
 
 void DrawObjects(void)
@@ -536,11 +652,17 @@ Byte			playerNum = gCurrentSplitScreenPane;			// get the player # who's draw con
 		return;
 
 
-				/* FIRST DO OUR CULLING */
+			/* FINISH SHADOWS QUEUED AFTER MOVEOBJECTS (I.E. BY SPLINE ITEMS) */
 
-	CullTestAllObjects();
+	FlushPendingShadowUpdates();
 
-	theNode = gFirstNodePtr;
+	if (!gDrawListValid)										// not done yet this frame, or nodes got recycled since
+		PrepareObjectsForDrawing();
+
+
+				/* FIRST DO OUR CULLING */
+
+	CullTestAllObjects(gDrawList, gDrawListLength);
 
 
 			/* GET CAMERA COORDS */
@@ -554,8 +676,10 @@ Byte			playerNum = gCurrentSplitScreenPane;			// get the player # who's draw con
 			/***********************/
 			/* MAIN NODE TASK LOOP */
 			/***********************/
-	do
+
+	for (int drawIndex = 0; drawIndex < gDrawListLength; drawIndex++)
 	{
+		theNode = gDrawList[drawIndex];
 		statusBits = theNode->StatusBits;						// get obj's status bits
 
 		if (statusBits & ((STATUS_BIT_ISCULLED1 << gCurrentSplitScreenPane) | STATUS_BIT_HIDDEN))	// see if is culled or hidden
@@ -835,6 +959,28 @@ Byte			playerNum = gCurrentSplitScreenPane;			// get the player # who's draw con
  		else
  			glEnable(GL_NORMALIZE);
 
+
+			/******************************************/
+			/* DRAW IN BETWEEN FIXED SIMULATION TICKS */
+			/******************************************/
+			//
+			// Only the position is interpolated, and only for 3D geometry
+			// (including custom drawers such as the player's).  Sprites and text
+			// aren't in the node's space, and custom-genre drawers that follow
+			// an owner apply its offset themselves (see GetObjectDrawOffset).
+			//
+
+		Boolean		interpolated = false;
+		OGLVector3D	drawOffset;
+
+		if ((theNode->Genre == SKELETON_GENRE || theNode->Genre == DISPLAY_GROUP_GENRE || theNode->Genre == QUADMESH_GENRE)
+			&& GetObjectDrawOffset(theNode, &drawOffset))
+		{
+			glPushMatrix();
+			glTranslatef(drawOffset.x, drawOffset.y, drawOffset.z);
+			interpolated = true;
+		}
+
 		if (theNode->CustomDrawFunction)							// if has custom draw function, then override and use that
 			goto custom_draw;
 
@@ -909,6 +1055,10 @@ custom_draw:
 		}
 
 
+		if (interpolated)
+			glPopMatrix();
+
+
 				/***************************/
 				/* SEE IF END UV TRANSFORM */
 				/***************************/
@@ -924,9 +1074,8 @@ custom_draw:
 
 			/* NEXT NODE */
 next:
-
-		theNode = (ObjNode *)theNode->NextNode;
-	}while (theNode != nil);
+		;
+	}
 
 
 				/*****************************/
@@ -1403,13 +1552,13 @@ int		i;
 	{
 		if (theNode->WorldMeshes[i].points)
 		{
-			SafeDisposePtr(theNode->WorldMeshes[i].points);
+			MO_FreeVertexArrayPtr(theNode->WorldMeshes[i].points);
 			theNode->WorldMeshes[i].points = nil;
 		}
 
 		if (theNode->WorldPlaneEQs[i])
 		{
-			SafeDisposePtr(theNode->WorldPlaneEQs[i]);
+			MO_FreeVertexArrayPtr(theNode->WorldPlaneEQs[i]);
 			theNode->WorldPlaneEQs[i] = nil;
 		}
 
@@ -1421,6 +1570,7 @@ int		i;
 			/* REMOVE NODE FROM LINKED LIST */
 
 	DetachObject(theNode, false);
+	RemoveFromObjectTree(theNode);
 
 
 			/* SEE IF MARK AS NOT-IN-USE IN ITEM LIST */
@@ -1467,6 +1617,23 @@ void DetachObject(ObjNode *theNode, Boolean subrecurse)
 	if (theNode == gNextNode)						// if its the next node to be moved, then fix things
 		gNextNode = theNode->NextNode;
 
+	if (gSlotTail[theNode->Slot] == theNode)		// if it's the last of its slot, the one before it takes over
+	{
+		uint16_t	slot = theNode->Slot;
+
+		if (theNode->PrevNode && theNode->PrevNode->Slot == slot)
+		{
+			gSlotTail[slot] = theNode->PrevNode;
+		}
+		else										// slot is empty now
+		{
+			gSlotTail[slot] = nil;
+			gSlotMask[slot >> 5] &= ~(1u << (slot & 31));
+			if (gSlotMask[slot >> 5] == 0)
+				gSlotSummary[slot >> 10] &= ~(1u << ((slot >> 5) & 31));
+		}
+	}
+
 	if (theNode->PrevNode == nil)					// special case 1st node
 	{
 		gFirstNodePtr = theNode->NextNode;
@@ -1488,6 +1655,7 @@ void DetachObject(ObjNode *theNode, Boolean subrecurse)
 	theNode->NextNode = nil;
 
 	theNode->StatusBits |= STATUS_BIT_DETACHED;
+	gDrawListValid = false;
 
 			/* SUBRECURSE CHAINS & SHADOW */
 
@@ -1503,10 +1671,15 @@ void DetachObject(ObjNode *theNode, Boolean subrecurse)
 
 
 /****************** ATTACH OBJECT ***************************/
+//
+// Links the node in after the last node of its slot (or of the closest
+// slot before it), so nodes of equal slot stay in the order they were attached.
+//
 
 void AttachObject(ObjNode *theNode, Boolean recurse)
 {
-short	slot;
+uint16_t	slot;
+ObjNode		*prevNode;
 
 	if (theNode == nil)
 		return;
@@ -1515,51 +1688,37 @@ short	slot;
 		return;
 
 	slot = theNode->Slot;
+	gDrawListValid = false;
 
-	if (gFirstNodePtr == nil)						// special case only entry
-	{
-		gFirstNodePtr = theNode;
-		theNode->PrevNode = nil;
-		theNode->NextNode = nil;
-	}
+	prevNode = FindInsertionPoint(slot);
 
 			/* INSERT AS FIRST NODE */
-	else
-	if (slot < gFirstNodePtr->Slot)
+
+	if (prevNode == nil)
 	{
 		theNode->PrevNode = nil;					// no prev
 		theNode->NextNode = gFirstNodePtr; 			// next pts to old 1st
-		gFirstNodePtr->PrevNode = theNode; 			// old pts to new 1st
+		if (gFirstNodePtr)
+			gFirstNodePtr->PrevNode = theNode; 		// old pts to new 1st
 		gFirstNodePtr = theNode;
 	}
-		/* SCAN FOR INSERTION PLACE */
+
+			/* INSERT AFTER PREV NODE */
 	else
 	{
-		ObjNode	 *reNodePtr, *scanNodePtr;
-
-		reNodePtr = gFirstNodePtr;
-		scanNodePtr = gFirstNodePtr->NextNode;		// start scanning for insertion slot on 2nd node
-
-		while (scanNodePtr != nil)
-		{
-			if (slot < scanNodePtr->Slot)					// INSERT IN MIDDLE HERE
-			{
-				theNode->NextNode = scanNodePtr;
-				theNode->PrevNode = reNodePtr;
-				reNodePtr->NextNode = theNode;
-				scanNodePtr->PrevNode = theNode;
-				goto out;
-			}
-			reNodePtr = scanNodePtr;
-			scanNodePtr = scanNodePtr->NextNode;			// try next node
-		}
-
-		theNode->NextNode = nil;							// TAG TO END
-		theNode->PrevNode = reNodePtr;
-		reNodePtr->NextNode = theNode;
+		theNode->PrevNode = prevNode;
+		theNode->NextNode = prevNode->NextNode;
+		if (prevNode->NextNode)
+			prevNode->NextNode->PrevNode = theNode;
+		prevNode->NextNode = theNode;
 	}
-out:
 
+			/* IT'S THE NEW TAIL OF ITS SLOT */
+
+	gSlotTail[slot] = theNode;
+	theNode->AttachOrder = ++gAttachCounter;
+	gSlotMask[slot >> 5] |= 1u << (slot & 31);
+	gSlotSummary[slot >> 10] |= 1u << ((slot >> 5) & 31);
 
 	theNode->StatusBits &= ~STATUS_BIT_DETACHED;
 
@@ -1579,12 +1738,68 @@ out:
 }
 
 
+/****************** RESET SLOT BUCKETS ***************************/
+
+static void ResetSlotBuckets(void)
+{
+	SDL_zeroa(gSlotTail);
+	SDL_zeroa(gSlotMask);
+	SDL_zeroa(gSlotSummary);
+}
+
+
+/****************** FIND INSERTION POINT ***************************/
+//
+// Returns the node a new node of this slot goes after, or nil if it goes first.
+// That's the tail of its own slot, or else the tail of the highest occupied slot below it.
+//
+
+static ObjNode *FindInsertionPoint(uint16_t slot)
+{
+int			word, bit, summaryWord;
+uint32_t	bits;
+
+	if (gSlotTail[slot])
+		return gSlotTail[slot];
+
+			/* LOOK FOR A LOWER SLOT IN THE SAME WORD */
+
+	word = slot >> 5;
+	bit = slot & 31;
+	bits = gSlotMask[word] & ((1u << bit) - 1);
+
+	if (!bits)
+	{
+			/* LOOK FOR A LOWER WORD IN THE SAME SUMMARY WORD */
+
+		summaryWord = word >> 5;
+		bits = gSlotSummary[summaryWord] & ((1u << (word & 31)) - 1);
+
+			/* LOOK THRU THE LOWER SUMMARY WORDS */
+
+		while (!bits)
+		{
+			if (--summaryWord < 0)
+				return nil;											// nothing before this slot
+			bits = gSlotSummary[summaryWord];
+		}
+
+		word = (summaryWord << 5) + SDL_MostSignificantBitIndex32(bits);
+		bits = gSlotMask[word];
+	}
+
+	return gSlotTail[(word << 5) + SDL_MostSignificantBitIndex32(bits)];
+}
+
+
 /***************** FLUSH OBJECT DELETE QUEUE ****************/
 
 static void FlushObjectDeleteQueue(void)
 {
 long	i,num;
 
+	FlushPendingShadowUpdates();									// finish any queued shadows before their nodes can be recycled
+
 	num = gNumObjsInDeleteQueue;
 
 	gNumObjectNodes -= num;
@@ -1595,10 +1810,15 @@ long	i,num;
 		if (gObjectDeleteQueue[i]->objectNum == -1)					// see if dispose by freeing memory...
 			SafeDisposePtr((Ptr)gObjectDeleteQueue[i]);
 		else
+		{
 			gObjectDeleteQueue[i]->isUsed = false;					//.. or just return to gObjectList array
+			gFreeObjectStack[gNumFreeObjects++] = gObjectDeleteQueue[i]->objectNum;
+		}
 	}
 
 	gNumObjsInDeleteQueue = 0;
+
+	gDrawListValid = false;											// the draw list may point to recycled nodes now
 }
 
 
@@ -1755,6 +1975,7 @@ uint32_t			bits;
 
 	SetObjectTransformMatrix(theNode);
 
+	UpdateObjectTreeNode(theNode);					// keep it in the right spot for picking
 
 
 }
@@ -1922,3 +2143,80 @@ void SendNodeToOverlayPane(ObjNode* theNode)
 	theNode->StatusBits |= STATUS_BIT_ONLYSHOWTHISPLAYER;
 	theNode->PlayerNum = GetOverlayPaneNumber();
 }
+
+
+#pragma mark - Benchmark
+
+/********************** BENCHMARK OBJECT MANAGER *****************************/
+//
+// --benchmark-objects: fills the object list with OBJECT_BENCHMARK_LIVE nodes spread
+// over the slots the game really uses, then times spawning and deleting nodes on top
+// of that.  For comparison, it also times the list walk AttachObject used to do to
+// find each node's place.
+//
+
+#define	OBJECT_BENCHMARK_LIVE		5000
+#define	OBJECT_BENCHMARK_BATCH		100
+#define	OBJECT_BENCHMARK_ROUNDS		200
+
+void BenchmarkObjectManager(void)
+{
+static const uint16_t kSlots[] =
+{
+	TERRAIN_SLOT, FENCE_SLOT, PLAYER_SLOT, ENEMY_SLOT, WATER_SLOT, SLOT_OF_DUMB, SLOT_OF_DUMB+1,
+	SLOT_OF_DUMB+3, CONTRAIL_SLOT, CONFETTI_SLOT, PARTICLE_SLOT, SPRITE_SLOT, INFOBAR_SLOT, FADEPANE_SLOT,
+};
+const int numSlots = sizeof(kSlots) / sizeof(kSlots[0]);
+ObjNode	*batch[OBJECT_BENCHMARK_BATCH];
+Uint64	spawnNS = 0, deleteNS = 0, walkNS = 0;
+long	walked = 0;
+
+	NewObjectDefinitionType def =
+	{
+		.genre		= EVENT_GENRE,
+		.scale		= 1,
+	};
+
+	DeleteAllObjects();
+
+			/* FILL THE LIST */
+
+	for (int i = 0; i < OBJECT_BENCHMARK_LIVE - OBJECT_BENCHMARK_BATCH; i++)
+	{
+		def.slot = kSlots[RandomRange(0, numSlots-1)];
+		MakeNewObject(&def);
+	}
+
+			/* SPAWN & DELETE BATCHES ON TOP OF IT */
+
+	for (int round = 0; round < OBJECT_BENCHMARK_ROUNDS; round++)
+	{
+		def.slot = kSlots[round % numSlots];
+
+		Uint64 start = SDL_GetTicksNS();
+		for (int i = 0; i < OBJECT_BENCHMARK_BATCH; i++)
+			batch[i] = MakeNewObject(&def);
+		spawnNS += SDL_GetTicksNS() - start;
+
+		start = SDL_GetTicksNS();									// what the old insertion scan would've cost
+		for (int i = 0; i < OBJECT_BENCHMARK_BATCH; i++)
+		{
+			for (ObjNode *node = gFirstNodePtr; node && node->Slot <= def.slot; node = node->NextNode)
+				walked++;
+		}
+		walkNS += SDL_GetTicksNS() - start;
+
+		start = SDL_GetTicksNS();
+		for (int i = OBJECT_BENCHMARK_BATCH-1; i >= 0; i--)
+			DeleteObject(batch[i]);
+		FlushObjectDeleteQueue();
+		deleteNS += SDL_GetTicksNS() - start;
+	}
+
+	const double n = OBJECT_BENCHMARK_ROUNDS * OBJECT_BENCHMARK_BATCH;
+
+	SDL_Log("%d live nodes:  spawn %.3f us   delete %.3f us   old insertion walk %.3f us (%ld nodes)",
+			OBJECT_BENCHMARK_LIVE, spawnNS / n / 1000.0, deleteNS / n / 1000.0, walkNS / n / 1000.0, walked);
+
+	DeleteAllObjects();
+}
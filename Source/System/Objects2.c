@@ -17,6 +17,13 @@
 /****************************/
 
 static void DrawShadow(ObjNode *theNode);
+static void DrawSingleShadow(ObjNode *theNode);
+static void MakeShadowDrawer(void);
+static void DrawShadowBatch(ObjNode *theNode);
+static void DisposeShadowDrawer(ObjNode *theNode);
+
+static void GetFrustumPlanes(const OGLMatrix4x4 *worldToFrustum, float planes[6][4]);
+static Boolean IsBoxOutsideFrustum(const float planes[6][4], float cx, float cy, float cz, float ex, float ey, float ez);
 
 static void MO_CalcWorldPoints_Object(ObjNode *theNode, const MetaObjectPtr object);
 static void MO_CalcWorldPoints_Group(ObjNode *theNode, const MOGroupObject *object);
@@ -29,6 +36,22 @@ static void MO_CalcWorldPoints_VertexArray(ObjNode *theNode, MOVertexArrayData *
 
 #define	SHADOW_Y_OFF	2.1f
 
+#define	MAX_PENDING_SHADOWS	1000
+
+typedef struct
+{
+	ObjNode		*shadowNode;
+	float		ownerBottom;
+}PendingShadowType;
+
+#define	SHADOW_UPDATE_DIST		3.0f						// owner must move this much before its shadow looks for blockers again
+
+#define	SHADOW_QUAD_SIZE		20.0f
+#define	NUM_SHADOW_TEXTURES		(GLOBAL_SObjType_Shadow_Nano - GLOBAL_SObjType_Shadow_Circular + 1)
+#define	MAX_BATCHED_SHADOWS		256							// per shadow texture, per pane
+
+#define	PLAYER_VIEW_CULL_ASPECT	(16.0f / 9.0f)				// widest pane we expect, so the sim never culls what a pane could show
+
 /**********************/
 /*     VARIABLES      */
 /**********************/
@@ -36,6 +59,17 @@ static void MO_CalcWorldPoints_VertexArray(ObjNode *theNode, MOVertexArrayData *
 
 static	int		gMeshNum;
 
+static	int					gNumPendingShadows = 0;
+static	PendingShadowType	gPendingShadows[MAX_PENDING_SHADOWS];
+
+static	ObjNode				*gShadowDrawer = nil;
+static	Boolean				gShadowBatchInitialized = false;
+static	int					gNumBatchedShadows[NUM_SHADOW_TEXTURES];
+static	OGLPoint3D			gShadowBatchPoints[NUM_SHADOW_TEXTURES][MAX_BATCHED_SHADOWS * 4];
+static	OGLColorRGBA		gShadowBatchColors[NUM_SHADOW_TEXTURES][MAX_BATCHED_SHADOWS * 4];
+static	OGLTextureCoord		gShadowBatchUVs[MAX_BATCHED_SHADOWS * 4];
+static	MOTriangleIndecies	gShadowBatchTriangles[MAX_BATCHED_SHADOWS * 2];
+
 int		gNumWorldCalcsThisFrame;
 
 
@@ -382,8 +416,11 @@ ObjNode	*AttachShadowToObject(ObjNode *theNode, int shadowType, float scaleX, fl
 	shadowObj->ShadowScaleX = scaleX;							// need to remeber scales for update
 	shadowObj->ShadowScaleZ = scaleZ;
 	shadowObj->CheckForBlockers = checkBlockers;
+	shadowObj->ShadowIsPlaced = false;							// first UpdateShadow must place it
 	shadowObj->Kind = shadowType;							// remember the shadow type
 
+	MakeShadowDrawer();
+
 	return(shadowObj);
 }
 
@@ -422,6 +459,8 @@ ObjNode	*shadowObj;
 	shadowObj->Scale.z = scaleZ;
 	RotateOnTerrain(shadowObj, SHADOW_Y_OFF, nil);							// set transform matrix
 
+	MakeShadowDrawer();
+
 	return(shadowObj);
 }
 
@@ -432,7 +471,6 @@ void UpdateShadow(ObjNode *theNode)
 {
 ObjNode *shadowNode,*thisNodePtr;
 float	x,bottom,z,y;
-float	dist,scaleX,scaleZ;
 Boolean	onBlocker = false;
 
 	if (theNode == nil)
@@ -454,9 +492,35 @@ Boolean	onBlocker = false;
 	bottom = theNode->Coord.y + theNode->BottomOff;
 	z = theNode->Coord.z;
 
-	shadowNode->Coord = theNode->Coord;
+
+		/* ONLY LOOK FOR BLOCKERS AGAIN IF THE OWNER HAS MOVED ENOUGH */
+		//
+		// Until then, a shadow on the terrain just follows its owner & gets
+		// conformed to the terrain again in the batch below.  One on a blocker or water
+		// is always placed again, since blockers move and their edges are sharp.
+		//
+
+	shadowNode->Coord.x = x;
+	shadowNode->Coord.z = z;
 	shadowNode->Rot.y = theNode->Rot.y;
 
+	if (shadowNode->ShadowIsPlaced
+		&& !shadowNode->ShadowOnBlocker
+		&& fabsf(x - shadowNode->ShadowOwnerX) < SHADOW_UPDATE_DIST
+		&& fabsf(z - shadowNode->ShadowOwnerZ) < SHADOW_UPDATE_DIST
+		&& fabsf(bottom - shadowNode->ShadowOwnerBottom) < SHADOW_UPDATE_DIST)
+	{
+		goto on_terrain;
+	}
+
+	shadowNode->ShadowIsPlaced 		= true;
+	shadowNode->ShadowOnBlocker		= false;
+	shadowNode->ShadowOwnerX 		= x;
+	shadowNode->ShadowOwnerBottom 	= bottom;
+	shadowNode->ShadowOwnerZ 		= z;
+
+	shadowNode->Coord = theNode->Coord;
+
 		/****************************************************/
 		/* SEE IF SHADOW IS ON BLOCKER OBJECT OR ON TERRAIN */
 		/****************************************************/
@@ -528,6 +592,7 @@ Boolean	onBlocker = false;
 
 		if (onBlocker)
 		{
+			shadowNode->ShadowOnBlocker = true;
 			shadowNode->Scale.x = shadowNode->ShadowScaleX;					// use preset scale
 			shadowNode->Scale.z = shadowNode->ShadowScaleZ;
 			UpdateObjectTransforms(shadowNode);
@@ -538,43 +603,180 @@ Boolean	onBlocker = false;
 			/************************/
 			/* SHADOW IS ON TERRAIN */
 			/************************/
+			//
+			// Conforming to the terrain is deferred so that all of this frame's shadows
+			// can share one batched terrain query.  See FlushPendingShadowUpdates.
+			//
+
+on_terrain:
+	if (gNumPendingShadows >= MAX_PENDING_SHADOWS)
+		FlushPendingShadowUpdates();
+
+	gPendingShadows[gNumPendingShadows].shadowNode = shadowNode;
+	gPendingShadows[gNumPendingShadows].ownerBottom = bottom;
+	gNumPendingShadows++;
+}
+
 
-	RotateOnTerrain(shadowNode, SHADOW_Y_OFF, nil);							// set transform matrix
+/******************** FLUSH PENDING SHADOW UPDATES *********************/
+//
+// Conforms all shadows queued by UpdateShadow to the terrain.
+//
+// This must run before deleted ObjNodes get recycled (see FlushObjectDeleteQueue),
+// and before the shadows are drawn.
+//
+
+void FlushPendingShadowUpdates(void)
+{
+static	OGLPoint2D		queryCoord[MAX_PENDING_SHADOWS * 2];
+static	float			queryY[MAX_PENDING_SHADOWS * 2];
+static	OGLVector3D		queryNormal[MAX_PENDING_SHADOWS * 2];
+int		i,n;
+
+	n = gNumPendingShadows;
+	if (n == 0)
+		return;
+
+			/* GATHER CENTER & "TO" COORDS OF EACH SHADOW */
+
+	for (i = 0; i < n; i++)
+	{
+		ObjNode	*shadowNode = gPendingShadows[i].shadowNode;
+		float	x = shadowNode->Coord.x;
+		float	z = shadowNode->Coord.z;
+		float	r = shadowNode->Rot.y;
+
+		queryCoord[i*2].x = x;
+		queryCoord[i*2].y = z;
+		queryCoord[i*2+1].x = x + sin(r) * -30.0f;
+		queryCoord[i*2+1].y = z + cos(r) * -30.0f;
+	}
 
+	GetTerrainYBatch(n * 2, queryCoord, queryY, queryNormal);
+
+
+			/* SET EACH SHADOW'S MATRIX & SCALE */
+
+	for (i = 0; i < n; i++)
+	{
+		ObjNode		*shadowNode = gPendingShadows[i].shadowNode;
+		OGLPoint3D	to;
+		float		dist,scaleX,scaleZ;
+
+		if (shadowNode->CType == INVALID_NODE_FLAG)						// skip if got deleted since it was queued
+			continue;
+
+		shadowNode->Coord.y = queryY[i*2] + SHADOW_Y_OFF;
+
+		to.x = queryCoord[i*2+1].x;
+		to.y = queryY[i*2+1] + SHADOW_Y_OFF;
+		to.z = queryCoord[i*2+1].y;
+
+		SetTerrainAlignedMatrix(shadowNode, &queryNormal[i*2], &to);		// set transform matrix
 
 
 			/* CALC SCALE OF SHADOW */
 
-	dist = (bottom - shadowNode->Coord.y) * (1.0f/1000.0f);					// as we go higher, shadow gets smaller
-	if (dist < 0.0f)
-		dist = 0;
+		dist = (gPendingShadows[i].ownerBottom - shadowNode->Coord.y) * (1.0f/1000.0f);	// as we go higher, shadow gets smaller
+		if (dist < 0.0f)
+			dist = 0;
 
-	dist = 1.0f - dist;
+		dist = 1.0f - dist;
 
-	scaleX = dist * shadowNode->ShadowScaleX;
-	scaleZ = dist * shadowNode->ShadowScaleZ;
+		scaleX = dist * shadowNode->ShadowScaleX;
+		scaleZ = dist * shadowNode->ShadowScaleZ;
 
-	if (scaleX < 0.0f)
-		scaleX = 0;
-	if (scaleZ < 0.0f)
-		scaleZ = 0;
+		if (scaleX < 0.0f)
+			scaleX = 0;
+		if (scaleZ < 0.0f)
+			scaleZ = 0;
 
-	shadowNode->Scale.x = scaleX;				// this scale wont get updated until next frame (RotateOnTerrain).
-	shadowNode->Scale.z = scaleZ;
+		shadowNode->Scale.x = scaleX;				// this scale wont get updated until next frame (SetTerrainAlignedMatrix).
+		shadowNode->Scale.z = scaleZ;
+	}
+
+	gNumPendingShadows = 0;
 }
 
 
 /******************* DRAW SHADOW ******************/
+//
+// Called by DrawObjects, which has already worked out the shadow's transparency
+// (including autofade).  The quad is added to the batch that DrawShadowBatch
+// draws once all the shadows in this pane have been gathered.
+//
 
 static void DrawShadow(ObjNode *theNode)
 {
-int	shadowType = theNode->Kind;
+int				shadowType = theNode->Kind;
+int				n;
+OGLPoint3D		*points;
+OGLColorRGBA	*colors;
+MOMaterialObject	*material;
+OGLVector3D		drawOffset;
+static const OGLPoint3D	corners[4] =
+{
+	{-SHADOW_QUAD_SIZE, 0, SHADOW_QUAD_SIZE},
+	{ SHADOW_QUAD_SIZE, 0, SHADOW_QUAD_SIZE},
+	{ SHADOW_QUAD_SIZE, 0, -SHADOW_QUAD_SIZE},
+	{-SHADOW_QUAD_SIZE, 0, -SHADOW_QUAD_SIZE},
+};
+
+			/* SEE IF IT CAN'T GO IN THE BATCH */
+
+	if (!gShadowDrawer
+		|| theNode->Slot >= SHADOW_SLOT											// the batch was (or may have been) drawn already
+		|| shadowType < 0 || shadowType >= NUM_SHADOW_TEXTURES
+		|| gNumBatchedShadows[shadowType] >= MAX_BATCHED_SHADOWS)
+	{
+		DrawSingleShadow(theNode);
+		return;
+	}
+
+	n = gNumBatchedShadows[shadowType]++;
+
+	points = &gShadowBatchPoints[shadowType][n * 4];
+	colors = &gShadowBatchColors[shadowType][n * 4];
+	material = gSpriteGroupList[SPRITE_GROUP_GLOBAL][GLOBAL_SObjType_Shadow_Circular+shadowType].materialObject;
+
+			/* THE SHADOW FOLLOWS ITS OWNER EVERY TICK, SO IT'S DRAWN BACK BY THE SAME AMOUNT */
+
+	if (!GetObjectDrawOffset(theNode, &drawOffset))
+		drawOffset.x = drawOffset.y = drawOffset.z = 0;
+
+	for (int i = 0; i < 4; i++)
+	{
+		OGLPoint3D_Transform(&corners[i], &theNode->BaseTransformMatrix, &points[i]);	// put the quad in world space
+		points[i].x += drawOffset.x;
+		points[i].y += drawOffset.y;
+		points[i].z += drawOffset.z;
+
+		colors[i].r = material->objectData.diffuseColor.r;
+		colors[i].g = material->objectData.diffuseColor.g;
+		colors[i].b = material->objectData.diffuseColor.b;
+		colors[i].a = material->objectData.diffuseColor.a * gGlobalTransparency;
+	}
+}
+
+
+/******************* DRAW SINGLE SHADOW ******************/
+//
+// For the odd shadow that can't be batched.
+//
+
+static void DrawSingleShadow(ObjNode *theNode)
+{
+int			shadowType = theNode->Kind;
+OGLVector3D	drawOffset;
 
 	OGL_PushState();
 	OGL_DisableCullFace();
 
 			/* SUBMIT THE MATRIX */
 
+	if (GetObjectDrawOffset(theNode, &drawOffset))						// stay with the interpolated owner
+		glTranslatef(drawOffset.x, drawOffset.y, drawOffset.z);
+
 	glMultMatrixf(theNode->BaseTransformMatrix.value);
 
 
@@ -588,10 +790,10 @@ int	shadowType = theNode->Kind;
 			/* DRAW THE SHADOW */
 
 	glBegin(GL_QUADS);
-	glTexCoord2f(0,0);	glVertex3f(-20, 0, 20);
-	glTexCoord2f(1,0);	glVertex3f(20, 0, 20);
-	glTexCoord2f(1,1);	glVertex3f(20, 0, -20);
-	glTexCoord2f(0,1);	glVertex3f(-20, 0, -20);
+	glTexCoord2f(0,0);	glVertex3f(-SHADOW_QUAD_SIZE, 0, SHADOW_QUAD_SIZE);
+	glTexCoord2f(1,0);	glVertex3f(SHADOW_QUAD_SIZE, 0, SHADOW_QUAD_SIZE);
+	glTexCoord2f(1,1);	glVertex3f(SHADOW_QUAD_SIZE, 0, -SHADOW_QUAD_SIZE);
+	glTexCoord2f(0,1);	glVertex3f(-SHADOW_QUAD_SIZE, 0, -SHADOW_QUAD_SIZE);
 	glEnd();
 
 	OGL_PopState();
@@ -600,6 +802,109 @@ int	shadowType = theNode->Kind;
 }
 
 
+/******************* MAKE SHADOW DRAWER ******************/
+//
+// The first shadow in a scene creates the object which draws the batch.
+//
+
+static void MakeShadowDrawer(void)
+{
+	if (gShadowDrawer)
+		return;
+
+			/* THE UVS & TRIANGLES ARE THE SAME FOR EVERY QUAD */
+
+	if (!gShadowBatchInitialized)
+	{
+		for (int i = 0; i < MAX_BATCHED_SHADOWS; i++)
+		{
+			OGLTextureCoord		*uv = &gShadowBatchUVs[i * 4];
+			MOTriangleIndecies	*t = &gShadowBatchTriangles[i * 2];
+
+			uv[0].u = 0;	uv[0].v = 0;
+			uv[1].u = 1;	uv[1].v = 0;
+			uv[2].u = 1;	uv[2].v = 1;
+			uv[3].u = 0;	uv[3].v = 1;
+
+			t[0].vertexIndices[0] = i*4;
+			t[0].vertexIndices[1] = i*4 + 1;
+			t[0].vertexIndices[2] = i*4 + 2;
+			t[1].vertexIndices[0] = i*4;
+			t[1].vertexIndices[1] = i*4 + 2;
+			t[1].vertexIndices[2] = i*4 + 3;
+		}
+
+		gShadowBatchInitialized = true;
+	}
+
+	SDL_zeroa(gNumBatchedShadows);
+
+	NewObjectDefinitionType def =
+	{
+		.genre		= CUSTOM_GENRE,
+		.slot		= SHADOW_SLOT,
+		.flags		= STATUS_BIT_NOZWRITES | STATUS_BIT_NOLIGHTING | STATUS_BIT_DOUBLESIDED | STATUS_BIT_DONTCULL,
+		.drawCall	= DrawShadowBatch,
+		.scale		= 1,
+	};
+
+	gShadowDrawer = MakeNewObject(&def);
+	gShadowDrawer->Destructor = DisposeShadowDrawer;
+}
+
+
+/******************* DISPOSE SHADOW DRAWER ******************/
+
+static void DisposeShadowDrawer(ObjNode *theNode)
+{
+	(void) theNode;
+
+	gShadowDrawer = nil;
+	SDL_zeroa(gNumBatchedShadows);
+}
+
+
+/******************* DRAW SHADOW BATCH ******************/
+//
+// Draws every shadow gathered by DrawShadow in this pane, one call per shadow texture.
+//
+
+static void DrawShadowBatch(ObjNode *theNode)
+{
+MOVertexArrayData	mesh;
+
+	(void) theNode;
+
+	SDL_zero(mesh);
+	mesh.VARtype 		= -1;
+	mesh.numMaterials 	= 1;
+
+	gGlobalTransparency = .99f;								// force blending, the vertex colors have the real alpha
+
+	for (int shadowType = 0; shadowType < NUM_SHADOW_TEXTURES; shadowType++)
+	{
+		int	n = gNumBatchedShadows[shadowType];
+
+		if (n == 0)
+			continue;
+
+		mesh.materials[0] 	= gSpriteGroupList[SPRITE_GROUP_GLOBAL][GLOBAL_SObjType_Shadow_Circular+shadowType].materialObject;
+		mesh.numPoints 		= n * 4;
+		mesh.numTriangles 	= n * 2;
+		mesh.points 		= gShadowBatchPoints[shadowType];
+		mesh.colorsFloat 	= gShadowBatchColors[shadowType];
+		mesh.uvs[0] 		= gShadowBatchUVs;
+		mesh.triangles 		= gShadowBatchTriangles;
+
+		MO_DrawGeometry_VertexArray(&mesh);
+
+		gNumBatchedShadows[shadowType] = 0;					// next pane gathers its own
+	}
+
+	gGlobalTransparency = 1.0f;
+}
+
+
 //============================================================================================================
 //============================================================================================================
 //============================================================================================================
@@ -607,195 +912,226 @@ int	shadowType = theNode->Kind;
 #pragma mark ----- OBJECT CULLING ------
 
 
-/**************** CULL TEST ALL OBJECTS *******************/
+/**************** CALC OBJECT CULL BOUNDS *******************/
+//
+// Builds the world-space box that CullTestAllObjects tests against each pane's frustum.
+// It doesn't depend on the camera, so it's done once per frame by PrepareObjectsForDrawing
+// no matter how many split-screen panes or stereo passes there are.
+//
 
-void CullTestAllObjects(void)
+void CalcObjectCullBounds(ObjNode *theNode)
 {
-int			i;
-ObjNode		*theNode;
-float		m00,m01,m02,m03;
-float		m10,m11,m12,m13;
-float		m20,m21,m22,m23;
-float		m30,m31,m32,m33;
-float		minX,minY,minZ,maxX,maxY,maxZ;
-OGLBoundingBox		*bBox;
-uint32_t		clipFlags;				// Clip in/out tests for point
-uint32_t		clipCodeAND;			// Clip test for entire object
-
-
-	theNode = gFirstNodePtr;														// get & verify 1st node
-	if (theNode == nil)
+OGLBoundingBox		*bBox = &theNode->LocalBBox;
+OGLBoundingBox		*cullBox = &theNode->CullBBox;
+float				cx,cy,cz, ex,ey,ez;
+
+	if ((theNode->StatusBits & STATUS_BIT_DONTCULL) || bBox->isEmpty)		// never culled
+	{
+		cullBox->isEmpty = true;
 		return;
+	}
 
-					/* PROCESS EACH OBJECT */
+	cullBox->isEmpty = false;
+
+	cx = (bBox->min.x + bBox->max.x) * .5f;									// local center & half-extents
+	cy = (bBox->min.y + bBox->max.y) * .5f;
+	cz = (bBox->min.z + bBox->max.z) * .5f;
+	ex = (bBox->max.x - bBox->min.x) * .5f;
+	ey = (bBox->max.y - bBox->min.y) * .5f;
+	ez = (bBox->max.z - bBox->min.z) * .5f;
+
+
+			/* SKELETONS ARE ALREADY ORIENTED, JUST NEED TRANSLATION */
 
-	do
+	if (theNode->Genre == SKELETON_GENRE)
 	{
-		if (theNode->StatusBits & STATUS_BIT_HIDDEN)			// if hidden then skip
-			goto next;
+		cx += theNode->Coord.x;
+		cy += theNode->Coord.y;
+		cz += theNode->Coord.z;
+	}
 
-		if (theNode->StatusBits & STATUS_BIT_DONTCULL)			// see if dont want to use our culling
-			goto draw_on;
+			/* NON-SKELETONS: BOX AROUND THE TRANSFORMED BOX */
 
-		bBox = &theNode->LocalBBox;
-		if (bBox->isEmpty)											// skip culling if no bbox
-			goto draw_on;
+	else
+	{
+		const float	*m = theNode->BaseTransformMatrix.value;
+		float		wx,wy,wz;
 
-				/*******************************************************/
-				/* CALCULATE THE LOCAL->FRUSTUM MATRIX FOR THIS OBJECT */
-				/*******************************************************/
-				//
-				// NOTE: 	I load the matrices into registers inside the "if" statements instead
-				// 			of at the end because this tricks CodeWarrior into really pre-loading
-				//			the registers.  Otherwise, CodeWarrior loads them each pass in the loop
-				//			below.
-				//
+		wx = m[M00]*cx + m[M01]*cy + m[M02]*cz + m[M03];
+		wy = m[M10]*cx + m[M11]*cy + m[M12]*cz + m[M13];
+		wz = m[M20]*cx + m[M21]*cy + m[M22]*cz + m[M23];
 
-						/* MATRIX FOR SKELETON OBJECT */
+		cx = wx;
+		cy = wy;
+		cz = wz;
 
-		if (theNode->Genre == SKELETON_GENRE)			// skeletons are already oriented, just need translation
-		{
-			OGLMatrix4x4	m,m2;
-			OGLMatrix4x4_SetTranslate(&m2, theNode->Coord.x, theNode->Coord.y, theNode->Coord.z);
-			OGLMatrix4x4_Multiply(&m2, &gWorldToFrustumMatrix, &m);
-
-			m00 = m.value[M00];							// load matrix into registers
-			m01 = m.value[M01];
-			m02 = m.value[M02];
-			m03 = m.value[M03];
-			m10 = m.value[M10];
-			m11 = m.value[M11];
-			m12 = m.value[M12];
-			m13 = m.value[M13];
-			m20 = m.value[M20];
-			m21 = m.value[M21];
-			m22 = m.value[M22];
-			m23 = m.value[M23];
-			m30 = m.value[M30];
-			m31 = m.value[M31];
-			m32 = m.value[M32];
-			m33 = m.value[M33];
-		}
+		wx = fabsf(m[M00])*ex + fabsf(m[M01])*ey + fabsf(m[M02])*ez;
+		wy = fabsf(m[M10])*ex + fabsf(m[M11])*ey + fabsf(m[M12])*ez;
+		wz = fabsf(m[M20])*ex + fabsf(m[M21])*ey + fabsf(m[M22])*ez;
 
-				/* MATRIX FOR NON-SKELETON OBJECT */
+		ex = wx;
+		ey = wy;
+		ez = wz;
+	}
 
-		else											// non-skeletons need full transform
-		{
-			OGLMatrix4x4	m;
-
-			OGLMatrix4x4_Multiply(&theNode->BaseTransformMatrix, &gWorldToFrustumMatrix, &m);
-
-			m00 = m.value[M00];							// load matrix into registers
-			m01 = m.value[M01];
-			m02 = m.value[M02];
-			m03 = m.value[M03];
-			m10 = m.value[M10];
-			m11 = m.value[M11];
-			m12 = m.value[M12];
-			m13 = m.value[M13];
-			m20 = m.value[M20];
-			m21 = m.value[M21];
-			m22 = m.value[M22];
-			m23 = m.value[M23];
-			m30 = m.value[M30];
-			m31 = m.value[M31];
-			m32 = m.value[M32];
-			m33 = m.value[M33];
-		}
 
+			/* OBJECTS THAT TURN TO FACE EACH PANE'S CAMERA */
+			//
+			// DrawObjects re-aims these about y for every pane, so the box has to hold any y rotation.
+			//
+
+	if (theNode->StatusBits & STATUS_BIT_AIMATCAMERA)
+	{
+		float dx = fabsf(cx - theNode->Coord.x) + ex;
+		float dz = fabsf(cz - theNode->Coord.z) + ez;
+		float r = sqrtf(dx*dx + dz*dz);
+
+		cx = theNode->Coord.x;
+		cz = theNode->Coord.z;
+		ex = ez = r;
+	}
 
-					/******************************/
-					/* TRANSFORM THE BOUNDING BOX */
-					/******************************/
+	cullBox->min.x = cx - ex;		cullBox->max.x = cx + ex;
+	cullBox->min.y = cy - ey;		cullBox->max.y = cy + ey;
+	cullBox->min.z = cz - ez;		cullBox->max.z = cz + ez;
+}
 
-		minX = bBox->min.x;								// load bbox into registers
-		minY = bBox->min.y;
-		minZ = bBox->min.z;
-		maxX = bBox->max.x;
-		maxY = bBox->max.y;
-		maxZ = bBox->max.z;
 
-		clipCodeAND = ~0u;
+/**************** GET FRUSTUM PLANES *******************/
+//
+// The planes come straight from the world-to-frustum matrix, so "inside" means
+// the same thing as the old per-corner clip code test:
+// -w <= x <= w, -w <= y <= w, 0 <= z <= w.
+//
 
-		for (i = 0; i < 8; i++)
-		{
-			float		lX, lY, lZ;				// Local space co-ordinates
-			float		hX, hY, hZ, hW;			// Homogeneous co-ordinates
-			float		minusHW;				// -hW
+static void GetFrustumPlanes(const OGLMatrix4x4 *worldToFrustum, float planes[6][4])
+{
+const float	*m = worldToFrustum->value;
 
-			switch (i)							// load current bbox corner in IX,IY,IZ
-			{
-				default:
-				case	0:	lX = minX;	lY = minY;	lZ = minZ;	break;
-				case	1:	lX = minX;	lY = minY;	lZ = maxZ;	break;
-				case	2:	lX = minX;	lY = maxY;	lZ = minZ;	break;
-				case	3:	lX = minX;	lY = maxY;	lZ = maxZ;	break;
-				case	4:	lX = maxX;	lY = minY;	lZ = minZ;	break;
-				case	5:	lX = maxX;	lY = minY;	lZ = maxZ;	break;
-				case	6:	lX = maxX;	lY = maxY;	lZ = minZ;	break;
-				case	7:	lX = maxX;	lY = maxY;	lZ = maxZ;  break;
-			}
+	for (int c = 0; c < 4; c++)
+	{
+		float	row0 = m[M00 + c*4];
+		float	row1 = m[M10 + c*4];
+		float	row2 = m[M20 + c*4];
+		float	row3 = m[M30 + c*4];
+
+		planes[0][c] = row3 + row0;				// left
+		planes[1][c] = row3 - row0;				// right
+		planes[2][c] = row3 + row1;				// bottom
+		planes[3][c] = row3 - row1;				// top
+		planes[4][c] = row2;					// near
+		planes[5][c] = row3 - row2;				// far
+	}
+}
 
-			hW = lX * m30 + lY * m31 + lZ * m32 + m33;
-			hY = lX * m10 + lY * m11 + lZ * m12 + m13;
-			hZ = lX * m20 + lY * m21 + lZ * m22 + m23;
-			hX = lX * m00 + lY * m01 + lZ * m02 + m03;
 
-			minusHW = -hW;
+/**************** IS BOX OUTSIDE FRUSTUM *******************/
+//
+// A box (center & half-extents) is outside if it's entirely behind any one plane.
+//
 
-					/* CHECK Y */
+static Boolean IsBoxOutsideFrustum(const float planes[6][4], float cx, float cy, float cz, float ex, float ey, float ez)
+{
+	for (int p = 0; p < 6; p++)
+	{
+		const float *pl = planes[p];
+		float dist		= pl[0]*cx + pl[1]*cy + pl[2]*cz + pl[3];
+		float radius	= fabsf(pl[0])*ex + fabsf(pl[1])*ey + fabsf(pl[2])*ez;
 
-			if (hY < minusHW)
-				clipFlags = 0x8;
-			else
-			if (hY > hW)
-				clipFlags = 0x4;
-			else
-				clipFlags = 0;
+		if (dist + radius < 0.0f)
+			return true;
+	}
 
+	return false;
+}
 
-					/* CHECK Z */
 
-			if (hZ > hW)
-				clipFlags |= 0x20;
-			else
-			if (hZ < 0.0f)
-				clipFlags |= 0x10;
+/**************** CULL TEST ALL OBJECTS *******************/
+//
+// The per-pane half of culling: tests each object's CullBBox against the
+// current pane's frustum planes and sets/clears that pane's cull bit.
+//
 
+void CullTestAllObjects(ObjNode **nodeList, int numNodes)
+{
+float		planes[6][4];
+uint32_t	cullBit = STATUS_BIT_ISCULLED1 << gCurrentSplitScreenPane;
 
-					/* CHECK X */
+	GetFrustumPlanes(&gWorldToFrustumMatrix, planes);
 
-			if (hX < minusHW)
-				clipFlags |= 0x2;
-			else
-			if (hX > hW)
-				clipFlags |= 0x1;
 
-			clipCodeAND &= clipFlags;
-		}
+					/* PROCESS EACH OBJECT */
 
-		/****************************/
-		/* SEE IF WAS CULLED OR NOT */
-		/****************************/
+	for (int n = 0; n < numNodes; n++)
+	{
+		ObjNode				*theNode = nodeList[n];
+		const OGLBoundingBox *box = &theNode->CullBBox;
+		Boolean				culled = false;
 
-		if (clipCodeAND)															// check for case #2
+		if (!box->isEmpty)
 		{
-//draw_off:
-			theNode->StatusBits |= (STATUS_BIT_ISCULLED1 << gCurrentSplitScreenPane);		// set cull bit for this pane/player
+			culled = IsBoxOutsideFrustum(planes,
+						(box->min.x + box->max.x) * .5f,
+						(box->min.y + box->max.y) * .5f,
+						(box->min.z + box->max.z) * .5f,
+						(box->max.x - box->min.x) * .5f,
+						(box->max.y - box->min.y) * .5f,
+						(box->max.z - box->min.z) * .5f);
 		}
+
+		if (culled)
+			theNode->StatusBits |= cullBit;		// set cull bit for this pane/player
 		else
-		{
-draw_on:
-			theNode->StatusBits &= ~(STATUS_BIT_ISCULLED1 << gCurrentSplitScreenPane);		// clear cull bit
-		}
+			theNode->StatusBits &= ~cullBit;	// clear cull bit
+	}
+}
+
+
+/**************** CULL TEST OBJECTS FOR PLAYER *******************/
+//
+// While input is being recorded or replayed, gameplay that filters on a player's cull bit
+// (auto-aim) calls this from the move first, so that the bit comes from the simulation and
+// not from whenever -- or whether -- the last frame was drawn.  That keeps recorded input
+// replaying the same way, windowed or headless, at any frame rate.  Normal play keeps
+// using the bits from the real panes.
+//
+// Only objects of the given cTypes are tested, against the player's camera at this
+// tick with a fixed aspect ratio, using their bounding spheres.  Drawing redoes the
+// bit from the real pane before it uses it.
+//
+
+void CullTestObjectsForPlayer(short playerNum, uint32_t cTypes)
+{
+const OGLCameraPlacement	*cam = &gGameViewInfoPtr->cameraPlacement[playerNum];
+OGLMatrix4x4	worldToView, viewToFrustum, worldToFrustum;
+float			planes[6][4];
+uint32_t		cullBit = STATUS_BIT_ISCULLED1 << playerNum;
+
+	OGL_SetGluPerspectiveMatrix(&viewToFrustum, gGameViewInfoPtr->fov[playerNum], PLAYER_VIEW_CULL_ASPECT,
+								gGameViewInfoPtr->hither, gGameViewInfoPtr->yon);
+	OGL_SetGluLookAtMatrix(&worldToView, &cam->cameraLocation, &cam->pointOfInterest, &cam->upVector);
+	OGLMatrix4x4_Multiply(&worldToView, &viewToFrustum, &worldToFrustum);
 
+	GetFrustumPlanes(&worldToFrustum, planes);
 
+	for (ObjNode *theNode = gFirstNodePtr; theNode; theNode = theNode->NextNode)
+	{
+		if (theNode->Slot >= SLOT_OF_DUMB)
+			break;
 
-				/* NEXT NODE */
-next:
-		theNode = theNode->NextNode;		// next node
+		if (theNode->CType == INVALID_NODE_FLAG || !(theNode->CType & cTypes))
+			continue;
+
+		float r = theNode->BoundingSphereRadius;
+
+		if (!(theNode->StatusBits & STATUS_BIT_DONTCULL)
+			&& IsBoxOutsideFrustum(planes, theNode->Coord.x, theNode->Coord.y, theNode->Coord.z, r, r, r))
+		{
+			theNode->StatusBits |= cullBit;
+		}
+		else
+			theNode->StatusBits &= ~cullBit;
 	}
-	while (theNode != nil);
 }
 
 
@@ -951,7 +1287,7 @@ MOTriangleIndecies	*tris;
 	if (theNode->WorldMeshes[meshNum].points == nil)
 	{
 		theNode->WorldMeshes[meshNum] = *data;												// copy the entire vertex array data struct
-		theNode->WorldMeshes[meshNum].points = AllocPtrClear(sizeof(OGLPoint3D) * numPoints);	// assign a new points array, however
+		theNode->WorldMeshes[meshNum].points = MO_AllocVertexArrayPtr(sizeof(OGLPoint3D) * numPoints);	// assign a new points array, however
 	}
 
 	worldBuffer = theNode->WorldMeshes[meshNum].points;				// get ptr to the world-space point buffer
@@ -979,7 +1315,7 @@ MOTriangleIndecies	*tris;
 	tris = data->triangles;												// get ptr to triangle array
 
 	if (theNode->WorldPlaneEQs[meshNum] == nil)
-		theNode->WorldPlaneEQs[meshNum] = AllocPtrClear(sizeof(OGLPlaneEquation) * numTriangles);	// alloc array for plane eq's
+		theNode->WorldPlaneEQs[meshNum] = MO_AllocVertexArrayPtr(sizeof(OGLPlaneEquation) * numTriangles);	// alloc array for plane eq's
 
 	for (t = 0; t < numTriangles; t++)
 	{
@@ -0,0 +1,761 @@
+/****************************/
+/*      PREFETCH.C          */
+/****************************/
+
+//
+// Background file loading.
+//
+// A worker thread reads a level's big files while the main thread is busy with
+// something else (the level intro screen, setting up the game view, or uploading
+// the previous model file to GL).  Models are baked in memory on the worker
+// (see BakeBG3DImage) so that the JPEG decoding and byte swapping are off the
+// main thread too; ImportBG3D then only has to copy vertex streams and upload
+// textures, which must stay on the main thread because they need the GL
+// context and the level's VAR memory.
+//
+// The worker never calls into Pomme: it reads files through SDL using the
+// host path of the Data folder, and only hands back AllocPtr memory.
+// It must never reach DoFatalAlert either (that needs GL and would try to
+// shut this very thread down), so it only uses TryAllocPtr, and a file that
+// can't be read or a model that won't bake is just marked as failed;
+// the main thread then loads it itself and reports the error.
+//
+// If a model's .bg3dc is up to date, the worker reads that instead of baking.
+//
+// Besides whole files, it decodes sprite images (a .jpg and/or its .png mask,
+// see OGL_TextureMap_LoadImageFile) and, while LoadSuperTileTextures uploads
+// the terrain textures, the supertile JPEGs a few tiles ahead of it.
+//
+// Whether a file exists is checked on the main thread with FSMakeFSSpec, like the
+// loaders do; the worker then opens it with SDL_IOFromFile, which also reads
+// assets that aren't plain files on the host (e.g. inside an Android APK).
+//
+
+/***************/
+/* EXTERNALS   */
+/***************/
+
+#include "game.h"
+#include "stb_image.h"
+
+
+/****************************/
+/*    PROTOTYPES            */
+/****************************/
+
+static int SDLCALL PrefetchThread(void *unused);
+static void QueuePrefetchEntry(const FSSpec *spec, const char *path, Byte kind);
+static Ptr ReadHostFile(const char *hostPath, long *outSize);
+static Ptr ReadBG3DHostFile(const char *hostPath, long *outSize);
+static Ptr ReadImageHostFiles(const char *hostPath, long *outSize);
+
+
+/****************************/
+/*    CONSTANTS             */
+/****************************/
+
+#define	MAX_HOST_PATH			512
+
+enum
+{
+	PREFETCH_STATUS_FREE,
+	PREFETCH_STATUS_QUEUED,
+	PREFETCH_STATUS_LOADING,
+	PREFETCH_STATUS_READY,
+	PREFETCH_STATUS_FAILED,
+	PREFETCH_STATUS_CANCELLED,			// flushed while loading: the worker frees the result
+};
+
+typedef struct
+{
+	Byte		status;
+	Byte		kind;
+	uint32_t	ticket;					// files are loaded in the order they were requested
+	FSSpec		spec;					// what the main thread will ask for
+	char		hostPath[MAX_HOST_PATH];	// what the worker actually reads
+	const char	*source;				// PREFETCH_KIND_SUPERTILE: the JPEG to decode (it's in the compiled playfield)
+	long		sourceSize;
+	Ptr			data;
+	long		size;
+}PrefetchEntryType;
+
+
+/**********************/
+/*     VARIABLES      */
+/**********************/
+
+static SDL_Thread			*gPrefetchThread = nil;
+static SDL_Mutex			*gPrefetchMutex = nil;
+static SDL_Condition		*gPrefetchCondition = nil;
+static Boolean				gPrefetchQuit = false;
+static uint32_t				gPrefetchNextTicket = 0;
+static Boolean				gPrefetchShareTaken = false;
+
+static PrefetchEntryType	gPrefetchEntries[MAX_PREFETCH_FILES];
+
+
+/********************** INIT PREFETCHER **************************/
+//
+// If there's no thread support (e.g. a WebAssembly build without pthreads),
+// prefetching is silently disabled and everything loads on the main thread as before.
+//
+
+void InitPrefetcher(void)
+{
+	SDL_zeroa(gPrefetchEntries);
+	gPrefetchQuit = false;
+
+	gPrefetchMutex = SDL_CreateMutex();
+	gPrefetchCondition = SDL_CreateCondition();
+
+	if (gPrefetchMutex && gPrefetchCondition)
+		gPrefetchThread = SDL_CreateThread(PrefetchThread, "Prefetch", nil);
+
+	if (!gPrefetchThread)
+	{
+		SDL_Log("%s: no prefetch thread (%s), assets will load synchronously", __func__, SDL_GetError());
+		ShutdownPrefetcher();
+	}
+}
+
+
+/********************** SHUTDOWN PREFETCHER **************************/
+
+void ShutdownPrefetcher(void)
+{
+	if (gPrefetchThread)
+	{
+		FlushPrefetchedFiles();
+
+		SDL_LockMutex(gPrefetchMutex);
+		gPrefetchQuit = true;
+		SDL_BroadcastCondition(gPrefetchCondition);
+		SDL_UnlockMutex(gPrefetchMutex);
+
+		SDL_WaitThread(gPrefetchThread, nil);				// lets it finish the file it's on
+		gPrefetchThread = nil;
+	}
+
+	if (gPrefetchCondition)
+	{
+		SDL_DestroyCondition(gPrefetchCondition);
+		gPrefetchCondition = nil;
+	}
+
+	if (gPrefetchMutex)
+	{
+		SDL_DestroyMutex(gPrefetchMutex);
+		gPrefetchMutex = nil;
+	}
+}
+
+
+#pragma mark -
+
+
+/*********************** FIND PREFETCH ENTRY ****************************/
+//
+// Must hold gPrefetchMutex.
+//
+
+static PrefetchEntryType *FindPrefetchEntry(const FSSpec *spec)
+{
+	for (int i = 0; i < MAX_PREFETCH_FILES; i++)
+	{
+		PrefetchEntryType *entry = &gPrefetchEntries[i];
+
+		if (entry->status == PREFETCH_STATUS_FREE || entry->status == PREFETCH_STATUS_CANCELLED
+			|| entry->kind == PREFETCH_KIND_SUPERTILE)
+			continue;
+
+		if (entry->spec.vRefNum == spec->vRefNum
+			&& entry->spec.parID == spec->parID
+			&& SDL_strcmp(entry->spec.cName, spec->cName) == 0)
+		{
+			return entry;
+		}
+	}
+
+	return nil;
+}
+
+
+/*********************** FIND PREFETCHED SUPERTILE ****************************/
+//
+// Must hold gPrefetchMutex.
+//
+
+static PrefetchEntryType *FindPrefetchedSuperTile(const char *jpeg)
+{
+	for (int i = 0; i < MAX_PREFETCH_FILES; i++)
+	{
+		PrefetchEntryType *entry = &gPrefetchEntries[i];
+
+		if (entry->status != PREFETCH_STATUS_FREE && entry->status != PREFETCH_STATUS_CANCELLED
+			&& entry->kind == PREFETCH_KIND_SUPERTILE
+			&& entry->source == jpeg)
+		{
+			return entry;
+		}
+	}
+
+	return nil;
+}
+
+
+/*********************** GET FREE PREFETCH ENTRY ****************************/
+//
+// Must hold gPrefetchMutex.  Returns nil if the queue is full.
+//
+
+static PrefetchEntryType *GetFreePrefetchEntry(void)
+{
+	for (int i = 0; i < MAX_PREFETCH_FILES; i++)
+	{
+		if (gPrefetchEntries[i].status == PREFETCH_STATUS_FREE)
+			return &gPrefetchEntries[i];
+	}
+
+	return nil;
+}
+
+
+/*********************** PREFETCH FILE ****************************/
+//
+// Queues a file (colon path relative to the Data folder, like everywhere else)
+// for the worker thread.  Does nothing if the file doesn't exist, is already
+// queued, or if the queue is full -- the loader will just read it itself.
+//
+
+void PrefetchFile(const char *path, Byte kind)
+{
+FSSpec	spec;
+
+	if (!gPrefetchThread)
+		return;
+
+	if (FSMakeFSSpec(gDataSpec.vRefNum, gDataSpec.parID, path, &spec) != noErr)
+		return;
+
+	QueuePrefetchEntry(&spec, path, kind);
+}
+
+
+/*********************** PREFETCH IMAGE ****************************/
+//
+// Queues a sprite image for decoding: partialPath is what OGL_TextureMap_LoadImageFile
+// gets, i.e. without the .jpg/.png extension.  It's handed out by TakePrefetchedFile
+// for the .jpg (or the .png if there's no .jpg) as a PrefetchedImageHeader
+// followed by the RGBA pixels.
+//
+
+void PrefetchImage(const char *partialPath)
+{
+FSSpec	spec;
+char	path[256];
+
+	if (!gPrefetchThread)
+		return;
+
+	SDL_snprintf(path, sizeof(path), "%s.jpg", partialPath);
+	if (FSMakeFSSpec(gDataSpec.vRefNum, gDataSpec.parID, path, &spec) != noErr)
+	{
+		SDL_snprintf(path, sizeof(path), "%s.png", partialPath);
+		if (FSMakeFSSpec(gDataSpec.vRefNum, gDataSpec.parID, path, &spec) != noErr)
+			return;
+	}
+
+	QueuePrefetchEntry(&spec, partialPath, PREFETCH_KIND_IMAGE);
+}
+
+
+/*********************** QUEUE PREFETCH ENTRY ****************************/
+
+static void QueuePrefetchEntry(const FSSpec *spec, const char *path, Byte kind)
+{
+PrefetchEntryType	*entry = nil;
+
+	SDL_LockMutex(gPrefetchMutex);
+
+	if (!FindPrefetchEntry(spec))
+		entry = GetFreePrefetchEntry();
+
+	if (entry)
+	{
+		entry->status		= PREFETCH_STATUS_QUEUED;
+		entry->kind			= kind;
+		entry->ticket		= gPrefetchNextTicket++;
+		entry->spec			= *spec;
+		entry->source		= nil;
+		entry->sourceSize	= 0;
+		entry->data			= nil;
+		entry->size			= 0;
+
+				/* CONVERT ":Models:foo.bg3d" TO "<data folder>/Models/foo.bg3d" */
+
+		SDL_snprintf(entry->hostPath, sizeof(entry->hostPath), "%s/%s", gDataHostPath, path[0] == ':' ? path + 1 : path);
+		for (char *c = entry->hostPath + SDL_strlen(gDataHostPath); *c; c++)
+		{
+			if (*c == ':')
+				*c = '/';
+		}
+
+		SDL_BroadcastCondition(gPrefetchCondition);
+	}
+
+	SDL_UnlockMutex(gPrefetchMutex);
+}
+
+
+/*********************** PREFETCH SUPERTILE ****************************/
+//
+// Has the worker decode a supertile JPEG (see TryDecodeSuperTilePixelBuffer) before
+// LoadSuperTileTextures gets to it.  The data must stay put until it's been taken.
+// These go ahead of any queued files, because the main thread is about to wait for them.
+//
+
+void PrefetchSuperTile(const char *jpeg, long size)
+{
+PrefetchEntryType	*entry = nil;
+
+	if (!gPrefetchThread)
+		return;
+
+	SDL_LockMutex(gPrefetchMutex);
+
+	if (!FindPrefetchedSuperTile(jpeg))
+		entry = GetFreePrefetchEntry();
+
+	if (entry)
+	{
+		SDL_zerop(entry);
+		entry->status		= PREFETCH_STATUS_QUEUED;
+		entry->kind			= PREFETCH_KIND_SUPERTILE;
+		entry->ticket		= gPrefetchNextTicket++;
+		entry->source		= jpeg;
+		entry->sourceSize	= size;
+
+		SDL_BroadcastCondition(gPrefetchCondition);
+	}
+
+	SDL_UnlockMutex(gPrefetchMutex);
+}
+
+
+/*********************** TAKE PREFETCH ENTRY ****************************/
+//
+// Must hold gPrefetchMutex.  Waits for the worker to be done with the entry.
+//
+
+static Ptr TakePrefetchEntry(PrefetchEntryType *entry, long *outSize)
+{
+Ptr		data = nil;
+
+	while (entry->status == PREFETCH_STATUS_QUEUED || entry->status == PREFETCH_STATUS_LOADING)
+		SDL_WaitCondition(gPrefetchCondition, gPrefetchMutex);
+
+	if (entry->status == PREFETCH_STATUS_READY && gPrefetchShareTaken)
+	{
+		data = AllocPtr(entry->size);							// keep the original for the next taker
+		SDL_memcpy(data, entry->data, entry->size);
+		*outSize = entry->size;
+	}
+	else
+	{
+		if (entry->status == PREFETCH_STATUS_READY)
+		{
+			data = entry->data;
+			*outSize = entry->size;
+		}
+
+		entry->status	= PREFETCH_STATUS_FREE;
+		entry->data		= nil;
+		entry->size		= 0;
+	}
+
+	return data;
+}
+
+
+/*********************** TAKE PREFETCHED FILE ****************************/
+//
+// If spec was prefetched, waits for the worker to be done with it and returns
+// the file's contents; the caller owns the pointer from then on.
+// Returns nil if it was never requested or couldn't be read.
+//
+
+Ptr TakePrefetchedFile(const FSSpec *spec, long *outSize)
+{
+PrefetchEntryType	*entry;
+Ptr					data = nil;
+
+	if (!gPrefetchThread)
+		return nil;
+
+	SDL_LockMutex(gPrefetchMutex);
+
+	entry = FindPrefetchEntry(spec);
+	if (entry)
+		data = TakePrefetchEntry(entry, outSize);
+
+	SDL_UnlockMutex(gPrefetchMutex);
+
+	return data;
+}
+
+
+/*********************** TAKE PREFETCHED SUPERTILE ****************************/
+//
+// Returns the decoded pixels of a JPEG passed to PrefetchSuperTile, or nil if it
+// wasn't queued or won't decode (the caller then decodes it and reports the error).
+//
+
+Ptr TakePrefetchedSuperTile(const char *jpeg)
+{
+PrefetchEntryType	*entry;
+Ptr					data = nil;
+long				size = 0;
+
+	if (!gPrefetchThread)
+		return nil;
+
+	SDL_LockMutex(gPrefetchMutex);
+
+	entry = FindPrefetchedSuperTile(jpeg);
+	if (entry)
+		data = TakePrefetchEntry(entry, &size);
+
+	SDL_UnlockMutex(gPrefetchMutex);
+
+	return data;
+}
+
+
+/*********************** SHARE PREFETCHED FILES ****************************/
+//
+// While on, TakePrefetchedFile hands out copies and leaves the prefetched file
+// in place.  The level intro loads a few of the level's files; this keeps them
+// around for LoadLevelArt instead of reading & baking them all over again.
+//
+
+void SharePrefetchedFiles(Boolean share)
+{
+	if (!gPrefetchThread)
+		return;
+
+	SDL_LockMutex(gPrefetchMutex);
+	gPrefetchShareTaken = share;
+	SDL_UnlockMutex(gPrefetchMutex);
+}
+
+
+/*********************** FLUSH PREFETCHED FILES ****************************/
+//
+// Drops everything that hasn't been taken yet.
+// Doesn't wait: if the worker is in the middle of a file, it frees it when it's done.
+//
+
+void FlushPrefetchedFiles(void)
+{
+	if (!gPrefetchThread)
+		return;
+
+	SDL_LockMutex(gPrefetchMutex);
+
+	for (int i = 0; i < MAX_PREFETCH_FILES; i++)
+	{
+		PrefetchEntryType *entry = &gPrefetchEntries[i];
+
+		switch (entry->status)
+		{
+			case	PREFETCH_STATUS_LOADING:
+					entry->status = PREFETCH_STATUS_CANCELLED;
+					break;
+
+			case	PREFETCH_STATUS_READY:
+					SafeDisposePtr(entry->data);
+					entry->data = nil;
+					entry->status = PREFETCH_STATUS_FREE;
+					break;
+
+			case	PREFETCH_STATUS_QUEUED:
+			case	PREFETCH_STATUS_FAILED:
+					entry->status = PREFETCH_STATUS_FREE;
+					break;
+		}
+	}
+
+	SDL_UnlockMutex(gPrefetchMutex);
+}
+
+
+#pragma mark -
+
+
+/*********************** PREFETCH THREAD ****************************/
+
+static int SDLCALL PrefetchThread(void *unused)
+{
+	(void) unused;
+
+	SDL_LockMutex(gPrefetchMutex);
+
+	while (!gPrefetchQuit)
+	{
+		PrefetchEntryType	*entry = nil;
+		char				hostPath[sizeof(entry->hostPath)];
+		const char			*source;
+		long				sourceSize;
+		Byte				kind;
+		Ptr					data;
+		long				size = 0;
+
+				/* PICK THE OLDEST QUEUED SUPERTILE, OR ELSE THE OLDEST QUEUED FILE */
+
+		for (int i = 0; i < MAX_PREFETCH_FILES; i++)
+		{
+			PrefetchEntryType *candidate = &gPrefetchEntries[i];
+
+			if (candidate->status != PREFETCH_STATUS_QUEUED)
+				continue;
+
+			if (!entry)
+				entry = candidate;
+			else if ((candidate->kind == PREFETCH_KIND_SUPERTILE) != (entry->kind == PREFETCH_KIND_SUPERTILE))
+			{
+				if (candidate->kind == PREFETCH_KIND_SUPERTILE)				// the main thread is about to wait for it
+					entry = candidate;
+			}
+			else if (candidate->ticket < entry->ticket)
+				entry = candidate;
+		}
+
+		if (!entry)
+		{
+			SDL_WaitCondition(gPrefetchCondition, gPrefetchMutex);
+			continue;
+		}
+
+		entry->status = PREFETCH_STATUS_LOADING;
+		SDL_strlcpy(hostPath, entry->hostPath, sizeof(hostPath));
+		source = entry->source;
+		sourceSize = entry->sourceSize;
+		kind = entry->kind;
+
+
+				/* LOAD IT WITHOUT HOLDING THE LOCK */
+
+		SDL_UnlockMutex(gPrefetchMutex);
+
+		switch (kind)
+		{
+			case	PREFETCH_KIND_BG3D:
+					SetMemoryTag(MEMORY_TAG_MODELS);
+					data = ReadBG3DHostFile(hostPath, &size);
+					break;
+
+			case	PREFETCH_KIND_IMAGE:
+					SetMemoryTag(MEMORY_TAG_UI);
+					data = ReadImageHostFiles(hostPath, &size);
+					break;
+
+			case	PREFETCH_KIND_SUPERTILE:
+					SetMemoryTag(MEMORY_TAG_TERRAIN);
+					data = TryDecodeSuperTilePixelBuffer(source, (int) sourceSize);
+					size = SUPERTILE_TEXMAP_SIZE * SUPERTILE_TEXMAP_SIZE * 4;
+					break;
+
+			default:
+					SetMemoryTag(MEMORY_TAG_TERRAIN);				// raw files are playfields
+					data = ReadHostFile(hostPath, &size);
+					break;
+		}
+
+		SDL_LockMutex(gPrefetchMutex);
+
+
+				/* HAND IT OVER */
+
+		if (entry->status == PREFETCH_STATUS_CANCELLED)
+		{
+			SafeDisposePtr(data);
+			entry->status = PREFETCH_STATUS_FREE;
+		}
+		else
+		{
+			entry->data = data;
+			entry->size = size;
+			entry->status = data ? PREFETCH_STATUS_READY : PREFETCH_STATUS_FAILED;
+		}
+
+		SDL_BroadcastCondition(gPrefetchCondition);
+	}
+
+	SDL_UnlockMutex(gPrefetchMutex);
+
+	return 0;
+}
+
+
+/*********************** READ HOST FILE ****************************/
+
+static Ptr ReadHostFile(const char *hostPath, long *outSize)
+{
+SDL_IOStream	*io;
+Sint64			size;
+Ptr				data = nil;
+
+	io = SDL_IOFromFile(hostPath, "rb");
+	if (!io)
+		return nil;
+
+	size = SDL_GetIOSize(io);
+	if (size > 0 && size <= 0x7FFFFFFF)
+	{
+		data = TryAllocPtr((long) size);
+		if (data && SDL_ReadIO(io, data, (size_t) size) != (size_t) size)
+		{
+			SafeDisposePtr(data);
+			data = nil;
+		}
+	}
+
+	SDL_CloseIO(io);
+
+	*outSize = (long) size;
+	return data;
+}
+
+
+/*********************** READ BG3D HOST FILE ****************************/
+//
+// Returns foo.bg3dc for foo.bg3d if it was baked from this exact file,
+// otherwise bakes foo.bg3d right here.  Nil if it can't be read or won't bake.
+//
+
+static Ptr ReadBG3DHostFile(const char *hostPath, long *outSize)
+{
+char			bakedPath[MAX_HOST_PATH + 1];
+Ptr				source;
+Ptr				baked;
+long			sourceSize = 0;
+long			bakedSize = 0;
+
+	source = ReadHostFile(hostPath, &sourceSize);
+	if (!source)
+		return nil;
+
+	SDL_snprintf(bakedPath, sizeof(bakedPath), "%sc", hostPath);
+
+	baked = ReadHostFile(bakedPath, &bakedSize);
+	if (baked && !IsBakedBG3DImageUpToDate(baked, bakedSize, source, sourceSize))
+	{
+		SafeDisposePtr(baked);
+		baked = nil;
+	}
+
+	if (!baked)
+		baked = BakeBG3DImage(source, sourceSize, &bakedSize);		// nil if it's damaged
+
+	SafeDisposePtr(source);
+
+	*outSize = bakedSize;
+	return baked;
+}
+
+
+/*********************** READ IMAGE HOST FILES ****************************/
+//
+// Does what OGL_TextureMap_LoadImageFile does before uploading: decodes foo.jpg,
+// and applies foo.png to it as an alpha mask (or decodes foo.png on its own if
+// there's no foo.jpg).  Nil if neither can be read, or if they won't decode or
+// don't match; the main thread then loads them itself and reports the error.
+//
+
+static Ptr ReadImageHostFiles(const char *hostPath, long *outSize)
+{
+char					path[MAX_HOST_PATH + 5];
+Ptr						jpgData, pngData;
+long					jpgSize = 0;
+long					pngSize = 0;
+uint8_t					*colorPixels = nil;
+int						width = 0;
+int						height = 0;
+Ptr						image = nil;
+PrefetchedImageHeader	header = { .sourceKey = HASH_BYTES_SEED };
+
+	SDL_snprintf(path, sizeof(path), "%s.jpg", hostPath);
+	jpgData = ReadHostFile(path, &jpgSize);
+
+	SDL_snprintf(path, sizeof(path), "%s.png", hostPath);
+	pngData = ReadHostFile(path, &pngSize);
+
+
+			/* COLORS FROM THE JPEG */
+
+	if (jpgData)
+	{
+		header.sourceKey = HashBytes(header.sourceKey, jpgData, jpgSize);
+
+		colorPixels = (uint8_t *) stbi_load_from_memory((const stbi_uc *) jpgData, (int) jpgSize, &width, &height, NULL, 4);
+		if (!colorPixels)
+			goto bail;
+	}
+
+
+			/* THE PNG IS EITHER THE ALPHA MASK OR THE WHOLE IMAGE */
+
+	if (pngData)
+	{
+		header.sourceKey = HashBytes(header.sourceKey, pngData, pngSize);
+		header.hasAlpha = 1;
+
+		if (!colorPixels)
+		{
+			colorPixels = (uint8_t *) stbi_load_from_memory((const stbi_uc *) pngData, (int) pngSize, &width, &height, NULL, 4);
+			if (!colorPixels)
+				goto bail;
+		}
+		else
+		{
+			int		alphaWidth = 0;
+			int		alphaHeight = 0;
+			uint8_t	*alphaPixels = (uint8_t *) stbi_load_from_memory((const stbi_uc *) pngData, (int) pngSize, &alphaWidth, &alphaHeight, NULL, 1);
+
+			if (!alphaPixels || alphaWidth != width || alphaHeight != height)
+			{
+				SafeDisposePtr(alphaPixels);
+				goto bail;
+			}
+
+			for (int a = 0, c = 3; a < width * height; a++, c += 4)
+				colorPixels[c] = alphaPixels[a];
+
+			SafeDisposePtr(alphaPixels);
+		}
+	}
+
+	if (!colorPixels)
+		goto bail;
+
+
+			/* HEADER + PIXELS IN ONE BLOCK */
+
+	header.width = width;
+	header.height = height;
+
+	*outSize = (long) sizeof(header) + width * height * 4;
+	image = TryAllocPtr(*outSize);
+	if (image)
+	{
+		SDL_memcpy(image, &header, sizeof(header));
+		SDL_memcpy(image + sizeof(header), colorPixels, width * height * 4);
+	}
+
+bail:
+	SafeDisposePtr(colorPixels);
+	SafeDisposePtr(jpgData);
+	SafeDisposePtr(pngData);
+
+	return image;
+}
@@ -0,0 +1,378 @@
+/****************************/
+/*      REPLAY.C            */
+/****************************/
+
+//
+// Input recording & playback, for repeatable benchmark runs.
+//
+// --record <file> captures the gameplay needs of every player on every simulation
+// tick of the next level that's played, along with the random seed the level was
+// started with.  --replay <file> jumps straight into that level with the same seed
+// and feeds the recorded ticks back through SetInputFrame, one tick per drawn
+// frame and with no frame rate limiting, then reports how long it took.
+// --headless hides the window and skips drawing during the replay, which
+// measures the simulation alone.
+//
+// Both modes run the fixed timestep and play the game from the frame rather than
+// from the devices, so the game sees exactly the same input either way.  The random
+// generator is set aside while drawing, since some draw code rolls dice too.
+//
+// File layout (little-endian):
+//		header		magic, version, tick rate, level, #players, vs mode,
+//					players & needs per frame, seed
+//		runs		repeat count (1..255) followed by one frame:
+//					need states, analog values (0..255), mouse delta x & y (floats)
+//
+
+/***************/
+/* EXTERNALS   */
+/***************/
+
+#include "game.h"
+
+
+/****************************/
+/*    PROTOTYPES            */
+/****************************/
+
+static void WriteReplayRun(void);
+static Boolean ReadReplayRun(void);
+
+
+/****************************/
+/*    CONSTANTS             */
+/****************************/
+
+#define	MAX_REPLAY_RUN_LENGTH	255
+
+enum
+{
+	REPLAY_MODE_NONE,
+	REPLAY_MODE_RECORD,
+	REPLAY_MODE_PLAYBACK,
+};
+
+typedef struct
+{
+	uint32_t	magic;
+	uint16_t	version;
+	uint16_t	tickRate;
+	uint16_t	levelNum;
+	uint8_t		numPlayers;
+	uint8_t		vsMode;
+	uint8_t		playersPerFrame;
+	uint8_t		needsPerFrame;
+	uint32_t	seed;
+}ReplayHeaderType;
+
+
+/**********************/
+/*     VARIABLES      */
+/**********************/
+
+static Byte					gReplayMode = REPLAY_MODE_NONE;
+static SDL_IOStream			*gReplayFile = nil;
+static ReplayHeaderType		gReplayHeader;
+
+static InputFrame			gReplayFrame;					// what the game is playing from this tick
+static InputFrame			gReplayRunFrame;				// recording: the frame being repeated
+static int					gReplayRunLength = 0;			// recording: # of ticks in the current run; playback: # of ticks left in it
+
+static uint32_t				gReplayTicks = 0;
+static Uint64				gReplayStartTime = 0;
+
+
+/********************** OPEN INPUT REPLAY **************************/
+//
+// Called once at boot.  With --replay, reads the file's header and
+// points --level at the recorded level so that GameMain jumps straight into it.
+//
+
+void OpenInputReplay(void)
+{
+	gReplayMode = REPLAY_MODE_NONE;
+
+	if (gCmdReplayPath[0] != '\0')
+	{
+		ReplayHeaderType	*h = &gReplayHeader;
+		Boolean				ok;
+
+		if (gCmdRecordPath[0] != '\0')
+			SDL_Log("%s: --replay given, ignoring --record", __func__);
+
+		gReplayFile = SDL_IOFromFile(gCmdReplayPath, "rb");
+		if (!gReplayFile)
+			DoFatalAlert("Couldn't open replay file %s: %s", gCmdReplayPath, SDL_GetError());
+
+		ok = SDL_ReadU32LE(gReplayFile, &h->magic)
+			&& SDL_ReadU16LE(gReplayFile, &h->version)
+			&& SDL_ReadU16LE(gReplayFile, &h->tickRate)
+			&& SDL_ReadU16LE(gReplayFile, &h->levelNum)
+			&& SDL_ReadU8(gReplayFile, &h->numPlayers)
+			&& SDL_ReadU8(gReplayFile, &h->vsMode)
+			&& SDL_ReadU8(gReplayFile, &h->playersPerFrame)
+			&& SDL_ReadU8(gReplayFile, &h->needsPerFrame)
+			&& SDL_ReadU32LE(gReplayFile, &h->seed);
+
+		if (!ok || h->magic != REPLAY_FILE_MAGIC || h->version != REPLAY_FILE_VERSION)
+			DoFatalAlert("%s isn't a replay file from this version of the game.", gCmdReplayPath);
+
+		if (h->tickRate != SIMULATION_TICK_RATE
+			|| h->playersPerFrame != MAX_PLAYERS
+			|| h->needsPerFrame != NUM_REMAPPABLE_NEEDS
+			|| h->levelNum >= NUM_LEVELS
+			|| h->numPlayers < 1 || h->numPlayers > MAX_PLAYERS)
+		{
+			DoFatalAlert("%s was recorded with incompatible settings.", gCmdReplayPath);
+		}
+
+		gCmdLevelNum = h->levelNum;
+		gReplayMode = REPLAY_MODE_PLAYBACK;
+	}
+	else
+	if (gCmdRecordPath[0] != '\0')
+	{
+		gReplayMode = REPLAY_MODE_RECORD;					// the file is created when the level starts
+	}
+}
+
+
+/********************** APPLY INPUT REPLAY SETUP **************************/
+//
+// Call after GameMain has set up its defaults for a directly-loaded level:
+// a replay puts back the player count & versus mode it was recorded with.
+//
+
+void ApplyInputReplaySetup(void)
+{
+	if (gReplayMode != REPLAY_MODE_PLAYBACK)
+		return;
+
+	gNumPlayers = gReplayHeader.numPlayers;
+	gVSMode = gReplayHeader.vsMode;
+}
+
+
+/********************** BEGIN INPUT REPLAY LEVEL **************************/
+//
+// Call at the very start of InitLevel, before anything rolls the dice.
+// Seeds the random generator and, when recording, writes the file header.
+//
+
+void BeginInputReplayLevel(void)
+{
+	gReplayTicks = 0;
+	gReplayStartTime = 0;
+	gReplayRunLength = 0;
+
+	switch (gReplayMode)
+	{
+		case	REPLAY_MODE_RECORD:
+		{
+			ReplayHeaderType	*h = &gReplayHeader;
+			Boolean				ok;
+
+			gReplayFile = SDL_IOFromFile(gCmdRecordPath, "wb");
+			if (!gReplayFile)
+			{
+				SDL_Log("%s: couldn't create %s: %s", __func__, gCmdRecordPath, SDL_GetError());
+				gReplayMode = REPLAY_MODE_NONE;
+				return;
+			}
+
+			h->magic			= REPLAY_FILE_MAGIC;
+			h->version			= REPLAY_FILE_VERSION;
+			h->tickRate			= SIMULATION_TICK_RATE;
+			h->levelNum			= gLevelNum;
+			h->numPlayers		= gNumPlayers;
+			h->vsMode			= gVSMode;
+			h->playersPerFrame	= MAX_PLAYERS;
+			h->needsPerFrame	= NUM_REMAPPABLE_NEEDS;
+			h->seed				= MyRandomLong();
+
+			ok = SDL_WriteU32LE(gReplayFile, h->magic)
+				&& SDL_WriteU16LE(gReplayFile, h->version)
+				&& SDL_WriteU16LE(gReplayFile, h->tickRate)
+				&& SDL_WriteU16LE(gReplayFile, h->levelNum)
+				&& SDL_WriteU8(gReplayFile, h->numPlayers)
+				&& SDL_WriteU8(gReplayFile, h->vsMode)
+				&& SDL_WriteU8(gReplayFile, h->playersPerFrame)
+				&& SDL_WriteU8(gReplayFile, h->needsPerFrame)
+				&& SDL_WriteU32LE(gReplayFile, h->seed);
+
+			if (!ok)
+				SDL_Log("%s: couldn't write %s: %s", __func__, gCmdRecordPath, SDL_GetError());
+
+			SetMyRandomSeed(h->seed);
+			SetInputFrame(&gReplayFrame);
+			break;
+		}
+
+		case	REPLAY_MODE_PLAYBACK:
+			SetMyRandomSeed(gReplayHeader.seed);
+			SetInputFrame(&gReplayFrame);
+			break;
+	}
+}
+
+
+/********************** UPDATE INPUT REPLAY **************************/
+//
+// Call once per simulation tick, right after DoSDLMaintenance.
+// Returns false once a replay has run out of recorded ticks.
+//
+
+Boolean UpdateInputReplay(void)
+{
+	switch (gReplayMode)
+	{
+		case	REPLAY_MODE_RECORD:
+				CaptureInputFrame(&gReplayFrame);
+
+				if (gReplayRunLength > 0
+					&& (gReplayRunLength == MAX_REPLAY_RUN_LENGTH
+						|| SDL_memcmp(&gReplayFrame, &gReplayRunFrame, sizeof(InputFrame)) != 0))
+				{
+					WriteReplayRun();
+				}
+
+				gReplayRunFrame = gReplayFrame;
+				gReplayRunLength++;
+				break;
+
+		case	REPLAY_MODE_PLAYBACK:
+				if (gReplayStartTime == 0)
+					gReplayStartTime = SDL_GetTicksNS();
+
+				if (gReplayRunLength == 0 && !ReadReplayRun())
+					return false;
+
+				gReplayRunLength--;
+				break;
+
+		default:
+				return true;
+	}
+
+	gReplayTicks++;
+	return true;
+}
+
+
+/********************** END INPUT REPLAY LEVEL **************************/
+//
+// Call when the level's main loop is done.  Closes the file
+// (only one level is recorded or replayed per run) and, after a replay,
+// reports the timing.
+//
+
+void EndInputReplayLevel(void)
+{
+	switch (gReplayMode)
+	{
+		case	REPLAY_MODE_RECORD:
+				if (gReplayRunLength > 0)
+					WriteReplayRun();
+				SDL_Log("Recorded %u ticks of level %d to %s", gReplayTicks, gLevelNum, gCmdRecordPath);
+				break;
+
+		case	REPLAY_MODE_PLAYBACK:
+		{
+			double	seconds = (SDL_GetTicksNS() - gReplayStartTime) * 1e-9;
+
+			if (gReplayTicks == 0 || seconds <= 0)
+				break;
+
+			SDL_Log("Replayed %u ticks of level %d in %.3f s%s: %.1f ticks/s, %.3f ms/tick",
+					gReplayTicks, gLevelNum, seconds,
+					gCmdHeadless ? " (headless)" : "",
+					gReplayTicks / seconds,
+					seconds * 1000.0 / gReplayTicks);
+			break;
+		}
+
+		default:
+				return;
+	}
+
+	if (gReplayFile)
+	{
+		SDL_CloseIO(gReplayFile);
+		gReplayFile = nil;
+	}
+
+	SetInputFrame(nil);
+	gReplayMode = REPLAY_MODE_NONE;
+}
+
+
+/********************** IS INPUT REPLAY ACTIVE **************************/
+//
+// True while a level is being recorded or replayed.
+//
+
+Boolean IsInputReplayActive(void)
+{
+	return gReplayMode != REPLAY_MODE_NONE && gReplayFile != nil;
+}
+
+
+/********************** IS REPLAYING INPUT **************************/
+
+Boolean IsReplayingInput(void)
+{
+	return gReplayMode == REPLAY_MODE_PLAYBACK && gReplayFile != nil;
+}
+
+
+#pragma mark -
+
+
+/********************** WRITE REPLAY RUN **************************/
+
+static void WriteReplayRun(void)
+{
+const InputFrame	*frame = &gReplayRunFrame;
+Boolean				ok;
+uint32_t			mouseX, mouseY;
+
+	SDL_memcpy(&mouseX, &frame->mouseDelta.x, sizeof(mouseX));
+	SDL_memcpy(&mouseY, &frame->mouseDelta.y, sizeof(mouseY));
+
+	ok = SDL_WriteU8(gReplayFile, (Uint8) gReplayRunLength)
+		&& SDL_WriteIO(gReplayFile, frame->needStates, sizeof(frame->needStates)) == sizeof(frame->needStates)
+		&& SDL_WriteIO(gReplayFile, frame->needAnalog, sizeof(frame->needAnalog)) == sizeof(frame->needAnalog)
+		&& SDL_WriteU32LE(gReplayFile, mouseX)
+		&& SDL_WriteU32LE(gReplayFile, mouseY);
+
+	if (!ok)
+		SDL_Log("%s: couldn't write %s: %s", __func__, gCmdRecordPath, SDL_GetError());
+
+	gReplayRunLength = 0;
+}
+
+
+/********************** READ REPLAY RUN **************************/
+
+static Boolean ReadReplayRun(void)
+{
+InputFrame	*frame = &gReplayFrame;
+Uint8		runLength;
+uint32_t	mouseX, mouseY;
+
+	if (!SDL_ReadU8(gReplayFile, &runLength)
+		|| runLength == 0
+		|| SDL_ReadIO(gReplayFile, frame->needStates, sizeof(frame->needStates)) != sizeof(frame->needStates)
+		|| SDL_ReadIO(gReplayFile, frame->needAnalog, sizeof(frame->needAnalog)) != sizeof(frame->needAnalog)
+		|| !SDL_ReadU32LE(gReplayFile, &mouseX)
+		|| !SDL_ReadU32LE(gReplayFile, &mouseY))
+	{
+		return false;												// end of the recording
+	}
+
+	SDL_memcpy(&frame->mouseDelta.x, &mouseX, sizeof(mouseX));
+	SDL_memcpy(&frame->mouseDelta.y, &mouseY, sizeof(mouseY));
+
+	gReplayRunLength = runLength;
+	return true;
+}
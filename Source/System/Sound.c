@@ -18,6 +18,7 @@
 /****************************/
 
 static short FindSilentChannel(void);
+static void DecodeLazyEffect(short effectNum);
 static void Calc3DEffectVolume(short effectNum, OGLPoint3D *where, float volAdjust, uint32_t *leftVolOut, uint32_t *rightVolOut);
 
 
@@ -35,12 +36,21 @@ static void Calc3DEffectVolume(short effectNum, OGLPoint3D *where, float volAdju
 #define		FULL_SONG_VOLUME		1.0f
 #define		FULL_EFFECTS_VOLUME		1.0f
 
+#define		LAZY_DECODE_RARE_EFFECTS		1					// keep EFFECT_FLAG_LAZY effects compressed until they're played
+#define		DECODED_LAZY_EFFECTS_BUDGET		(320 * 1024)		// max bytes of decoded lazy effects kept around: RocketLaunch (~280K decoded) fits, but not with PlaneCrash (~130K)
+
+
+enum
+{
+	EFFECT_FLAG_LAZY	= 1 << 0,		// rarely played: decode on first use instead of at bank load
+};
 
 typedef struct
 {
 	uint8_t			bank;
 	const char*		name;
 	float			refVol;
+	uint8_t			flags;
 }EffectType;
 
 typedef struct
@@ -70,6 +80,12 @@ static	OGLVector3D			gEyeVector[MAX_PLAYERS];
 static	SndListHandle		gSndHandles[MAX_EFFECTS];		// handles to ALL sounds
 static  long				gSndOffsets[MAX_EFFECTS];
 
+static	SndListHandle		gSndCompressedHandles[MAX_EFFECTS];	// lazy effects: still-compressed copy to decode from
+static	long				gSndCompressedOffsets[MAX_EFFECTS];
+static	uint32_t			gSndLastUsed[MAX_EFFECTS];			// lazy effects: LRU stamp
+static	uint32_t			gSndUseCounter = 0;
+static	long				gDecodedLazyEffectsBytes = 0;
+
 static	SndChannelPtr		gSndChannel[MAX_CHANNELS];
 ChannelInfoType				gChannelInfo[MAX_CHANNELS];
 static	SndChannelPtr		gMusicChannel;
@@ -104,10 +120,10 @@ static const EffectType gEffectsTable[NUM_EFFECTS] =
 	[EFFECT_IMPACTSIZZLE   ] = {SOUND_BANK_MAIN, "ImpactSizzle",	1},
 	[EFFECT_SHIELD         ] = {SOUND_BANK_MAIN, "Shield",			1},
 	[EFFECT_MINEEXPLODE    ] = {SOUND_BANK_MAIN, "MineExplode",		3},
-	[EFFECT_PLANECRASH     ] = {SOUND_BANK_MAIN, "PlaneCrash",		1},
+	[EFFECT_PLANECRASH     ] = {SOUND_BANK_MAIN, "PlaneCrash",		1, EFFECT_FLAG_LAZY},
 	[EFFECT_TURRETFIRE     ] = {SOUND_BANK_MAIN, "TurretFire",		.6f},
 	[EFFECT_STUNGUN        ] = {SOUND_BANK_MAIN, "StunGun",			.7f},
-	[EFFECT_ROCKETLAUNCH   ] = {SOUND_BANK_MAIN, "RocketLaunch",	1},		// unused?
+	[EFFECT_ROCKETLAUNCH   ] = {SOUND_BANK_MAIN, "RocketLaunch",	1, EFFECT_FLAG_LAZY},		// unused?
 	[EFFECT_WEAPONCHARGE   ] = {SOUND_BANK_MAIN, "WeaponCharge",	1},
 	[EFFECT_FLARESHOOT     ] = {SOUND_BANK_MAIN, "FlareShoot",		1},
 	[EFFECT_CHANGEWEAPON   ] = {SOUND_BANK_MAIN, "ChangeWeapon",	1},
@@ -260,6 +276,13 @@ void ShutdownSound(void)
 #pragma mark -
 
 /******************* LOAD SOUND BANK ************************/
+//
+// Everything is decompressed by the time this returns, except effects
+// marked EFFECT_FLAG_LAZY, which are left compressed; see DecodeLazyEffect.
+//
+// The decompression stays on this thread: Pomme_DecompressSoundResource
+// allocates and frees Pomme handles, which isn't safe to do from two threads.
+//
 
 void LoadSoundBank(uint8_t bank)
 {
@@ -324,13 +347,101 @@ void LoadSoundBank(uint8_t bank)
 
 		GetSoundHeaderOffset(gSndHandles[i], &gSndOffsets[i]);
 
-				/* PRE-DECOMPRESS IT */
+				/* CLOSE DATA FORK */
+
+		FSClose(refNum);
+
+				/* PRE-DECOMPRESS IT, OR KEEP IT COMPRESSED FOR LATER */
+
+#if LAZY_DECODE_RARE_EFFECTS
+		if (effectDef->flags & EFFECT_FLAG_LAZY)
+		{
+			gSndCompressedHandles[i] = gSndHandles[i];
+			gSndCompressedOffsets[i] = gSndOffsets[i];
+			gSndHandles[i] = nil;
+			gSndOffsets[i] = 0;
+			continue;
+		}
+#endif
 
 		Pomme_DecompressSoundResource(&gSndHandles[i], &gSndOffsets[i]);
+	}
 
-				/* CLOSE DATA FORK */
+			/* ACCOUNT FOR THE SOUND DATA */
 
-		FSClose(refNum);
+	for (int i = 0; i < NUM_EFFECTS; i++)
+	{
+		if (gEffectsTable[i].bank == bank)
+		{
+			CountHandleMemory(MEMORY_TAG_SOUND, (Handle) gSndHandles[i], true);
+			CountHandleMemory(MEMORY_TAG_SOUND, (Handle) gSndCompressedHandles[i], true);
+		}
+	}
+}
+
+
+/******************* DECODE LAZY EFFECT ************************/
+//
+// Called by PlayEffect the first time a lazy effect is played (or the first time
+// since it got evicted).  Decodes a copy of the compressed sound, then evicts the
+// least recently played decoded lazy effects until we're back under budget.
+// An effect that's still playing on a channel is never evicted.
+//
+
+static void DecodeLazyEffect(short effectNum)
+{
+SndListHandle	compressed = gSndCompressedHandles[effectNum];
+Size			size;
+
+	GAME_ASSERT_MESSAGE(compressed, "sound effect wasn't loaded!");
+
+			/* DECODE A COPY -- THE DECOMPRESSOR CONSUMES ITS INPUT */
+
+	size = GetHandleSize((Handle) compressed);
+	gSndHandles[effectNum] = (SndListHandle) NewHandle(size);
+	GAME_ASSERT(gSndHandles[effectNum]);
+	SDL_memcpy(*gSndHandles[effectNum], *compressed, size);
+
+	gSndOffsets[effectNum] = gSndCompressedOffsets[effectNum];
+	Pomme_DecompressSoundResource(&gSndHandles[effectNum], &gSndOffsets[effectNum]);
+
+	gDecodedLazyEffectsBytes += GetHandleSize((Handle) gSndHandles[effectNum]);
+	CountHandleMemory(MEMORY_TAG_SOUND, (Handle) gSndHandles[effectNum], true);
+
+
+			/* EVICT LEAST RECENTLY USED */
+
+	while (gDecodedLazyEffectsBytes > DECODED_LAZY_EFFECTS_BUDGET)
+	{
+		short victim = -1;
+
+		for (int i = 0; i < MAX_EFFECTS; i++)
+		{
+			if (i == effectNum || !gSndCompressedHandles[i] || !gSndHandles[i])
+				continue;
+
+			Boolean inUse = false;
+			for (int c = 0; c < gMaxChannels; c++)
+			{
+				if (gChannelInfo[c].effectNum == i && IsEffectChannelPlaying(c))
+				{
+					inUse = true;
+					break;
+				}
+			}
+
+			if (!inUse && (victim == -1 || gSndLastUsed[i] < gSndLastUsed[victim]))
+				victim = i;
+		}
+
+		if (victim == -1)										// everything else is playing, go over budget for now
+			break;
+
+		gDecodedLazyEffectsBytes -= GetHandleSize((Handle) gSndHandles[victim]);
+		CountHandleMemory(MEMORY_TAG_SOUND, (Handle) gSndHandles[victim], false);
+		DisposeHandle((Handle) gSndHandles[victim]);
+		gSndHandles[victim] = nil;
+		gSndOffsets[victim] = 0;
 	}
 }
 
@@ -349,11 +460,23 @@ void DisposeSoundBank(uint8_t bank)
 		{
 			if (gSndHandles[i])
 			{
+				if (gSndCompressedHandles[i])						// it's a decoded lazy effect
+					gDecodedLazyEffectsBytes -= GetHandleSize((Handle) gSndHandles[i]);
+
+				CountHandleMemory(MEMORY_TAG_SOUND, (Handle) gSndHandles[i], false);
 				DisposeHandle((Handle) gSndHandles[i]);
 			}
 
+			if (gSndCompressedHandles[i])
+			{
+				CountHandleMemory(MEMORY_TAG_SOUND, (Handle) gSndCompressedHandles[i], false);
+				DisposeHandle((Handle) gSndCompressedHandles[i]);
+			}
+
 			gSndHandles[i] = nil;
 			gSndOffsets[i] = 0;
+			gSndCompressedHandles[i] = nil;
+			gSndCompressedOffsets[i] = 0;
 		}
 	}
 }
@@ -867,6 +990,14 @@ SoundHeaderPtr   sndPtr;
 
 	GAME_ASSERT(effectNum >= 0);
 	GAME_ASSERT(effectNum < MAX_EFFECTS);
+
+	if (gSndCompressedHandles[effectNum])					// lazy effect: make sure it's decoded & bump it in the LRU
+	{
+		gSndLastUsed[effectNum] = ++gSndUseCounter;
+		if (!gSndHandles[effectNum])
+			DecodeLazyEffect(effectNum);
+	}
+
 	GAME_ASSERT_MESSAGE(gSndHandles[effectNum], "sound effect wasn't loaded!");
 
 			/* LOOK FOR FREE CHANNEL */
@@ -5,8 +5,8 @@
 #define STBI_ONLY_JPEG
 #define STBI_ONLY_PNG
 #define STBI_ASSERT GAME_ASSERT
-#define STBI_MALLOC AllocPtr
-#define STBI_REALLOC ReallocPtr
+#define STBI_MALLOC TryAllocPtr			// stb_image reports running out of memory itself, and it runs on the prefetch thread
+#define STBI_REALLOC TryReallocPtr
 #define STBI_FREE SafeDisposePtr
 
 #include "stb_image.h"
@@ -383,7 +383,7 @@ int		f;
 		gFenceList[f].sectionNormals = nil;
 
 		if (gFenceList[f].nubList)
-			SafeDisposePtr((Ptr)gFenceList[f].nubList);
+			SafeDisposePlayfieldPtr(gFenceList[f].nubList);
 		gFenceList[f].nubList = nil;
 	}
 
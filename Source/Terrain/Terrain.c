@@ -44,6 +44,9 @@ Boolean			gDisableHiccupTimer = false;
 
 SuperTileStatus	**gSuperTileStatusGrid = nil;				// supertile status grid
 
+SuperTileHeightRange	**gSuperTileHeightRanges = nil;		// min/max y of each supertile (see CalculateSuperTileHeightRanges)
+float			gTerrainMinY = 0, gTerrainMaxY = 0;			// min/max y of the whole heightfield
+
 
 
 long			gTerrainTileWidth,gTerrainTileDepth;			// width & depth of terrain in tiles
@@ -204,7 +207,7 @@ void InitSuperTileGrid(void)
 {
 int		r,c;
 
-	Alloc_2d_array(SuperTileStatus, gSuperTileStatusGrid, gNumSuperTilesDeep, gNumSuperTilesWide);	// alloc 2D grid array
+	Alloc_Level_2d_array(SuperTileStatus, gSuperTileStatusGrid, gNumSuperTilesDeep, gNumSuperTilesWide);	// alloc 2D grid array
 
 
 			/* INIT ALL GRID SLOTS TO EMPTY AND UNUSED */
@@ -250,7 +253,7 @@ int	i;
 
 	if (gSuperTileTextureGrid)
 	{
-		Free_2d_array(gSuperTileTextureGrid);
+		Free_Playfield_2d_array(gSuperTileTextureGrid);
 		gSuperTileTextureGrid = nil;
 	}
 
@@ -268,19 +271,19 @@ int	i;
 
 	if (gMasterItemList)
 	{
-		SafeDisposePtr(gMasterItemList);
+		SafeDisposePlayfieldPtr(gMasterItemList);
 		gMasterItemList = nil;
 	}
 
 	if (gMapYCoords)
 	{
-		Free_2d_array(gMapYCoords);
+		Free_Playfield_2d_array(gMapYCoords);
 		gMapYCoords = nil;
 	}
 
 	if (gMapYCoordsOriginal)
 	{
-		Free_2d_array(gMapYCoordsOriginal);
+		Free_Playfield_2d_array(gMapYCoordsOriginal);
 		gMapYCoordsOriginal = nil;
 	}
 
@@ -290,14 +293,20 @@ int	i;
 		gMapSplitMode = nil;
 	}
 
+	if (gSuperTileHeightRanges)
+	{
+		Free_2d_array(gSuperTileHeightRanges);
+		gSuperTileHeightRanges = nil;
+	}
+
 			/* NUKE SPLINE DATA */
 
 	if (gSplineList)
 	{
 		for (i = 0; i < gNumSplines; i++)
 		{
-			SafeDisposePtr(gSplineList[i].pointList);		// nuke point list
-			SafeDisposePtr(gSplineList[i].itemList);		// nuke item list
+			SafeDisposePlayfieldPtr(gSplineList[i].pointList);		// nuke point list
+			SafeDisposePlayfieldPtr(gSplineList[i].itemList);		// nuke item list
 		}
 		SafeDisposePtr(gSplineList);
 		gSplineList = nil;
@@ -305,20 +314,14 @@ int	i;
 
 				/* NUKE WATER PATCH */
 
-	if (gWaterListHandle)
-	{
-		DisposeHandle((Handle)gWaterListHandle);
-		gWaterListHandle = nil;
-	}
-
-	gWaterList = nil;
-	gNumWaterPatches = 0;
+	DisposeWater();
 	gNumSuperTilesDeep = gNumSuperTilesWide = 0;
 
 	ReleaseAllSuperTiles();
 
 	DisposeFences();
 
+	DisposeCompiledPlayfield();						// nothing points into it anymore
 }
 
 
@@ -845,8 +848,14 @@ OGLVector3D			*vertexNormals;
 
 
 			/* WE'VE MODIFIED DATA IN THE VERTEX ARRAY RANGE, SO FORCE AN UPDATE */
+			//
+			// Only this supertile's arrays need to be sent to the terrain's vertex buffer.
+			//
 
-	OGL_SetVertexArrayRangeDirty(VERTEX_ARRAY_RANGE_TYPE_TERRAIN);
+	OGL_SetVertexArrayMemoryDirty(vertexPointList, sizeof(OGLPoint3D) * NUM_VERTICES_IN_SUPERTILE, VERTEX_ARRAY_RANGE_TYPE_TERRAIN);
+	OGL_SetVertexArrayMemoryDirty(vertexNormals, sizeof(OGLVector3D) * NUM_VERTICES_IN_SUPERTILE, VERTEX_ARRAY_RANGE_TYPE_TERRAIN);
+	OGL_SetVertexArrayMemoryDirty(vertexColorList, sizeof(OGLColorRGBA) * NUM_VERTICES_IN_SUPERTILE, VERTEX_ARRAY_RANGE_TYPE_TERRAIN);
+	OGL_SetVertexArrayMemoryDirty(triangleList, sizeof(MOTriangleIndecies) * NUM_TRIS_IN_SUPERTILE, VERTEX_ARRAY_RANGE_TYPE_TERRAIN);
 
 	return(superTileNum);
 }
@@ -1229,6 +1238,105 @@ float				xi,zi;
 }
 
 
+/***************** GET TERRAIN HEIGHT: BATCH ******************/
+//
+// Same as GetTerrainY, but for a whole list of x/z coords at once.  The heightfield
+// is read straight out of the row-major storage behind gMapYCoords, and each triangle's
+// height is evaluated from its slopes instead of building a plane equation per query.
+//
+// Unlike GetTerrainY, this does NOT touch gRecentTerrainNormal.  Pass a normals array
+// if you need them, otherwise nil.  Coords off the map get y=0 and a straight-up normal.
+//
+
+void GetTerrainYBatch(int numQueries, const OGLPoint2D *where, float *outY, OGLVector3D *outNormals)
+{
+const float	*yCoords;
+const Byte	*splitModes;
+long		rowStride;
+float		size = gTerrainPolygonSize;
+float		sizeFrac = gTerrainPolygonSizeFrac;
+
+	if (!gMapYCoords)												// make sure there's a terrain
+	{
+		for (int i = 0; i < numQueries; i++)
+		{
+			outY[i] = ILLEGAL_TERRAIN_Y;
+			if (outNormals)
+				outNormals[i] = (OGLVector3D) {0,1,0};
+		}
+		return;
+	}
+
+	yCoords		= gMapYCoords[0];									// 2D arrays are contiguous, so index them flat
+	splitModes	= gMapSplitMode[0];
+	rowStride	= gTerrainTileWidth + 1;
+
+	for (int i = 0; i < numQueries; i++)
+	{
+		float	x = where[i].x;
+		float	z = where[i].y;
+		int		col = x * sizeFrac;									// see which tile row/col we're on
+		int		row = z * sizeFrac;
+		float	xi,zi,y0,y1,y2,y3,dydx,dydz,y;
+
+		if ((col < 0) || (col >= gTerrainTileWidth) || (row < 0) || (row >= gTerrainTileDepth))
+		{
+			outY[i] = 0;
+			if (outNormals)
+				outNormals[i] = (OGLVector3D) {0,1,0};
+			continue;
+		}
+
+		xi = x - (float)(col * gTerrainPolygonSizeInt);				// calc x/z offset into the tile
+		zi = z - (float)(row * gTerrainPolygonSizeInt);
+
+		const float *farRow = &yCoords[row * rowStride + col];
+		const float *nearRow = farRow + rowStride;
+		y0 = farRow[0];												// far left
+		y1 = farRow[1];												// far right
+		y2 = nearRow[1];											// near right
+		y3 = nearRow[0];											// near left
+
+				/* GET SLOPES OF THE TRIANGLE WE'RE ON */
+
+		if (splitModes[row * gTerrainTileWidth + col] == SPLIT_BACKWARD)	// if \ split
+		{
+			if (xi < zi)											// left triangle
+			{
+				dydx = (y2 - y3) * sizeFrac;
+				dydz = (y3 - y0) * sizeFrac;
+			}
+			else													// right triangle
+			{
+				dydx = (y1 - y0) * sizeFrac;
+				dydz = (y2 - y1) * sizeFrac;
+			}
+			y = y0 + dydx * xi + dydz * zi;
+		}
+		else														// otherwise, / split
+		{
+			if ((size - xi) > zi)									// left triangle
+			{
+				dydx = (y1 - y0) * sizeFrac;
+				dydz = (y3 - y0) * sizeFrac;
+				y = y0 + dydx * xi + dydz * zi;
+			}
+			else													// right triangle
+			{
+				dydx = (y2 - y3) * sizeFrac;
+				dydz = (y2 - y1) * sizeFrac;
+				y = y1 + dydx * (xi - size) + dydz * zi;
+			}
+		}
+
+		outY[i] = y;
+
+		if (outNormals)
+			FastNormalizeVector(-dydx, 1.0f, -dydz, &outNormals[i]);
+	}
+}
+
+
 
 
 
@@ -1667,7 +1775,7 @@ void CalculateSplitModeMatrix(void)
 int		row,col;
 float	y0,y1,y2,y3;
 
-	Alloc_2d_array(Byte, gMapSplitMode, gTerrainTileDepth, gTerrainTileWidth);	// alloc 2D array
+	Alloc_Level_2d_array(Byte, gMapSplitMode, gTerrainTileDepth, gTerrainTileWidth);	// alloc 2D array
 
 	for (row = 0; row < gTerrainTileDepth; row++)
 	{
@@ -1701,6 +1809,60 @@ float	y0,y1,y2,y3;
 }
 
 
+/*************** CALCULATE SUPERTILE HEIGHT RANGES ***********************/
+//
+// Finds the lowest & highest heightfield vertex under every supertile so the
+// terrain picking code can skip supertiles that a line passes over or under.
+// The grid is rounded up so that it covers every tile even if the map
+// isn't a multiple of SUPERTILE_SIZE.
+//
+
+void CalculateSuperTileHeightRanges(void)
+{
+long	numWide = (gTerrainTileWidth + SUPERTILE_SIZE - 1) / SUPERTILE_SIZE;
+long	numDeep = (gTerrainTileDepth + SUPERTILE_SIZE - 1) / SUPERTILE_SIZE;
+
+	Alloc_Level_2d_array(SuperTileHeightRange, gSuperTileHeightRanges, numDeep, numWide);
+
+	gTerrainMinY = 10000000;
+	gTerrainMaxY = -gTerrainMinY;
+
+	for (long superRow = 0; superRow < numDeep; superRow++)
+	{
+		for (long superCol = 0; superCol < numWide; superCol++)
+		{
+			long	startRow = superRow * SUPERTILE_SIZE;
+			long	startCol = superCol * SUPERTILE_SIZE;
+			long	endRow = SDL_min(startRow + SUPERTILE_SIZE, gTerrainTileDepth);		// inclusive: the far edge vertices belong to the tiles too
+			long	endCol = SDL_min(startCol + SUPERTILE_SIZE, gTerrainTileWidth);
+			float	miny = 10000000;
+			float	maxy = -miny;
+
+			for (long row = startRow; row <= endRow; row++)
+			{
+				for (long col = startCol; col <= endCol; col++)
+				{
+					float y = gMapYCoords[row][col];
+
+					if (y < miny)
+						miny = y;
+					if (y > maxy)
+						maxy = y;
+				}
+			}
+
+			gSuperTileHeightRanges[superRow][superCol].minY = miny;
+			gSuperTileHeightRanges[superRow][superCol].maxY = maxy;
+
+			if (miny < gTerrainMinY)
+				gTerrainMinY = miny;
+			if (maxy > gTerrainMaxY)
+				gTerrainMaxY = maxy;
+		}
+	}
+}
+
+
 
 
 
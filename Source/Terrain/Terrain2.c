@@ -16,12 +16,31 @@
 
 static Boolean NilAdd(TerrainItemEntryType *itemPtr,float x, float z);
 static void FindPlayerStartCoordItems(void);
+static float GetItemShadowHeight(uint16_t type);
+static void ItemShadowBandsJob(void *unused);
+static void CastItemShadowsOnRows(long firstRow, long endRow);
+static uint64_t HashItemShadowInputs(void);
+static Boolean LoadItemShadowCache(const char *cacheName, uint64_t key);
+static void SaveItemShadowCache(const char *cacheName, uint64_t key);
 
 
 /****************************/
 /*    CONSTANTS             */
 /****************************/
 
+#define	ITEM_SHADOW_SHADE_FACTOR	.7f
+#define	ITEM_SHADOW_BAND_ROWS		16					// rows of the shading grid per unit of bake work
+
+#define	ITEM_SHADOW_CACHE_MAGIC		'ISH1'				// bump when the bake changes
+
+typedef struct
+{
+	uint32_t	magic;
+	int32_t		depth;
+	int32_t		width;
+	uint32_t	unused;
+	uint64_t	key;									// followed by one bit per vertex of gVertexShading, row by row
+}ItemShadowCacheHeader;
 
 
 /**********************/
@@ -40,6 +59,11 @@ SuperTileItemIndexType	**gSuperTileItemIndexGrid = nil;
 int						gNumLineMarkers;
 LineMarkerDefType		gLineMarkerList[MAX_LINEMARKERS];
 
+static OGLVector2D		gShadowLightVector;				// item shadow bake: main light direction on the ground
+static float			gShadowLightDot;				//   and how far it throws the shadows
+static int				gNumItemShadowBands;
+static SDL_AtomicInt	gNextItemShadowBand;
+
 
 /**********************/
 /*     TABLES         */
@@ -118,7 +142,7 @@ int						total;
 
 			/* ALLOC MEMORY FOR SUPERTILE ITEM INDEX GRID */
 
-	Alloc_2d_array(SuperTileItemIndexType, gSuperTileItemIndexGrid, gNumSuperTilesDeep, gNumSuperTilesWide);
+	Alloc_Level_2d_array(SuperTileItemIndexType, gSuperTileItemIndexGrid, gNumSuperTilesDeep, gNumSuperTilesWide);
 
 	if (gNumTerrainItems == 0)
 		DoFatalAlert("BuildTerrainItemList: there must be at least 1 terrain item!");
@@ -126,7 +150,7 @@ int						total;
 
 			/* ALLOC MEMORY FOR NEW LIST */
 
-	tempItemList = (TerrainItemEntryType *) AllocPtrClear(sizeof(TerrainItemEntryType) * gNumTerrainItems);
+	tempItemList = (TerrainItemEntryType *) AllocLevelPtrClear(sizeof(TerrainItemEntryType) * gNumTerrainItems);
 	if (tempItemList == nil)
 		DoFatalAlert("BuildTerrainItemList: AllocPtr failed!");
 
@@ -184,7 +208,7 @@ int						total;
 
 		/* NUKE THE ORIGINAL ITEM LIST AND REASSIGN TO THE NEW SORTED LIST */
 
-	SafeDisposePtr(gMasterItemList);						// nuke old list
+	SafeDisposePlayfieldPtr(gMasterItemList);				// nuke old list
 	gMasterItemList = tempItemList;							// reassign
 
 
@@ -297,6 +321,8 @@ Boolean			flag;
 		if (flag)
 			itemPtr[i].flags |= ITEM_FLAGS_INUSE;				// set in-use flag
 	}
+
+	BuildPendingFoliage();										// bake any foliage the items just added
 }
 
 
@@ -368,15 +394,14 @@ int			row,col;
 void RotateOnTerrain(ObjNode *theNode, float yOffset, OGLVector3D *surfaceNormal)
 {
 OGLVector3D		up;
-float			r,x,z,y;
+float			r,x,z;
 OGLPoint3D		to;
-OGLMatrix4x4	*m,m2;
 
 			/* GET CENTER Y COORD & TERRAIN NORMAL */
 
 	x = theNode->Coord.x;
 	z = theNode->Coord.z;
-	y = theNode->Coord.y = GetTerrainY(x, z) + yOffset;
+	theNode->Coord.y = GetTerrainY(x, z) + yOffset;
 
 	if (surfaceNormal)
 		up = *surfaceNormal;
@@ -391,18 +416,33 @@ OGLMatrix4x4	*m,m2;
 	to.z = z + cos(r) * -30.0f;
 	to.y = GetTerrainY(to.x, to.z) + yOffset;
 
+	SetTerrainAlignedMatrix(theNode, &up, &to);
+}
+
+
+/*********************** SET TERRAIN ALIGNED MATRIX ***************************/
+//
+// Builds the object's transform from its Coord & Scale, tilted to the given up vector
+// and aimed at the "to" point.  This is the second half of RotateOnTerrain, split out
+// so that callers who already have the terrain heights & normal (i.e. from
+// GetTerrainYBatch) don't need to query the terrain again.
+//
+
+void SetTerrainAlignedMatrix(ObjNode *theNode, const OGLVector3D *up, const OGLPoint3D *to)
+{
+OGLMatrix4x4	*m,m2;
 
 			/* CREATE THE MATRIX */
 
 	m = &theNode->BaseTransformMatrix;
-	SetLookAtMatrix(m, &up, &theNode->Coord, &to);
+	SetLookAtMatrix(m, up, &theNode->Coord, to);
 
 
 		/* POP IN THE TRANSLATE INTO THE MATRIX */
 
-	m->value[M03] = x;
-	m->value[M13] = y;
-	m->value[M23] = z;
+	m->value[M03] = theNode->Coord.x;
+	m->value[M13] = theNode->Coord.y;
+	m->value[M23] = theNode->Coord.z;
 
 
 			/* SET SCALE */
@@ -570,77 +610,146 @@ static OGLPoint3D	p4 = {0,0,0};
 // Scans thru item list and casts a shadown onto the terrain
 // by darkening the vertex colors of the terrain.
 //
+// The result only depends on the trees in the item list, the main light and the
+// map size, so it's cached in the prefs folder per .ter file and only baked again
+// when one of those changes.  The bake is split into bands of rows which the job
+// thread and the main thread take turns grabbing.
+//
 
-void DoItemShadowCasting(void)
+void DoItemShadowCasting(const char *terrainName)
 {
-long				i;
 static OGLVector3D up = {0,1,0};
-float				height,dot,length;
-OGLVector2D			lightVector;
-OGLPoint2D			from,to;
-float				x,z,t;
 long				row,col;
-Byte				**shadowFlags;
-float				shadeFactor;
-
-	shadeFactor = .7;
+uint64_t			key;
+char				cacheName[256];
+uint32_t			ticket;
+Uint64				startTime;
 
 				/* INIT SHADING GRID */
 
-	Alloc_2d_array(float, gVertexShading, gTerrainTileDepth+1, gTerrainTileWidth+1);	// alloc 2D array for map
+	Alloc_Level_2d_array(float, gVertexShading, gTerrainTileDepth+1, gTerrainTileWidth+1);	// alloc 2D array for map
 	for (row = 0; row <= gTerrainTileDepth; row++)
 		for (col = 0; col <= gTerrainTileWidth; col++)
 			gVertexShading[row][col] = 1.0;
 
 
-			/* INIT SHADOW FLAGS TEMP BUFFER */
+			/* GET MAIN LIGHT VECTOR INFO */
 
-	Alloc_2d_array(Byte, shadowFlags, gTerrainTileDepth+1, gTerrainTileWidth+1);
+	gShadowLightVector.x = gGameViewInfoPtr->lightList.fillDirection[0].x;
+	gShadowLightVector.y = gGameViewInfoPtr->lightList.fillDirection[0].z;
+	OGLVector2D_Normalize(&gShadowLightVector, &gShadowLightVector);
 
-	for (row = 0; row <= gTerrainTileDepth; row++)
-		for (col = 0; col <= gTerrainTileWidth; col++)
-			shadowFlags[row][col] = 0;
+	gShadowLightDot = OGLVector3D_Dot(&up, &gGameViewInfoPtr->lightList.fillDirection[0]);
+	gShadowLightDot = 1.0f - gShadowLightDot;
 
 
-			/* GET MAIN LIGHT VECTOR INFO */
+			/* SEE IF WE'VE ALREADY BAKED THIS */
 
-	lightVector.x = gGameViewInfoPtr->lightList.fillDirection[0].x;
-	lightVector.y = gGameViewInfoPtr->lightList.fillDirection[0].z;
-	OGLVector2D_Normalize(&lightVector, &lightVector);
+	key = HashItemShadowInputs();
+	SDL_snprintf(cacheName, sizeof(cacheName), "ItemShadows %s", terrainName);
 
-	dot = OGLVector3D_Dot(&up, &gGameViewInfoPtr->lightList.fillDirection[0]);
-	dot = 1.0f - dot;
+	if (LoadItemShadowCache(cacheName, key))
+		return;
 
-			/***********************/
-			/* SCAN THRU ITEM LIST */
-			/***********************/
 
-	for (i = 0; i < gNumTerrainItems; i++)
+			/***************************/
+			/* BAKE IT ON BOTH THREADS */
+			/***************************/
+
+	startTime = SDL_GetTicksNS();
+
+	gNumItemShadowBands = (gTerrainTileDepth + ITEM_SHADOW_BAND_ROWS - 1) / ITEM_SHADOW_BAND_ROWS;
+	SDL_SetAtomicInt(&gNextItemShadowBand, 0);
+
+	ticket = KickJob(ItemShadowBandsJob, nil);
+	ItemShadowBandsJob(nil);
+	WaitForJob(ticket);
+
+	SDL_Log("%s: baked %s in %d ms", __func__, terrainName, (int) ((SDL_GetTicksNS() - startTime) / 1000000));
+
+	SaveItemShadowCache(cacheName, key);
+}
+
+
+/****************** GET ITEM SHADOW HEIGHT **********************/
+//
+// Returns 0 for items that don't cast a shadow onto the terrain.
+//
+
+static float GetItemShadowHeight(uint16_t type)
+{
+	switch(type)
 	{
-			/* SEE WHICH THINGS WE SUPPORT & GET PARMS */
+		case	1:						// birch
+				return 1000;
 
-		switch(gMasterItemList[i].type)
-		{
-			case	1:						// birch
-					height = 1000;
-					break;
+		case	2:						// pine
+				return 1000;
 
-			case	2:						// pine
-					height = 1000;
-					break;
+		default:
+				return 0;
+	}
+}
 
 
-			default:
-					continue;
-		}
+/****************** ITEM SHADOW BANDS JOB **********************/
+//
+// Takes bands of rows off the shared counter until there are none left.
+// Each band only writes its own rows of gVertexShading.
+//
+
+static void ItemShadowBandsJob(void *unused)
+{
+	(void) unused;
+
+	while (1)
+	{
+		int band = SDL_AddAtomicInt(&gNextItemShadowBand, 1);
+		if (band >= gNumItemShadowBands)
+			break;
+
+		CastItemShadowsOnRows(band * ITEM_SHADOW_BAND_ROWS,
+							SDL_min((band + 1) * ITEM_SHADOW_BAND_ROWS, gTerrainTileDepth));
+	}
+}
+
+
+/****************** CAST ITEM SHADOWS ON ROWS **********************/
+//
+// Shades the vertices in rows firstRow..endRow-1 that lie under any item's shadow line.
+// Shading is all-or-nothing, so the bands come out the same no matter which thread does what.
+//
+
+static void CastItemShadowsOnRows(long firstRow, long endRow)
+{
+long				i;
+float				height,length;
+OGLPoint2D			from,to;
+float				x,z,t;
+long				row,col;
+
+	for (i = 0; i < gNumTerrainItems; i++)
+	{
+			/* SEE WHICH THINGS WE SUPPORT & GET PARMS */
+
+		height = GetItemShadowHeight(gMasterItemList[i].type);
+		if (height <= 0.0f)
+			continue;
 
 			/* CALCULATE LINE TO DRAW SHADOW ALONG */
 
 		from.x = gMasterItemList[i].x;
 		from.y = gMasterItemList[i].y;
 
-		to.x = from.x + lightVector.x * (height * dot);
-		to.y = from.y + lightVector.y * (height * dot);
+		to.x = from.x + gShadowLightVector.x * (height * gShadowLightDot);
+		to.y = from.y + gShadowLightVector.y * (height * gShadowLightDot);
+
+			/* SKIP IT IF THE LINE DOESN'T CROSS THIS BAND */
+
+		if ((SDL_max(from.y, to.y) / gTerrainPolygonSize + 1.0f) < firstRow)
+			continue;
+		if ((SDL_min(from.y, to.y) / gTerrainPolygonSize - 1.0f) >= endRow)
+			continue;
 
 		length = OGLPoint2D_Distance(&from, &to);
 
@@ -664,28 +773,137 @@ float				shadeFactor;
 					row = z / gTerrainPolygonSize + ro;			// calc row/col
 					col = x / gTerrainPolygonSize + co;
 
-					if ((row < 0) || (col < 0))						// check for out of bounds
+					if ((row < firstRow) || (col < 0))				// check for out of bounds
 						continue;
-					if ((row >= gTerrainTileDepth) || (col >= gTerrainTileWidth))
+					if ((row >= endRow) || (col >= gTerrainTileWidth))
 						continue;
 
-					if (shadowFlags[row][col])						// see if this already shadowed
-						continue;
+					gVertexShading[row][col] = ITEM_SHADOW_SHADE_FACTOR;	// set shading
+
+				}// co
+			} // ro
+		}
+	}
+}
 
-					shadowFlags[row][col] = 1;						// set flag
 
+#pragma mark -
 
-					gVertexShading[row][col] = shadeFactor;			// set shading
 
-				}// co
-			} // ro
+/****************** HASH ITEM SHADOW INPUTS **********************/
+//
+// HashBytes over everything the bake depends on.
+//
+
+static uint64_t HashItemShadowInputs(void)
+{
+uint64_t	hash = HASH_BYTES_SEED;
+int32_t		dims[2] = { (int32_t) gTerrainTileDepth, (int32_t) gTerrainTileWidth };
+float		light[4] = { gTerrainPolygonSize, gShadowLightVector.x, gShadowLightVector.y, gShadowLightDot };
+
+	hash = HashBytes(hash, dims, sizeof(dims));
+	hash = HashBytes(hash, light, sizeof(light));
+
+	for (long i = 0; i < gNumTerrainItems; i++)
+	{
+		if (GetItemShadowHeight(gMasterItemList[i].type) <= 0.0f)
+			continue;
+
+		hash = HashBytes(hash, &gMasterItemList[i].x, sizeof(gMasterItemList[i].x));
+		hash = HashBytes(hash, &gMasterItemList[i].y, sizeof(gMasterItemList[i].y));
+		hash = HashBytes(hash, &gMasterItemList[i].type, sizeof(gMasterItemList[i].type));
+	}
+
+	return hash;
+}
+
+
+/****************** LOAD ITEM SHADOW CACHE **********************/
+//
+// Fills gVertexShading from the cache file if it was baked from the same inputs.
+//
+
+static Boolean LoadItemShadowCache(const char *cacheName, uint64_t key)
+{
+Ptr			cache;
+long		cacheSize = 0;
+long		numVertices = (gTerrainTileDepth+1) * (gTerrainTileWidth+1);
+Boolean		ok;
+
+	cache = LoadUserDataBlob(cacheName, &cacheSize);
+	if (!cache)
+		return false;
+
+	{
+		const ItemShadowCacheHeader	*header = (const ItemShadowCacheHeader *) cache;
+		const uint8_t				*bits = (const uint8_t *) (header + 1);
+
+		ok = cacheSize == (long) sizeof(*header) + (numVertices + 7) / 8
+			&& header->magic == ITEM_SHADOW_CACHE_MAGIC
+			&& header->depth == gTerrainTileDepth
+			&& header->width == gTerrainTileWidth
+			&& header->key == key;
+
+		if (ok)
+		{
+			long	v = 0;
+
+			for (long row = 0; row <= gTerrainTileDepth; row++)
+			{
+				for (long col = 0; col <= gTerrainTileWidth; col++, v++)
+				{
+					if (bits[v >> 3] & (1 << (v & 7)))
+						gVertexShading[row][col] = ITEM_SHADOW_SHADE_FACTOR;
+				}
+			}
 		}
 	}
 
+	SafeDisposePtr(cache);
+
+	if (!ok)
+		SDL_Log("%s: ignoring stale cache %s", __func__, cacheName);
+
+	return ok;
+}
+
+
+/****************** SAVE ITEM SHADOW CACHE **********************/
+//
+// One bit per vertex of gVertexShading, set where it's shaded.
+//
+
+static void SaveItemShadowCache(const char *cacheName, uint64_t key)
+{
+long					numVertices = (gTerrainTileDepth+1) * (gTerrainTileWidth+1);
+long					cacheSize = sizeof(ItemShadowCacheHeader) + (numVertices + 7) / 8;
+Ptr						cache;
+ItemShadowCacheHeader	*header;
+uint8_t					*bits;
+long					v = 0;
+
+	cache = AllocPtrClear(cacheSize);
+	header = (ItemShadowCacheHeader *) cache;
+	bits = (uint8_t *) (header + 1);
+
+	header->magic	= ITEM_SHADOW_CACHE_MAGIC;
+	header->depth	= (int32_t) gTerrainTileDepth;
+	header->width	= (int32_t) gTerrainTileWidth;
+	header->key		= key;
+
+	for (long row = 0; row <= gTerrainTileDepth; row++)
+	{
+		for (long col = 0; col <= gTerrainTileWidth; col++, v++)
+		{
+			if (gVertexShading[row][col] < 1.0f)
+				bits[v >> 3] |= 1 << (v & 7);
+		}
+	}
 
-			/* CLEANUP */
+	if (SaveUserDataBlob(cacheName, cache, cacheSize) != noErr)
+		SDL_Log("%s: couldn't write %s", __func__, cacheName);
 
-	Free_2d_array(shadowFlags);
+	SafeDisposePtr(cache);
 }
 
 
@@ -18,8 +18,10 @@
 static void MoveWater(ObjNode *theNode);
 static void DrawWater(ObjNode *theNode);
 static void MakeWaterGeometry(void);
+static void DisposeWaterGeometry(void);
 
 static void InitRipples(void);
+static int NewRipple(void);
 static void DrawRipples(ObjNode *theNode);
 static void MoveRippleEvent(ObjNode *theNode);
 
@@ -36,9 +38,8 @@ static void MoveRippleEvent(ObjNode *theNode);
 
 typedef struct
 {
-	Boolean		isUsed;
 	OGLPoint3D	coord;
-	float		alpha, fadeRate;
+	float		alpha, fadeRate;						// faded out when alpha <= 0
 	float		scale,scaleSpeed;
 }RippleType;
 
@@ -57,15 +58,21 @@ WaterDefType	*gWaterList;
 static float					gWaterInitY[MAX_WATER];
 
 
-typedef struct				// we group all the vertex arrays into a stuct so that we can easily allocate it to the Vertex Array Range engine
-{
-	MOTriangleIndecies		triangles[MAX_WATER][MAX_NUBS_IN_WATER*2];
-	OGLPoint3D				points[MAX_WATER][MAX_NUBS_IN_WATER*2];
-	OGLTextureCoord			uvs1[MAX_WATER][MAX_NUBS_IN_WATER*2];
-	OGLTextureCoord			uvs2[MAX_WATER][MAX_NUBS_IN_WATER*2];
-}WaterVertexArraysType;
+		/* GEOMETRY */
+		//
+		// All of the patches share one set of static vertex arrays in the terrain's VAR memory,
+		// sorted by water type so that the visible patches of a type can be drawn
+		// together.  Each patch's gWaterTriMeshData points at its own run of triangles
+		// (whose indices are into the shared point list), which is also what picking uses.
+		//
+
+static OGLPoint3D				*gWaterPoints = nil;
+static OGLTextureCoord			*gWaterVertexUVs[2] = {nil, nil};
+static MOTriangleIndecies		*gWaterTriangles = nil;
+
+static short					gWaterDrawOrder[MAX_WATER];				// patch #'s sorted by type
+static short					gWaterTypeFirst[NUM_WATER_TYPES+1];		// where each type starts in gWaterDrawOrder
 
-static WaterVertexArraysType	gWaterVertexArrays;
 MOVertexArrayData				gWaterTriMeshData[MAX_WATER];
 
 OGLBoundingBox					gWaterBBox[MAX_WATER];
@@ -78,12 +85,23 @@ static OGLTextureCoord	gWaterUVs[NUM_WATER_TYPES][2];			// [2] is for the two la
 
 
 		/* RIPPLES */
-
-static	int			gNumRipples;
+		//
+		// The ripples are a ring buffer, oldest first.  They mostly live about as long
+		// as each other, so faded ones are dropped from the front; if it fills up, the
+		// oldest ripple is recycled.  They're all drawn as one vertex array.
+		//
+
+static	int			gFirstRipple;									// index of the oldest ripple
+static	int			gNumRipples;									// # from there on, including any that already faded
 static	ObjNode		*gRippleEventObj = nil;
 
 static	RippleType	gRippleList[MAX_RIPPLES];
 
+static	OGLPoint3D			gRipplePoints[MAX_RIPPLES*4];
+static	OGLColorRGBA		gRippleColors[MAX_RIPPLES*4];
+static	OGLTextureCoord		gRippleUVs[MAX_RIPPLES*4];				// same for every quad
+static	MOTriangleIndecies	gRippleTriangles[MAX_RIPPLES*2];
+
 
 
 
@@ -149,12 +167,14 @@ static const float	gWaterFixedYCoord[] =
 
 void DisposeWater(void)
 {
+	DisposeWaterGeometry();
 
-	if (!gWaterListHandle)
-		return;
+	if (gWaterListHandle)
+	{
+		DisposeHandle((Handle)gWaterListHandle);
+		gWaterListHandle = nil;
+	}
 
-	DisposeHandle((Handle)gWaterListHandle);
-	gWaterListHandle = nil;
 	gWaterList = nil;
 	gNumWaterPatches = 0;
 }
@@ -171,7 +191,7 @@ void PrimeTerrainWater(void)
 long					f,i,numNubs;
 OGLPoint2D				*nubs;
 ObjNode					*obj;
-float					y,centerX,centerZ;
+float					y;
 
 	InitRipples();
 
@@ -247,29 +267,6 @@ float					y,centerX,centerZ;
 		}
 
 		gWaterInitY[f] = y;									// save water's y coord
-
-
-		for (i = 0; i < numNubs; i++)
-		{
-			gWaterVertexArrays.points[f][i].x = nubs[i].x;
-			gWaterVertexArrays.points[f][i].y = y;
-			gWaterVertexArrays.points[f][i].z = nubs[i].y;
-		}
-
-			/* APPEND THE CENTER POINT TO THE POINT LIST */
-
-		centerX = centerZ = 0;											// calc average of points
-		for (i = 0; i < numNubs; i++)
-		{
-			centerX += gWaterVertexArrays.points[f][i].x;
-			centerZ += gWaterVertexArrays.points[f][i].z;
-		}
-		centerX /= (float)numNubs;
-		centerZ /= (float)numNubs;
-
-		gWaterVertexArrays.points[f][numNubs].x = centerX;
-		gWaterVertexArrays.points[f][numNubs].z = centerZ;
-		gWaterVertexArrays.points[f][numNubs].y = y;
 	}
 
 			/***********************/
@@ -294,68 +291,120 @@ float					y,centerX,centerZ;
 	};
 
 	obj = MakeNewObject(&def);
-	obj->VertexArrayMode = VERTEX_ARRAY_RANGE_TYPE_USER_WATER;
-
-
-#if VERTEXARRAYRANGES
-			/* ASSIGN MEMORY TO VERTEX ARRAY RANGE */
-			//
-			// Each double-buffer of fence geometry gets its own VAR range type
-			//
-
-	AssignVertexArrayRangeMemory(sizeof(WaterVertexArraysType), &gWaterVertexArrays, VERTEX_ARRAY_RANGE_TYPE_USER_WATER);
-#endif
+	obj->VertexArrayMode = VERTEX_ARRAY_RANGE_TYPE_TERRAIN;
 }
 
 
 /*************** MAKE WATER GEOMETRY *********************/
+//
+// Builds every patch into the shared vertex arrays, grouped by water type.
+// Each patch is a fan around the center of its nubs.
+//
 
 static void MakeWaterGeometry(void)
 {
-int						f;
-uint16_t					type, numNubs;
+int						f,n,type;
+int						numPoints, numTriangles;
+uint16_t				numNubs;
 short					i;
 WaterDefType			*water;
 float					minX,minY,minZ,maxX,maxY,maxZ;
 double					x,y,z;
-MOMaterialObject	*mat;
+MOMaterialObject		*mat;
+OGLPoint3D				*points;
+OGLTextureCoord			*uvs1, *uvs2;
+MOTriangleIndecies		*triangles;
 
-	for (f = 0; f < gNumWaterPatches; f++)
+			/************************/
+			/* SORT PATCHES BY TYPE */
+			/************************/
+
+	numPoints = numTriangles = 0;
+
+	for (type = 0, n = 0; type < NUM_WATER_TYPES; type++)
+	{
+		gWaterTypeFirst[type] = n;
+
+		for (f = 0; f < gNumWaterPatches; f++)
+		{
+			if (gWaterList[f].type != type)
+				continue;
+
+			numNubs = gWaterList[f].numNubs;			// note:  this is the # from the file, not including the center point we add below!
+			if (numNubs < 3)
+				DoFatalAlert("MakeWaterGeometry: numNubs < 3");
+
+			gWaterDrawOrder[n++] = f;
+			numPoints += numNubs + 1;
+			numTriangles += numNubs;
+		}
+	}
+	gWaterTypeFirst[NUM_WATER_TYPES] = n;
+
+	if (n != gNumWaterPatches)
+		DoFatalAlert("MakeWaterGeometry: illegal water type");
+
+	if (n == 0)											// no water on this level
+		return;
+
+
+			/**************************/
+			/* ALLOCATE SHARED ARRAYS */
+			/**************************/
+
+	gWaterPoints		= OGL_AllocVertexArrayMemory(sizeof(OGLPoint3D) * numPoints, VERTEX_ARRAY_RANGE_TYPE_TERRAIN);
+	gWaterVertexUVs[0]	= OGL_AllocVertexArrayMemory(sizeof(OGLTextureCoord) * numPoints, VERTEX_ARRAY_RANGE_TYPE_TERRAIN);
+	gWaterVertexUVs[1]	= OGL_AllocVertexArrayMemory(sizeof(OGLTextureCoord) * numPoints, VERTEX_ARRAY_RANGE_TYPE_TERRAIN);
+	gWaterTriangles		= OGL_AllocVertexArrayMemory(sizeof(MOTriangleIndecies) * numTriangles, VERTEX_ARRAY_RANGE_TYPE_TERRAIN);
+
+
+			/********************/
+			/* BUILD EACH PATCH */
+			/********************/
+
+	points		= gWaterPoints;
+	uvs1		= gWaterVertexUVs[0];
+	uvs2		= gWaterVertexUVs[1];
+	triangles	= gWaterTriangles;
+
+	for (n = 0; n < gNumWaterPatches; n++)
 	{
+		int		firstPoint = points - gWaterPoints;
+		float	centerX, centerZ;
+
 				/* GET WATER INFO */
 
+		f = gWaterDrawOrder[n];
 		water = &gWaterList[f];								// point to this water
-		numNubs = water->numNubs;							// get # nubs in water (note:  this is the # from the file, not including the extra center point we added earlier!)
-		if (numNubs < 3)
-			DoFatalAlert("MakeWaterGeometry: numNubs < 3");
+		numNubs = water->numNubs;							// get # nubs in water
 		type = water->type;									// get water type
 
 
-					/***************************/
-					/* SET VERTEX ARRAY HEADER */
-					/***************************/
+				/* SET POINTS & APPEND THE CENTER POINT */
 
-		gWaterTriMeshData[f].VARtype					= VERTEX_ARRAY_RANGE_TYPE_USER_WATER;
-		gWaterTriMeshData[f].points 					= &gWaterVertexArrays.points[f][0];
-		gWaterTriMeshData[f].triangles					= &gWaterVertexArrays.triangles[f][0];
-		gWaterTriMeshData[f].uvs[0]						= &gWaterVertexArrays.uvs1[f][0];
-		gWaterTriMeshData[f].uvs[1]						= &gWaterVertexArrays.uvs2[f][0];
-		gWaterTriMeshData[f].normals					= nil;
-		gWaterTriMeshData[f].colorsFloat				= nil;
-		gWaterTriMeshData[f].numPoints 					= numNubs+1;					// +1 is to include the extra center point
-		gWaterTriMeshData[f].numTriangles 				= numNubs;
+		centerX = centerZ = 0;
+		for (i = 0; i < numNubs; i++)
+		{
+			points[i].x = water->nubList[i].x;
+			points[i].y = gWaterInitY[f];
+			points[i].z = water->nubList[i].y;
+
+			centerX += points[i].x;							// calc average of points
+			centerZ += points[i].z;
+		}
+
+		points[numNubs].x = centerX / (float)numNubs;
+		points[numNubs].y = gWaterInitY[f];
+		points[numNubs].z = centerZ / (float)numNubs;
 
 
 				/* BUILD TRIANGLE INFO */
 
-		for (i = 0; i < gWaterTriMeshData[f].numTriangles; i++)
+		for (i = 0; i < numNubs; i++)
 		{
-			gWaterVertexArrays.triangles[f][i].vertexIndices[0] = numNubs;							// vertex 0 is always the radial center that we appended to the end of the list
-			gWaterVertexArrays.triangles[f][i].vertexIndices[1] = i + 0;
-			gWaterVertexArrays.triangles[f][i].vertexIndices[2] = i + 1;
-
-			if (gWaterVertexArrays.triangles[f][i].vertexIndices[2] == numNubs)						// check for wrap back
-				 gWaterVertexArrays.triangles[f][i].vertexIndices[2] = 0;
+			triangles[i].vertexIndices[0] = firstPoint + numNubs;					// vertex 0 is always the radial center that we appended to the end of the list
+			triangles[i].vertexIndices[1] = firstPoint + i;
+			triangles[i].vertexIndices[2] = firstPoint + ((i + 1 == numNubs) ? 0 : i + 1);	// check for wrap back
 		}
 
 
@@ -363,14 +412,28 @@ MOMaterialObject	*mat;
 
 		mat = gSpriteGroupList[SPRITE_GROUP_GLOBAL][gWaterTextureType[type]].materialObject;		// get material obj
 
-		gWaterTriMeshData[f].numMaterials	= 2;
-		gWaterTriMeshData[f].materials[0] 	= 														// set illegal ref to material
-		gWaterTriMeshData[f].materials[1] 	= mat;
-
 		mat->objectData.flags |= BG3D_MATERIALFLAG_MULTITEXTURE;									// set flags for multi-texture
 		mat->objectData.multiTextureCombine	= MULTI_TEXTURE_COMBINE_MODULATE;							// set combining mode
 
 
+					/***************************/
+					/* SET VERTEX ARRAY HEADER */
+					/***************************/
+
+		gWaterTriMeshData[f].VARtype			= VERTEX_ARRAY_RANGE_TYPE_TERRAIN;
+		gWaterTriMeshData[f].points 			= gWaterPoints;						// indices are into the shared list
+		gWaterTriMeshData[f].triangles			= triangles;
+		gWaterTriMeshData[f].uvs[0]				= gWaterVertexUVs[0];
+		gWaterTriMeshData[f].uvs[1]				= gWaterVertexUVs[1];
+		gWaterTriMeshData[f].normals			= nil;
+		gWaterTriMeshData[f].colorsFloat		= nil;
+		gWaterTriMeshData[f].numPoints 			= firstPoint + numNubs + 1;
+		gWaterTriMeshData[f].numTriangles 		= numNubs;
+		gWaterTriMeshData[f].numMaterials		= 2;
+		gWaterTriMeshData[f].materials[0] 		= 											// set illegal ref to material
+		gWaterTriMeshData[f].materials[1] 		= mat;
+
+
 				/*************/
 				/* CALC BBOX */
 				/*************/
@@ -383,9 +446,9 @@ MOMaterialObject	*mat;
 
 					/* GET COORDS */
 
-			x = gWaterVertexArrays.points[f][i].x;
-			y = gWaterVertexArrays.points[f][i].y;
-			z = gWaterVertexArrays.points[f][i].z;
+			x = points[i].x;
+			y = points[i].y;
+			z = points[i].z;
 
 					/* CHECK BBOX */
 
@@ -414,16 +477,47 @@ MOMaterialObject	*mat;
 
 		for (i = 0; i <= numNubs; i++)
 		{
-			x = gWaterVertexArrays.points[f][i].x;
-			y = gWaterVertexArrays.points[f][i].y;
-			z = gWaterVertexArrays.points[f][i].z;
-
-			gWaterVertexArrays.uvs1[f][i].u 	= x * .0005;
-			gWaterVertexArrays.uvs1[f][i].v 	= z * .0005;
-			gWaterVertexArrays.uvs2[f][i].u 	= x * .0004;
-			gWaterVertexArrays.uvs2[f][i].v 	= z * .0004;
+			x = points[i].x;
+			z = points[i].z;
+
+			uvs1[i].u 	= x * .0005;
+			uvs1[i].v 	= z * .0005;
+			uvs2[i].u 	= x * .0004;
+			uvs2[i].v 	= z * .0004;
+		}
+
+		points		+= numNubs + 1;
+		uvs1		+= numNubs + 1;
+		uvs2		+= numNubs + 1;
+		triangles	+= numNubs;
+	}
+}
+
+
+/*************** DISPOSE WATER GEOMETRY *********************/
+
+static void DisposeWaterGeometry(void)
+{
+	if (gWaterPoints)
+	{
+		OGL_FreeVertexArrayMemory(gWaterPoints, VERTEX_ARRAY_RANGE_TYPE_TERRAIN);
+		gWaterPoints = nil;
+	}
+
+	for (int i = 0; i < 2; i++)
+	{
+		if (gWaterVertexUVs[i])
+		{
+			OGL_FreeVertexArrayMemory(gWaterVertexUVs[i], VERTEX_ARRAY_RANGE_TYPE_TERRAIN);
+			gWaterVertexUVs[i] = nil;
 		}
 	}
+
+	if (gWaterTriangles)
+	{
+		OGL_FreeVertexArrayMemory(gWaterTriangles, VERTEX_ARRAY_RANGE_TYPE_TERRAIN);
+		gWaterTriangles = nil;
+	}
 }
 
 
@@ -508,39 +602,48 @@ short	i;
 
 
 /********************* DRAW WATER ***********************/
+//
+// Each water type is drawn in as few calls as culling allows:  the patches of a type
+// are next to each other in the shared arrays, so a run of visible ones is one draw.
+//
 
 static void DrawWater(ObjNode *theNode)
 {
-long	prevType = -1;
-
 	(void) theNode;
 
-			/*******************/
-			/* DRAW EACH WATER */
-			/*******************/
-
 	gNumWaterDrawn = 0;
 
-	for (int f = 0; f < gNumWaterPatches; f++)
+	for (int waterType = 0; waterType < NUM_WATER_TYPES; waterType++)
 	{
-		long	waterType = gWaterList[f].type;
+		int		first = gWaterTypeFirst[waterType];
+		int		last = gWaterTypeFirst[waterType+1];
+		Boolean	didSetup = false;
 
-				/* DO BBOX CULLING */
-
-		if (OGL_IsBBoxVisible(&gWaterBBox[f], nil))
+		for (int n = first; n < last; )
 		{
-			gGlobalTransparency = gWaterTransparency[waterType];
+			MOVertexArrayData	run;
+			int					f = gWaterDrawOrder[n];
 
-			if (gWaterGlow[waterType])										// set glow
-				OGL_BlendFunc(GL_SRC_ALPHA, GL_ONE);
-			else
-				OGL_BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+					/* DO BBOX CULLING */
 
+			if (!OGL_IsBBoxVisible(&gWaterBBox[f], nil))
+			{
+				n++;
+				continue;
+			}
 
-				/* SET TEXTURE SCROLL FOR BOTH TEXTURE LAYERS */
 
-			if (waterType != prevType)										// only update UV's if this is a different water type than the last loop
+				/* SET BLENDING & TEXTURE SCROLL FOR BOTH TEXTURE LAYERS */
+
+			if (!didSetup)													// only once per water type
 			{
+				gGlobalTransparency = gWaterTransparency[waterType];
+
+				if (gWaterGlow[waterType])									// set glow
+					OGL_BlendFunc(GL_SRC_ALPHA, GL_ONE);
+				else
+					OGL_BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
 				glMatrixMode(GL_TEXTURE);									// set texture matrix
 				OGL_ActiveTextureUnit(GL_TEXTURE0);
 				glLoadIdentity();
@@ -550,13 +653,33 @@ long	prevType = -1;
 				glTranslatef(gWaterUVs[waterType][1].u, gWaterUVs[waterType][1].v, 0);
 				glMatrixMode(GL_MODELVIEW);
 				OGL_ActiveTextureUnit(GL_TEXTURE0);
+
+				didSetup = true;
 			}
-					/* DRAW IT */
 
-			MO_DrawGeometry_VertexArray(&gWaterTriMeshData[f]);
+
+				/* GATHER THE RUN OF VISIBLE PATCHES THAT FOLLOW */
+
+			run = gWaterTriMeshData[f];
 			gNumWaterDrawn++;
 
-			prevType = waterType;
+			for (n++; n < last; n++)
+			{
+				f = gWaterDrawOrder[n];
+				if (!OGL_IsBBoxVisible(&gWaterBBox[f], nil))
+				{
+					n++;													// (we already know this one's culled)
+					break;
+				}
+
+				run.numTriangles += gWaterTriMeshData[f].numTriangles;		// its triangles come right after
+				run.numPoints = gWaterTriMeshData[f].numPoints;
+				gNumWaterDrawn++;
+			}
+
+					/* DRAW IT */
+
+			MO_DrawGeometry_VertexArray(&run);
 		}
 	}
 
@@ -690,14 +813,47 @@ int	i;
 
 static void InitRipples(void)
 {
-int	i;
-
+	gFirstRipple = 0;
 	gNumRipples = 0;
 	gRippleEventObj = nil;
 
-	for (i = 0; i < MAX_RIPPLES; i++)
-			gRippleList[i].isUsed = false;
+			/* PRE-BUILD THE QUADS' UVS & TRIANGLES */
+
+	for (int q = 0; q < MAX_RIPPLES; q++)
+	{
+		OGLTextureCoord		*uv = &gRippleUVs[q * 4];
+		MOTriangleIndecies	*t = &gRippleTriangles[q * 2];
+
+		uv[0] = (OGLTextureCoord) {0,0};
+		uv[1] = (OGLTextureCoord) {1,0};
+		uv[2] = (OGLTextureCoord) {1,1};
+		uv[3] = (OGLTextureCoord) {0,1};
+
+		t[0].vertexIndices[0] = q*4 + 0;
+		t[0].vertexIndices[1] = q*4 + 1;
+		t[0].vertexIndices[2] = q*4 + 2;
+		t[1].vertexIndices[0] = q*4 + 0;
+		t[1].vertexIndices[1] = q*4 + 2;
+		t[1].vertexIndices[2] = q*4 + 3;
+	}
+}
+
+
+/********************** NEW RIPPLE ************************/
+//
+// Returns the index of a slot at the end of the ring buffer.
+// If it's full, the oldest ripple makes room.
+//
+
+static int NewRipple(void)
+{
+	if (gNumRipples == MAX_RIPPLES)
+	{
+		gFirstRipple = (gFirstRipple + 1) % MAX_RIPPLES;
+		gNumRipples--;
+	}
 
+	return((gFirstRipple + gNumRipples++) % MAX_RIPPLES);
 }
 
 
@@ -739,18 +895,8 @@ int		i;
 		/* ADD TO RIPPLE LIST */
 		/**********************/
 
-		/* SCAN FOR FREE RIPPLE SLOT */
-
-	for (i = 0; i < MAX_RIPPLES; i++)
-	{
-		if (!gRippleList[i].isUsed)
-			goto got_it;
-	}
-	return;												// no free slots
-
-got_it:
+	i = NewRipple();
 
-	gRippleList[i].isUsed = true;
 	gRippleList[i].coord.x = x;
 	gRippleList[i].coord.y = y;
 	gRippleList[i].coord.z = z;
@@ -759,8 +905,6 @@ got_it:
 	gRippleList[i].scaleSpeed = scaleSpeed;
 	gRippleList[i].alpha = .999f - (RandomFloat() * .2f);
 	gRippleList[i].fadeRate = fadeRate;
-
-	gNumRipples++;
 }
 
 
@@ -807,18 +951,8 @@ long	i, j;
 
 	for (j = 0; j < numRipples; j++)
 	{
-			/* SCAN FOR FREE RIPPLE SLOT */
+		i = NewRipple();
 
-		for (i = 0; i < MAX_RIPPLES; i++)
-		{
-			if (!gRippleList[i].isUsed)
-				goto got_it;
-		}
-		return;												// no free slots
-
-	got_it:
-
-		gRippleList[i].isUsed = true;
 		gRippleList[i].coord.x = x;
 		gRippleList[i].coord.y = y;
 		gRippleList[i].coord.z = z;
@@ -827,8 +961,6 @@ long	i, j;
 		gRippleList[i].scaleSpeed = scaleSpeed + RandomFloat() * scaleSpeed * 3.0f;
 		gRippleList[i].alpha = .999f - (RandomFloat() * .3f);
 		gRippleList[i].fadeRate = fadeRate;
-
-		gNumRipples++;
 	}
 }
 
@@ -838,21 +970,25 @@ long	i, j;
 
 static void MoveRippleEvent(ObjNode *theNode)
 {
-int		i;
 float	fps = gFramesPerSecondFrac;
 
-	for (i = 0; i < MAX_RIPPLES; i++)
+	for (int n = 0; n < gNumRipples; n++)
 	{
-		if (!gRippleList[i].isUsed)									// see if this ripple slot active
+		RippleType	*ripple = &gRippleList[(gFirstRipple + n) % MAX_RIPPLES];
+
+		if (ripple->alpha <= 0.0f)									// see if already faded
 			continue;
 
-		gRippleList[i].scale += fps * gRippleList[i].scaleSpeed;
-		gRippleList[i].alpha -= fps * gRippleList[i].fadeRate;
-		if (gRippleList[i].alpha <= 0.0f)							// see if done
-		{
-			gRippleList[i].isUsed = false;							// kill this slot
-			gNumRipples--;
-		}
+		ripple->scale += fps * ripple->scaleSpeed;
+		ripple->alpha -= fps * ripple->fadeRate;
+	}
+
+			/* DROP FADED RIPPLES FROM THE FRONT */
+
+	while ((gNumRipples > 0) && (gRippleList[gFirstRipple].alpha <= 0.0f))
+	{
+		gFirstRipple = (gFirstRipple + 1) % MAX_RIPPLES;
+		gNumRipples--;
 	}
 
 	if (gNumRipples <= 0)											// see if all done
@@ -868,46 +1004,59 @@ float	fps = gFramesPerSecondFrac;
 
 static void DrawRipples(ObjNode *theNode)
 {
-int			i;
-float		s,x,y,z;
+MOVertexArrayData	data;
+int					q = 0;
 
 #pragma unused (theNode)
 
-		/* ACTIVATE MATERIAL */
-
-	MO_DrawMaterial(gSpriteGroupList[SPRITE_GROUP_GLOBAL][GLOBAL_SObjType_WaterRipple].materialObject);
-
+		/* ADD EACH RIPPLE'S QUAD */
 
-		/* DRAW EACH RIPPLE */
-
-	for (i = 0; i < MAX_RIPPLES; i++)
+	for (int n = 0; n < gNumRipples; n++)
 	{
-		if (!gRippleList[i].isUsed)									// see if this ripple slot active
-			continue;
+		const RippleType	*ripple = &gRippleList[(gFirstRipple + n) % MAX_RIPPLES];
+		OGLPoint3D			*v = &gRipplePoints[q * 4];
+		OGLColorRGBA		*c = &gRippleColors[q * 4];
+		float				s,x,y,z;
 
-		x = gRippleList[i].coord.x;									// get coord
-		y = gRippleList[i].coord.y;
-		z = gRippleList[i].coord.z;
-
-		s = gRippleList[i].scale;									// get scale
-		OGL_SetColor4f(1,1,1,gRippleList[i].alpha);						// get/set alpha
+		if (ripple->alpha <= 0.0f)									// see if this ripple is gone
+			continue;
 
-		glBegin(GL_QUADS);
-		glTexCoord2f(0,0);	glVertex3f(x - s, y, z - s);
-		glTexCoord2f(1,0);	glVertex3f(x + s, y, z - s);
-		glTexCoord2f(1,1);	glVertex3f(x + s, y, z + s);
-		glTexCoord2f(0,1);	glVertex3f(x - s, y, z + s);
-		glEnd();
-	}
+		x = ripple->coord.x;										// get coord
+		y = ripple->coord.y;
+		z = ripple->coord.z;
+		s = ripple->scale;											// get scale
 
-	OGL_SetColor4f(1,1,1,1);
-	gGlobalTransparency = 1.0f;
-}
+		v[0] = (OGLPoint3D) {x - s, y, z - s};
+		v[1] = (OGLPoint3D) {x + s, y, z - s};
+		v[2] = (OGLPoint3D) {x + s, y, z + s};
+		v[3] = (OGLPoint3D) {x - s, y, z + s};
 
+		for (int j = 0; j < 4; j++)
+			c[j] = (OGLColorRGBA) {1, 1, 1, ripple->alpha};
 
+		q++;
+	}
 
+	if (q == 0)
+		return;
 
 
+		/* DRAW THEM ALL AT ONCE */
 
+	SDL_zero(data);
+	data.VARtype		= -1;											// lives in regular memory
+	data.numMaterials	= 1;
+	data.materials[0]	= gSpriteGroupList[SPRITE_GROUP_GLOBAL][GLOBAL_SObjType_WaterRipple].materialObject;
+	data.numPoints		= q * 4;
+	data.numTriangles	= q * 2;
+	data.points			= gRipplePoints;
+	data.uvs[0]			= gRippleUVs;
+	data.colorsFloat	= gRippleColors;
+	data.triangles		= gRippleTriangles;
 
+	gGlobalTransparency = .99f;										// (leave @ < 1 to ensure GL_BLEND)
+	MO_DrawGeometry_VertexArray(&data);
 
+	OGL_SetColor4f(1,1,1,1);
+	gGlobalTransparency = 1.0f;
+}